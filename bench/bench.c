@@ -0,0 +1,708 @@
+/**
+ * @file bench.c
+ * @brief Microbenchmarks for storage, product, transaction, report and shard code
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Loads a data set (see datagen.c), then times each operation in turn and
+ * prints one pipe-delimited row per benchmark: throughput plus per-operation
+ * latency percentiles. Output is meant to be saved and compared between
+ * commits, e.g. with diff or a spreadsheet.
+ *
+ * Each benchmark runs in samples. The batch size (operations per sample) is
+ * doubled until a sample takes at least BENCH_MIN_SAMPLE_US, so clock
+ * overhead stays negligible; samples are then taken until the time budget
+ * is spent. Percentiles are over per-operation times (sample time / batch).
+ * Benchmarks that modify the lists restore them between samples, outside
+ * the timed region, so every sample sees the same data.
+ *
+ * Usage:
+ *   benchmark [--data DIR] [--time SECONDS] [--only TEXT] [--threads N]
+ */
+
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "pool.h"
+#include "report.h"
+#include "shard.h"
+#include "storage.h"
+
+#define BENCH_MIN_SAMPLE_US 100.0   // Shortest sample worth timing
+#define BENCH_MIN_SAMPLES 3         // Samples taken even past the time budget
+#define BENCH_MAX_SAMPLES 10000
+#define BENCH_KEYS 4096             // Precomputed random lookup keys (power of two)
+#define BENCH_SEARCH_RESULTS 100    // Result buffer for name/category searches
+#define BENCH_SHARDS 4              // Shards of the sharded-store benchmarks
+
+typedef enum {
+    ROWS_PRODUCTS,
+    ROWS_SUPPLIERS,
+    ROWS_TRANSACTIONS
+} BenchRows;
+
+/**
+ * @brief One benchmark
+ *
+ * prepare and undo run untimed around every sample; run is the timed
+ * operation, called batch times per sample with i = 0..batch-1.
+ */
+typedef struct {
+    const char *name;
+    BenchRows rows;
+    int max_batch;                  ///< Largest batch (0 = unlimited)
+    void (*prepare)(int batch);
+    int (*run)(int i);              ///< Returns 0 if the operation failed
+    void (*undo)(int batch);
+} Benchmark;
+
+static ProductList products;
+static SupplierList suppliers;
+static TransactionList transactions;
+
+static char data_dir[256] = DATA_DIR;
+static char path[512];
+
+static unsigned long long rng_state = 1;
+static int product_keys[BENCH_KEYS];        // Random existing product IDs
+static int transaction_keys[BENCH_KEYS];    // Random existing transaction IDs
+static char name_keys[BENCH_KEYS][16];      // Name fragments of random products
+static const char *category_keys[BENCH_KEYS];
+static char date_keys[BENCH_KEYS][2][16];   // Week-long date ranges
+static char first_date[16], last_date[16];
+static int last_day;
+
+// Scratch buffers sized to the loaded lists
+static Product *product_results;
+static Transaction *transaction_results;
+static VelocityRow *velocity_results;
+static GroupRow *group_results;
+static AbcRow *abc_results;
+
+// State restored by undo
+static int saved_count;
+static int saved_next_id;
+static int next_product_id;
+static int *victim_slots;
+static Product *victims;
+static ShardedStore shards;         // Built on first use from the loaded lists
+static int shard_saved_counts[MAX_SHARDS];
+static int shard_saved_next_ids[MAX_SHARDS];
+static int shards_saved;            // Set once the shard files exist for the load benchmark
+static ProductList *shard_catalogue; // Targets of the gather benchmark, allocated on first use
+static TransactionList *shard_log;
+
+static unsigned long long next_random(void) {
+    unsigned long long z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(int n) {
+    return (n > 0) ? (int)(next_random() % (unsigned long long)n) : 0;
+}
+
+/**
+ * @brief Monotonic time in microseconds
+ */
+static double now_us(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e6 / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+#endif
+}
+
+static const char* data_path(const char *file) {
+    snprintf(path, sizeof(path), "%s/%s", data_dir, file);
+    return path;
+}
+
+/* ---- Storage ---- */
+
+static int run_load_products(int i) {
+    (void)i;
+    return storage_load_products_file(&products, data_path("products.txt"));
+}
+
+static int run_save_products(int i) {
+    (void)i;
+    return storage_save_products_file(&products, data_path("bench_products.tmp"));
+}
+
+static int run_load_suppliers(int i) {
+    (void)i;
+    return storage_load_suppliers_file(&suppliers, data_path("suppliers.txt"));
+}
+
+static int run_save_suppliers(int i) {
+    (void)i;
+    return storage_save_suppliers_file(&suppliers, data_path("bench_suppliers.tmp"));
+}
+
+static int run_load_transactions(int i) {
+    (void)i;
+    return storage_load_transactions_file(&transactions, data_path("transactions.txt"));
+}
+
+static int run_save_transactions(int i) {
+    (void)i;
+    return storage_save_transactions_file(&transactions, data_path("bench_transactions.tmp"));
+}
+
+/* ---- Products ---- */
+
+static void prepare_product_add(int batch) {
+    (void)batch;
+    saved_count = products.count;
+}
+
+static int run_product_add(int i) {
+    Product p = products.products[i % saved_count];
+    p.id = next_product_id + i;
+    return product_add(&products, &p);
+}
+
+static void undo_product_add(int batch) {
+    (void)batch;
+    products.count = saved_count;
+}
+
+// Victims are spread evenly over the list, one per stretch of count / batch
+static void prepare_product_delete(int batch) {
+    int stretch = products.count / batch;
+    for (int i = 0; i < batch; i++) {
+        victim_slots[i] = i * stretch + random_below(stretch);
+        victims[i] = products.products[victim_slots[i]];
+    }
+    saved_count = products.count;
+}
+
+static int run_product_delete(int i) {
+    return product_delete(&products, victims[i].id);
+}
+
+// Reopen the gaps from the back, so each row moves once
+static void undo_product_delete(int batch) {
+    int source = products.count - 1;
+    int target = saved_count - 1;
+    for (int i = batch - 1; i >= 0; i--) {
+        while (target > victim_slots[i]) products.products[target--] = products.products[source--];
+        products.products[target--] = victims[i];
+    }
+    products.count = saved_count;
+}
+
+static int run_product_update(int i) {
+    Product *p = product_find_by_id(&products, product_keys[i & (BENCH_KEYS - 1)]);
+    if (p == NULL) return 0;
+    Product updated = *p;
+    return product_update(&products, updated.id, &updated);
+}
+
+static int run_product_find_by_id(int i) {
+    return product_find_by_id(&products, product_keys[i & (BENCH_KEYS - 1)]) != NULL;
+}
+
+static int run_product_find_by_name(int i) {
+    product_find_by_name(&products, name_keys[i & (BENCH_KEYS - 1)], product_results,
+                         BENCH_SEARCH_RESULTS);
+    return 1;
+}
+
+static int run_product_find_by_category(int i) {
+    product_find_by_category(&products, category_keys[i & (BENCH_KEYS - 1)], product_results,
+                             BENCH_SEARCH_RESULTS);
+    return 1;
+}
+
+static int run_product_id_exists(int i) {
+    return product_id_exists(&products, product_keys[i & (BENCH_KEYS - 1)]);
+}
+
+static int run_product_get_low_stock(int i) {
+    (void)i;
+    product_get_low_stock(&products, product_results, products.count);
+    return 1;
+}
+
+static int run_product_get_all(int i) {
+    (void)i;
+    return product_get_all(&products, product_results) == products.count;
+}
+
+/* ---- Transactions ---- */
+
+static void prepare_transaction_add(int batch) {
+    (void)batch;
+    saved_count = transactions.count;
+    saved_next_id = transactions.next_id;
+}
+
+static int run_transaction_add(int i) {
+    Transaction t = transactions.transactions[i % saved_count];
+    t.transaction_id = transaction_get_next_id(&transactions);
+    return transaction_add(&transactions, &t);
+}
+
+static void undo_transaction_add(int batch) {
+    (void)batch;
+    transactions.count = saved_count;
+    transactions.next_id = saved_next_id;
+}
+
+static int run_transaction_find_by_id(int i) {
+    return transaction_find_by_id(&transactions, transaction_keys[i & (BENCH_KEYS - 1)]) != NULL;
+}
+
+static int run_transaction_get_by_product(int i) {
+    transaction_get_by_product(&transactions, product_keys[i & (BENCH_KEYS - 1)],
+                               transaction_results, transactions.count);
+    return 1;
+}
+
+static int run_transaction_get_by_date_range(int i) {
+    int key = i & (BENCH_KEYS - 1);
+    transaction_get_by_date_range(&transactions, date_keys[key][0], date_keys[key][1],
+                                  transaction_results, transactions.count);
+    return 1;
+}
+
+static int run_transaction_get_all(int i) {
+    (void)i;
+    return transaction_get_all(&transactions, transaction_results) == transactions.count;
+}
+
+static int run_transaction_get_next_id(int i) {
+    (void)i;
+    return transaction_get_next_id(&transactions) > 0;
+}
+
+/* ---- Reports ---- */
+
+static int run_report_total_products(int i) {
+    (void)i;
+    return report_total_products(&products) == products.count;
+}
+
+static int run_report_total_stock_value(int i) {
+    (void)i;
+    return report_total_stock_value(&products) >= 0.0;
+}
+
+static int run_report_top_by_quantity(int i) {
+    (void)i;
+    report_top_products_by_quantity(&products, product_results, 10);
+    return 1;
+}
+
+static int run_report_top_by_value(int i) {
+    (void)i;
+    report_top_products_by_value(&products, product_results, 10);
+    return 1;
+}
+
+static int run_report_low_stock(int i) {
+    (void)i;
+    report_low_stock_products(&products, product_results, products.count);
+    return 1;
+}
+
+static int run_report_count_by_date(int i) {
+    (void)i;
+    report_transaction_count_by_date(&transactions, first_date, last_date);
+    return 1;
+}
+
+static int run_report_count_by_date_prefix(int i) {
+    (void)i;
+    report_transaction_count_by_date_prefix(&transactions, transactions.count / 2,
+                                            first_date, last_date);
+    return 1;
+}
+
+static int run_report_stock_velocity(int i) {
+    (void)i;
+    return report_stock_velocity(&products, &transactions, 30, last_day, velocity_results) > 0;
+}
+
+static int run_report_dashboard(int i) {
+    static DashboardSummary summary;
+    (void)i;
+    return report_dashboard(&products, &summary);
+}
+
+static int run_report_group_category(int i) {
+    (void)i;
+    return report_group_stock(&products, &suppliers, REPORT_GROUP_CATEGORY, REPORT_SORT_VALUE,
+                              0, group_results) > 0;
+}
+
+static int run_report_group_supplier(int i) {
+    (void)i;
+    return report_group_stock(&products, &suppliers, REPORT_GROUP_SUPPLIER, REPORT_SORT_VALUE,
+                              0, group_results) > 0;
+}
+
+static int run_report_abc(int i) {
+    AbcSummary summary;
+    (void)i;
+    return report_abc_classification(&products, REPORT_ABC_A_SHARE, REPORT_ABC_B_SHARE,
+                                     abc_results, products.count, &summary) > 0;
+}
+
+/* ---- Sharded store ---- */
+
+// Partition the loaded lists the first time a shard benchmark runs
+static int ensure_shards(void) {
+    if (shards.count > 0) return 1;
+    if (shard_store_init(&shards, BENCH_SHARDS) &&
+        shard_store_import(&shards, &products, &transactions)) {
+        return 1;
+    }
+    shard_store_free(&shards);
+    return 0;
+}
+
+static void prepare_shard_move(int batch) {
+    (void)batch;
+    if (!ensure_shards()) return;
+    for (int k = 0; k < shards.count; k++) {
+        shard_saved_counts[k] = shards.shards[k].transactions->count;
+        shard_saved_next_ids[k] = shards.shards[k].transactions->next_id;
+    }
+}
+
+// Pairs of one unit in, then out, so stock levels end where they began
+static int run_shard_move(int i) {
+    int product_id = product_keys[(i / 2) & (BENCH_KEYS - 1)];
+    return shard_store_move(&shards, product_id,
+                            (i % 2 == 0) ? TRANSACTION_TYPE_IN : TRANSACTION_TYPE_OUT,
+                            1, "bench", NULL) == STOCK_OK;
+}
+
+static void undo_shard_move(int batch) {
+    (void)batch;
+    for (int k = 0; k < shards.count; k++) {
+        shards.shards[k].transactions->count = shard_saved_counts[k];
+        shards.shards[k].transactions->next_id = shard_saved_next_ids[k];
+    }
+}
+
+static void prepare_shards(int batch) {
+    (void)batch;
+    ensure_shards();
+}
+
+static int run_shard_summary(int i) {
+    ShardSummary summary;
+    (void)i;
+    return shard_store_summary(&shards, &summary) && summary.product_count == products.count;
+}
+
+static int run_shard_save(int i) {
+    (void)i;
+    shards_saved = shard_store_save(&shards, data_path("bench_shards.tmp"));
+    return shards_saved;
+}
+
+static void prepare_shard_load(int batch) {
+    (void)batch;
+    if (ensure_shards() && !shards_saved) {
+        run_shard_save(0);
+    }
+}
+
+static int run_shard_load(int i) {
+    (void)i;
+    return shard_store_load(&shards, data_path("bench_shards.tmp"));
+}
+
+static void prepare_shard_gather(int batch) {
+    prepare_shards(batch);
+    if (shard_catalogue == NULL) shard_catalogue = calloc(1, sizeof(ProductList));
+    if (shard_log == NULL) shard_log = calloc(1, sizeof(TransactionList));
+}
+
+static int run_shard_gather(int i) {
+    (void)i;
+    return shard_catalogue != NULL && shard_log != NULL &&
+           shard_store_gather(&shards, shard_catalogue, shard_log) &&
+           shard_log->count == transactions.count;
+}
+
+// Delete the files of the shard save benchmark
+static void remove_shard_files(void) {
+    char file[600];
+    for (int k = 0; k < BENCH_SHARDS; k++) {
+        snprintf(file, sizeof(file), "%s/bench_shards.tmp/%d/products.txt", data_dir, k);
+        remove(file);
+        snprintf(file, sizeof(file), "%s/bench_shards.tmp/%d/transactions.txt", data_dir, k);
+        remove(file);
+        snprintf(file, sizeof(file), "%s/bench_shards.tmp/%d", data_dir, k);
+        remove(file);
+    }
+    remove(data_path("bench_shards.tmp"));
+}
+
+static const Benchmark benchmarks[] = {
+    {"storage_load_products", ROWS_PRODUCTS, 1, NULL, run_load_products, NULL},
+    {"storage_save_products", ROWS_PRODUCTS, 1, NULL, run_save_products, NULL},
+    {"storage_load_suppliers", ROWS_SUPPLIERS, 1, NULL, run_load_suppliers, NULL},
+    {"storage_save_suppliers", ROWS_SUPPLIERS, 1, NULL, run_save_suppliers, NULL},
+    {"storage_load_transactions", ROWS_TRANSACTIONS, 1, NULL, run_load_transactions, NULL},
+    {"storage_save_transactions", ROWS_TRANSACTIONS, 1, NULL, run_save_transactions, NULL},
+    {"product_add", ROWS_PRODUCTS, 0, prepare_product_add, run_product_add, undo_product_add},
+    {"product_delete", ROWS_PRODUCTS, BENCH_KEYS, prepare_product_delete, run_product_delete,
+     undo_product_delete},
+    {"product_update", ROWS_PRODUCTS, 0, NULL, run_product_update, NULL},
+    {"product_find_by_id", ROWS_PRODUCTS, 0, NULL, run_product_find_by_id, NULL},
+    {"product_find_by_name", ROWS_PRODUCTS, 0, NULL, run_product_find_by_name, NULL},
+    {"product_find_by_category", ROWS_PRODUCTS, 0, NULL, run_product_find_by_category, NULL},
+    {"product_id_exists", ROWS_PRODUCTS, 0, NULL, run_product_id_exists, NULL},
+    {"product_get_low_stock", ROWS_PRODUCTS, 0, NULL, run_product_get_low_stock, NULL},
+    {"product_get_all", ROWS_PRODUCTS, 0, NULL, run_product_get_all, NULL},
+    {"transaction_add", ROWS_TRANSACTIONS, 0, prepare_transaction_add, run_transaction_add,
+     undo_transaction_add},
+    {"transaction_find_by_id", ROWS_TRANSACTIONS, 0, NULL, run_transaction_find_by_id, NULL},
+    {"transaction_get_by_product", ROWS_TRANSACTIONS, 0, NULL, run_transaction_get_by_product, NULL},
+    {"transaction_get_by_date_range", ROWS_TRANSACTIONS, 0, NULL,
+     run_transaction_get_by_date_range, NULL},
+    {"transaction_get_all", ROWS_TRANSACTIONS, 0, NULL, run_transaction_get_all, NULL},
+    {"transaction_get_next_id", ROWS_TRANSACTIONS, 0, NULL, run_transaction_get_next_id, NULL},
+    {"report_total_products", ROWS_PRODUCTS, 0, NULL, run_report_total_products, NULL},
+    {"report_total_stock_value", ROWS_PRODUCTS, 0, NULL, run_report_total_stock_value, NULL},
+    {"report_top_products_by_quantity", ROWS_PRODUCTS, 0, NULL, run_report_top_by_quantity, NULL},
+    {"report_top_products_by_value", ROWS_PRODUCTS, 0, NULL, run_report_top_by_value, NULL},
+    {"report_low_stock_products", ROWS_PRODUCTS, 0, NULL, run_report_low_stock, NULL},
+    {"report_transaction_count_by_date", ROWS_TRANSACTIONS, 0, NULL, run_report_count_by_date, NULL},
+    {"report_transaction_count_by_date_prefix", ROWS_TRANSACTIONS, 0, NULL,
+     run_report_count_by_date_prefix, NULL},
+    {"report_stock_velocity", ROWS_TRANSACTIONS, 0, NULL, run_report_stock_velocity, NULL},
+    {"report_dashboard", ROWS_PRODUCTS, 0, NULL, run_report_dashboard, NULL},
+    {"report_group_stock_category", ROWS_PRODUCTS, 0, NULL, run_report_group_category, NULL},
+    {"report_group_stock_supplier", ROWS_PRODUCTS, 0, NULL, run_report_group_supplier, NULL},
+    {"report_abc_classification", ROWS_PRODUCTS, 0, NULL, run_report_abc, NULL},
+    {"shard_store_move", ROWS_PRODUCTS, 0, prepare_shard_move, run_shard_move, undo_shard_move},
+    {"shard_store_summary", ROWS_PRODUCTS, 0, prepare_shards, run_shard_summary, NULL},
+    {"shard_store_save", ROWS_TRANSACTIONS, 1, prepare_shards, run_shard_save, NULL},
+    {"shard_store_load", ROWS_TRANSACTIONS, 1, prepare_shard_load, run_shard_load, NULL},
+    {"shard_store_gather", ROWS_TRANSACTIONS, 1, prepare_shard_gather, run_shard_gather, NULL},
+};
+
+#define BENCHMARK_COUNT ((int)(sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Run one sample
+ * @return Sample time in microseconds, or -1 if an operation failed
+ */
+static double run_sample(const Benchmark *b, int batch) {
+    int ok = 1;
+    if (b->prepare != NULL) b->prepare(batch);
+    
+    double start = now_us();
+    for (int i = 0; i < batch; i++) ok &= b->run(i);
+    double elapsed = now_us() - start;
+    
+    if (b->undo != NULL) b->undo(batch);
+    return ok ? elapsed : -1.0;
+}
+
+/**
+ * @brief Calibrate, sample and print one benchmark
+ * @param b Benchmark
+ * @param budget_us Time budget for sampling
+ * @param samples Scratch for BENCH_MAX_SAMPLES times
+ * @return 1 on success, 0 if an operation failed
+ */
+static int run_benchmark(const Benchmark *b, double budget_us, double *samples) {
+    int rows = (b->rows == ROWS_PRODUCTS) ? products.count
+             : (b->rows == ROWS_SUPPLIERS) ? suppliers.count : transactions.count;
+    int max_batch = b->max_batch;
+    // Deletes need a victim per stretch of the list
+    if (b->undo == undo_product_delete && max_batch > products.count) max_batch = products.count;
+    
+    int batch = 1;
+    double elapsed = run_sample(b, batch);
+    while (elapsed >= 0 && elapsed < BENCH_MIN_SAMPLE_US &&
+           (max_batch == 0 || batch * 2 <= max_batch)) {
+        batch *= 2;
+        elapsed = run_sample(b, batch);
+    }
+    if (elapsed < 0) {
+        printf("%s|%d|%d|0|FAILED|||||\n", b->name, rows, batch);
+        return 0;
+    }
+    
+    int count = 0;
+    double total = 0.0;
+    double start = now_us();
+    while (count < BENCH_MAX_SAMPLES &&
+           (count < BENCH_MIN_SAMPLES || now_us() - start < budget_us)) {
+        elapsed = run_sample(b, batch);
+        if (elapsed < 0) {
+            printf("%s|%d|%d|%d|FAILED|||||\n", b->name, rows, batch, count);
+            return 0;
+        }
+        samples[count++] = elapsed / batch;
+        total += elapsed;
+    }
+    
+    qsort(samples, (size_t)count, sizeof(double), compare_doubles);
+    printf("%s|%d|%d|%d|%.1f|%.3f|%.3f|%.3f|%.3f|%.3f\n", b->name, rows, batch, count,
+           (double)count * batch / (total / 1e6), total / ((double)count * batch),
+           percentile(samples, count, 50), percentile(samples, count, 90),
+           percentile(samples, count, 99), samples[count - 1]);
+    fflush(stdout);
+    return 1;
+}
+
+/**
+ * @brief Draw lookup keys and size the scratch buffers for the loaded data
+ * @return 1 on success, 0 on allocation failure or missing data
+ */
+static int prepare_data(void) {
+    if (products.count == 0 || transactions.count == 0) {
+        fprintf(stderr, "No products or transactions in %s (run datagen first)\n", data_dir);
+        return 0;
+    }
+    
+    for (int i = 0; i < products.count; i++) {
+        if (products.products[i].id >= next_product_id) next_product_id = products.products[i].id + 1;
+    }
+    first_date[0] = last_date[0] = '\0';
+    last_day = 0;
+    for (int i = 0; i < transactions.count; i++) {
+        const char *date = transactions.transactions[i].date_time;
+        int day;
+        if (date_to_days(date, &day) && day > last_day) last_day = day;
+    }
+    days_to_date(last_day - 29, first_date, sizeof(first_date));
+    days_to_date(last_day, last_date, sizeof(last_date));
+    
+    for (int i = 0; i < BENCH_KEYS; i++) {
+        const Product *p = &products.products[random_below(products.count)];
+        product_keys[i] = p->id;
+        category_keys[i] = p->category;
+        // The tail of a name (its model code) is nearly unique
+        size_t length = strlen(p->name);
+        snprintf(name_keys[i], sizeof(name_keys[i]), "%s", p->name + (length > 7 ? length - 7 : 0));
+        
+        transaction_keys[i] = transactions.transactions[random_below(transactions.count)].transaction_id;
+        int first = last_day - random_below(365);
+        days_to_date(first - 6, date_keys[i][0], sizeof(date_keys[i][0]));
+        days_to_date(first, date_keys[i][1], sizeof(date_keys[i][1]));
+    }
+    
+    size_t n = (size_t)products.count;
+    product_results = malloc(sizeof(Product) * n);
+    transaction_results = malloc(sizeof(Transaction) * (size_t)transactions.count);
+    velocity_results = malloc(sizeof(VelocityRow) * n);
+    group_results = malloc(sizeof(GroupRow) * n);
+    abc_results = malloc(sizeof(AbcRow) * n);
+    victim_slots = malloc(sizeof(int) * BENCH_KEYS);
+    victims = malloc(sizeof(Product) * BENCH_KEYS);
+    return product_results != NULL && transaction_results != NULL && velocity_results != NULL &&
+           group_results != NULL && abc_results != NULL && victim_slots != NULL && victims != NULL;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --data DIR      Data set to load (default data)\n");
+    printf("  --time SECONDS  Sampling time per benchmark (default 0.5)\n");
+    printf("  --only TEXT     Run benchmarks whose name contains TEXT\n");
+    printf("  --threads N     Worker threads for parallel reports (default: one per CPU)\n");
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = 0.5;
+    const char *only = NULL;
+    int threads = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+        
+        if (ok && strcmp(argv[i], "--data") == 0) {
+            snprintf(data_dir, sizeof(data_dir), "%s", value);
+        } else if (ok && strcmp(argv[i], "--time") == 0) {
+            ok = sscanf(value, "%lf", &seconds) == 1 && seconds > 0;
+        } else if (ok && strcmp(argv[i], "--only") == 0) {
+            only = value;
+        } else if (ok && strcmp(argv[i], "--threads") == 0) {
+            ok = sscanf(value, "%d", &threads) == 1 && threads >= 0;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    
+    if (!storage_load_products_file(&products, data_path("products.txt")) ||
+        !storage_load_suppliers_file(&suppliers, data_path("suppliers.txt")) ||
+        !storage_load_transactions_file(&transactions, data_path("transactions.txt")) ||
+        !prepare_data()) {
+        return 1;
+    }
+    pool_start(threads);
+    
+    double *samples = malloc(sizeof(double) * BENCH_MAX_SAMPLES);
+    if (samples == NULL) return 1;
+    
+    printf("# bench data=%s products=%d suppliers=%d transactions=%d threads=%d\n", data_dir,
+           products.count, suppliers.count, transactions.count, pool_size());
+    printf("benchmark|rows|batch|samples|ops_per_sec|mean_us|p50_us|p90_us|p99_us|max_us\n");
+    
+    int failed = 0;
+    for (int i = 0; i < BENCHMARK_COUNT; i++) {
+        if (only != NULL && strstr(benchmarks[i].name, only) == NULL) continue;
+        if (!run_benchmark(&benchmarks[i], seconds * 1e6, samples)) failed++;
+    }
+    
+    remove(data_path("bench_products.tmp"));
+    remove(data_path("bench_suppliers.tmp"));
+    remove(data_path("bench_transactions.tmp"));
+    if (shards_saved) remove_shard_files();
+    pool_stop();
+    shard_store_free(&shards);
+    free(shard_catalogue);
+    free(shard_log);
+    free(samples);
+    free(product_results);
+    free(transaction_results);
+    free(velocity_results);
+    free(group_results);
+    free(abc_results);
+    free(victim_slots);
+    free(victims);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file datagen.c
+ * @brief Deterministic synthetic data generator for benchmarks
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Writes products.txt, suppliers.txt and transactions.txt in the formats
+ * the storage module reads. The same seed and sizes always produce the
+ * same files, so benchmark runs on different machines or commits compare
+ * like with like. Rows are streamed, so any scale can be generated
+ * whatever MAX_PRODUCTS the application was built with.
+ *
+ * Transactions are in time order over the chosen number of days, and pick
+ * products with a skew (a few hot products get most movements), as a real
+ * log would. About one product in eight is at or below its reorder level.
+ *
+ * Usage:
+ *   datagen [--scale 1k|10k|100k|1m|10m] [--products N] [--suppliers N]
+ *           [--transactions N] [--days N] [--start YYYY-MM-DD]
+ *           [--seed N] [--out DIR]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include "storage.h"
+#include "utils.h"
+
+#define DATAGEN_BUFFER_SIZE (1 << 20)   // stdio buffer per output file
+
+static const char *const adjectives[] = {
+    "Cordless", "Heavy Duty", "Compact", "Wireless", "Stainless", "Digital", "Portable",
+    "Industrial", "Premium", "Smart", "Magnetic", "Adjustable", "Rechargeable", "Classic",
+    "Ergonomic", "Waterproof"
+};
+static const char *const nouns[] = {
+    "Drill", "Speaker", "Hammer", "Screwdriver Set", "Wrench", "Saw", "Lamp", "Cable",
+    "Adapter", "Charger", "Mouse", "Keyboard", "Monitor", "Router", "Kettle", "Toaster",
+    "Backpack", "Bottle", "Helmet", "Tape Measure", "Clamp", "Sander", "Glue Gun", "Battery"
+};
+static const char *const categories[] = {
+    "Electronics", "Tools", "Hardware", "Kitchen", "Office", "Outdoor", "Safety",
+    "Lighting", "Automotive", "Garden", "Plumbing", "Electrical", "Storage", "Sports",
+    "Cleaning", "Furniture"
+};
+static const char *const uses[] = {"home", "workshop", "office", "site", "outdoor", "travel"};
+static const char *const in_notes[] = {"restock", "supplier delivery", "customer return", "transfer in"};
+static const char *const out_notes[] = {"customer order", "online order", "damaged", "transfer out"};
+
+#define COUNT_OF(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+static unsigned long long rng_state;
+
+// splitmix64: fast, and identical on every platform
+static unsigned long long next_random(void) {
+    unsigned long long z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(int n) {
+    return (int)(next_random() % (unsigned long long)n);
+}
+
+// Uniform in [0, 1)
+static double random_unit(void) {
+    return (double)(next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Parse a count with an optional k or m suffix ("100k", "10m")
+ * @param text Text to parse
+ * @param value Output count
+ * @return 1 on success, 0 if invalid
+ */
+static int parse_count(const char *text, long *value) {
+    char *end;
+    double number = strtod(text, &end);
+    
+    if (end == text || number < 0) return 0;
+    if (tolower((unsigned char)*end) == 'k') {
+        number *= 1e3;
+        end++;
+    } else if (tolower((unsigned char)*end) == 'm') {
+        number *= 1e6;
+        end++;
+    }
+    if (*end != '\0' || number > 2e9) return 0;
+    *value = (long)number;
+    return 1;
+}
+
+static FILE* open_output(const char *dir, const char *name, char *buffer) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return NULL;
+    }
+    setvbuf(file, buffer, _IOFBF, DATAGEN_BUFFER_SIZE);
+    return file;
+}
+
+static void write_suppliers(FILE *file, long count) {
+    fprintf(file, "supplier_id|name|contact_number|email|address\n");
+    for (long id = 1; id <= count; id++) {
+        fprintf(file, "%ld|%s Supply Co %ld|555%07ld|orders%ld@supplier%ld.example|%d Market Street, Unit %ld\n",
+                id, nouns[random_below(COUNT_OF(nouns))], id, id % 10000000L, id, id,
+                1 + random_below(999), id);
+    }
+}
+
+static void write_products(FILE *file, long count, long suppliers) {
+    fprintf(file, "id|name|category|description|quantity|reorder_level|price|supplier_id\n");
+    for (long id = 1; id <= count; id++) {
+        const char *noun = nouns[random_below(COUNT_OF(nouns))];
+        int reorder = 5 + random_below(46);
+        // One product in eight at or below its reorder level
+        int quantity = (random_below(8) == 0) ? random_below(reorder + 1)
+                                              : reorder + 1 + random_below(500);
+        // Prices spread over 0.50-1000.00, most of them low
+        double price = 0.5 + 999.5 * pow(random_unit(), 3.0);
+        
+        fprintf(file, "%ld|%s %s %c%c-%04d|%s|%s for %s use|%d|%d|%.2f|%ld\n",
+                id, adjectives[random_below(COUNT_OF(adjectives))], noun,
+                'A' + random_below(26), 'A' + random_below(26), random_below(10000),
+                categories[random_below(COUNT_OF(categories))], noun,
+                uses[random_below(COUNT_OF(uses))], quantity, reorder, price,
+                1 + (long)random_below((int)suppliers));
+    }
+}
+
+static void write_transactions(FILE *file, long count, long products, int first_day, int days) {
+    double span = (double)days * 86400.0;
+    
+    fprintf(file, "transaction_id|product_id|type|quantity|date_time|notes\n");
+    for (long i = 0; i < count; i++) {
+        // Evenly spaced in time with jitter, so the log stays in order
+        long long second = (long long)((i + random_unit()) * span / (double)count);
+        char date[16];
+        days_to_date(first_day + (int)(second / 86400), date, sizeof(date));
+        int in_day = (int)(second % 86400);
+        
+        // Skewed popularity: low ranks are hot, scattered over the IDs by a
+        // multiplicative permutation
+        long rank = (long)(pow(random_unit(), 2.5) * (double)products);
+        long product = 1 + (long)(((unsigned long long)rank * 2654435761ULL) % (unsigned long long)products);
+        
+        int in = random_below(5) < 2;
+        fprintf(file, "%ld|%ld|%s|%d|%s %02d:%02d:%02d|%s\n", i + 1, product,
+                in ? TRANSACTION_TYPE_IN : TRANSACTION_TYPE_OUT,
+                in ? 10 + random_below(191) : 1 + random_below(20),
+                date, in_day / 3600, in_day / 60 % 60, in_day % 60,
+                in ? in_notes[random_below(COUNT_OF(in_notes))]
+                   : out_notes[random_below(COUNT_OF(out_notes))]);
+    }
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --scale S           Preset sizes: 1k, 10k, 100k, 1m or 10m products\n");
+    printf("                      (1 supplier per 200 products, 2 transactions per product)\n");
+    printf("  --products N        Products (k/m suffixes allowed)\n");
+    printf("  --suppliers N       Suppliers\n");
+    printf("  --transactions N    Transactions\n");
+    printf("  --days N            Days the transactions span (default 365)\n");
+    printf("  --start YYYY-MM-DD  First transaction day (default 2024-01-01)\n");
+    printf("  --seed N            Random seed (default 1)\n");
+    printf("  --out DIR           Output directory (default data)\n");
+}
+
+int main(int argc, char *argv[]) {
+    long products = 1000, suppliers = -1, transactions = -1, days = 365;
+    unsigned long long seed = 1;
+    const char *start = "2024-01-01";
+    const char *out = DATA_DIR;
+    int first_day;
+    
+    for (int i = 1; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+        
+        if (strcmp(argv[i], "--scale") == 0 || strcmp(argv[i], "--products") == 0) {
+            ok = ok && parse_count(value, &products) && products > 0;
+        } else if (strcmp(argv[i], "--suppliers") == 0) {
+            ok = ok && parse_count(value, &suppliers) && suppliers > 0;
+        } else if (strcmp(argv[i], "--transactions") == 0) {
+            ok = ok && parse_count(value, &transactions);
+        } else if (strcmp(argv[i], "--days") == 0) {
+            ok = ok && parse_count(value, &days) && days > 0;
+        } else if (strcmp(argv[i], "--start") == 0) {
+            start = value;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            ok = ok && sscanf(value, "%llu", &seed) == 1;
+        } else if (strcmp(argv[i], "--out") == 0) {
+            out = value;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (suppliers < 0) suppliers = (products >= 1000) ? products / 200 : 5;
+    if (transactions < 0) transactions = products * 2;
+    if (start == NULL || !date_to_days(start, &first_day)) {
+        fprintf(stderr, "Invalid start date: %s\n", start != NULL ? start : "");
+        return 2;
+    }
+    if (!storage_ensure_directory(out)) {
+        fprintf(stderr, "Cannot create %s\n", out);
+        return 2;
+    }
+    
+    static char buffer[DATAGEN_BUFFER_SIZE];
+    clock_t begin = clock();
+    rng_state = seed;
+    
+    // Each file draws from its own stream, so changing one size leaves the
+    // rows of the other files unchanged
+    const char *names[] = {"suppliers.txt", "products.txt", "transactions.txt"};
+    for (int f = 0; f < 3; f++) {
+        FILE *file = open_output(out, names[f], buffer);
+        if (file == NULL) return 1;
+        
+        rng_state = seed * 3 + (unsigned long long)f;
+        if (f == 0) {
+            write_suppliers(file, suppliers);
+        } else if (f == 1) {
+            write_products(file, products, suppliers);
+        } else {
+            write_transactions(file, transactions, products, first_day, (int)days);
+        }
+        if (fclose(file) != 0) {
+            fprintf(stderr, "Cannot write %s/%s\n", out, names[f]);
+            return 1;
+        }
+    }
+    
+    fprintf(stderr, "Wrote %ld products, %ld suppliers and %ld transactions to %s in %.1f s\n",
+            products, suppliers, transactions, out, (double)(clock() - begin) / CLOCKS_PER_SEC);
+    return 0;
+}
@@ -0,0 +1,606 @@
+/**
+ * @file loadgen.c
+ * @brief Multi-threaded load generator for the stock engine
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Loads a data set (see datagen.c) and drives it from several threads at
+ * once with a mix of stock-in, stock-out, name search and dashboard report
+ * operations, calling the product, stock engine and report APIs directly.
+ * Movements go through the concurrent stock engine; searches and reports
+ * read snapshot versions that a publisher thread refreshes from the engine,
+ * as a server would serve readers next to writers. With --shards N the
+ * movements go to a sharded store instead (see shard.h) and reports are its
+ * fan-out summary, so the two write paths can be compared under the same
+ * load; searches then read the loaded names, which movements never change.
+ *
+ * Operations pick products with Zipf-distributed popularity (a few hot
+ * products get most of the traffic), or replay a recorded movement stream:
+ * a transactions.txt log or a product_id|type|quantity|notes file, taken
+ * in order and repeated as needed.
+ *
+ * The run is a series of steps, one per target rate. A paced step issues
+ * operations on a fixed schedule and measures each from its scheduled
+ * start, so time spent queued behind a slow operation counts (no
+ * coordinated omission); rate 0 runs each thread flat out. Every step
+ * starts from the loaded data. Rows give achieved throughput and latency
+ * percentiles per operation; plotted against the target rate they give
+ * the throughput and latency curves of the build being tested.
+ *
+ * Usage:
+ *   loadgen [--data DIR] [--threads N] [--rate R[,R...]] [--duration SECONDS]
+ *           [--mix IN:OUT:SEARCH:REPORT] [--zipf S] [--replay FILE]
+ *           [--refresh-ms N] [--shards N] [--seed N] [--no-metrics]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "metrics.h"
+#include "report.h"
+#include "shard.h"
+#include "snapshot.h"
+#include "stock.h"
+#include "storage.h"
+#include "sync.h"
+
+#define LOADGEN_MAX_THREADS 256
+#define LOADGEN_MAX_STEPS 32
+#define LOADGEN_SEARCH_RESULTS 100  // Result buffer for name searches
+#define LOADGEN_START_DELAY_NS 2000000ULL   // Lets every thread start before the step clock
+
+typedef enum {
+    OP_IN,
+    OP_OUT,
+    OP_SEARCH,
+    OP_REPORT,
+    OP_COUNT
+} LoadOp;
+
+static const char *const op_names[OP_COUNT] = {"in", "out", "search", "report"};
+
+/**
+ * @brief One operation to issue
+ */
+typedef struct {
+    LoadOp op;
+    int product_id;                 ///< Product to move (movements)
+    int slot;                       ///< Product whose name is searched (search)
+    int quantity;                   ///< Units to move (movements)
+} Operation;
+
+/**
+ * @brief State of one load thread
+ */
+typedef struct {
+    int id;
+    Thread thread;
+    unsigned long long rng;
+    long long failed[OP_COUNT];
+    int full;                                   ///< Saw STOCK_ERR_FULL
+    LatencyHistogram latency[OP_COUNT];
+    Product results[LOADGEN_SEARCH_RESULTS];
+    DashboardSummary dashboard;
+    ShardSummary shard_summary;
+} Worker;
+
+static ProductList products;
+static TransactionList transactions;
+static StockEngine engine;
+static SnapshotStore snapshots;
+static ShardedStore shards;
+static int shard_count;             // 0 drives the stock engine
+
+static char data_dir[256] = DATA_DIR;
+static char path[512];
+
+// Workload
+static int thread_count;
+static int mix[OP_COUNT] = {30, 50, 15, 5};
+static int mix_total;
+static double zipf_exponent = 1.0;
+static double *zipf_cdf;            // Popularity rank to cumulative share
+static int *ranked_slots;           // Popularity rank to product slot
+static StockMovement *replay_rows;
+static int replay_count;
+static atomic_long replay_cursor;
+static int refresh_ms = 100;
+
+// Current step
+static unsigned long long step_begin;
+static unsigned long long step_end;
+static double step_interval_ns;     // Per thread; 0 runs flat out
+static atomic_int publisher_stop;
+
+// Loaded state restored after every step
+static int *saved_quantities;
+static int saved_count;
+static int saved_next_id;
+
+// splitmix64, one stream per thread
+static unsigned long long next_random(unsigned long long *state) {
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int random_below(unsigned long long *state, int n) {
+    return (n > 0) ? (int)(next_random(state) % (unsigned long long)n) : 0;
+}
+
+// Uniform in [0, 1)
+static double random_unit(unsigned long long *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static const char* data_path(const char *file) {
+    snprintf(path, sizeof(path), "%s/%s", data_dir, file);
+    return path;
+}
+
+/**
+ * @brief Rank the products by popularity
+ *
+ * Rank r gets a share proportional to 1 / (r + 1)^s. Ranks are assigned to
+ * a random permutation of the slots, so hot products are spread over the
+ * list (and over the engine's lock stripes) rather than being its head.
+ *
+ * @param seed Random seed
+ * @return 1 on success, 0 on allocation failure
+ */
+static int build_popularity(unsigned long long seed) {
+    int n = products.count;
+    zipf_cdf = malloc(sizeof(double) * (size_t)n);
+    ranked_slots = malloc(sizeof(int) * (size_t)n);
+    if (zipf_cdf == NULL || ranked_slots == NULL) return 0;
+    
+    double total = 0.0;
+    for (int r = 0; r < n; r++) {
+        total += pow((double)(r + 1), -zipf_exponent);
+        zipf_cdf[r] = total;
+    }
+    for (int r = 0; r < n; r++) {
+        zipf_cdf[r] /= total;
+        ranked_slots[r] = r;
+    }
+    
+    unsigned long long state = seed;
+    for (int r = n - 1; r > 0; r--) {
+        int other = random_below(&state, r + 1);
+        int slot = ranked_slots[r];
+        ranked_slots[r] = ranked_slots[other];
+        ranked_slots[other] = slot;
+    }
+    return 1;
+}
+
+// Slot of a product drawn by popularity
+static int pick_slot(Worker *w) {
+    double u = random_unit(&w->rng);
+    int low = 0, high = products.count - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (zipf_cdf[middle] < u) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return ranked_slots[low];
+}
+
+/**
+ * @brief Load a recorded movement stream
+ *
+ * A transactions log (with its "transaction_id|" header) is replayed as
+ * its product_id, type and quantity columns; anything else is read as a
+ * movement file.
+ *
+ * @param file_path File to read
+ * @return 1 on success, 0 on failure
+ */
+static int load_replay(const char *file_path) {
+    FILE *file = fopen(file_path, "r");
+    if (file == NULL) return 0;
+    
+    char line[1000];
+    if (fgets(line, sizeof(line), file) == NULL || strncmp(line, "transaction_id|", 15) != 0) {
+        fclose(file);
+        return storage_load_movements(file_path, &replay_rows, &replay_count);
+    }
+    
+    int capacity = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        Transaction t;
+        if (!storage_parse_transaction(line, &t)) continue;
+        
+        if (replay_count == capacity) {
+            capacity = (capacity > 0) ? capacity * 2 : 1024;
+            StockMovement *grown = realloc(replay_rows, sizeof(StockMovement) * (size_t)capacity);
+            if (grown == NULL) {
+                fclose(file);
+                return 0;
+            }
+            replay_rows = grown;
+        }
+        StockMovement *row = &replay_rows[replay_count++];
+        memset(row, 0, sizeof(*row));
+        row->line_no = replay_count + 1;
+        row->product_id = t.product_id;
+        snprintf(row->type, sizeof(row->type), "%s", t.type);
+        row->quantity = t.quantity;
+    }
+    fclose(file);
+    return 1;
+}
+
+static Operation next_operation(Worker *w) {
+    Operation operation = {OP_IN, 0, 0, 0};
+    int draw = random_below(&w->rng, mix_total);
+    
+    int op = 0;
+    while (draw >= mix[op]) draw -= mix[op++];
+    operation.op = (LoadOp)op;
+    
+    if (operation.op == OP_SEARCH) {
+        operation.slot = pick_slot(w);
+    } else if (operation.op != OP_REPORT && replay_count > 0) {
+        // Movements come from the recording, in order
+        long next = atomic_fetch_add(&replay_cursor, 1);
+        const StockMovement *row = &replay_rows[next % replay_count];
+        operation.op = (strcmp(row->type, TRANSACTION_TYPE_IN) == 0) ? OP_IN : OP_OUT;
+        operation.product_id = row->product_id;
+        operation.quantity = row->quantity;
+    } else if (operation.op != OP_REPORT) {
+        // Same sizes as datagen: large deliveries, small orders
+        operation.product_id = products.products[pick_slot(w)].id;
+        operation.quantity = (operation.op == OP_IN) ? 10 + random_below(&w->rng, 191)
+                                                     : 1 + random_below(&w->rng, 20);
+    }
+    return operation;
+}
+
+/**
+ * @brief Issue one operation
+ * @param w Calling thread
+ * @param operation Operation to issue
+ * @return 1 if it succeeded, 0 otherwise
+ */
+static int perform(Worker *w, const Operation *operation) {
+    if (operation->op == OP_IN || operation->op == OP_OUT) {
+        const char *type = (operation->op == OP_IN) ? TRANSACTION_TYPE_IN : TRANSACTION_TYPE_OUT;
+        StockStatus status = (shard_count > 0)
+            ? shard_store_move(&shards, operation->product_id, type, operation->quantity,
+                               "loadgen", NULL)
+            : stock_engine_move(&engine, operation->product_id, type, operation->quantity,
+                                "loadgen", NULL);
+        if (status == STOCK_ERR_FULL) w->full = 1;
+        return status == STOCK_OK;
+    }
+    if (operation->op == OP_REPORT && shard_count > 0) {
+        return shard_store_summary(&shards, &w->shard_summary);
+    }
+    
+    Snapshot *snapshot = snapshot_acquire(&snapshots);
+    int ok;
+    if (operation->op == OP_SEARCH) {
+        // The tail of a name (its model code) is nearly unique. The search
+        // only reads the list, so the snapshot's const can be cast away
+        ProductList *list = (ProductList *)snapshot->products;
+        const char *name = list->products[operation->slot].name;
+        size_t length = strlen(name);
+        product_find_by_name(list, name + (length > 7 ? length - 7 : 0), w->results,
+                             LOADGEN_SEARCH_RESULTS);
+        ok = 1;
+    } else {
+        ok = report_dashboard(snapshot->products, &w->dashboard);
+    }
+    snapshot_release(snapshot);
+    return ok;
+}
+
+// Sleep while far ahead of a deadline, then spin the last stretch, as
+// sleeps overshoot
+static void wait_until(unsigned long long deadline) {
+    for (;;) {
+        unsigned long long now = sync_clock_ns();
+        if (now >= deadline) return;
+        int ms = (int)((deadline - now) / 1000000ULL) - 1;
+        if (ms >= 1) thread_sleep_ms(ms);
+    }
+}
+
+static void worker_loop(void *arg) {
+    Worker *w = arg;
+    // Threads are staggered over one interval so paced operations arrive
+    // evenly rather than in bursts
+    double offset = step_interval_ns * (double)w->id / (double)thread_count;
+    
+    wait_until(step_begin);
+    for (long long k = 0;; k++) {
+        unsigned long long start;
+        if (step_interval_ns > 0) {
+            start = step_begin + (unsigned long long)(offset + (double)k * step_interval_ns);
+            if (start >= step_end) break;
+            wait_until(start);
+        } else {
+            start = sync_clock_ns();
+        }
+        // A thread that fell behind its schedule drops the backlog at the end
+        if (sync_clock_ns() >= step_end) break;
+        
+        Operation operation = next_operation(w);
+        if (!perform(w, &operation)) w->failed[operation.op]++;
+        metrics_histogram_record(&w->latency[operation.op], sync_clock_ns() - start);
+    }
+}
+
+static void publisher_loop(void *arg) {
+    (void)arg;
+    while (!atomic_load(&publisher_stop)) {
+        thread_sleep_ms(refresh_ms);
+        stock_engine_publish(&engine, &snapshots);
+    }
+}
+
+static void print_row(double rate, const char *name, long long failed,
+                      const LatencyHistogram *latency, double seconds) {
+    MetricSummary s;
+    metrics_histogram_summary(latency, &s);
+    printf("%.0f|%d|%s|%llu|%lld|%.0f|%.1f|%.1f|%.1f|%.1f|%.1f\n", rate, thread_count, name,
+           s.count, failed, (double)s.count / seconds, s.mean_us, s.p50_us, s.p90_us,
+           s.p99_us, s.max_us);
+}
+
+/**
+ * @brief Run one step and print its rows
+ * @param rate Target operations per second over all threads (0 = flat out)
+ * @param seconds Step length
+ * @param workers Thread states
+ * @param total Scratch histogram for the all-operations row
+ * @return 1 on success, 0 if a thread could not start
+ */
+static int run_step(double rate, double seconds, Worker *workers, LatencyHistogram *total) {
+    if (shard_count > 0) {
+        // A fresh store per step, partitioned from the loaded lists
+        if (!shard_store_init(&shards, shard_count) ||
+            !shard_store_import(&shards, &products, &transactions)) {
+            fprintf(stderr, "Cannot partition %s into %d shards\n", data_dir, shard_count);
+            shard_store_free(&shards);
+            return 0;
+        }
+    } else {
+        if (!stock_engine_begin(&engine, &products, &transactions)) {
+            fprintf(stderr, "Out of memory\n");
+            return 0;
+        }
+        stock_engine_publish(&engine, &snapshots);
+    }
+    
+    for (int t = 0; t < thread_count; t++) {
+        for (int op = 0; op < OP_COUNT; op++) {
+            metrics_histogram_reset(&workers[t].latency[op]);
+            workers[t].failed[op] = 0;
+        }
+        workers[t].full = 0;
+    }
+    step_interval_ns = (rate > 0) ? (double)thread_count * 1e9 / rate : 0.0;
+    step_begin = sync_clock_ns() + LOADGEN_START_DELAY_NS;
+    step_end = step_begin + (unsigned long long)(seconds * 1e9);
+    atomic_store(&publisher_stop, 0);
+    
+    // The sharded store has no snapshots to refresh
+    Thread publisher;
+    int publishing = (shard_count > 0) || thread_start(&publisher, publisher_loop, NULL);
+    int started = 0;
+    while (publishing && started < thread_count &&
+           thread_start(&workers[started].thread, worker_loop, &workers[started])) {
+        started++;
+    }
+    for (int t = 0; t < started; t++) thread_join(workers[t].thread);
+    unsigned long long finished = sync_clock_ns();
+    atomic_store(&publisher_stop, 1);
+    if (shard_count > 0) {
+        shard_store_free(&shards);
+    } else {
+        if (publishing) thread_join(publisher);
+        stock_engine_end(&engine);
+    }
+    
+    // Put the loaded state back so every step starts alike
+    for (int i = 0; i < products.count; i++) {
+        products.products[i].quantity_in_stock = saved_quantities[i];
+    }
+    products.generation = generation_next();
+    transactions.count = saved_count;
+    transactions.next_id = saved_next_id;
+    transactions.generation = generation_next();
+    if (started < thread_count) {
+        fprintf(stderr, "Cannot start %d threads\n", thread_count);
+        return 0;
+    }
+    
+    double elapsed = (double)(finished - step_begin) / 1e9;
+    int full = 0;
+    long long failed_total = 0;
+    metrics_histogram_reset(total);
+    for (int op = 0; op < OP_COUNT; op++) {
+        LatencyHistogram *merged = &workers[0].latency[op];
+        long long failed = workers[0].failed[op];
+        for (int t = 1; t < thread_count; t++) {
+            metrics_histogram_merge(merged, &workers[t].latency[op]);
+            failed += workers[t].failed[op];
+        }
+        print_row(rate, op_names[op], failed, merged, elapsed);
+        metrics_histogram_merge(total, merged);
+        failed_total += failed;
+    }
+    for (int t = 0; t < thread_count; t++) full |= workers[t].full;
+    print_row(rate, "all", failed_total, total, elapsed);
+    fflush(stdout);
+    
+    if (full) {
+        fprintf(stderr, "Transaction list filled up at rate %.0f; shorten --duration or "
+                        "raise MAX_TRANSACTIONS\n", rate);
+    }
+    return 1;
+}
+
+/**
+ * @brief Parse a comma-separated list of rates
+ * @param text Text to parse
+ * @param rates Output rates
+ * @return Number of rates, or 0 if invalid
+ */
+static int parse_rates(const char *text, double *rates) {
+    int count = 0;
+    while (count < LOADGEN_MAX_STEPS) {
+        char *end;
+        double rate = strtod(text, &end);
+        if (end == text || rate < 0) return 0;
+        rates[count++] = rate;
+        if (*end == '\0') return count;
+        if (*end != ',') return 0;
+        text = end + 1;
+    }
+    return 0;
+}
+
+static void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  --data DIR          Data set to load (default data)\n");
+    printf("  --threads N         Load threads (default: one per CPU)\n");
+    printf("  --rate R[,R...]     Target operations/s over all threads, one step per\n");
+    printf("                      rate (default 0: as fast as possible)\n");
+    printf("  --duration SECONDS  Length of each step (default 5)\n");
+    printf("  --mix I:O:S:R       Relative shares of stock-in, stock-out, search and\n");
+    printf("                      report operations (default 30:50:15:5)\n");
+    printf("  --zipf S            Popularity skew; 0 is uniform (default 1.0)\n");
+    printf("  --replay FILE       Take movements in order from a transactions log or\n");
+    printf("                      movement file instead of generating them\n");
+    printf("  --refresh-ms N      Snapshot refresh interval for readers (default 100)\n");
+    printf("  --shards N          Move stock in a store of N shards and report with its\n");
+    printf("                      fan-out summary instead of the stock engine (1..%d)\n",
+           MAX_SHARDS);
+    printf("  --seed N            Random seed (default 1)\n");
+    printf("  --no-metrics        Turn off the built-in operation timing\n");
+}
+
+int main(int argc, char *argv[]) {
+    double rates[LOADGEN_MAX_STEPS] = {0};
+    int rate_count = 1;
+    double seconds = 5.0;
+    unsigned long long seed = 1;
+    const char *replay_path = NULL;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-metrics") == 0) {
+            metrics_set_enabled(0);
+            continue;
+        }
+        
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+        
+        if (ok && strcmp(argv[i], "--data") == 0) {
+            snprintf(data_dir, sizeof(data_dir), "%s", value);
+        } else if (ok && strcmp(argv[i], "--threads") == 0) {
+            ok = sscanf(value, "%d", &thread_count) == 1 && thread_count >= 1 &&
+                 thread_count <= LOADGEN_MAX_THREADS;
+        } else if (ok && strcmp(argv[i], "--rate") == 0) {
+            rate_count = parse_rates(value, rates);
+            ok = rate_count > 0;
+        } else if (ok && strcmp(argv[i], "--duration") == 0) {
+            ok = sscanf(value, "%lf", &seconds) == 1 && seconds > 0;
+        } else if (ok && strcmp(argv[i], "--mix") == 0) {
+            ok = sscanf(value, "%d:%d:%d:%d", &mix[OP_IN], &mix[OP_OUT], &mix[OP_SEARCH],
+                        &mix[OP_REPORT]) == 4 &&
+                 mix[OP_IN] >= 0 && mix[OP_OUT] >= 0 && mix[OP_SEARCH] >= 0 && mix[OP_REPORT] >= 0;
+        } else if (ok && strcmp(argv[i], "--zipf") == 0) {
+            ok = sscanf(value, "%lf", &zipf_exponent) == 1 && zipf_exponent >= 0;
+        } else if (ok && strcmp(argv[i], "--replay") == 0) {
+            replay_path = value;
+        } else if (ok && strcmp(argv[i], "--refresh-ms") == 0) {
+            ok = sscanf(value, "%d", &refresh_ms) == 1 && refresh_ms >= 1;
+        } else if (ok && strcmp(argv[i], "--shards") == 0) {
+            ok = sscanf(value, "%d", &shard_count) == 1 && shard_count >= 1 &&
+                 shard_count <= MAX_SHARDS;
+        } else if (ok && strcmp(argv[i], "--seed") == 0) {
+            ok = sscanf(value, "%llu", &seed) == 1;
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            print_usage(argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    mix_total = mix[OP_IN] + mix[OP_OUT] + mix[OP_SEARCH] + mix[OP_REPORT];
+    if (mix_total == 0) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (thread_count == 0) {
+        thread_count = sync_cpu_count();
+        if (thread_count > LOADGEN_MAX_THREADS) thread_count = LOADGEN_MAX_THREADS;
+    }
+    
+    if (!storage_load_products_file(&products, data_path("products.txt")) ||
+        !storage_load_transactions_file(&transactions, data_path("transactions.txt"))) {
+        fprintf(stderr, "Cannot load %s\n", data_dir);
+        return 1;
+    }
+    if (products.count == 0) {
+        fprintf(stderr, "No products in %s (generate some with datagen)\n", data_dir);
+        return 1;
+    }
+    if (replay_path != NULL && (!load_replay(replay_path) || replay_count == 0)) {
+        fprintf(stderr, "Cannot replay %s\n", replay_path);
+        return 1;
+    }
+    
+    saved_quantities = malloc(sizeof(int) * (size_t)products.count);
+    Worker *workers = calloc((size_t)thread_count, sizeof(Worker));
+    LatencyHistogram *total = malloc(sizeof(LatencyHistogram));
+    if (saved_quantities == NULL || workers == NULL || total == NULL ||
+        !build_popularity(seed) || !snapshot_store_init(&snapshots, &products, &transactions)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < products.count; i++) {
+        saved_quantities[i] = products.products[i].quantity_in_stock;
+    }
+    saved_count = transactions.count;
+    saved_next_id = transaction_get_next_id(&transactions);
+    for (int t = 0; t < thread_count; t++) {
+        workers[t].id = t;
+        workers[t].rng = seed * 0x100000001B3ULL + (unsigned long long)t + 1;
+    }
+    
+    printf("# loadgen data=%s products=%d transactions=%d threads=%d mix=%d:%d:%d:%d "
+           "zipf=%.2f source=%s duration=%.1f shards=%d\n", data_dir, products.count,
+           transactions.count, thread_count, mix[OP_IN], mix[OP_OUT], mix[OP_SEARCH],
+           mix[OP_REPORT], zipf_exponent, (replay_path != NULL) ? replay_path : "synthetic",
+           seconds, shard_count);
+    printf("rate|threads|operation|count|failed|ops_per_sec|mean_us|p50_us|p90_us|p99_us|max_us\n");
+    
+    int status = 0;
+    for (int s = 0; s < rate_count; s++) {
+        if (!run_step(rates[s], seconds, workers, total)) {
+            status = 1;
+            break;
+        }
+    }
+    
+    snapshot_store_free(&snapshots);
+    free(saved_quantities);
+    free(workers);
+    free(total);
+    free(zipf_cdf);
+    free(ranked_slots);
+    free(replay_rows);
+    return status;
+}
@@ -17,11 +17,30 @@ gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\auth.c -o obj\auth.o
 gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\storage.c -o obj\storage.o
 gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\ui.c -o obj\ui.o
 gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\report.c -o obj\report.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\stock.c -o obj\stock.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\batch.c -o obj\batch.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\sync.c -o obj\sync.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\shard.c -o obj\shard.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\pool.c -o obj\pool.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\snapshot.c -o obj\snapshot.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\rollup.c -o obj\rollup.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\forecast.c -o obj\forecast.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\history.c -o obj\history.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\filter.c -o obj\filter.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\cache.c -o obj\cache.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\sketch.c -o obj\sketch.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\export.c -o obj\export.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\output.c -o obj\output.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\view.c -o obj\view.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\trie.c -o obj\trie.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\fuzzy.c -o obj\fuzzy.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\metrics.c -o obj\metrics.o
+gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\startup.c -o obj\startup.o
 gcc -Wall -Wextra -Wpedantic -std=c11 -g -c src\main.c -o obj\main.o
 
 REM Link all object files
 echo Linking...
-gcc obj\utils.o obj\product.o obj\supplier.o obj\transaction.o obj\auth.o obj\storage.o obj\ui.o obj\report.o obj\main.o -o inventory.exe
+gcc obj\utils.o obj\product.o obj\supplier.o obj\transaction.o obj\auth.o obj\storage.o obj\ui.o obj\report.o obj\stock.o obj\batch.o obj\sync.o obj\shard.o obj\pool.o obj\snapshot.o obj\rollup.o obj\forecast.o obj\history.o obj\filter.o obj\cache.o obj\sketch.o obj\export.o obj\output.o obj\view.o obj\trie.o obj\fuzzy.o obj\metrics.o obj\startup.o obj\main.o -o inventory.exe -lm
 
 if %ERRORLEVEL% EQU 0 (
     echo.
@@ -0,0 +1,998 @@
+/**
+ * @file batch.c
+ * @brief Implementation of batch command processing
+ */
+
+#include "batch.h"
+#include "export.h"
+#include "metrics.h"
+#include "report.h"
+#include "stock.h"
+#include "storage.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_BATCH_FIELDS 16
+
+typedef int (*BatchHandler)(BatchContext *ctx, char *args, int line_no);
+
+/**
+ * @brief How a command runs against a sharded store
+ */
+typedef enum {
+    SHARDS_UNSUPPORTED,     ///< Needs lists or indexes the sharded mode does not keep
+    SHARDS_DIRECT,          ///< Uses the store itself, or no data at all
+    SHARDS_PRODUCTS,        ///< Reads the catalogue gathered from the shards
+    SHARDS_ALL              ///< Reads the catalogue and the merged transaction log
+} ShardUse;
+
+/**
+ * @brief Batch command table entry
+ */
+typedef struct {
+    const char *name;       ///< Command keyword
+    BatchHandler handler;   ///< Handler function
+    ShardUse shards;        ///< How it runs with a sharded store
+} BatchCommand;
+
+static void batch_ok(BatchContext *ctx, int line_no, const char *fmt, ...) {
+    if (ctx->quiet) return;
+    
+    va_list args;
+    va_start(args, fmt);
+    fprintf(ctx->out, "OK %d ", line_no);
+    vfprintf(ctx->out, fmt, args);
+    fputc('\n', ctx->out);
+    va_end(args);
+}
+
+static void batch_error(BatchContext *ctx, int line_no, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fprintf(ctx->out, "ERR %d ", line_no);
+    vfprintf(ctx->out, fmt, args);
+    fputc('\n', ctx->out);
+    va_end(args);
+}
+
+// Split a line on '|' in place, keeping empty fields (unlike strtok)
+static int split_fields(char *line, char **fields, int max_fields) {
+    int count = 0;
+    char *start = line;
+    
+    while (count < max_fields) {
+        char *sep = strchr(start, '|');
+        fields[count++] = start;
+        if (sep == NULL) break;
+        *sep = '\0';
+        start = sep + 1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        trim_string(fields[i]);
+    }
+    return count;
+}
+
+// Parse a strictly numeric integer token
+static int parse_int(const char *token, int *value) {
+    if (token == NULL || *token == '\0') return 0;
+    
+    char *endptr;
+    errno = 0;
+    long result = strtol(token, &endptr, 10);
+    if (*endptr != '\0' || errno == ERANGE) return 0;
+    if (result < INT_MIN || result > INT_MAX) return 0;
+    
+    *value = (int)result;
+    return 1;
+}
+
+static int batch_save(BatchContext *ctx) {
+    if (ctx->shards != NULL) {
+        return shard_store_save(ctx->shards, ctx->shard_dir);
+    }
+    
+    int ok = storage_save_products(ctx->products);
+    ok = storage_save_transactions(ctx->transactions) && ok;
+    if (ctx->forecasts != NULL) {
+        ok = storage_save_forecasts(ctx->forecasts) && ok;
+    }
+    return ok;
+}
+
+// Find a product in the lists, or copy it out of its shard
+static const Product* batch_find_product(BatchContext *ctx, int product_id, Product *copy) {
+    if (ctx->shards != NULL) {
+        return shard_store_get_product(ctx->shards, product_id, copy) ? copy : NULL;
+    }
+    return product_find_by_id(ctx->products, product_id);
+}
+
+static int cmd_add_product(BatchContext *ctx, char *args, int line_no) {
+    char *fields[MAX_BATCH_FIELDS];
+    int n = split_fields(args, fields, MAX_BATCH_FIELDS);
+    if (n != 8) {
+        batch_error(ctx, line_no, "add-product expects 8 '|' separated fields");
+        return 0;
+    }
+    
+    Product p = {0};
+    double price;
+    char *endptr;
+    if (!parse_int(fields[0], &p.id) ||
+        !parse_int(fields[4], &p.quantity_in_stock) ||
+        !parse_int(fields[5], &p.reorder_level) ||
+        !parse_int(fields[7], &p.supplier_id)) {
+        batch_error(ctx, line_no, "invalid numeric field");
+        return 0;
+    }
+    price = strtod(fields[6], &endptr);
+    if (*fields[6] == '\0' || *endptr != '\0') {
+        batch_error(ctx, line_no, "invalid price");
+        return 0;
+    }
+    p.unit_price = price;
+    
+    strncpy(p.name, fields[1], MAX_NAME_LEN - 1);
+    strncpy(p.category, fields[2], MAX_CATEGORY_LEN - 1);
+    strncpy(p.description, fields[3], MAX_DESC_LEN - 1);
+    
+    Product existing;
+    if (batch_find_product(ctx, p.id, &existing) != NULL) {
+        batch_error(ctx, line_no, "product %d already exists", p.id);
+        return 0;
+    }
+    if (!supplier_id_exists(ctx->suppliers, p.supplier_id)) {
+        batch_error(ctx, line_no, "supplier %d does not exist", p.supplier_id);
+        return 0;
+    }
+    // The reports gather every shard into one list, so the catalogue keeps its limit
+    int added;
+    if (ctx->shards != NULL) {
+        int catalogue;
+        shard_store_counts(ctx->shards, &catalogue, NULL);
+        added = (catalogue < MAX_PRODUCTS) && shard_store_add_product(ctx->shards, &p);
+    } else {
+        added = product_add(ctx->products, &p);
+    }
+    if (!added) {
+        batch_error(ctx, line_no, "failed to add product %d", p.id);
+        return 0;
+    }
+    
+    batch_ok(ctx, line_no, "added %d", p.id);
+    return 1;
+}
+
+static int run_stock_move(BatchContext *ctx, char *args, int line_no,
+                          const char *type) {
+    char *id_token = strtok(args, " \t");
+    char *qty_token = strtok(NULL, " \t");
+    char *notes = strtok(NULL, "");
+    int product_id, quantity;
+    
+    if (!parse_int(id_token, &product_id) || !parse_int(qty_token, &quantity)) {
+        batch_error(ctx, line_no, "usage: <product_id> <quantity> [notes]");
+        return 0;
+    }
+    if (notes != NULL) {
+        trim_string(notes);
+    }
+    
+    Transaction logged;
+    StockStatus status;
+    if (ctx->shards != NULL) {
+        status = shard_store_move(ctx->shards, product_id, type, quantity, notes, &logged);
+    } else {
+        status = stock_move(ctx->products, ctx->transactions,
+                            product_id, type, quantity, notes, &logged);
+    }
+    if (status != STOCK_OK) {
+        batch_error(ctx, line_no, "%s (product %d)",
+                    stock_status_message(status), product_id);
+        return 0;
+    }
+    
+    Product copy;
+    const Product *p = batch_find_product(ctx, product_id, &copy);
+    batch_ok(ctx, line_no, "txn %d product %d qty %d",
+             logged.transaction_id, product_id, p->quantity_in_stock);
+    return 1;
+}
+
+static int cmd_stock_in(BatchContext *ctx, char *args, int line_no) {
+    return run_stock_move(ctx, args, line_no, TRANSACTION_TYPE_IN);
+}
+
+static int cmd_stock_out(BatchContext *ctx, char *args, int line_no) {
+    return run_stock_move(ctx, args, line_no, TRANSACTION_TYPE_OUT);
+}
+
+static int cmd_query(BatchContext *ctx, char *args, int line_no) {
+    int product_id;
+    trim_string(args);
+    if (!parse_int(args, &product_id)) {
+        batch_error(ctx, line_no, "usage: query <product_id>");
+        return 0;
+    }
+    
+    Product copy;
+    const Product *p = batch_find_product(ctx, product_id, &copy);
+    if (p == NULL) {
+        batch_error(ctx, line_no, "product %d not found", product_id);
+        return 0;
+    }
+    
+    // Query results are data, so they are printed even in quiet mode
+    fprintf(ctx->out, "OK %d %d|%s|%s|%d|%d|%.2f|%d\n", line_no,
+            p->id, p->name, p->category, p->quantity_in_stock,
+            p->reorder_level, p->unit_price, p->supplier_id);
+    return 1;
+}
+
+static int cmd_import(BatchContext *ctx, char *args, int line_no) {
+    char *path = strtok(args, " \t");
+    char *report_path = NULL;
+    int strict = 0;
+    char *token;
+    
+    while ((token = strtok(NULL, " \t")) != NULL) {
+        if (strcmp(token, "--strict") == 0) {
+            strict = 1;
+        } else if (strcmp(token, "--report") == 0) {
+            report_path = strtok(NULL, " \t");
+        } else {
+            path = NULL;  // Unknown option
+            break;
+        }
+    }
+    if (path == NULL) {
+        batch_error(ctx, line_no, "usage: import <file> [--strict] [--report <path>]");
+        return 0;
+    }
+    
+    FILE *report = NULL;
+    if (report_path != NULL) {
+        report = fopen(report_path, "w");
+        if (report == NULL) {
+            batch_error(ctx, line_no, "cannot write report %s", report_path);
+            return 0;
+        }
+    }
+    
+    ImportSummary summary;
+    int ok = batch_import_movements(ctx, path, strict, report, &summary);
+    if (report != NULL) {
+        fclose(report);
+    }
+    
+    if (!ok) {
+        batch_error(ctx, line_no, "cannot import %s", path);
+        return 0;
+    }
+    if (summary.rejected > 0) {
+        batch_error(ctx, line_no, "import %s: %d rows, %d accepted, %d rejected, %d applied",
+                    path, summary.rows, summary.accepted, summary.rejected, summary.applied);
+        return 0;
+    }
+    
+    batch_ok(ctx, line_no, "import %s: %d rows, %d applied", path, summary.rows, summary.applied);
+    return 1;
+}
+
+static int cmd_velocity(BatchContext *ctx, char *args, int line_no) {
+    int window = 30;
+    trim_string(args);
+    if (args[0] != '\0' && (!parse_int(args, &window) || window < 1)) {
+        batch_error(ctx, line_no, "usage: velocity [window_days]");
+        return 0;
+    }
+    
+    VelocityRow *rows = malloc(sizeof(VelocityRow) * (size_t)(ctx->products->count + 1));
+    if (rows == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    // One data line per product: id|name|stock|out|per_day|cover_days|turnover
+    int count = report_stock_velocity(ctx->products, ctx->transactions, window,
+                                      current_day(), rows);
+    for (int i = 0; i < count; i++) {
+        const VelocityRow *r = &rows[i];
+        fprintf(ctx->out, "OK %d %d|%s|%d|%ld|%.2f|", line_no, r->product_id,
+                r->name, r->quantity_in_stock, r->units_out, r->velocity);
+        if (r->days_of_cover < 0) {
+            fprintf(ctx->out, "-|%.2f\n", r->turnover);
+        } else {
+            fprintf(ctx->out, "%.1f|%.2f\n", r->days_of_cover, r->turnover);
+        }
+    }
+    
+    free(rows);
+    return 1;
+}
+
+static int cmd_reorder(BatchContext *ctx, char *args, int line_no) {
+    (void)args;
+    if (ctx->forecasts == NULL) {
+        batch_error(ctx, line_no, "demand forecasts not available");
+        return 0;
+    }
+    
+    ReorderSuggestion *rows = malloc(sizeof(ReorderSuggestion) * (size_t)(ctx->products->count + 1));
+    if (rows == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    // One data line per product: supplier_id|product_id|stock|per_day|safety|reorder_point|order
+    int count = forecast_reorder_suggestions(ctx->forecasts, ctx->products,
+                                             current_day(), rows);
+    for (int i = 0; i < count; i++) {
+        const ReorderSuggestion *r = &rows[i];
+        fprintf(ctx->out, "OK %d %d|%d|%d|%.2f|%.1f|%d|%d\n", line_no, r->supplier_id,
+                r->product_id, r->quantity_in_stock, r->forecast.daily_demand,
+                r->forecast.safety_stock, r->forecast.reorder_point, r->order_quantity);
+    }
+    
+    free(rows);
+    return 1;
+}
+
+static int cmd_as_of(BatchContext *ctx, char *args, int line_no) {
+    char date[32];
+    int day, product_id = 0;
+    int n = sscanf(args, "%31s %d", date, &product_id);
+    if (n < 1 || !date_to_days(date, &day) || product_id < 0) {
+        batch_error(ctx, line_no, "usage: as-of <YYYY-MM-DD> [product_id]");
+        return 0;
+    }
+    if (ctx->history == NULL) {
+        batch_error(ctx, line_no, "stock history not available");
+        return 0;
+    }
+    
+    // One data line per product: id|quantity
+    if (product_id > 0) {
+        int quantity;
+        if (!history_stock_as_of(ctx->history, product_id, day, &quantity)) {
+            batch_error(ctx, line_no, "product %d not found", product_id);
+            return 0;
+        }
+        fprintf(ctx->out, "OK %d %d|%d\n", line_no, product_id, quantity);
+        return 1;
+    }
+    
+    size_t room = (size_t)(ctx->history->product_count + ctx->products->count + 1);
+    StockAsOf *rows = malloc(sizeof(StockAsOf) * room);
+    if (rows == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    int count = history_all_as_of(ctx->history, day, rows);
+    for (int i = 0; i < count; i++) {
+        fprintf(ctx->out, "OK %d %d|%d\n", line_no, rows[i].product_id, rows[i].quantity);
+    }
+    
+    free(rows);
+    return 1;
+}
+
+typedef struct {
+    BatchContext *batch;
+    int line_no;
+} FilterOutput;
+
+static int emit_product(void *ctx, const Product *p) {
+    FilterOutput *out = (FilterOutput *)ctx;
+    fprintf(out->batch->out, "OK %d %d|%s|%s|%d|%d|%.2f|%d\n", out->line_no, p->id, p->name,
+            p->category, p->quantity_in_stock, p->reorder_level, p->unit_price, p->supplier_id);
+    return 1;
+}
+
+static int emit_transaction(void *ctx, const Transaction *t) {
+    FilterOutput *out = (FilterOutput *)ctx;
+    fprintf(out->batch->out, "OK %d %d|%d|%s|%d|%s|%s\n", out->line_no, t->transaction_id,
+            t->product_id, t->type, t->quantity, t->date_time, t->notes);
+    return 1;
+}
+
+static int cmd_filter(BatchContext *ctx, char *args, int line_no) {
+    char *target = strtok(args, " \t");
+    char *expression = strtok(NULL, "");
+    FilterTarget kind;
+    FilterPlan plan;
+    
+    if (target != NULL && strcmp(target, "products") == 0) {
+        kind = FILTER_PRODUCTS;
+    } else if (target != NULL && strcmp(target, "transactions") == 0) {
+        kind = FILTER_TRANSACTIONS;
+    } else {
+        batch_error(ctx, line_no, "usage: filter products|transactions <expression>");
+        return 0;
+    }
+    if (!filter_compile(expression, kind, &plan)) {
+        batch_error(ctx, line_no, "%s", plan.error);
+        return 0;
+    }
+    
+    // Matches are written as they are found, one per line
+    FilterOutput out = {ctx, line_no};
+    if (kind == FILTER_PRODUCTS) {
+        filter_run_products(&plan, ctx->products, ctx->filter_index, emit_product, &out);
+    } else {
+        filter_run_transactions(&plan, ctx->transactions, emit_transaction, &out);
+    }
+    return 1;
+}
+
+static int cmd_group(BatchContext *ctx, char *args, int line_no) {
+    static const char *const orders[] = {"value", "units", "low", "name"};
+    char by_text[16], sort_text[16] = "value";
+    int limit = 0;
+    ReportGroupBy by;
+    int sort = -1;
+    
+    int n = sscanf(args, "%15s %15s %d", by_text, sort_text, &limit);
+    if (n >= 1 && strcmp(by_text, "category") == 0) {
+        by = REPORT_GROUP_CATEGORY;
+    } else if (n >= 1 && strcmp(by_text, "supplier") == 0) {
+        by = REPORT_GROUP_SUPPLIER;
+    } else {
+        n = 0;
+    }
+    for (int i = 0; n >= 1 && i < 4; i++) {
+        if (strcmp(sort_text, orders[i]) == 0) sort = i;
+    }
+    if (n < 1 || sort < 0 || limit < 0) {
+        batch_error(ctx, line_no, "usage: group category|supplier [value|units|low|name] [limit]");
+        return 0;
+    }
+    
+    GroupRow *rows = malloc(sizeof(GroupRow) * (size_t)(ctx->products->count + 1));
+    if (rows == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    // One data line per group: [supplier_id|]name|products|units|value|low_stock
+    int count = report_group_stock(ctx->products, ctx->suppliers, by, (ReportGroupSort)sort,
+                                   limit, rows);
+    for (int i = 0; i < count; i++) {
+        const GroupRow *r = &rows[i];
+        if (by == REPORT_GROUP_SUPPLIER) {
+            fprintf(ctx->out, "OK %d %d|%s|%d|%ld|%.2f|%d\n", line_no, r->supplier_id,
+                    r->name, r->products, r->units, r->value, r->low_stock);
+        } else {
+            fprintf(ctx->out, "OK %d %s|%d|%ld|%.2f|%d\n", line_no, r->name,
+                    r->products, r->units, r->value, r->low_stock);
+        }
+    }
+    
+    free(rows);
+    return 1;
+}
+
+static void emit_dashboard_rows(BatchContext *ctx, int line_no, const char *list,
+                                const Product *rows, int count) {
+    for (int i = 0; i < count; i++) {
+        fprintf(ctx->out, "OK %d %s|%d|%s|%d|%d|%.2f\n", line_no, list, rows[i].id,
+                rows[i].name, rows[i].quantity_in_stock, rows[i].reorder_level,
+                rows[i].quantity_in_stock * rows[i].unit_price);
+    }
+}
+
+static int cmd_dashboard(BatchContext *ctx, char *args, int line_no) {
+    static DashboardSummary summary;
+    (void)args;
+    
+    if (!report_dashboard(ctx->products, &summary)) {
+        batch_error(ctx, line_no, "dashboard failed");
+        return 0;
+    }
+    
+    // totals|products|units|value|low_stock, then list|id|name|qty|reorder|value rows
+    fprintf(ctx->out, "OK %d totals|%d|%ld|%.2f|%d\n", line_no, summary.total_products,
+            summary.total_units, summary.total_value, summary.low_stock_count);
+    emit_dashboard_rows(ctx, line_no, "top-quantity", summary.top_quantity,
+                        summary.top_quantity_count);
+    emit_dashboard_rows(ctx, line_no, "top-value", summary.top_value, summary.top_value_count);
+    emit_dashboard_rows(ctx, line_no, "low-stock", summary.low_stock, summary.low_stock_shown);
+    return 1;
+}
+
+static int cmd_abc(BatchContext *ctx, char *args, int line_no) {
+    static const char tiers[] = "ABC";
+    double a_percent = REPORT_ABC_A_SHARE * 100, b_percent = REPORT_ABC_B_SHARE * 100;
+    int limit = 0;
+    
+    int n = sscanf(args, "%lf %lf %d", &a_percent, &b_percent, &limit);
+    if (n == 1 || a_percent <= 0 || b_percent < a_percent || b_percent > 100 || limit < 0) {
+        batch_error(ctx, line_no, "usage: abc [a_percent b_percent [limit]]");
+        return 0;
+    }
+    
+    AbcRow *rows = NULL;
+    if (limit > 0) {
+        rows = malloc(sizeof(AbcRow) * (size_t)limit);
+        if (rows == NULL) {
+            batch_error(ctx, line_no, "out of memory");
+            return 0;
+        }
+    }
+    
+    // tier|products|value lines, then id|value|cumulative_share|tier for the top rows
+    AbcSummary summary;
+    int count = report_abc_classification(ctx->products, a_percent / 100.0, b_percent / 100.0,
+                                          rows, limit, &summary);
+    for (int t = 0; t < 3; t++) {
+        fprintf(ctx->out, "OK %d %c|%d|%.2f\n", line_no, tiers[t], summary.products[t],
+                summary.value[t]);
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(ctx->out, "OK %d %d|%.2f|%.4f|%c\n", line_no, rows[i].product_id, rows[i].value,
+                rows[i].cumulative_share, rows[i].tier);
+    }
+    
+    free(rows);
+    return 1;
+}
+
+static int cmd_export(BatchContext *ctx, char *args, int line_no) {
+    char path[256];
+    ExportStats stats;
+    
+    if (sscanf(args, "%255s", path) != 1) {
+        batch_error(ctx, line_no, "usage: export <file>");
+        return 0;
+    }
+    if (!export_transactions(path, ctx->products, ctx->transactions, &stats)) {
+        batch_error(ctx, line_no, "cannot write %s", path);
+        return 0;
+    }
+    batch_ok(ctx, line_no, "exported %ld rows in %d row groups, %lld bytes",
+             stats.rows, stats.row_groups, stats.bytes);
+    return 1;
+}
+
+typedef struct {
+    BatchContext *batch;
+    int line_no;
+} ExportOutput;
+
+static int emit_export_row(void *ctx, const Transaction *t, const char *category) {
+    ExportOutput *out = (ExportOutput *)ctx;
+    fprintf(out->batch->out, "OK %d %d|%d|%s|%d|%s|%s|%s\n", out->line_no, t->transaction_id,
+            t->product_id, t->type, t->quantity, t->date_time, category, t->notes);
+    return 1;
+}
+
+static int cmd_export_read(BatchContext *ctx, char *args, int line_no) {
+    char path[256], from[32], to[32];
+    int first_day, last_day;
+    ExportStats stats;
+    
+    if (sscanf(args, "%255s %31s %31s", path, from, to) != 3 ||
+        !date_to_days(from, &first_day) || !date_to_days(to, &last_day)) {
+        batch_error(ctx, line_no, "usage: export-read <file> <from YYYY-MM-DD> <to YYYY-MM-DD>");
+        return 0;
+    }
+    
+    // Rows as id|product|type|qty|date_time|category|notes, then the scan counters
+    ExportOutput out = {ctx, line_no};
+    if (!export_scan(path, (long long)first_day * 86400, (long long)last_day * 86400 + 86399,
+                     emit_export_row, &out, &stats)) {
+        batch_error(ctx, line_no, "cannot read %s", path);
+        return 0;
+    }
+    batch_ok(ctx, line_no, "%ld rows; %d row groups read, %d skipped",
+             stats.rows, stats.row_groups, stats.groups_skipped);
+    return 1;
+}
+
+// Milliseconds of processor time since start
+static double elapsed_ms(clock_t start) {
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static int cmd_sketches(BatchContext *ctx, char *args, int line_no) {
+    static const double quantiles[] = {0.5, 0.9, 0.99};
+    int window = 7;
+    if (sscanf(args, "%d", &window) == 1 && (window < 1 || window > SKETCH_DAYS)) {
+        batch_error(ctx, line_no, "usage: sketches [window_days 1-%d]", SKETCH_DAYS);
+        return 0;
+    }
+    if (ctx->sketches == NULL || ctx->sketches->days == NULL) {
+        batch_error(ctx, line_no, "sketches not enabled (start with --sketches)");
+        return 0;
+    }
+    
+    // Each estimate is printed next to the exact answer and both timings:
+    // kind|key|estimate|exact|sketch_ms|exact_ms
+    int last_day = current_day();
+    int first_day = last_day - window + 1;
+    clock_t start = clock();
+    double distinct = sketch_distinct_products(ctx->sketches, first_day, last_day);
+    double sketch_ms = elapsed_ms(start);
+    start = clock();
+    int exact_distinct = sketch_exact_distinct(ctx->transactions, first_day, last_day);
+    fprintf(ctx->out, "OK %d distinct|%d_days|%.0f|%d|%.3f|%.3f\n", line_no, window,
+            distinct, exact_distinct, sketch_ms, elapsed_ms(start));
+    
+    for (int i = 0; i < 3; i++) {
+        int estimate, exact;
+        start = clock();
+        int found = sketch_quantity_quantile(ctx->sketches, quantiles[i], &estimate);
+        sketch_ms = elapsed_ms(start);
+        start = clock();
+        if (!found || !sketch_exact_quantile(ctx->transactions, quantiles[i], &exact)) break;
+        fprintf(ctx->out, "OK %d quantile|p%g|%d|%d|%.3f|%.3f\n", line_no, quantiles[i] * 100,
+                estimate, exact, sketch_ms, elapsed_ms(start));
+    }
+    
+    HeavyHitter top[10];
+    start = clock();
+    int count = sketch_top_sellers(ctx->sketches, last_day, window, top, 10);
+    sketch_ms = elapsed_ms(start);
+    for (int i = 0; i < count; i++) {
+        start = clock();
+        long exact = sketch_exact_out_units(ctx->transactions, top[i].product_id, last_day, window);
+        fprintf(ctx->out, "OK %d top|%d|%ld|%ld|%.3f|%.3f\n", line_no, top[i].product_id,
+                top[i].units, exact, (i == 0) ? sketch_ms : 0.0, elapsed_ms(start));
+    }
+    return 1;
+}
+
+/**
+ * @brief Split an optional leading "--limit k" from text that runs to the end of the line
+ * @param args Arguments
+ * @param limit In: default; out: k, or 0 if k is invalid
+ * @return The rest of the line, trimmed
+ */
+static char* parse_limit(char *args, int *limit) {
+    char *rest = args;
+    
+    if (strncmp(args, "--limit", 7) == 0) {
+        long value = strtol(args + 7, &rest, 10);
+        *limit = (value > 0 && value <= MAX_PRODUCTS) ? (int)value : 0;
+    }
+    trim_string(rest);
+    return rest;
+}
+
+static int cmd_complete(BatchContext *ctx, char *args, int line_no) {
+    int limit = TRIE_DEFAULT_COMPLETIONS;
+    
+    // The prefix is the rest of the line, so names with spaces can be completed
+    char *prefix = parse_limit(args, &limit);
+    if (ctx->trie == NULL || limit == 0) {
+        batch_error(ctx, line_no, "usage: complete [--limit k] <prefix>");
+        return 0;
+    }
+    if (ctx->trie->root == NULL && !trie_build(ctx->trie, ctx->products)) {
+        trie_free(ctx->trie);
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    int *ids = malloc(sizeof(int) * (size_t)limit);
+    if (ids == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    // Completions are data, printed as id|name in alphabetical order
+    int count = trie_complete(ctx->trie, prefix, ids, limit);
+    for (int i = 0; i < count; i++) {
+        Product *p = trie_product(ctx->trie, ctx->products, ids[i]);
+        if (p != NULL) fprintf(ctx->out, "OK %d %d|%s\n", line_no, p->id, p->name);
+    }
+    batch_ok(ctx, line_no, "%d completions", count);
+    
+    free(ids);
+    return 1;
+}
+
+static int cmd_fuzzy(BatchContext *ctx, char *args, int line_no) {
+    int limit = FUZZY_DEFAULT_RESULTS;
+    char *query = parse_limit(args, &limit);
+    
+    if (limit == 0 || query[0] == '\0') {
+        batch_error(ctx, line_no, "usage: fuzzy [--limit k] <name>");
+        return 0;
+    }
+    
+    FuzzyMatch *matches = malloc(sizeof(FuzzyMatch) * (size_t)limit);
+    if (matches == NULL) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    
+    // Without a kept index, build one for this command only
+    FuzzyIndex local = {0};
+    FuzzyIndex *index = (ctx->fuzzy != NULL) ? ctx->fuzzy : &local;
+    local.stale = 1;
+    
+    // Matches are data, printed as id|name|distance, closest first
+    FuzzyStats stats;
+    int count = fuzzy_search(index, ctx->products, query, -1, matches, limit, &stats);
+    for (int i = 0; i < count; i++) {
+        const Product *p = &ctx->products->products[matches[i].slot];
+        fprintf(ctx->out, "OK %d %d|%s|%d\n", line_no, p->id, p->name, matches[i].distance);
+    }
+    fuzzy_index_free(&local);
+    free(matches);
+    
+    if (count < 0) {
+        batch_error(ctx, line_no, "out of memory");
+        return 0;
+    }
+    batch_ok(ctx, line_no, "%d matches; %d of %d names compared", count, stats.compared, stats.names);
+    return 1;
+}
+
+static int cmd_stats(BatchContext *ctx, char *args, int line_no) {
+    trim_string(args);
+    if (strcmp(args, "reset") == 0) {
+        metrics_reset();
+        batch_ok(ctx, line_no, "statistics reset");
+        return 1;
+    }
+    if (strcmp(args, "on") == 0 || strcmp(args, "off") == 0) {
+        metrics_set_enabled(args[1] == 'n');
+        batch_ok(ctx, line_no, "recording %s", args);
+        return 1;
+    }
+    if (args[0] != '\0') {
+        batch_error(ctx, line_no, "usage: stats [reset|on|off]");
+        return 0;
+    }
+    
+    // operation|count|mean_us|p50_us|p90_us|p99_us|max_us per recorded operation
+    int shown = 0;
+    for (int id = 0; id < METRIC_COUNT; id++) {
+        MetricSummary m;
+        if (!metrics_summary((MetricId)id, &m)) continue;
+        fprintf(ctx->out, "OK %d %s|%llu|%.1f|%.1f|%.1f|%.1f|%.1f\n", line_no, m.name, m.count,
+                m.mean_us, m.p50_us, m.p90_us, m.p99_us, m.max_us);
+        shown++;
+    }
+    batch_ok(ctx, line_no, "%d operations recorded; recording %s", shown,
+             metrics_enabled() ? "on" : "off");
+    return 1;
+}
+
+static int cmd_save(BatchContext *ctx, char *args, int line_no) {
+    (void)args;
+    if (!batch_save(ctx)) {
+        batch_error(ctx, line_no, "save failed");
+        return 0;
+    }
+    batch_ok(ctx, line_no, "saved");
+    return 1;
+}
+
+static const BatchCommand batch_commands[] = {
+    {"add-product", cmd_add_product, SHARDS_DIRECT},
+    {"stock-in",    cmd_stock_in,    SHARDS_DIRECT},
+    {"stock-out",   cmd_stock_out,   SHARDS_DIRECT},
+    {"query",       cmd_query,       SHARDS_DIRECT},
+    {"import",      cmd_import,      SHARDS_UNSUPPORTED},
+    {"velocity",    cmd_velocity,    SHARDS_ALL},
+    {"reorder",     cmd_reorder,     SHARDS_UNSUPPORTED},
+    {"as-of",       cmd_as_of,       SHARDS_UNSUPPORTED},
+    {"filter",      cmd_filter,      SHARDS_ALL},
+    {"group",       cmd_group,       SHARDS_PRODUCTS},
+    {"dashboard",   cmd_dashboard,   SHARDS_PRODUCTS},
+    {"sketches",    cmd_sketches,    SHARDS_UNSUPPORTED},
+    {"abc",         cmd_abc,         SHARDS_PRODUCTS},
+    {"export",      cmd_export,      SHARDS_ALL},
+    {"export-read", cmd_export_read, SHARDS_DIRECT},
+    {"complete",    cmd_complete,    SHARDS_UNSUPPORTED},
+    {"fuzzy",       cmd_fuzzy,       SHARDS_PRODUCTS},
+    {"stats",       cmd_stats,       SHARDS_DIRECT},
+    {"save",        cmd_save,        SHARDS_DIRECT},
+};
+
+#define BATCH_COMMAND_COUNT (int)(sizeof(batch_commands) / sizeof(batch_commands[0]))
+
+// Products plus transactions, across the shards in sharded mode
+static long batch_rows(BatchContext *ctx) {
+    if (ctx->shards != NULL) {
+        int products, transactions;
+        shard_store_counts(ctx->shards, &products, &transactions);
+        return (long)products + transactions;
+    }
+    return (long)ctx->products->count + ctx->transactions->count;
+}
+
+// Refuse a command the sharded mode cannot run, or gather the lists a report reads
+static int prepare_sharded(BatchContext *ctx, const BatchCommand *cmd, int line_no) {
+    if (cmd->shards == SHARDS_UNSUPPORTED) {
+        batch_error(ctx, line_no, "'%s' is not available with --shards", cmd->name);
+        return 0;
+    }
+    if (cmd->shards == SHARDS_DIRECT) return 1;
+    
+    TransactionList *log = (cmd->shards == SHARDS_ALL) ? ctx->transactions : NULL;
+    if (!shard_store_gather(ctx->shards, ctx->products, log)) {
+        batch_error(ctx, line_no, "cannot gather the shards into one list");
+        return 0;
+    }
+    return 1;
+}
+
+void batch_context_init(BatchContext *ctx, ProductList *products,
+                        SupplierList *suppliers, TransactionList *transactions) {
+    if (ctx == NULL) return;
+    ctx->products = products;
+    ctx->suppliers = suppliers;
+    ctx->transactions = transactions;
+    ctx->forecasts = NULL;
+    ctx->history = NULL;
+    ctx->filter_index = NULL;
+    ctx->sketches = NULL;
+    ctx->trie = NULL;
+    ctx->fuzzy = NULL;
+    ctx->shards = NULL;
+    ctx->shard_dir = SHARD_DIR;
+    ctx->save_interval = 0;
+    ctx->quiet = 0;
+    ctx->out = stdout;
+}
+
+int batch_run(BatchContext *ctx, FILE *input, BatchSummary *summary) {
+    if (ctx == NULL || input == NULL) return 0;
+    
+    BatchSummary stats = {0};
+    int pending = 0;  // Mutations since last save
+    int line_no = 0;
+    int save_ok = 1;
+    char line[MAX_BATCH_LINE_LEN];
+    
+    while (fgets(line, sizeof(line), input) != NULL) {
+        line_no++;
+
+        // A line that does not fit is rejected whole, not run in pieces
+        if (strchr(line, '\n') == NULL && !feof(input)) {
+            int c;
+            while ((c = fgetc(input)) != '\n' && c != EOF);
+            stats.processed++;
+            stats.failed++;
+            batch_error(ctx, line_no, "line longer than %d characters", MAX_BATCH_LINE_LEN - 2);
+            continue;
+        }
+
+        trim_string(line);
+        if (line[0] == '\0' || line[0] == '#') continue;
+        
+        // Split keyword from arguments
+        char *args = line;
+        while (*args != '\0' && *args != ' ' && *args != '\t') args++;
+        if (*args != '\0') {
+            *args++ = '\0';
+        }
+        
+        const BatchCommand *cmd = NULL;
+        for (int i = 0; i < BATCH_COMMAND_COUNT; i++) {
+            if (strcmp(line, batch_commands[i].name) == 0) {
+                cmd = &batch_commands[i];
+                break;
+            }
+        }
+        
+        stats.processed++;
+        if (cmd == NULL) {
+            batch_error(ctx, line_no, "unknown command '%s'", line);
+            stats.failed++;
+            continue;
+        }
+        
+        if (ctx->shards != NULL && !prepare_sharded(ctx, cmd, line_no)) {
+            stats.failed++;
+            continue;
+        }
+        
+        // Every data change adds a product or a transaction
+        long rows_before = batch_rows(ctx);
+        
+        if (cmd->handler(ctx, args, line_no)) {
+            stats.succeeded++;
+        } else {
+            stats.failed++;
+        }
+        
+        if (cmd->handler == cmd_save) {
+            stats.saves++;
+            pending = 0;
+        } else if (batch_rows(ctx) != rows_before) {
+            stats.mutations++;
+            pending++;
+            if (ctx->save_interval > 0 && pending >= ctx->save_interval) {
+                save_ok = batch_save(ctx) && save_ok;
+                stats.saves++;
+                pending = 0;
+            }
+        }
+    }
+    
+    if (pending > 0) {
+        save_ok = batch_save(ctx) && save_ok;
+        stats.saves++;
+    }
+    
+    if (summary != NULL) {
+        *summary = stats;
+    }
+    return (stats.failed == 0 && save_ok);
+}
+
+int batch_run_file(BatchContext *ctx, const char *path, BatchSummary *summary) {
+    if (ctx == NULL || path == NULL) return 0;
+    
+    if (strcmp(path, "-") == 0) {
+        return batch_run(ctx, stdin, summary);
+    }
+    
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return 0;
+    
+    int result = batch_run(ctx, file, summary);
+    fclose(file);
+    return result;
+}
+
+int batch_import_movements(BatchContext *ctx, const char *path, int strict,
+                           FILE *report, ImportSummary *summary) {
+    if (ctx == NULL || path == NULL) return 0;
+    
+    ImportSummary stats = {0};
+    StockMovement *rows;
+    int count;
+    
+    if (!storage_load_movements(path, &rows, &count)) {
+        return 0;
+    }
+    
+    StockMovementResult *results = malloc(sizeof(StockMovementResult) * (count > 0 ? count : 1));
+    if (results == NULL) {
+        free(rows);
+        return 0;
+    }
+    
+    int accepted = stock_validate_movements(ctx->products, ctx->transactions,
+                                            rows, count, results);
+    if (accepted < 0) {
+        free(results);
+        free(rows);
+        return 0;
+    }
+    
+    stats.rows = count;
+    stats.accepted = accepted;
+    stats.rejected = count - accepted;
+    
+    if (accepted > 0 && !(strict && stats.rejected > 0)) {
+        int applied = stock_apply_movements(ctx->products, ctx->transactions,
+                                            rows, results, count);
+        stats.applied = (applied > 0) ? applied : 0;
+    }
+    
+    if (report != NULL) {
+        stock_write_movement_report(report, rows, results, count);
+    }
+    
+    free(results);
+    free(rows);
+    
+    if (summary != NULL) {
+        *summary = stats;
+    }
+    return 1;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file batch.h
+ * @brief Non-interactive batch command processing
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A batch is a stream of text commands, one per line:
+ *
+ *   add-product id|name|category|description|quantity|reorder_level|price|supplier_id
+ *   stock-in  <product_id> <quantity> [notes]
+ *   stock-out <product_id> <quantity> [notes]
+ *   query     <product_id>
+ *   import    <file> [--strict] [--report <path>]
+ *   velocity  [window_days]
+ *   reorder
+ *   as-of     <YYYY-MM-DD> [product_id]
+ *   filter    products|transactions <expression>
+ *   group     category|supplier [value|units|low|name] [limit]
+ *   dashboard
+ *   sketches  [window_days]
+ *   abc       [a_percent b_percent [limit]]
+ *   export    <file>
+ *   export-read <file> <from YYYY-MM-DD> <to YYYY-MM-DD>
+ *   complete  [--limit k] <prefix>
+ *   fuzzy     [--limit k] <name>
+ *   stats     [reset|on|off]
+ *   save
+ *
+ * Blank lines and lines starting with '#' are ignored; a line longer than
+ * MAX_BATCH_LINE_LEN - 2 characters fails whole. Commands run
+ * against the in-memory lists; data is persisted every save_interval
+ * mutating commands (0 = only once, at the end of the batch).
+ *
+ * With a sharded store set, add-product, stock-in/out, query and save go
+ * to the product's shard, and the reports run on a catalogue gathered
+ * from the shards just before each one. Commands that need the forecast,
+ * history, sketch or trie indexes, and import, are refused.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+#include "product.h"
+#include "supplier.h"
+#include "transaction.h"
+#include "forecast.h"
+#include "history.h"
+#include "filter.h"
+#include "sketch.h"
+#include "trie.h"
+#include "fuzzy.h"
+#include "shard.h"
+
+#define MAX_BATCH_LINE_LEN 1024
+
+/**
+ * @brief Batch execution context
+ */
+typedef struct {
+    ProductList *products;          ///< Products to operate on
+    SupplierList *suppliers;        ///< Suppliers (for add-product checks)
+    TransactionList *transactions;  ///< Transaction log
+    ForecastStore *forecasts;       ///< Demand forecasts (NULL if not tracked)
+    StockHistory *history;          ///< Stock checkpoints (NULL if not tracked)
+    FilterIndex *filter_index;      ///< Product indexes for filters (NULL to scan)
+    MovementSketches *sketches;     ///< Movement sketches (NULL if not enabled)
+    ProductTrie *trie;              ///< Type-ahead trie, built on first use (NULL if not kept)
+    FuzzyIndex *fuzzy;              ///< Fuzzy name index (NULL to build one per search)
+    ShardedStore *shards;           ///< Sharded store (NULL to use the lists); the lists
+                                    ///< then hold the gathered catalogue, without listeners
+    const char *shard_dir;          ///< Where save writes the shards (default SHARD_DIR)
+    int save_interval;              ///< Save every N mutations (0 = at end only)
+    int quiet;                      ///< 1 to print only errors
+    FILE *out;                      ///< Destination for command results
+} BatchContext;
+
+/**
+ * @brief Batch run statistics
+ */
+typedef struct {
+    int processed;      ///< Commands executed (excluding blanks/comments)
+    int succeeded;      ///< Commands that succeeded
+    int failed;         ///< Commands that failed
+    int mutations;      ///< Commands that changed data
+    int saves;          ///< Number of persistence steps
+} BatchSummary;
+
+/**
+ * @brief Bulk movement import statistics
+ */
+typedef struct {
+    int rows;           ///< Rows read from the file
+    int accepted;       ///< Rows that passed validation
+    int rejected;       ///< Rows that failed validation
+    int applied;        ///< Rows applied (0 if strict and any row was rejected)
+} ImportSummary;
+
+/**
+ * @brief Initialize a batch context with defaults
+ * @param ctx Context to initialize
+ * @param products Product list
+ * @param suppliers Supplier list
+ * @param transactions Transaction list
+ */
+void batch_context_init(BatchContext *ctx, ProductList *products,
+                        SupplierList *suppliers, TransactionList *transactions);
+
+/**
+ * @brief Run all commands from an input stream
+ * @param ctx Batch context
+ * @param input Stream to read commands from
+ * @param summary Output statistics (may be NULL)
+ * @return 1 if every command succeeded and data was saved, 0 otherwise
+ */
+int batch_run(BatchContext *ctx, FILE *input, BatchSummary *summary);
+
+/**
+ * @brief Run all commands from a file ("-" for stdin)
+ * @param ctx Batch context
+ * @param path File path or "-"
+ * @param summary Output statistics (may be NULL)
+ * @return 1 if every command succeeded and data was saved, 0 otherwise
+ */
+int batch_run_file(BatchContext *ctx, const char *path, BatchSummary *summary);
+
+/**
+ * @brief Import a file of stock movements in one validated step
+ *
+ * Loads product_id|type|quantity|notes rows, validates them all in one
+ * pass (OUT rows in arrival order against projected stock) and applies
+ * every accepted row at once. With strict set, nothing is applied if any
+ * row is rejected. Does not save; the caller persists once afterwards.
+ *
+ * @param ctx Batch context (lists to operate on)
+ * @param path Movement file
+ * @param strict 1 to apply nothing unless every row is accepted
+ * @param report Stream for the per-row report (may be NULL)
+ * @param summary Output statistics (may be NULL)
+ * @return 1 if the file was processed, 0 on read/allocation failure
+ */
+int batch_import_movements(BatchContext *ctx, const char *path, int strict,
+                           FILE *report, ImportSummary *summary);
+
+#endif /* BATCH_H */
@@ -0,0 +1,109 @@
+/**
+ * @file cache.c
+ * @brief Implementation of the report result cache
+ */
+
+#include "cache.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int same_report(const ReportCacheKey *a, const ReportCacheKey *b) {
+    if (a->kind != b->kind) return 0;
+    for (int i = 0; i < REPORT_CACHE_PARAMS; i++) {
+        if (a->params[i] != b->params[i]) return 0;
+    }
+    return 1;
+}
+
+static void drop_entry(ReportCache *cache, ReportCacheEntry *entry) {
+    cache->bytes -= entry->size;
+    free(entry->data);
+    entry->data = NULL;
+    entry->size = 0;
+    cache->evictions++;
+}
+
+void report_cache_init(ReportCache *cache, size_t max_bytes) {
+    if (cache == NULL) return;
+    
+    memset(cache, 0, sizeof(ReportCache));
+    cache->max_bytes = (max_bytes > 0) ? max_bytes : (size_t)REPORT_CACHE_MAX_BYTES;
+}
+
+void report_cache_free(ReportCache *cache) {
+    if (cache == NULL) return;
+    
+    for (int i = 0; i < REPORT_CACHE_ENTRIES; i++) {
+        free(cache->entries[i].data);
+        cache->entries[i].data = NULL;
+        cache->entries[i].size = 0;
+    }
+    cache->bytes = 0;
+}
+
+const void* report_cache_get(ReportCache *cache, const ReportCacheKey *key, size_t *size) {
+    if (cache == NULL || key == NULL) return NULL;
+    
+    for (int i = 0; i < REPORT_CACHE_ENTRIES; i++) {
+        ReportCacheEntry *entry = &cache->entries[i];
+        if (entry->data == NULL || !same_report(&entry->key, key)) continue;
+        
+        // Same report on older data can never be used again
+        if (entry->key.product_generation != key->product_generation ||
+            entry->key.transaction_generation != key->transaction_generation) {
+            drop_entry(cache, entry);
+            continue;
+        }
+        
+        entry->last_used = ++cache->tick;
+        cache->hits++;
+        if (size != NULL) *size = entry->size;
+        return entry->data;
+    }
+    
+    cache->misses++;
+    return NULL;
+}
+
+int report_cache_put(ReportCache *cache, const ReportCacheKey *key, const void *data, size_t size) {
+    if (cache == NULL || key == NULL || (data == NULL && size > 0)) return 0;
+    if (size > cache->max_bytes) return 0;
+    
+    // Replace an earlier result for the same report
+    for (int i = 0; i < REPORT_CACHE_ENTRIES; i++) {
+        ReportCacheEntry *entry = &cache->entries[i];
+        if (entry->data != NULL && same_report(&entry->key, key)) {
+            drop_entry(cache, entry);
+        }
+    }
+    
+    // Evict least recently used entries until there is a free slot and room
+    while (1) {
+        ReportCacheEntry *free_slot = NULL;
+        ReportCacheEntry *oldest = NULL;
+        for (int i = 0; i < REPORT_CACHE_ENTRIES; i++) {
+            ReportCacheEntry *entry = &cache->entries[i];
+            if (entry->data == NULL) {
+                if (free_slot == NULL) free_slot = entry;
+            } else if (oldest == NULL || entry->last_used < oldest->last_used) {
+                oldest = entry;
+            }
+        }
+        
+        if (free_slot != NULL && cache->bytes + size <= cache->max_bytes) {
+            // A zero-byte result still needs a non-NULL block to mark the slot used
+            void *copy = malloc((size > 0) ? size : 1);
+            if (copy == NULL) return 0;
+            if (size > 0) memcpy(copy, data, size);
+            
+            free_slot->key = *key;
+            free_slot->data = copy;
+            free_slot->size = size;
+            free_slot->last_used = ++cache->tick;
+            cache->bytes += size;
+            return 1;
+        }
+        if (oldest == NULL) return 0;
+        drop_entry(cache, oldest);
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file cache.h
+ * @brief Report result cache keyed by report, parameters and data version
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A key holds the report kind, its parameters and the product and
+ * transaction list generations the result was computed from. Any change
+ * to either list gives it a new generation, so stale results can never
+ * match; they are dropped the next time the same report is looked up, or
+ * evicted least-recently-used once the entry or byte limit is reached.
+ *
+ * The cache is used from the menu thread only and does no locking.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stddef.h>
+
+#ifndef REPORT_CACHE_ENTRIES
+#define REPORT_CACHE_ENTRIES 32
+#endif
+
+#ifndef REPORT_CACHE_MAX_BYTES
+#define REPORT_CACHE_MAX_BYTES (16L * 1024 * 1024)
+#endif
+
+#define REPORT_CACHE_PARAMS 3
+
+/**
+ * @brief Identity of a cached result
+ */
+typedef struct {
+    int kind;                               ///< Report kind (caller-defined, > 0)
+    long params[REPORT_CACHE_PARAMS];       ///< Report parameters (unused = 0)
+    unsigned long product_generation;       ///< Product list generation
+    unsigned long transaction_generation;   ///< Transaction list generation
+} ReportCacheKey;
+
+/**
+ * @brief One cached result
+ */
+typedef struct {
+    ReportCacheKey key;
+    void *data;                 ///< Copy of the result (NULL = free entry)
+    size_t size;                ///< Bytes in data
+    unsigned long last_used;    ///< Tick of the last hit or store
+} ReportCacheEntry;
+
+/**
+ * @brief Report cache
+ */
+typedef struct {
+    ReportCacheEntry entries[REPORT_CACHE_ENTRIES];
+    size_t bytes;               ///< Bytes held
+    size_t max_bytes;           ///< Byte limit
+    unsigned long tick;         ///< Use counter for LRU
+    long hits;                  ///< Lookups answered from the cache
+    long misses;                ///< Lookups that had to be computed
+    long evictions;             ///< Entries dropped for space or staleness
+} ReportCache;
+
+/**
+ * @brief Initialize an empty cache
+ * @param cache Cache to initialize
+ * @param max_bytes Byte limit (0 for REPORT_CACHE_MAX_BYTES)
+ */
+void report_cache_init(ReportCache *cache, size_t max_bytes);
+
+/**
+ * @brief Release all cached results
+ * @param cache Cache to free
+ */
+void report_cache_free(ReportCache *cache);
+
+/**
+ * @brief Look up a result
+ * @param cache Pointer to ReportCache
+ * @param key Report, parameters and current generations
+ * @param size Output size of the result in bytes
+ * @return Cached result (valid until the next store), or NULL on a miss
+ */
+const void* report_cache_get(ReportCache *cache, const ReportCacheKey *key, size_t *size);
+
+/**
+ * @brief Store a copy of a result, evicting least-recently-used entries
+ * @param cache Pointer to ReportCache
+ * @param key Key the result was computed for
+ * @param data Result bytes
+ * @param size Number of bytes (results over the byte limit are not stored)
+ * @return 1 if stored, 0 otherwise
+ */
+int report_cache_put(ReportCache *cache, const ReportCacheKey *key, const void *data, size_t size);
+
+#endif /* CACHE_H */
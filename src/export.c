@@ -0,0 +1,656 @@
+/**
+ * @file export.c
+ * @brief Implementation of the columnar transaction export
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  // fseeko/ftello for files over 2 GB
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "export.h"
+#include "storage.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    ENCODING_DELTA = 1,
+    ENCODING_VARINT,
+    ENCODING_DICT_U8,
+    ENCODING_DICT_VARINT,
+    ENCODING_STRING,
+    ENCODING_F64
+};
+
+enum {
+    COLUMN_ID,
+    COLUMN_PRODUCT,
+    COLUMN_TYPE,
+    COLUMN_QUANTITY,
+    COLUMN_TIME,
+    COLUMN_CATEGORY,
+    COLUMN_NOTES
+};
+
+static const char *const transaction_columns[EXPORT_TRANSACTION_COLUMNS] = {
+    "transaction_id", "product_id", "type", "quantity", "timestamp", "category", "notes"
+};
+static const int transaction_encodings[EXPORT_TRANSACTION_COLUMNS] = {
+    ENCODING_DELTA, ENCODING_VARINT, ENCODING_DICT_U8, ENCODING_VARINT,
+    ENCODING_DELTA, ENCODING_DICT_VARINT, ENCODING_STRING
+};
+static const char *const product_columns[EXPORT_PRODUCT_COLUMNS] = {
+    "id", "name", "category", "quantity", "reorder_level", "unit_price", "supplier_id"
+};
+static const int product_encodings[EXPORT_PRODUCT_COLUMNS] = {
+    ENCODING_DELTA, ENCODING_STRING, ENCODING_DICT_VARINT, ENCODING_VARINT,
+    ENCODING_VARINT, ENCODING_F64, ENCODING_VARINT
+};
+
+static int seek_to(FILE *file, long long offset, int whence) {
+#ifdef _WIN32
+    return _fseeki64(file, offset, whence) == 0;
+#else
+    return fseeko(file, (off_t)offset, whence) == 0;
+#endif
+}
+
+static long long tell_position(FILE *file) {
+#ifdef _WIN32
+    return _ftelli64(file);
+#else
+    return (long long)ftello(file);
+#endif
+}
+
+static int buffer_reserve(ByteBuffer *b, size_t extra) {
+    if (b->failed) return 0;
+    if (b->size + extra <= b->capacity) return 1;
+    
+    size_t capacity = (b->capacity > 0) ? b->capacity * 2 : 4096;
+    while (capacity < b->size + extra) capacity *= 2;
+    unsigned char *grown = realloc(b->data, capacity);
+    if (grown == NULL) {
+        b->failed = 1;
+        return 0;
+    }
+    b->data = grown;
+    b->capacity = capacity;
+    return 1;
+}
+
+static void put_bytes(ByteBuffer *b, const void *bytes, size_t n) {
+    if (!buffer_reserve(b, n)) return;
+    memcpy(b->data + b->size, bytes, n);
+    b->size += n;
+}
+
+static void put_varint(ByteBuffer *b, unsigned long long v) {
+    if (!buffer_reserve(b, 10)) return;
+    while (v >= 0x80) {
+        b->data[b->size++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    b->data[b->size++] = (unsigned char)v;
+}
+
+static void put_signed(ByteBuffer *b, long long v) {
+    put_varint(b, ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63));
+}
+
+static void put_string(ByteBuffer *b, const char *s) {
+    size_t n = strlen(s);
+    put_varint(b, n);
+    put_bytes(b, s, n);
+}
+
+static void put_f64(ByteBuffer *b, double v) {
+    unsigned long long bits;
+    unsigned char bytes[8];
+    memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)(bits >> (8 * i));
+    }
+    put_bytes(b, bytes, 8);
+}
+
+static void format_timestamp(long long seconds, char *buffer, size_t size) {
+    long long day = (seconds >= 0) ? seconds / 86400 : -((-seconds + 86399) / 86400);
+    int rest = (int)(seconds - day * 86400);
+    char date[16];
+    days_to_date((int)day, date, sizeof(date));
+    snprintf(buffer, size, "%s %02d:%02d:%02d", date, rest / 3600, rest / 60 % 60, rest % 60);
+}
+
+// A product slot keyed by its category, so sorting needs no outside state
+typedef struct {
+    const char *category;
+    int slot;
+} CategorySlot;
+
+static int compare_slot_categories(const void *a, const void *b) {
+    return strcmp(((const CategorySlot *)a)->category, ((const CategorySlot *)b)->category);
+}
+
+// Code every product's category; entry 0 is reserved for unknown products
+static int build_category_dictionary(ExportWriter *w) {
+    const ProductList *list = w->products;
+    CategorySlot *order = malloc(sizeof(CategorySlot) * (size_t)(list->count + 1));
+    w->category_codes = malloc(sizeof(int) * (size_t)(list->count + 1));
+    w->categories = malloc(sizeof(char *) * (size_t)(list->count + 1));
+    if (order == NULL || w->category_codes == NULL || w->categories == NULL) {
+        free(order);
+        return 0;
+    }
+    
+    for (int i = 0; i < list->count; i++) {
+        order[i].category = list->products[i].category;
+        order[i].slot = i;
+    }
+    qsort(order, (size_t)list->count, sizeof(CategorySlot), compare_slot_categories);
+    
+    w->categories[0] = "";
+    w->category_count = 1;
+    for (int i = 0; i < list->count; i++) {
+        const char *category = order[i].category;
+        if (strcmp(category, w->categories[w->category_count - 1]) != 0) {
+            w->categories[w->category_count++] = category;
+        }
+        w->category_codes[order[i].slot] = w->category_count - 1;
+    }
+    
+    free(order);
+    return 1;
+}
+
+static int type_code(ExportWriter *w, const char *type) {
+    for (int i = 0; i < w->type_count; i++) {
+        if (strcmp(w->types[i], type) == 0) return i;
+    }
+    if (w->type_count == EXPORT_MAX_TYPES) return -1;
+    
+    strncpy(w->types[w->type_count], type, sizeof(w->types[0]) - 1);
+    w->types[w->type_count][sizeof(w->types[0]) - 1] = '\0';
+    return w->type_count++;
+}
+
+// Write column chunks (length-prefixed) and return the bytes written, or -1
+static long long write_chunks(ExportWriter *w, ByteBuffer *columns, int count) {
+    ByteBuffer prefix = {0};
+    long long written = 0;
+    
+    for (int c = 0; c < count; c++) {
+        if (columns[c].failed) return -1;
+        prefix.size = 0;
+        put_varint(&prefix, columns[c].size);
+        if (prefix.failed ||
+            fwrite(prefix.data, 1, prefix.size, w->file) != prefix.size ||
+            fwrite(columns[c].data, 1, columns[c].size, w->file) != columns[c].size) {
+            free(prefix.data);
+            return -1;
+        }
+        written += (long long)(prefix.size + columns[c].size);
+    }
+    
+    free(prefix.data);
+    return written;
+}
+
+static int flush_group(ExportWriter *w) {
+    if (w->group.rows == 0) return 1;
+    
+    if (w->group_count == w->group_capacity) {
+        int capacity = (w->group_capacity > 0) ? w->group_capacity * 2 : 16;
+        ExportRowGroup *grown = realloc(w->groups, sizeof(ExportRowGroup) * (size_t)capacity);
+        if (grown == NULL) return 0;
+        w->groups = grown;
+        w->group_capacity = capacity;
+    }
+    
+    long long length = write_chunks(w, w->columns, EXPORT_TRANSACTION_COLUMNS);
+    if (length < 0) return 0;
+    
+    w->group.offset = w->offset;
+    w->group.length = length;
+    w->groups[w->group_count++] = w->group;
+    w->offset += length;
+    
+    // The next group starts its deltas from zero
+    memset(&w->group, 0, sizeof(ExportRowGroup));
+    for (int c = 0; c < EXPORT_TRANSACTION_COLUMNS; c++) {
+        w->columns[c].size = 0;
+    }
+    w->previous_id = 0;
+    w->previous_time = 0;
+    return 1;
+}
+
+static void release_writer(ExportWriter *w) {
+    if (w->file != NULL) fclose(w->file);
+    for (int c = 0; c < EXPORT_TRANSACTION_COLUMNS; c++) {
+        free(w->columns[c].data);
+    }
+    product_index_free(&w->ids);
+    free(w->category_codes);
+    free((void *)w->categories);
+    free(w->groups);
+    memset(w, 0, sizeof(ExportWriter));
+}
+
+int export_open(ExportWriter *writer, const char *path, const ProductList *products) {
+    if (writer == NULL || path == NULL || products == NULL) return 0;
+    
+    memset(writer, 0, sizeof(ExportWriter));
+    writer->products = products;
+    if (!product_index_build(&writer->ids, products) || !build_category_dictionary(writer)) {
+        release_writer(writer);
+        return 0;
+    }
+    type_code(writer, TRANSACTION_TYPE_IN);
+    type_code(writer, TRANSACTION_TYPE_OUT);
+    
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL || fwrite(EXPORT_MAGIC, 1, 8, writer->file) != 8) {
+        release_writer(writer);
+        return 0;
+    }
+    writer->offset = 8;
+    return 1;
+}
+
+int export_add(ExportWriter *writer, const Transaction *transaction) {
+    if (writer == NULL || writer->file == NULL || transaction == NULL || writer->failed) return 0;
+    
+    ExportRowGroup *g = &writer->group;
+    long long id = transaction->transaction_id;
+    long long time;
+    if (datetime_to_seconds(transaction->date_time, &time)) {
+        writer->last_time = time;
+    } else {
+        time = writer->last_time;
+    }
+    
+    int type = type_code(writer, transaction->type);
+    int slot = product_index_find(&writer->ids, writer->products, transaction->product_id);
+    int category = (slot >= 0) ? writer->category_codes[slot] : 0;
+    if (type < 0) {
+        writer->failed = 1;
+        return 0;
+    }
+    
+    ByteBuffer *col = writer->columns;
+    put_signed(&col[COLUMN_ID], id - writer->previous_id);
+    put_signed(&col[COLUMN_PRODUCT], transaction->product_id);
+    unsigned char type_byte = (unsigned char)type;
+    put_bytes(&col[COLUMN_TYPE], &type_byte, 1);
+    put_signed(&col[COLUMN_QUANTITY], transaction->quantity);
+    put_signed(&col[COLUMN_TIME], time - writer->previous_time);
+    put_varint(&col[COLUMN_CATEGORY], (unsigned long long)category);
+    put_string(&col[COLUMN_NOTES], transaction->notes);
+    writer->previous_id = id;
+    writer->previous_time = time;
+    
+    if (g->rows == 0 || time < g->min_time) g->min_time = time;
+    if (g->rows == 0 || time > g->max_time) g->max_time = time;
+    if (g->rows == 0 || id < g->min_id) g->min_id = id;
+    if (g->rows == 0 || id > g->max_id) g->max_id = id;
+    g->rows++;
+    writer->rows++;
+    
+    if (g->rows == EXPORT_ROW_GROUP_ROWS && !flush_group(writer)) {
+        writer->failed = 1;
+        return 0;
+    }
+    return 1;
+}
+
+// Product columns as one block at the end of the file
+static long long write_product_block(ExportWriter *w) {
+    ByteBuffer columns[EXPORT_PRODUCT_COLUMNS];
+    memset(columns, 0, sizeof(columns));
+    
+    long long previous = 0;
+    for (int i = 0; i < w->products->count; i++) {
+        const Product *p = &w->products->products[i];
+        put_signed(&columns[0], p->id - previous);
+        put_string(&columns[1], p->name);
+        put_varint(&columns[2], (unsigned long long)w->category_codes[i]);
+        put_signed(&columns[3], p->quantity_in_stock);
+        put_signed(&columns[4], p->reorder_level);
+        put_f64(&columns[5], p->unit_price);
+        put_signed(&columns[6], p->supplier_id);
+        previous = p->id;
+    }
+    
+    long long length = write_chunks(w, columns, EXPORT_PRODUCT_COLUMNS);
+    for (int c = 0; c < EXPORT_PRODUCT_COLUMNS; c++) {
+        free(columns[c].data);
+    }
+    return length;
+}
+
+int export_close(ExportWriter *writer, ExportStats *stats) {
+    if (writer == NULL || writer->file == NULL) return 0;
+    
+    int ok = !writer->failed && flush_group(writer);
+    long long products_offset = writer->offset;
+    long long products_length = ok ? write_product_block(writer) : -1;
+    ok = ok && products_length >= 0;
+    
+    ByteBuffer footer = {0};
+    put_varint(&footer, EXPORT_VERSION);
+    put_varint(&footer, EXPORT_TRANSACTION_COLUMNS);
+    for (int c = 0; c < EXPORT_TRANSACTION_COLUMNS; c++) {
+        put_string(&footer, transaction_columns[c]);
+        put_varint(&footer, (unsigned long long)transaction_encodings[c]);
+    }
+    put_varint(&footer, EXPORT_PRODUCT_COLUMNS);
+    for (int c = 0; c < EXPORT_PRODUCT_COLUMNS; c++) {
+        put_string(&footer, product_columns[c]);
+        put_varint(&footer, (unsigned long long)product_encodings[c]);
+    }
+    put_varint(&footer, (unsigned long long)writer->type_count);
+    for (int i = 0; i < writer->type_count; i++) {
+        put_string(&footer, writer->types[i]);
+    }
+    put_varint(&footer, (unsigned long long)writer->category_count);
+    for (int i = 0; i < writer->category_count; i++) {
+        put_string(&footer, writer->categories[i]);
+    }
+    put_varint(&footer, (unsigned long long)writer->rows);
+    put_varint(&footer, (unsigned long long)writer->group_count);
+    for (int i = 0; i < writer->group_count; i++) {
+        const ExportRowGroup *g = &writer->groups[i];
+        put_varint(&footer, (unsigned long long)g->offset);
+        put_varint(&footer, (unsigned long long)g->length);
+        put_varint(&footer, (unsigned long long)g->rows);
+        put_signed(&footer, g->min_time);
+        put_signed(&footer, g->max_time);
+        put_signed(&footer, g->min_id);
+        put_signed(&footer, g->max_id);
+    }
+    put_varint(&footer, (unsigned long long)products_offset);
+    put_varint(&footer, (unsigned long long)products_length);
+    put_varint(&footer, (unsigned long long)writer->products->count);
+    
+    unsigned char trailer[12];
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = (unsigned char)(footer.size >> (8 * i));
+    }
+    memcpy(trailer + 4, EXPORT_MAGIC, 8);
+    
+    ok = ok && !footer.failed &&
+         fwrite(footer.data, 1, footer.size, writer->file) == footer.size &&
+         fwrite(trailer, 1, sizeof(trailer), writer->file) == sizeof(trailer);
+    
+    if (stats != NULL) {
+        stats->rows = writer->rows;
+        stats->row_groups = writer->group_count;
+        stats->groups_skipped = 0;
+        stats->bytes = products_offset + products_length + (long long)footer.size + 12;
+    }
+    
+    free(footer.data);
+    if (fclose(writer->file) != 0) ok = 0;
+    writer->file = NULL;
+    release_writer(writer);
+    return ok;
+}
+
+int export_transactions(const char *path, const ProductList *products,
+                        const TransactionList *transactions, ExportStats *stats) {
+    if (transactions == NULL) return 0;
+    
+    ExportWriter writer;
+    if (!export_open(&writer, path, products)) return 0;
+    
+    for (int i = 0; i < transactions->count; i++) {
+        if (!export_add(&writer, &transactions->transactions[i])) break;
+    }
+    return export_close(&writer, stats);
+}
+
+int export_transactions_file(const char *path, const ProductList *products,
+                             const char *source, ExportStats *stats) {
+    if (source == NULL) return 0;
+    
+    FILE *in = fopen(source, "r");
+    if (in == NULL) return 0;
+    
+    ExportWriter writer;
+    if (!export_open(&writer, path, products)) {
+        fclose(in);
+        return 0;
+    }
+    
+    // One line at a time: memory stays at one row group however long the file is
+    char line[1000];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        Transaction t;
+        if (strncmp(line, "transaction_id|", 15) == 0) continue;  // Header
+        if (!storage_parse_transaction(line, &t)) continue;
+        if (!export_add(&writer, &t)) break;
+    }
+    
+    fclose(in);
+    return export_close(&writer, stats);
+}
+
+/**
+ * @brief Read position in a decoded buffer
+ */
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    size_t pos;
+    int failed;
+} Reader;
+
+static unsigned long long get_varint(Reader *r) {
+    unsigned long long v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->size) break;
+        unsigned char byte = r->data[r->pos++];
+        v |= (unsigned long long)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return v;
+    }
+    r->failed = 1;
+    return 0;
+}
+
+static long long get_signed(Reader *r) {
+    unsigned long long v = get_varint(r);
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+// Next length-prefixed string, copied into out (truncated to size)
+static void get_string(Reader *r, char *out, size_t size) {
+    unsigned long long n = get_varint(r);
+    if (r->failed || n > r->size - r->pos) {
+        r->failed = 1;
+        out[0] = '\0';
+        return;
+    }
+    size_t copy = (n < size) ? (size_t)n : size - 1;
+    memcpy(out, r->data + r->pos, copy);
+    out[copy] = '\0';
+    r->pos += (size_t)n;
+}
+
+// Sub-reader over the next column chunk
+static Reader get_chunk(Reader *r) {
+    Reader chunk = { NULL, 0, 0, 1 };
+    unsigned long long n = get_varint(r);
+    if (r->failed || n > r->size - r->pos) {
+        r->failed = 1;
+        return chunk;
+    }
+    chunk.data = r->data + r->pos;
+    chunk.size = (size_t)n;
+    chunk.failed = 0;
+    r->pos += (size_t)n;
+    return chunk;
+}
+
+/**
+ * @brief Parsed footer
+ */
+typedef struct {
+    char (*types)[10];
+    int type_count;
+    char (*categories)[MAX_CATEGORY_LEN];
+    int category_count;
+    ExportRowGroup *groups;
+    int group_count;
+} Footer;
+
+static void free_footer(Footer *f) {
+    free(f->types);
+    free(f->categories);
+    free(f->groups);
+}
+
+static int read_footer(FILE *file, unsigned char **buffer, Footer *f) {
+    unsigned char trailer[12];
+    memset(f, 0, sizeof(Footer));
+    if (!seek_to(file, -12, SEEK_END) || fread(trailer, 1, 12, file) != 12 ||
+        memcmp(trailer + 4, EXPORT_MAGIC, 8) != 0) {
+        return 0;
+    }
+    
+    size_t length = (size_t)trailer[0] | (size_t)trailer[1] << 8 |
+                    (size_t)trailer[2] << 16 | (size_t)trailer[3] << 24;
+    *buffer = malloc(length + 1);
+    if (*buffer == NULL || !seek_to(file, -12 - (long long)length, SEEK_END) ||
+        fread(*buffer, 1, length, file) != length) {
+        return 0;
+    }
+    
+    Reader r = { *buffer, length, 0, 0 };
+    char name[64];
+    if (get_varint(&r) != EXPORT_VERSION) return 0;
+    for (int table = 0; table < 2; table++) {
+        unsigned long long columns = get_varint(&r);
+        for (unsigned long long c = 0; c < columns && !r.failed; c++) {
+            get_string(&r, name, sizeof(name));
+            get_varint(&r);
+        }
+    }
+    
+    f->type_count = (int)get_varint(&r);
+    f->types = calloc((size_t)f->type_count + 1, sizeof(*f->types));
+    for (int i = 0; f->types != NULL && i < f->type_count; i++) {
+        get_string(&r, f->types[i], sizeof(f->types[i]));
+    }
+    f->category_count = (int)get_varint(&r);
+    f->categories = calloc((size_t)f->category_count + 1, sizeof(*f->categories));
+    for (int i = 0; f->categories != NULL && i < f->category_count; i++) {
+        get_string(&r, f->categories[i], sizeof(f->categories[i]));
+    }
+    
+    get_varint(&r);  // Total rows
+    f->group_count = (int)get_varint(&r);
+    f->groups = calloc((size_t)f->group_count + 1, sizeof(ExportRowGroup));
+    if (f->types == NULL || f->categories == NULL || f->groups == NULL) return 0;
+    for (int i = 0; i < f->group_count; i++) {
+        ExportRowGroup *g = &f->groups[i];
+        g->offset = (long long)get_varint(&r);
+        g->length = (long long)get_varint(&r);
+        g->rows = (int)get_varint(&r);
+        g->min_time = get_signed(&r);
+        g->max_time = get_signed(&r);
+        g->min_id = get_signed(&r);
+        g->max_id = get_signed(&r);
+    }
+    return !r.failed;
+}
+
+// Decode one row group and pass the rows in the time range to fn (1 = go on, 0 = stop, -1 = malformed)
+static int scan_group(const Footer *f, const unsigned char *data, const ExportRowGroup *g,
+                      long long first_time, long long last_time,
+                      ExportRowFunc fn, void *ctx, long *rows) {
+    Reader group = { data, (size_t)g->length, 0, 0 };
+    Reader col[EXPORT_TRANSACTION_COLUMNS];
+    for (int c = 0; c < EXPORT_TRANSACTION_COLUMNS; c++) {
+        col[c] = get_chunk(&group);
+    }
+    if (group.failed) return -1;
+    
+    long long id = 0, time = 0;
+    for (int i = 0; i < g->rows; i++) {
+        Transaction t;
+        memset(&t, 0, sizeof(t));
+        id += get_signed(&col[COLUMN_ID]);
+        time += get_signed(&col[COLUMN_TIME]);
+        t.transaction_id = (int)id;
+        t.product_id = (int)get_signed(&col[COLUMN_PRODUCT]);
+        t.quantity = (int)get_signed(&col[COLUMN_QUANTITY]);
+        
+        int type = (col[COLUMN_TYPE].pos < col[COLUMN_TYPE].size) ?
+                   col[COLUMN_TYPE].data[col[COLUMN_TYPE].pos++] : f->type_count;
+        unsigned long long category = get_varint(&col[COLUMN_CATEGORY]);
+        get_string(&col[COLUMN_NOTES], t.notes, sizeof(t.notes));
+        if (type >= f->type_count || category >= (unsigned long long)f->category_count) return -1;
+        for (int c = 0; c < EXPORT_TRANSACTION_COLUMNS; c++) {
+            if (col[c].failed) return -1;
+        }
+        
+        if (time < first_time || time > last_time) continue;
+        strcpy(t.type, f->types[type]);
+        format_timestamp(time, t.date_time, sizeof(t.date_time));
+        (*rows)++;
+        if (fn != NULL && !fn(ctx, &t, f->categories[category])) return 0;
+    }
+    return 1;
+}
+
+int export_scan(const char *path, long long first_time, long long last_time,
+                ExportRowFunc fn, void *ctx, ExportStats *stats) {
+    if (path == NULL) return 0;
+    
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return 0;
+    
+    unsigned char *footer_data = NULL;
+    unsigned char *group_data = NULL;
+    Footer footer;
+    ExportStats counts = {0};
+    int ok = read_footer(file, &footer_data, &footer);
+    
+    for (int i = 0; ok && i < footer.group_count; i++) {
+        const ExportRowGroup *g = &footer.groups[i];
+        if (g->max_time < first_time || g->min_time > last_time) {
+            counts.groups_skipped++;  // Never read
+            continue;
+        }
+        
+        unsigned char *grown = realloc(group_data, (size_t)g->length + 1);
+        if (grown == NULL) {
+            ok = 0;
+            break;  // group_data is still ours and freed below
+        }
+        group_data = grown;
+        if (!seek_to(file, g->offset, SEEK_SET) ||
+            fread(group_data, 1, (size_t)g->length, file) != (size_t)g->length) {
+            ok = 0;
+            break;
+        }
+        counts.row_groups++;
+        
+        int result = scan_group(&footer, group_data, g, first_time, last_time, fn, ctx, &counts.rows);
+        if (result < 0) ok = 0;
+        if (result <= 0) break;
+    }
+    
+    if (seek_to(file, 0, SEEK_END)) {
+        counts.bytes = tell_position(file);
+    }
+    if (stats != NULL) *stats = counts;
+    
+    free(group_data);
+    free(footer_data);
+    free_footer(&footer);
+    fclose(file);
+    return ok;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file export.h
+ * @brief Streaming columnar export of transactions for analytics tools
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Transactions are written in row groups of up to EXPORT_ROW_GROUP_ROWS
+ * rows, column by column, so memory use is bounded by one row group no
+ * matter how long the history is. The footer records the time and ID range
+ * of every row group, so a reader can skip groups outside a date range.
+ *
+ * File layout (integers are little-endian; "varint" is LEB128, "zigzag"
+ * maps signed to unsigned before the varint):
+ *
+ *   "INVCOL01"                       8-byte magic
+ *   row group ...                    transaction columns
+ *   product block                    product columns
+ *   footer                           see below
+ *   u32 footer length                bytes in the footer
+ *   "INVCOL01"                       8-byte magic
+ *
+ * A row group (and the product block) is a sequence of column chunks in
+ * schema order, each a varint byte length followed by the encoded values.
+ * Delta columns restart at 0 in every group, so groups decode on their own.
+ *
+ *   Transaction columns:
+ *     transaction_id   zigzag varint delta from the previous row
+ *     product_id       zigzag varint
+ *     type             u8 index into the type dictionary
+ *     quantity         zigzag varint
+ *     timestamp        zigzag varint delta (seconds since 1970-01-01)
+ *     category         varint index into the category dictionary
+ *                      (product's category at export time; 0 = unknown)
+ *     notes            varint length + bytes
+ *
+ *   Product columns:
+ *     id               zigzag varint delta
+ *     name             varint length + bytes
+ *     category         varint index into the category dictionary
+ *     quantity         zigzag varint
+ *     reorder_level    zigzag varint
+ *     unit_price       f64
+ *     supplier_id      zigzag varint
+ *
+ * Footer (all varints unless noted):
+ *
+ *   version (1)
+ *   transaction column count, then per column: name (length + bytes), encoding
+ *   product column count, then per column: name, encoding
+ *   type dictionary: count, then strings (length + bytes)
+ *   category dictionary: count, then strings (entry 0 is "")
+ *   total transaction rows
+ *   row group count, then per group: offset, byte length, rows,
+ *     min timestamp (zigzag), max timestamp (zigzag), min ID (zigzag), max ID (zigzag)
+ *   product block: offset, byte length, rows
+ *
+ * Encodings: 1 = zigzag delta varint, 2 = zigzag varint, 3 = u8 dictionary,
+ * 4 = varint dictionary, 5 = length-prefixed string, 6 = f64.
+ *
+ * Dates that do not parse take the last timestamp that did, even across
+ * row groups (0 only before the first parsed date of the export).
+ */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdio.h>
+#include "product.h"
+#include "transaction.h"
+
+#ifndef EXPORT_ROW_GROUP_ROWS
+#define EXPORT_ROW_GROUP_ROWS 65536
+#endif
+
+#define EXPORT_MAGIC "INVCOL01"
+#define EXPORT_VERSION 1
+#define EXPORT_TRANSACTION_COLUMNS 7
+#define EXPORT_PRODUCT_COLUMNS 7
+#define EXPORT_MAX_TYPES 255
+
+/**
+ * @brief Growable byte buffer
+ */
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    size_t capacity;
+    int failed;                 ///< Set if an allocation failed
+} ByteBuffer;
+
+/**
+ * @brief Footer entry of one row group
+ */
+typedef struct {
+    long long offset;           ///< File offset of the group
+    long long length;           ///< Bytes in the group
+    int rows;
+    long long min_time;         ///< Earliest timestamp in the group
+    long long max_time;         ///< Latest timestamp in the group
+    long long min_id;           ///< Smallest transaction ID
+    long long max_id;           ///< Largest transaction ID
+} ExportRowGroup;
+
+/**
+ * @brief Export counters
+ */
+typedef struct {
+    long rows;                  ///< Transaction rows written or read
+    int row_groups;             ///< Row groups written or read
+    int groups_skipped;         ///< Row groups skipped by a range scan
+    long long bytes;            ///< File size
+} ExportStats;
+
+/**
+ * @brief Columnar file writer
+ */
+typedef struct {
+    FILE *file;
+    const ProductList *products;
+    ProductIdIndex ids;                         ///< Product ID to slot
+    int *category_codes;                        ///< Dictionary code per product slot
+    const char **categories;                    ///< Category dictionary (product strings)
+    int category_count;
+    char types[EXPORT_MAX_TYPES][10];           ///< Type dictionary
+    int type_count;
+    ByteBuffer columns[EXPORT_TRANSACTION_COLUMNS];
+    ExportRowGroup group;                       ///< Group being filled
+    long long previous_id;                      ///< Delta base, reset per group
+    long long previous_time;                    ///< Delta base, reset per group
+    long long last_time;                        ///< Last parsed timestamp, never reset
+    ExportRowGroup *groups;                     ///< Finished groups
+    int group_count;
+    int group_capacity;
+    long long offset;                           ///< Bytes written so far
+    long rows;
+    int failed;
+} ExportWriter;
+
+/**
+ * @brief Callback for each row read back from an export
+ * @param ctx Caller context
+ * @param transaction Decoded transaction (date_time rebuilt from the timestamp)
+ * @param category Product category at export time ("" if unknown)
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (*ExportRowFunc)(void *ctx, const Transaction *transaction, const char *category);
+
+/**
+ * @brief Create an export file
+ * @param writer Writer to initialize
+ * @param path Output file
+ * @param products Products (category join and product block)
+ * @return 1 on success, 0 if the file cannot be created
+ */
+int export_open(ExportWriter *writer, const char *path, const ProductList *products);
+
+/**
+ * @brief Append one transaction, flushing a row group when it is full
+ * @param writer Open writer
+ * @param transaction Row to add
+ * @return 1 on success, 0 on a write or allocation failure
+ */
+int export_add(ExportWriter *writer, const Transaction *transaction);
+
+/**
+ * @brief Write the last row group, the product block and the footer, then close
+ * @param writer Open writer (released even on failure)
+ * @param stats Output counters (may be NULL)
+ * @return 1 on success, 0 on a write failure
+ */
+int export_close(ExportWriter *writer, ExportStats *stats);
+
+/**
+ * @brief Export a transaction list held in memory
+ * @param path Output file
+ * @param products Products
+ * @param transactions Rows to export
+ * @param stats Output counters (may be NULL)
+ * @return 1 on success, 0 on failure
+ */
+int export_transactions(const char *path, const ProductList *products,
+                        const TransactionList *transactions, ExportStats *stats);
+
+/**
+ * @brief Export a transactions data file line by line, without loading it
+ * @param path Output file
+ * @param products Products
+ * @param source Transactions file (same format as data/transactions.txt)
+ * @param stats Output counters (may be NULL)
+ * @return 1 on success, 0 on failure
+ */
+int export_transactions_file(const char *path, const ProductList *products,
+                             const char *source, ExportStats *stats);
+
+/**
+ * @brief Read back the rows of an export within a time range
+ *
+ * Row groups whose time range does not overlap are skipped unread.
+ *
+ * @param path Export file
+ * @param first_time First timestamp (seconds since 1970-01-01, inclusive)
+ * @param last_time Last timestamp (inclusive)
+ * @param fn Callback for each row in the range
+ * @param ctx Callback context
+ * @param stats Output counters (may be NULL)
+ * @return 1 on success, 0 if the file is missing or malformed
+ */
+int export_scan(const char *path, long long first_time, long long last_time,
+                ExportRowFunc fn, void *ctx, ExportStats *stats);
+
+#endif /* EXPORT_H */
@@ -0,0 +1,531 @@
+/**
+ * @file filter.c
+ * @brief Implementation of filter expressions
+ */
+
+#include "filter.h"
+#include "metrics.h"
+#include "utils.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { FIELD_NUMBER, FIELD_TEXT };
+
+enum {
+    OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE, OP_CONTAINS
+};
+
+// Product fields
+enum {
+    P_ID, P_NAME, P_CATEGORY, P_DESCRIPTION, P_QTY, P_REORDER, P_PRICE, P_SUPPLIER, P_VALUE
+};
+
+// Transaction fields
+enum {
+    T_ID, T_PRODUCT, T_TYPE, T_QTY, T_DATE, T_NOTES
+};
+
+typedef struct {
+    const char *name;
+    int field;
+    int kind;
+} FieldDef;
+
+static const FieldDef product_fields[] = {
+    {"id",          P_ID,          FIELD_NUMBER},
+    {"name",        P_NAME,        FIELD_TEXT},
+    {"category",    P_CATEGORY,    FIELD_TEXT},
+    {"description", P_DESCRIPTION, FIELD_TEXT},
+    {"qty",         P_QTY,         FIELD_NUMBER},
+    {"quantity",    P_QTY,         FIELD_NUMBER},
+    {"reorder",     P_REORDER,     FIELD_NUMBER},
+    {"price",       P_PRICE,       FIELD_NUMBER},
+    {"supplier",    P_SUPPLIER,    FIELD_NUMBER},
+    {"value",       P_VALUE,       FIELD_NUMBER},
+};
+
+static const FieldDef transaction_fields[] = {
+    {"id",          T_ID,          FIELD_NUMBER},
+    {"product",     T_PRODUCT,     FIELD_NUMBER},
+    {"type",        T_TYPE,        FIELD_TEXT},
+    {"qty",         T_QTY,         FIELD_NUMBER},
+    {"quantity",    T_QTY,         FIELD_NUMBER},
+    {"date",        T_DATE,        FIELD_TEXT},
+    {"notes",       T_NOTES,       FIELD_TEXT},
+};
+
+#define PRODUCT_FIELD_COUNT (int)(sizeof(product_fields) / sizeof(product_fields[0]))
+#define TRANSACTION_FIELD_COUNT (int)(sizeof(transaction_fields) / sizeof(transaction_fields[0]))
+
+static const FieldDef* find_field(FilterTarget target, const char *name) {
+    const FieldDef *fields = (target == FILTER_PRODUCTS) ? product_fields : transaction_fields;
+    int count = (target == FILTER_PRODUCTS) ? PRODUCT_FIELD_COUNT : TRANSACTION_FIELD_COUNT;
+    
+    for (int i = 0; i < count; i++) {
+        if (strcmp(fields[i].name, name) == 0) return &fields[i];
+    }
+    return NULL;
+}
+
+static int field_kind(FilterTarget target, int field) {
+    if (target == FILTER_PRODUCTS) {
+        return (field == P_NAME || field == P_CATEGORY || field == P_DESCRIPTION) ?
+            FIELD_TEXT : FIELD_NUMBER;
+    }
+    return (field == T_TYPE || field == T_DATE || field == T_NOTES) ? FIELD_TEXT : FIELD_NUMBER;
+}
+
+// Case-insensitive comparison of at most limit characters
+static int text_compare(const char *a, const char *b, int limit) {
+    for (int i = 0; i < limit; i++) {
+        int ca = tolower((unsigned char)a[i]);
+        int cb = tolower((unsigned char)b[i]);
+        if (ca != cb || ca == '\0') return (ca > cb) - (ca < cb);
+    }
+    return 0;
+}
+
+static int text_contains(const char *haystack, const char *needle) {
+    size_t n = strlen(needle);
+    for (const char *h = haystack; *h != '\0'; h++) {
+        if (text_compare(h, needle, (int)n) == 0) return 1;
+    }
+    return n == 0;
+}
+
+static double row_number(FilterTarget target, const void *row, int field) {
+    if (target == FILTER_PRODUCTS) {
+        const Product *p = (const Product *)row;
+        switch (field) {
+            case P_ID:       return p->id;
+            case P_QTY:      return p->quantity_in_stock;
+            case P_REORDER:  return p->reorder_level;
+            case P_PRICE:    return p->unit_price;
+            case P_SUPPLIER: return p->supplier_id;
+            case P_VALUE:    return p->quantity_in_stock * p->unit_price;
+            default:         return 0.0;
+        }
+    }
+    
+    const Transaction *t = (const Transaction *)row;
+    switch (field) {
+        case T_ID:      return t->transaction_id;
+        case T_PRODUCT: return t->product_id;
+        case T_QTY:     return t->quantity;
+        default:        return 0.0;
+    }
+}
+
+static const char* row_text(FilterTarget target, const void *row, int field) {
+    if (target == FILTER_PRODUCTS) {
+        const Product *p = (const Product *)row;
+        switch (field) {
+            case P_NAME:        return p->name;
+            case P_CATEGORY:    return p->category;
+            case P_DESCRIPTION: return p->description;
+            default:            return "";
+        }
+    }
+    
+    const Transaction *t = (const Transaction *)row;
+    switch (field) {
+        case T_TYPE:  return t->type;
+        case T_DATE:  return t->date_time;
+        case T_NOTES: return t->notes;
+        default:      return "";
+    }
+}
+
+static int op_holds(int op, int cmp) {
+    switch (op) {
+        case OP_EQ: return cmp == 0;
+        case OP_NE: return cmp != 0;
+        case OP_LT: return cmp < 0;
+        case OP_LE: return cmp <= 0;
+        case OP_GT: return cmp > 0;
+        case OP_GE: return cmp >= 0;
+        default:    return 0;
+    }
+}
+
+static int term_matches(FilterTarget target, const FilterTerm *term, const void *row) {
+    if (field_kind(target, term->field) == FIELD_NUMBER) {
+        double lhs = row_number(target, row, term->field);
+        double rhs = (term->rhs_field >= 0) ? row_number(target, row, term->rhs_field) : term->number;
+        return op_holds(term->op, (lhs > rhs) - (lhs < rhs));
+    }
+    
+    const char *lhs = row_text(target, row, term->field);
+    const char *rhs = (term->rhs_field >= 0) ? row_text(target, row, term->rhs_field) : term->text;
+    if (term->op == OP_CONTAINS) {
+        return text_contains(lhs, rhs);
+    }
+    
+    // Dates compare on the day, so date=2025-01-15 matches any time that day
+    int limit = (target == FILTER_TRANSACTIONS && term->field == T_DATE) ? 10 : INT_MAX;
+    return op_holds(term->op, text_compare(lhs, rhs, limit));
+}
+
+// All terms are checked in one pass over the row
+static int row_matches(const FilterPlan *plan, const void *row) {
+    for (int i = 0; i < plan->term_count; i++) {
+        if (!term_matches(plan->target, &plan->terms[i], row)) return 0;
+    }
+    return 1;
+}
+
+static const char* skip_spaces(const char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    return s;
+}
+
+static int read_operator(const char **s) {
+    static const struct { const char *text; int op; } ops[] = {
+        {"<=", OP_LE}, {">=", OP_GE}, {"!=", OP_NE},
+        {"=", OP_EQ}, {"<", OP_LT}, {">", OP_GT}, {"~", OP_CONTAINS},
+    };
+    
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        size_t n = strlen(ops[i].text);
+        if (strncmp(*s, ops[i].text, n) == 0) {
+            *s += n;
+            return ops[i].op;
+        }
+    }
+    return -1;
+}
+
+static int compile_error(FilterPlan *plan, const char *message, const char *detail) {
+    snprintf(plan->error, sizeof(plan->error), "%s '%.60s'", message, detail);
+    return 0;
+}
+
+// Parse one `field op value` term at *s
+static int compile_term(FilterPlan *plan, const char **s, FilterTerm *term) {
+    char name[32];
+    char value[MAX_FILTER_TEXT];
+    const char *p = *s;
+    size_t n = 0;
+    
+    while ((isalpha((unsigned char)*p) || *p == '_') && n < sizeof(name) - 1) {
+        name[n++] = (char)tolower((unsigned char)*p++);
+    }
+    name[n] = '\0';
+    const FieldDef *field = find_field(plan->target, name);
+    if (field == NULL) return compile_error(plan, "unknown field", (n > 0) ? name : p);
+    
+    p = skip_spaces(p);
+    term->op = read_operator(&p);
+    if (term->op < 0) return compile_error(plan, "expected operator after", name);
+    
+    // Value: quoted string or everything up to the next space
+    p = skip_spaces(p);
+    int quoted = (*p == '"');
+    n = 0;
+    if (quoted) {
+        p++;
+        while (*p != '\0' && *p != '"' && n < sizeof(value) - 1) value[n++] = *p++;
+        if (*p != '"') return compile_error(plan, "unterminated string after", name);
+        p++;
+    } else {
+        while (*p != '\0' && !isspace((unsigned char)*p) && n < sizeof(value) - 1) value[n++] = *p++;
+        if (n == 0) return compile_error(plan, "missing value after", name);
+    }
+    value[n] = '\0';
+    *s = p;
+    
+    term->field = field->field;
+    term->rhs_field = -1;
+    term->number = 0.0;
+    term->text[0] = '\0';
+    
+    const FieldDef *rhs = quoted ? NULL : find_field(plan->target, value);
+    if (rhs != NULL) {
+        if (rhs->kind != field->kind) return compile_error(plan, "cannot compare text and number in", name);
+        term->rhs_field = rhs->field;
+    } else if (field->kind == FIELD_NUMBER) {
+        char *end;
+        term->number = strtod(value, &end);
+        if (end == value || *end != '\0') return compile_error(plan, "not a number:", value);
+    } else {
+        strcpy(term->text, value);
+        to_lowercase(term->text);
+    }
+    
+    if (term->op == OP_CONTAINS && field->kind != FIELD_TEXT) {
+        return compile_error(plan, "~ needs a text field, not", name);
+    }
+    return 1;
+}
+
+// Choose the index for the first equality on ID, category or supplier
+static void choose_access(FilterPlan *plan) {
+    plan->access = FILTER_ACCESS_SCAN;
+    plan->access_term = -1;
+    if (plan->target != FILTER_PRODUCTS) return;
+    
+    for (int i = 0; i < plan->term_count; i++) {
+        const FilterTerm *t = &plan->terms[i];
+        if (t->op != OP_EQ || t->rhs_field >= 0) continue;
+        
+        if (t->field == P_ID) {
+            plan->access = FILTER_ACCESS_ID;
+            plan->access_term = i;
+            return;  // At most one row, always the best choice
+        }
+        if (plan->access_term < 0 && t->field == P_CATEGORY) {
+            plan->access = FILTER_ACCESS_CATEGORY;
+            plan->access_term = i;
+        } else if (plan->access_term < 0 && t->field == P_SUPPLIER) {
+            plan->access = FILTER_ACCESS_SUPPLIER;
+            plan->access_term = i;
+        }
+    }
+}
+
+int filter_compile(const char *expression, FilterTarget target, FilterPlan *plan) {
+    if (plan == NULL) return 0;
+    
+    memset(plan, 0, sizeof(FilterPlan));
+    plan->target = target;
+    if (expression == NULL) return compile_error(plan, "empty expression", "");
+    
+    const char *s = skip_spaces(expression);
+    if (*s == '\0') return compile_error(plan, "empty expression", "");
+    
+    while (1) {
+        if (plan->term_count >= MAX_FILTER_TERMS) return compile_error(plan, "too many terms at", s);
+        if (!compile_term(plan, &s, &plan->terms[plan->term_count])) return 0;
+        plan->term_count++;
+        
+        s = skip_spaces(s);
+        if (*s == '\0') break;
+        if (text_compare(s, "and", 3) != 0 || !isspace((unsigned char)s[3])) {
+            return compile_error(plan, "expected AND at", s);
+        }
+        s = skip_spaces(s + 3);
+    }
+    
+    choose_access(plan);
+    return 1;
+}
+
+void filter_index_free(FilterIndex *index) {
+    if (index == NULL) return;
+    
+    product_index_free(&index->ids);
+    free(index->by_category);
+    free(index->by_supplier);
+    index->by_category = NULL;
+    index->by_supplier = NULL;
+    index->count = 0;
+}
+
+typedef struct {
+    char key[MAX_CATEGORY_LEN];
+    int slot;
+} CategoryKey;
+
+typedef struct {
+    int key;
+    int slot;
+} SupplierKey;
+
+static int compare_category_keys(const void *a, const void *b) {
+    const CategoryKey *ka = (const CategoryKey *)a;
+    const CategoryKey *kb = (const CategoryKey *)b;
+    int cmp = strcmp(ka->key, kb->key);
+    return (cmp != 0) ? cmp : (ka->slot > kb->slot) - (ka->slot < kb->slot);
+}
+
+static int compare_supplier_keys(const void *a, const void *b) {
+    const SupplierKey *ka = (const SupplierKey *)a;
+    const SupplierKey *kb = (const SupplierKey *)b;
+    if (ka->key != kb->key) return (ka->key > kb->key) - (ka->key < kb->key);
+    return (ka->slot > kb->slot) - (ka->slot < kb->slot);
+}
+
+static void on_product_change(void *ctx, const Product *before, const Product *after) {
+    FilterIndex *index = ctx;
+    
+    // Quantity, price and name edits leave every key in its slot
+    if (before != NULL && after != NULL && before->id == after->id &&
+        before->supplier_id == after->supplier_id &&
+        strcmp(before->category, after->category) == 0) {
+        return;
+    }
+    index->stale = 1;
+}
+
+int filter_attach(FilterIndex *index, ProductList *products) {
+    if (index == NULL) return 0;
+    index->stale = 1;
+    index->attached = product_add_listener(products, on_product_change, index);
+    return index->attached;
+}
+
+// Rebuild the indexes if a key changed since they were built
+static int index_refresh(FilterIndex *index, const ProductList *products) {
+    int valid = index->attached ? !index->stale && index->count == products->count
+                                : index->generation == products->generation;
+    if (index->by_category != NULL && valid) return 1;
+    
+    filter_index_free(index);
+    size_t n = (size_t)products->count + 1;
+    CategoryKey *categories = malloc(sizeof(CategoryKey) * n);
+    SupplierKey *suppliers = malloc(sizeof(SupplierKey) * n);
+    index->by_category = malloc(sizeof(int) * n);
+    index->by_supplier = malloc(sizeof(int) * n);
+    if (categories == NULL || suppliers == NULL || index->by_category == NULL ||
+        index->by_supplier == NULL || !product_index_build(&index->ids, products)) {
+        free(categories);
+        free(suppliers);
+        filter_index_free(index);
+        return 0;
+    }
+    
+    for (int i = 0; i < products->count; i++) {
+        strcpy(categories[i].key, products->products[i].category);
+        to_lowercase(categories[i].key);
+        categories[i].slot = i;
+        suppliers[i].key = products->products[i].supplier_id;
+        suppliers[i].slot = i;
+    }
+    qsort(categories, (size_t)products->count, sizeof(CategoryKey), compare_category_keys);
+    qsort(suppliers, (size_t)products->count, sizeof(SupplierKey), compare_supplier_keys);
+    
+    for (int i = 0; i < products->count; i++) {
+        index->by_category[i] = categories[i].slot;
+        index->by_supplier[i] = suppliers[i].slot;
+    }
+    free(categories);
+    free(suppliers);
+    
+    index->count = products->count;
+    index->generation = products->generation;
+    index->stale = 0;
+    return 1;
+}
+
+typedef struct {
+    const FilterPlan *plan;
+    FilterProductFunc fn;
+    void *ctx;
+    int matches;
+    int stopped;
+} ProductRun;
+
+// Check the remaining terms on a candidate and stream it if it matches
+static void emit_product(ProductRun *run, const Product *product) {
+    if (run->stopped || !row_matches(run->plan, product)) return;
+    
+    run->matches++;
+    if (!run->fn(run->ctx, product)) {
+        run->stopped = 1;
+    }
+}
+
+static int run_products(const FilterPlan *plan, const ProductList *products,
+                        FilterIndex *index, FilterProductFunc fn, void *ctx) {
+    if (plan == NULL || products == NULL || fn == NULL || plan->target != FILTER_PRODUCTS) return 0;
+    
+    ProductRun run = {plan, fn, ctx, 0, 0};
+    FilterAccess access = plan->access;
+    if (access != FILTER_ACCESS_SCAN && (index == NULL || !index_refresh(index, products))) {
+        access = FILTER_ACCESS_SCAN;
+    }
+    const FilterTerm *key = (access != FILTER_ACCESS_SCAN) ? &plan->terms[plan->access_term] : NULL;
+    
+    if (access == FILTER_ACCESS_ID) {
+        if (key->number == (int)key->number) {
+            int slot = product_index_find(&index->ids, products, (int)key->number);
+            if (slot >= 0) emit_product(&run, &products->products[slot]);
+        }
+    } else if (access == FILTER_ACCESS_CATEGORY) {
+        // Lower bound of the category, then the run of equal keys
+        int lo = 0, hi = index->count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            const char *category = products->products[index->by_category[mid]].category;
+            if (text_compare(category, key->text, INT_MAX) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (int i = lo; i < index->count && !run.stopped; i++) {
+            const Product *p = &products->products[index->by_category[i]];
+            if (text_compare(p->category, key->text, INT_MAX) != 0) break;
+            emit_product(&run, p);
+        }
+    } else if (access == FILTER_ACCESS_SUPPLIER) {
+        int lo = 0, hi = index->count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (products->products[index->by_supplier[mid]].supplier_id < key->number) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (int i = lo; i < index->count && !run.stopped; i++) {
+            const Product *p = &products->products[index->by_supplier[i]];
+            if (p->supplier_id != key->number) break;
+            emit_product(&run, p);
+        }
+    } else {
+        for (int i = 0; i < products->count && !run.stopped; i++) {
+            emit_product(&run, &products->products[i]);
+        }
+    }
+    
+    return run.matches;
+}
+
+int filter_run_products(const FilterPlan *plan, const ProductList *products,
+                        FilterIndex *index, FilterProductFunc fn, void *ctx) {
+    MetricTimer timer = metrics_start();
+    int result = run_products(plan, products, index, fn, ctx);
+    metrics_stop(METRIC_SEARCH_FILTER_PRODUCTS, timer);
+    return result;
+}
+
+static int run_transactions(const FilterPlan *plan, const TransactionList *transactions,
+                            FilterTransactionFunc fn, void *ctx) {
+    if (plan == NULL || transactions == NULL || fn == NULL ||
+        plan->target != FILTER_TRANSACTIONS) {
+        return 0;
+    }
+    
+    int matches = 0;
+    for (int i = 0; i < transactions->count; i++) {
+        const Transaction *t = &transactions->transactions[i];
+        if (!row_matches(plan, t)) continue;
+        
+        matches++;
+        if (!fn(ctx, t)) break;
+    }
+    return matches;
+}
+
+int filter_run_transactions(const FilterPlan *plan, const TransactionList *transactions,
+                            FilterTransactionFunc fn, void *ctx) {
+    MetricTimer timer = metrics_start();
+    int result = run_transactions(plan, transactions, fn, ctx);
+    metrics_stop(METRIC_SEARCH_FILTER_TRANSACTIONS, timer);
+    return result;
+}
+
+const char* filter_access_name(const FilterPlan *plan) {
+    if (plan == NULL) return "";
+    
+    switch (plan->access) {
+        case FILTER_ACCESS_ID:       return "id index";
+        case FILTER_ACCESS_CATEGORY: return "category index";
+        case FILTER_ACCESS_SUPPLIER: return "supplier index";
+        default:                     return "full scan";
+    }
+}
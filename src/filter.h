@@ -0,0 +1,162 @@
+/**
+ * @file filter.h
+ * @brief Filter expressions for ad-hoc product and transaction queries
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * An expression is one or more terms joined by AND:
+ *
+ *   category=electronics AND qty<reorder AND price>10
+ *
+ * A term is `field op value` with op one of = != < <= > >= and ~
+ * (contains). The value is a number, a "quoted string", another field of
+ * the same kind, or a bare word. Text comparisons ignore case.
+ *
+ *   Products:     id name category description qty reorder price supplier value
+ *   Transactions: id product type qty date notes
+ *
+ * filter_compile() parses an expression once into a FilterPlan. Running a
+ * product plan uses the ID, category or supplier index for the first
+ * matching equality term and checks the remaining terms on those rows only;
+ * without one, every term is checked in a single fused pass. Matching rows
+ * are streamed to a callback as they are found.
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "product.h"
+#include "transaction.h"
+
+#define MAX_FILTER_TERMS 16
+#define MAX_FILTER_TEXT 100
+
+/**
+ * @brief Rows a plan runs over
+ */
+typedef enum {
+    FILTER_PRODUCTS,
+    FILTER_TRANSACTIONS
+} FilterTarget;
+
+/**
+ * @brief How a product plan finds candidate rows
+ */
+typedef enum {
+    FILTER_ACCESS_SCAN,         ///< Fused scan over all rows
+    FILTER_ACCESS_ID,           ///< ID hash index
+    FILTER_ACCESS_CATEGORY,     ///< Category index
+    FILTER_ACCESS_SUPPLIER      ///< Supplier index
+} FilterAccess;
+
+/**
+ * @brief One compiled comparison
+ */
+typedef struct {
+    int field;                      ///< Field on the left
+    int op;                         ///< Comparison operator
+    int rhs_field;                  ///< Field on the right (-1 for a constant)
+    double number;                  ///< Numeric constant
+    char text[MAX_FILTER_TEXT];     ///< Text constant (lowercase)
+} FilterTerm;
+
+/**
+ * @brief Compiled filter expression
+ */
+typedef struct {
+    FilterTarget target;
+    FilterTerm terms[MAX_FILTER_TERMS];
+    int term_count;
+    FilterAccess access;            ///< Access path for product plans
+    int access_term;                ///< Term answered by the index (-1 for a scan)
+    char error[128];                ///< Reason filter_compile failed
+} FilterPlan;
+
+/**
+ * @brief Secondary indexes over a product list
+ *
+ * Zero-initialize before first use. After filter_attach, rebuilt by
+ * filter_run_products only once a product is added or deleted or its ID,
+ * category or supplier changes; stock movements keep it valid. Without
+ * filter_attach it is rebuilt whenever the list generation has changed.
+ */
+typedef struct {
+    ProductIdIndex ids;             ///< ID to slot
+    int *by_category;               ///< Slots ordered by lowercase category
+    int *by_supplier;               ///< Slots ordered by supplier ID
+    int count;                      ///< Slots indexed
+    unsigned long generation;       ///< List generation the indexes match
+    int attached;                   ///< Whether a listener keeps stale current
+    int stale;                      ///< Set when an indexed key changed since the build
+} FilterIndex;
+
+/**
+ * @brief Callback for each matching product
+ * @param ctx Caller context
+ * @param product Matching product
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (*FilterProductFunc)(void *ctx, const Product *product);
+
+/**
+ * @brief Callback for each matching transaction
+ * @param ctx Caller context
+ * @param transaction Matching transaction
+ * @return 1 to continue, 0 to stop
+ */
+typedef int (*FilterTransactionFunc)(void *ctx, const Transaction *transaction);
+
+/**
+ * @brief Parse an expression into a plan
+ * @param expression Expression text
+ * @param target Rows the expression applies to
+ * @param plan Output plan (plan->error is set on failure)
+ * @return 1 on success, 0 on a syntax or type error
+ */
+int filter_compile(const char *expression, FilterTarget target, FilterPlan *plan);
+
+/**
+ * @brief Stream the products matching a plan
+ * @param plan Compiled product plan
+ * @param products Products to search
+ * @param index Indexes to use and refresh (NULL to always scan)
+ * @param fn Callback for each match
+ * @param ctx Callback context
+ * @return Number of matches streamed
+ */
+int filter_run_products(const FilterPlan *plan, const ProductList *products,
+                        FilterIndex *index, FilterProductFunc fn, void *ctx);
+
+/**
+ * @brief Stream the transactions matching a plan, oldest first
+ * @param plan Compiled transaction plan
+ * @param transactions Log to search
+ * @param fn Callback for each match
+ * @param ctx Callback context
+ * @return Number of matches streamed
+ */
+int filter_run_transactions(const FilterPlan *plan, const TransactionList *transactions,
+                            FilterTransactionFunc fn, void *ctx);
+
+/**
+ * @brief Describe a plan's access path (e.g. "category index")
+ * @param plan Compiled plan
+ * @return Static description
+ */
+const char* filter_access_name(const FilterPlan *plan);
+
+/**
+ * @brief Mark the index stale whenever a product's indexed keys change
+ * @param index Index
+ * @param products List to listen to
+ * @return 1 on success, 0 if no listener slot is free
+ */
+int filter_attach(FilterIndex *index, ProductList *products);
+
+/**
+ * @brief Release index memory
+ * @param index Index to free
+ */
+void filter_index_free(FilterIndex *index);
+
+#endif /* FILTER_H */
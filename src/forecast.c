@@ -0,0 +1,246 @@
+/**
+ * @file forecast.c
+ * @brief Implementation of incremental demand forecasting
+ */
+
+#include "forecast.h"
+#include "metrics.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int hash_id(int id) {
+    return (unsigned int)id * 2654435761u;
+}
+
+static DemandState* find_state(const ForecastStore *store, int product_id) {
+    if (store->capacity == 0) return NULL;
+    
+    unsigned int mask = (unsigned int)store->capacity - 1;
+    unsigned int h = hash_id(product_id) & mask;
+    while (store->slots[h].product_id != 0) {
+        if (store->slots[h].product_id == product_id) {
+            return &store->slots[h];
+        }
+        h = (h + 1) & mask;
+    }
+    return NULL;
+}
+
+static int grow(ForecastStore *store) {
+    int capacity = (store->capacity > 0) ? store->capacity * 2 : 256;
+    DemandState *slots = calloc((size_t)capacity, sizeof(DemandState));
+    if (slots == NULL) return 0;
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < store->capacity; i++) {
+        if (store->slots[i].product_id == 0) continue;
+        unsigned int h = hash_id(store->slots[i].product_id) & mask;
+        while (slots[h].product_id != 0) {
+            h = (h + 1) & mask;
+        }
+        slots[h] = store->slots[i];
+    }
+    
+    free(store->slots);
+    store->slots = slots;
+    store->capacity = capacity;
+    return 1;
+}
+
+int forecast_put(ForecastStore *store, const DemandState *state) {
+    if (store == NULL || state == NULL || state->product_id <= 0) return 0;
+    
+    DemandState *existing = find_state(store, state->product_id);
+    if (existing != NULL) {
+        *existing = *state;
+        return 1;
+    }
+    
+    // Keep load factor at or below 0.5
+    if ((store->count + 1) * 2 > store->capacity && !grow(store)) {
+        return 0;
+    }
+    
+    unsigned int mask = (unsigned int)store->capacity - 1;
+    unsigned int h = hash_id(state->product_id) & mask;
+    while (store->slots[h].product_id != 0) {
+        h = (h + 1) & mask;
+    }
+    store->slots[h] = *state;
+    store->count++;
+    return 1;
+}
+
+// Fold one completed day of demand into the averages
+static void fold_day(DemandState *s, double units) {
+    if (s->days == 0) {
+        s->mean = units;
+        s->variance = 0.0;
+    } else {
+        double diff = units - s->mean;
+        double incr = FORECAST_ALPHA * diff;
+        s->mean += incr;
+        s->variance = (1.0 - FORECAST_ALPHA) * (s->variance + diff * incr);
+    }
+    s->days++;
+}
+
+// Fold k days without demand at once. With b = 1 - alpha, each zero day
+// maps (m, v) to (b m, b (v + alpha m^2)); summing the geometric series
+// gives m b^k and b^k (v + m^2 (1 - b^k)) after k days
+static void fold_idle_days(DemandState *s, int k) {
+    if (k <= 0 || s->days == 0) return;
+    
+    double decay = pow(1.0 - FORECAST_ALPHA, (double)k);
+    s->variance = decay * (s->variance + s->mean * s->mean * (1.0 - decay));
+    s->mean *= decay;
+    s->days += k;
+}
+
+// Close out last_day and any idle days before day
+static void advance_to(DemandState *s, int day) {
+    if (day <= s->last_day) return;
+    
+    fold_day(s, (double)s->day_units);
+    int gap = day - s->last_day - 1;
+    if (gap > FORECAST_MAX_GAP_DAYS) gap = FORECAST_MAX_GAP_DAYS;
+    fold_idle_days(s, gap);
+    
+    s->day_units = 0;
+    s->last_day = day;
+}
+
+void forecast_observe(ForecastStore *store, const Transaction *transaction) {
+    if (store == NULL || transaction == NULL) return;
+    
+    store->covered_rows++;
+    store->covered_last_id = transaction->transaction_id;
+    
+    int day;
+    if (strcmp(transaction->type, TRANSACTION_TYPE_OUT) != 0 ||
+        !date_to_days(transaction->date_time, &day)) {
+        return;
+    }
+    
+    DemandState *s = find_state(store, transaction->product_id);
+    if (s == NULL) {
+        DemandState fresh = {0};
+        fresh.product_id = transaction->product_id;
+        fresh.last_day = day;
+        fresh.day_units = transaction->quantity;
+        forecast_put(store, &fresh);
+        return;
+    }
+    
+    // Back-dated rows count towards the current day
+    advance_to(s, day);
+    s->day_units += transaction->quantity;
+}
+
+void forecast_free(ForecastStore *store) {
+    if (store == NULL) return;
+    
+    free(store->slots);
+    store->slots = NULL;
+    store->capacity = 0;
+    store->count = 0;
+    store->covered_rows = 0;
+    store->covered_last_id = 0;
+}
+
+int forecast_catch_up(ForecastStore *store, const TransactionList *transactions) {
+    if (store == NULL || transactions == NULL) return 0;
+    
+    // The saved state must describe a prefix of this log
+    int start = store->covered_rows;
+    if (start > transactions->count ||
+        (start > 0 && transactions->transactions[start - 1].transaction_id != store->covered_last_id)) {
+        forecast_free(store);
+        start = 0;
+    }
+    
+    for (int i = start; i < transactions->count; i++) {
+        forecast_observe(store, &transactions->transactions[i]);
+    }
+    return transactions->count - start;
+}
+
+static void forecast_listener(void *ctx, const Transaction *transaction) {
+    forecast_observe((ForecastStore *)ctx, transaction);
+}
+
+int forecast_attach(ForecastStore *store, TransactionList *transactions) {
+    if (store == NULL) return 0;
+    return transaction_add_listener(transactions, forecast_listener, store);
+}
+
+int forecast_get(const ForecastStore *store, int product_id, int today,
+                 DemandForecast *forecast) {
+    if (store == NULL || forecast == NULL) return 0;
+    
+    const DemandState *stored = find_state(store, product_id);
+    if (stored == NULL) return 0;
+    
+    // Age a copy to today without touching the stored state
+    DemandState s = *stored;
+    advance_to(&s, today);
+    if (s.days == 0) {
+        s.mean = (double)s.day_units;  // Only a partial first day so far
+    }
+    
+    double lead_time = FORECAST_LEAD_TIME_DAYS;
+    forecast->daily_demand = s.mean;
+    forecast->daily_stddev = sqrt(s.variance > 0.0 ? s.variance : 0.0);
+    forecast->safety_stock = FORECAST_SERVICE_Z * forecast->daily_stddev * sqrt(lead_time);
+    forecast->reorder_point = (int)ceil(s.mean * lead_time + forecast->safety_stock);
+    return 1;
+}
+
+static int compare_by_supplier(const void *a, const void *b) {
+    const ReorderSuggestion *sa = (const ReorderSuggestion *)a;
+    const ReorderSuggestion *sb = (const ReorderSuggestion *)b;
+    
+    if (sa->supplier_id != sb->supplier_id) {
+        return (sa->supplier_id > sb->supplier_id) - (sa->supplier_id < sb->supplier_id);
+    }
+    return (sa->product_id > sb->product_id) - (sa->product_id < sb->product_id);
+}
+
+static int reorder_suggestions(const ForecastStore *store, const ProductList *products,
+                               int today, ReorderSuggestion *results) {
+    if (store == NULL || products == NULL || results == NULL) return 0;
+    
+    int count = 0;
+    for (int i = 0; i < products->count; i++) {
+        const Product *p = &products->products[i];
+        DemandForecast f;
+        
+        if (!forecast_get(store, p->id, today, &f) || f.daily_demand <= 0.0) continue;
+        if (p->quantity_in_stock > f.reorder_point) continue;
+        
+        ReorderSuggestion *r = &results[count++];
+        r->product_id = p->id;
+        strncpy(r->name, p->name, MAX_NAME_LEN - 1);
+        r->name[MAX_NAME_LEN - 1] = '\0';
+        r->supplier_id = p->supplier_id;
+        r->quantity_in_stock = p->quantity_in_stock;
+        r->reorder_level = p->reorder_level;
+        r->forecast = f;
+        
+        // Refill to the reorder point plus one more lead time of demand
+        int cover = (int)ceil(f.daily_demand * FORECAST_LEAD_TIME_DAYS);
+        r->order_quantity = f.reorder_point + cover - p->quantity_in_stock;
+    }
+    
+    qsort(results, count, sizeof(ReorderSuggestion), compare_by_supplier);
+    return count;
+}
+
+int forecast_reorder_suggestions(const ForecastStore *store, const ProductList *products,
+                                 int today, ReorderSuggestion *results) {
+    MetricTimer timer = metrics_start();
+    int result = reorder_suggestions(store, products, today, results);
+    metrics_stop(METRIC_REPORT_REORDER, timer);
+    return result;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file forecast.h
+ * @brief Incremental per-product demand forecasting and reorder suggestions
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Each product keeps an exponentially weighted mean and variance of its
+ * daily OUT units. Every OUT transaction updates the state in O(1): when
+ * a new day starts, the finished day is folded into the averages and any
+ * idle days in between (up to FORECAST_MAX_GAP_DAYS) are folded in one
+ * closed-form step, as are the idle days up to today when a forecast is
+ * read. No history is rescanned; the state is saved next to the products
+ * and only rows added since the last save are replayed at load.
+ *
+ * Suggested reorder points assume a lead time of
+ * FORECAST_LEAD_TIME_DAYS and a service level given by FORECAST_SERVICE_Z:
+ *
+ *   safety stock  = z * stddev * sqrt(lead time)
+ *   reorder point = mean * lead time + safety stock
+ */
+
+#ifndef FORECAST_H
+#define FORECAST_H
+
+#include "product.h"
+#include "transaction.h"
+
+#define FORECAST_ALPHA 0.1              // Weight of the newest day
+#define FORECAST_LEAD_TIME_DAYS 7       // Assumed supplier lead time
+#define FORECAST_SERVICE_Z 1.65         // ~95% cycle service level
+#define FORECAST_MAX_GAP_DAYS 365       // Idle days folded in at most
+
+/**
+ * @brief Demand state of one product
+ */
+typedef struct {
+    int product_id;     ///< Product ID (0 = empty slot)
+    int last_day;       ///< Day of the most recent OUT movement
+    long day_units;     ///< Units issued on last_day so far
+    double mean;        ///< EW mean of daily demand (completed days)
+    double variance;    ///< EW variance of daily demand
+    int days;           ///< Completed days folded in
+} DemandState;
+
+/**
+ * @brief Demand states for all products, keyed by product ID
+ */
+typedef struct {
+    DemandState *slots;         ///< Open-addressing table
+    int capacity;               ///< Power of two (0 = not allocated)
+    int count;                  ///< States in use
+    int covered_rows;           ///< Log rows folded in
+    int covered_last_id;        ///< ID of the last folded row (0 if none)
+} ForecastStore;
+
+/**
+ * @brief Forecast derived from a demand state
+ */
+typedef struct {
+    double daily_demand;        ///< Expected units per day
+    double daily_stddev;        ///< Standard deviation of daily units
+    double safety_stock;        ///< Units held against demand spikes
+    int reorder_point;          ///< Reorder when stock falls to this level
+} DemandForecast;
+
+/**
+ * @brief Reorder suggestion for one product
+ */
+typedef struct {
+    int product_id;             ///< Product ID
+    char name[MAX_NAME_LEN];    ///< Product name
+    int supplier_id;            ///< Supplier to order from
+    int quantity_in_stock;      ///< Current stock
+    int reorder_level;          ///< Manually set reorder level
+    DemandForecast forecast;    ///< Forecast behind the suggestion
+    int order_quantity;         ///< Units to order (covers one more lead time)
+} ReorderSuggestion;
+
+/**
+ * @brief Release all states
+ * @param store Store to free (zero-initialized stores need no init)
+ */
+void forecast_free(ForecastStore *store);
+
+/**
+ * @brief Fold one transaction into its product's state (OUT rows only)
+ * @param store Pointer to ForecastStore
+ * @param transaction Transaction appended to the log
+ */
+void forecast_observe(ForecastStore *store, const Transaction *transaction);
+
+/**
+ * @brief Fold in log rows added since the state was saved
+ *
+ * If the log no longer matches the saved state (e.g. after a restore),
+ * the state is rebuilt from the whole log instead.
+ *
+ * @param store Pointer to ForecastStore
+ * @param transactions The log
+ * @return Number of rows folded in
+ */
+int forecast_catch_up(ForecastStore *store, const TransactionList *transactions);
+
+/**
+ * @brief Keep the store current with every later transaction_add
+ * @param store Pointer to ForecastStore
+ * @param transactions The log
+ * @return 1 on success, 0 if the list has no free listener slot
+ */
+int forecast_attach(ForecastStore *store, TransactionList *transactions);
+
+/**
+ * @brief Insert a saved state (used by storage)
+ * @param store Pointer to ForecastStore
+ * @param state State to insert or replace
+ * @return 1 on success, 0 on allocation failure
+ */
+int forecast_put(ForecastStore *store, const DemandState *state);
+
+/**
+ * @brief Compute a product's forecast as of a day
+ * @param store Pointer to ForecastStore
+ * @param product_id Product ID
+ * @param today Day to forecast from (idle days since the last OUT count as zero demand)
+ * @param forecast Output forecast
+ * @return 1 if the product has demand history, 0 otherwise
+ */
+int forecast_get(const ForecastStore *store, int product_id, int today,
+                 DemandForecast *forecast);
+
+/**
+ * @brief List products at or below their suggested reorder point
+ *
+ * Sorted by supplier, then by product ID.
+ *
+ * @param store Pointer to ForecastStore
+ * @param products Pointer to ProductList
+ * @param today Day to forecast from
+ * @param results Output array (room for products->count entries)
+ * @return Number of suggestions
+ */
+int forecast_reorder_suggestions(const ForecastStore *store, const ProductList *products,
+                                 int today, ReorderSuggestion *results);
+
+#endif /* FORECAST_H */
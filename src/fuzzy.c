@@ -0,0 +1,234 @@
+/**
+ * @file fuzzy.c
+ * @brief Implementation of fuzzy product name search
+ */
+
+#include "fuzzy.h"
+#include "metrics.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Signature bit of a character pair
+static int bigram_bit(unsigned char a, unsigned char b) {
+    return (int)((((unsigned int)a << 8 | b) * 2654435761u) >> 26);
+}
+
+static int popcount64(unsigned long long x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static int rebuild(FuzzyIndex *index, const ProductList *products) {
+    fuzzy_index_free(index);
+    
+    int count = products->count;
+    size_t total = 1;
+    for (int i = 0; i < count; i++) total += strlen(products->products[i].name);
+    
+    size_t slots = (size_t)(count > 0 ? count : 1);
+    index->signatures = malloc(sizeof(unsigned long long) * slots);
+    index->offsets = malloc(sizeof(int) * slots);
+    index->lengths = malloc(slots);
+    index->names = malloc(total);
+    if (index->signatures == NULL || index->offsets == NULL || index->lengths == NULL ||
+        index->names == NULL) {
+        fuzzy_index_free(index);
+        return 0;
+    }
+    
+    // Folded names packed end to end, so scoring reads them sequentially
+    int offset = 0;
+    for (int i = 0; i < count; i++) {
+        const char *name = products->products[i].name;
+        unsigned long long signature = 0;
+        int length = 0;
+        for (; name[length] != '\0'; length++) {
+            char c = (char)tolower((unsigned char)name[length]);
+            index->names[offset + length] = c;
+            if (length > 0) {
+                signature |= 1ULL << bigram_bit((unsigned char)index->names[offset + length - 1],
+                                                (unsigned char)c);
+            }
+        }
+        index->signatures[i] = signature;
+        index->offsets[i] = offset;
+        index->lengths[i] = (unsigned char)length;
+        offset += length;
+    }
+    index->count = count;
+    index->stale = 0;
+    return 1;
+}
+
+static void on_product_change(void *ctx, const Product *before, const Product *after) {
+    FuzzyIndex *index = ctx;
+    
+    // Quantity and price edits keep every name in its slot
+    if (before != NULL && after != NULL && strcmp(before->name, after->name) == 0) return;
+    index->stale = 1;
+}
+
+int fuzzy_attach(FuzzyIndex *index, ProductList *products) {
+    if (index == NULL) return 0;
+    index->stale = 1;
+    return product_add_listener(products, on_product_change, index);
+}
+
+void fuzzy_index_free(FuzzyIndex *index) {
+    if (index == NULL) return;
+    free(index->signatures);
+    free(index->offsets);
+    free(index->lengths);
+    free(index->names);
+    index->signatures = NULL;
+    index->offsets = NULL;
+    index->lengths = NULL;
+    index->names = NULL;
+    index->count = 0;
+    index->stale = 1;
+}
+
+int fuzzy_default_distance(int length) {
+    return (length > 0) ? length / 8 + 1 : 0;
+}
+
+/**
+ * @brief Fewest edits turning the query into some substring of a name
+ *
+ * Myers (1999): the vertical deltas of one column of the edit table are
+ * held as bit vectors (pv = +1, mv = -1) and the next column is computed
+ * with word operations; score tracks the last row, i.e. the distance of a
+ * match ending at the current character.
+ *
+ * @param peq Per byte, the query positions holding it
+ * @param m Query length (1..64)
+ * @param name Folded name to scan
+ * @param length Name length
+ * @param limit Stop once the result is known to exceed this
+ * @return Distance (values above limit are not exact)
+ */
+static int myers_distance(const unsigned long long *peq, int m, const char *name, int length,
+                          int limit) {
+    unsigned long long pv = ~0ULL, mv = 0, last = 1ULL << (m - 1);
+    int score = m, best = m;
+    
+    for (int j = 0; j < length; j++) {
+        unsigned long long eq = peq[(unsigned char)name[j]];
+        unsigned long long xv = eq | mv;
+        unsigned long long xh = (((eq & pv) + pv) ^ pv) | eq;
+        unsigned long long ph = mv | ~(xh | pv);
+        unsigned long long mh = pv & xh;
+        
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        // Shifting in zeros lets a match start anywhere in the name
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        
+        if (score < best) best = score;
+        // The score drops by at most one per remaining character
+        int floor = score - (length - j - 1);
+        if (floor >= best || floor > limit) break;
+    }
+    return best;
+}
+
+// Whether match a ranks before match b
+static int ranks_before(const FuzzyIndex *index, const FuzzyMatch *a, const FuzzyMatch *b) {
+    if (a->distance != b->distance) return a->distance < b->distance;
+    if (index->lengths[a->slot] != index->lengths[b->slot]) {
+        return index->lengths[a->slot] < index->lengths[b->slot];
+    }
+    return a->slot < b->slot;
+}
+
+static int search(FuzzyIndex *index, const ProductList *products, const char *query,
+                  int max_distance, FuzzyMatch *matches, int max_results, FuzzyStats *stats) {
+    if (stats != NULL) {
+        stats->names = (products != NULL) ? products->count : 0;
+        stats->compared = 0;
+    }
+    if (index == NULL || products == NULL || query == NULL || matches == NULL || max_results <= 0) {
+        return 0;
+    }
+    if ((index->stale || index->count != products->count) && !rebuild(index, products)) return -1;
+    
+    // Query bit masks and bigram signature, case-folded. A bigram bit hit by
+    // several query positions is listed once per extra position, so that
+    // shared positions = popcount(shared bits) + repeats present
+    unsigned long long peq[256] = {0};
+    unsigned long long query_signature = 0;
+    int repeats[FUZZY_MAX_QUERY];
+    int repeat_count = 0;
+    unsigned char previous = 0;
+    int m = 0;
+    for (; query[m] != '\0' && m < FUZZY_MAX_QUERY; m++) {
+        unsigned char c = (unsigned char)tolower((unsigned char)query[m]);
+        peq[c] |= 1ULL << m;
+        if (m > 0) {
+            int bit = bigram_bit(previous, c);
+            if (query_signature & (1ULL << bit)) repeats[repeat_count++] = bit;
+            query_signature |= 1ULL << bit;
+        }
+        previous = c;
+    }
+    if (m == 0) return 0;
+    
+    int limit = (max_distance >= 0) ? max_distance : fuzzy_default_distance(m);
+    if (limit >= m) limit = m - 1;  // Otherwise every name would match
+    int count = 0;
+    
+    for (int slot = 0; slot < products->count; slot++) {
+        // Once k matches are kept, a name no shorter than the worst of them
+        // must also be closer to rank
+        int slot_limit = limit;
+        if (count == max_results && index->lengths[slot] >= index->lengths[matches[count - 1].slot]) {
+            slot_limit--;
+        }
+        if (slot_limit < 0 || index->lengths[slot] < m - slot_limit) continue;
+        
+        int needed = (m - 1) - 2 * slot_limit;
+        if (needed > 0) {
+            unsigned long long signature = index->signatures[slot];
+            int present = popcount64(signature & query_signature);
+            for (int i = 0; i < repeat_count; i++) {
+                present += (int)((signature >> repeats[i]) & 1);
+            }
+            if (present < needed) continue;
+        }
+        
+        if (stats != NULL) stats->compared++;
+        FuzzyMatch match = {slot, myers_distance(peq, m, index->names + index->offsets[slot],
+                                                 index->lengths[slot], slot_limit)};
+        if (match.distance > slot_limit) continue;
+        if (count == max_results && !ranks_before(index, &match, &matches[count - 1])) continue;
+        
+        // Insert in rank order, dropping the last match when full
+        int position = (count < max_results) ? count++ : count - 1;
+        while (position > 0 && ranks_before(index, &match, &matches[position - 1])) {
+            matches[position] = matches[position - 1];
+            position--;
+        }
+        matches[position] = match;
+        
+        // Only names at least as close as the worst kept match can still rank
+        if (count == max_results) limit = matches[count - 1].distance;
+    }
+    return count;
+}
+
+int fuzzy_search(FuzzyIndex *index, const ProductList *products, const char *query,
+                 int max_distance, FuzzyMatch *matches, int max_results, FuzzyStats *stats) {
+    MetricTimer timer = metrics_start();
+    int result = search(index, products, query, max_distance, matches, max_results, stats);
+    metrics_stop(METRIC_SEARCH_FUZZY, timer);
+    return result;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file fuzzy.h
+ * @brief Typo-tolerant product name search ranked by edit distance
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A query matches a name when some part of the name can be turned into the
+ * query with few single-character edits (insert, delete, substitute), so
+ * "speeker" finds "Bluetooth Speaker" at distance 1. Case is ignored.
+ *
+ * Distances come from Myers' bit-parallel algorithm, which advances a
+ * whole column of the edit-distance table per name character in a few
+ * word operations; queries are limited to FUZZY_MAX_QUERY characters so a
+ * column fits one 64-bit word. Before that, each name must pass two cheap
+ * filters:
+ *   - length: a name shorter than the query minus the allowed edits
+ *     cannot match
+ *   - bigrams: one edit destroys at most two of the query's character
+ *     pairs, so a match within k edits leaves at least (m - 1) - 2k of
+ *     them in the name. Names carry a 64-bit bigram signature to test this
+ * The edit limit tightens to the worst kept match once k results are held,
+ * so later names are filtered harder.
+ */
+
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include "product.h"
+
+#define FUZZY_MAX_QUERY 64          // Query characters compared (one machine word)
+#define FUZZY_DEFAULT_RESULTS 10    // Matches shown by searches
+
+/**
+ * @brief One ranked match
+ */
+typedef struct {
+    int slot;                   ///< Slot in the product list
+    int distance;               ///< Edits between the query and the best part of the name
+} FuzzyMatch;
+
+/**
+ * @brief Search statistics
+ */
+typedef struct {
+    int names;                  ///< Names in the list
+    int compared;               ///< Names that passed the filters and were scored
+} FuzzyStats;
+
+/**
+ * @brief Per-slot name signatures and folded copies of the names
+ *
+ * Zero-initialize, then fuzzy_attach. Rebuilt on the next search after a
+ * product is added, renamed or deleted; stock movements keep it valid.
+ * Free with fuzzy_index_free.
+ */
+typedef struct {
+    unsigned long long *signatures; ///< Bigram signature per slot
+    int *offsets;               ///< Start of each slot's name in names
+    unsigned char *lengths;     ///< Name length per slot
+    char *names;                ///< Case-folded names, packed without terminators
+    int count;                  ///< Slots covered
+    int stale;                  ///< Set when the names changed since the build
+} FuzzyIndex;
+
+/**
+ * @brief Mark the index stale whenever products are added, updated or deleted
+ * @param index Index
+ * @param products List to listen to
+ * @return 1 on success, 0 if no listener slot is free
+ */
+int fuzzy_attach(FuzzyIndex *index, ProductList *products);
+
+/**
+ * @brief Release the index
+ * @param index Index to free
+ */
+void fuzzy_index_free(FuzzyIndex *index);
+
+/**
+ * @brief Default edit limit for a query length
+ * @param length Query length
+ * @return Edits allowed: 1 below 8 characters, one more per 8 after that
+ */
+int fuzzy_default_distance(int length);
+
+/**
+ * @brief Find the names closest to a query
+ *
+ * Results are ordered by distance, then by name length (a closer fit of
+ * the whole name), then by list order.
+ *
+ * @param index Signature index (rebuilt here if stale)
+ * @param products Products
+ * @param query Text to look for (first FUZZY_MAX_QUERY characters)
+ * @param max_distance Most edits allowed (negative for fuzzy_default_distance)
+ * @param matches Output matches
+ * @param max_results Most matches to return (k)
+ * @param stats Output statistics (may be NULL)
+ * @return Number of matches, or -1 if the index could not be built
+ */
+int fuzzy_search(FuzzyIndex *index, const ProductList *products, const char *query,
+                 int max_distance, FuzzyMatch *matches, int max_results, FuzzyStats *stats);
+
+#endif /* FUZZY_H */
@@ -0,0 +1,312 @@
+/**
+ * @file history.c
+ * @brief Implementation of stock-as-of-date queries
+ */
+
+#include "history.h"
+#include "metrics.h"
+#include "utils.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HISTORY_NO_DAY INT_MIN
+
+static int signed_quantity(const Transaction *t) {
+    return (strcmp(t->type, TRANSACTION_TYPE_IN) == 0) ? t->quantity : -t->quantity;
+}
+
+static int compare_ids(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Position of a product in the tracked arrays (-1 if not tracked)
+static int find_tracked(const StockHistory *history, int product_id) {
+    int lo = 0, hi = history->product_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (history->product_ids[mid] == product_id) return mid;
+        if (history->product_ids[mid] < product_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// Day a row counts on, never earlier than the row before it
+static int row_day(const Transaction *t, int previous) {
+    int day;
+    if (!date_to_days(t->date_time, &day) || day < previous) return previous;
+    return day;
+}
+
+static void free_checkpoints(StockHistory *history, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        free(history->checkpoints[i].quantities);
+        history->checkpoints[i].quantities = NULL;
+    }
+}
+
+// Drop every other checkpoint (keeping the newest) and double the spacing
+static void thin_checkpoints(StockHistory *history) {
+    int kept = 0;
+    for (int i = 0; i < history->checkpoint_count; i++) {
+        if ((history->checkpoint_count - 1 - i) % 2 == 0) {
+            history->checkpoints[kept++] = history->checkpoints[i];
+        } else {
+            free_checkpoints(history, i, 1);
+        }
+    }
+    history->checkpoint_count = kept;
+    history->interval *= 2;
+}
+
+static void add_checkpoint(StockHistory *history, int day, int row) {
+    if (history->checkpoint_count >= HISTORY_MAX_CHECKPOINTS) {
+        thin_checkpoints(history);
+    }
+    
+    int *quantities = malloc(sizeof(int) * (size_t)(history->product_count + 1));
+    if (quantities == NULL) return;  // Queries fall back to an older checkpoint
+    memcpy(quantities, history->working, sizeof(int) * (size_t)history->product_count);
+    
+    StockCheckpoint *cp = &history->checkpoints[history->checkpoint_count++];
+    cp->day = day;
+    cp->row = row;
+    cp->quantities = quantities;
+}
+
+void history_observe(StockHistory *history, const Transaction *transaction) {
+    if (history == NULL || transaction == NULL || history->working == NULL) return;
+    
+    int day = row_day(transaction, history->last_day);
+    
+    // A new day closes the previous one
+    if (history->rows > 0 && history->last_day != HISTORY_NO_DAY && day > history->last_day) {
+        const StockCheckpoint *last = (history->checkpoint_count > 0) ?
+            &history->checkpoints[history->checkpoint_count - 1] : NULL;
+        if (last == NULL || history->last_day - last->day >= history->interval) {
+            add_checkpoint(history, history->last_day, history->rows);
+        }
+    }
+    
+    int slot = find_tracked(history, transaction->product_id);
+    if (slot >= 0) {
+        history->working[slot] += signed_quantity(transaction);
+    }
+    history->rows++;
+    history->last_day = day;
+}
+
+void history_free(StockHistory *history) {
+    if (history == NULL) return;
+    
+    if (history->checkpoints != NULL) {
+        free_checkpoints(history, 0, history->checkpoint_count);
+    }
+    free(history->checkpoints);
+    free(history->product_ids);
+    free(history->working);
+    history->checkpoints = NULL;
+    history->product_ids = NULL;
+    history->working = NULL;
+    history->checkpoint_count = 0;
+    history->product_count = 0;
+    history->rows = 0;
+}
+
+int history_build(StockHistory *history, const ProductList *products,
+                  const TransactionList *transactions) {
+    if (history == NULL || products == NULL || transactions == NULL) return 0;
+    
+    history_free(history);
+    history->products = products;
+    history->transactions = transactions;
+    history->product_ids = malloc(sizeof(int) * (size_t)(products->count + 1));
+    history->working = malloc(sizeof(int) * (size_t)(products->count + 1));
+    history->checkpoints = calloc(HISTORY_MAX_CHECKPOINTS, sizeof(StockCheckpoint));
+    if (history->product_ids == NULL || history->working == NULL || history->checkpoints == NULL) {
+        history_free(history);
+        return 0;
+    }
+    
+    for (int i = 0; i < products->count; i++) {
+        history->product_ids[i] = products->products[i].id;
+    }
+    history->product_count = products->count;
+    qsort(history->product_ids, (size_t)history->product_count, sizeof(int), compare_ids);
+    
+    // Stock before the first row: current stock minus every logged movement
+    for (int i = 0; i < products->count; i++) {
+        int slot = find_tracked(history, products->products[i].id);
+        history->working[slot] = products->products[i].quantity_in_stock;
+    }
+    for (int i = 0; i < transactions->count; i++) {
+        int slot = find_tracked(history, transactions->transactions[i].product_id);
+        if (slot >= 0) {
+            history->working[slot] -= signed_quantity(&transactions->transactions[i]);
+        }
+    }
+    
+    history->interval = 1;
+    history->last_day = HISTORY_NO_DAY;
+    for (int i = 0; i < transactions->count; i++) {
+        history_observe(history, &transactions->transactions[i]);
+    }
+    return 1;
+}
+
+static void history_listener(void *ctx, const Transaction *transaction) {
+    history_observe((StockHistory *)ctx, transaction);
+}
+
+int history_attach(StockHistory *history, TransactionList *transactions) {
+    if (history == NULL) return 0;
+    return transaction_add_listener(transactions, history_listener, history);
+}
+
+// Index of the newest checkpoint at or before day (-1 if none)
+static int checkpoint_before(const StockHistory *history, int day) {
+    int lo = 0, hi = history->checkpoint_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (history->checkpoints[mid].day <= day) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo - 1;
+}
+
+// Add sign * movement to the tracked quantities (only >= 0: just that slot, in out[0])
+static void apply_row(const StockHistory *history, const Transaction *t, int only,
+                      int sign, int *out) {
+    if (only >= 0) {
+        if (t->product_id == history->product_ids[only]) {
+            out[0] += sign * signed_quantity(t);
+        }
+        return;
+    }
+    
+    int slot = find_tracked(history, t->product_id);
+    if (slot >= 0) {
+        out[slot] += sign * signed_quantity(t);
+    }
+}
+
+// Stock at the end of day for one tracked slot (only >= 0) or all of them (only < 0)
+static void replay(const StockHistory *history, int day, int only, int *out) {
+    const Transaction *rows = history->transactions->transactions;
+    int k = checkpoint_before(history, day);
+    
+    // Start from the nearest checkpoint, or the newest state when there is none
+    const int *start = history->working;
+    int start_row = history->rows;
+    int start_day = history->last_day;
+    if (k >= 0 || history->checkpoint_count > 0) {
+        const StockCheckpoint *cp = &history->checkpoints[(k >= 0) ? k : 0];
+        start = cp->quantities;
+        start_row = cp->row;
+        start_day = cp->day;
+    }
+    
+    if (only >= 0) {
+        out[0] = start[only];
+    } else {
+        memcpy(out, start, sizeof(int) * (size_t)history->product_count);
+    }
+    
+    if (start_day <= day) {
+        // Forward over the movements after the checkpoint, up to the day
+        int current = start_day;
+        for (int r = start_row; r < history->rows; r++) {
+            current = row_day(&rows[r], current);
+            if (current > day) break;
+            apply_row(history, &rows[r], only, 1, out);
+        }
+    } else {
+        // The day is before the first checkpoint: undo movements back to it
+        for (int r = start_row - 1; r >= 0; r--) {
+            int row_date;
+            if (date_to_days(rows[r].date_time, &row_date) && row_date <= day) break;
+            apply_row(history, &rows[r], only, -1, out);
+        }
+    }
+}
+
+// Products added since the build: undo their movements after the day
+static int untracked_as_of(const StockHistory *history, const Product *product, int day) {
+    const Transaction *rows = history->transactions->transactions;
+    int quantity = product->quantity_in_stock;
+    
+    for (int r = history->rows - 1; r >= 0; r--) {
+        int row_date;
+        if (date_to_days(rows[r].date_time, &row_date) && row_date <= day) break;
+        if (rows[r].product_id == product->id) {
+            quantity -= signed_quantity(&rows[r]);
+        }
+    }
+    return quantity;
+}
+
+static int stock_as_of(const StockHistory *history, int product_id, int day, int *quantity) {
+    if (history == NULL || quantity == NULL || history->working == NULL) return 0;
+    
+    int slot = find_tracked(history, product_id);
+    if (slot >= 0) {
+        replay(history, day, slot, quantity);
+        return 1;
+    }
+    
+    for (int i = 0; i < history->products->count; i++) {
+        if (history->products->products[i].id == product_id) {
+            *quantity = untracked_as_of(history, &history->products->products[i], day);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int history_stock_as_of(const StockHistory *history, int product_id, int day, int *quantity) {
+    MetricTimer timer = metrics_start();
+    int result = stock_as_of(history, product_id, day, quantity);
+    metrics_stop(METRIC_REPORT_STOCK_AS_OF, timer);
+    return result;
+}
+
+static int all_as_of(const StockHistory *history, int day, StockAsOf *results) {
+    if (history == NULL || results == NULL || history->working == NULL) return 0;
+    
+    int *quantities = malloc(sizeof(int) * (size_t)(history->product_count + 1));
+    if (quantities == NULL) return 0;
+    
+    replay(history, day, -1, quantities);
+    int count = 0;
+    for (int i = 0; i < history->product_count; i++) {
+        results[count].product_id = history->product_ids[i];
+        results[count].quantity = quantities[i];
+        count++;
+    }
+    free(quantities);
+    
+    const ProductList *products = history->products;
+    for (int i = 0; i < products->count; i++) {
+        if (find_tracked(history, products->products[i].id) >= 0) continue;
+        results[count].product_id = products->products[i].id;
+        results[count].quantity = untracked_as_of(history, &products->products[i], day);
+        count++;
+    }
+    return count;
+}
+
+int history_all_as_of(const StockHistory *history, int day, StockAsOf *results) {
+    MetricTimer timer = metrics_start();
+    int result = all_as_of(history, day, results);
+    metrics_stop(METRIC_REPORT_ALL_AS_OF, timer);
+    return result;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file history.h
+ * @brief Stock-as-of-date queries from periodic quantity checkpoints
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A checkpoint records the stock of every product at the end of a day as
+ * one compact vector of quantities (parallel to a sorted product ID
+ * array), together with the log position it covers. An as-of query starts
+ * from the nearest checkpoint at or before the day and replays only the
+ * movements after it, so an audit costs O(products + movements since the
+ * checkpoint) instead of a pass over the whole log.
+ *
+ * Checkpoints are rebuilt from the log at load: the stock before the first
+ * row is the current stock minus all logged movements. A transaction
+ * listener then adds a checkpoint whenever a new day starts. At most
+ * HISTORY_MAX_CHECKPOINTS are kept; when full, every other checkpoint is
+ * dropped and the spacing doubles.
+ *
+ * The log is assumed to be in time order (rows are stamped when added); a
+ * row dated before its predecessor counts on its predecessor's day.
+ * Quantity edits made without a transaction are not in the log and show
+ * up as if they had always been there.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "product.h"
+#include "transaction.h"
+
+#define HISTORY_MAX_CHECKPOINTS 1024
+
+/**
+ * @brief Stock of all tracked products at the end of one day
+ */
+typedef struct {
+    int day;                ///< Day number (see date_to_days)
+    int row;                ///< Log rows applied (all rows up to this day)
+    int *quantities;        ///< One quantity per tracked product
+} StockCheckpoint;
+
+/**
+ * @brief Checkpoint store
+ */
+typedef struct {
+    const ProductList *products;            ///< Current stock (untracked products)
+    const TransactionList *transactions;    ///< The log
+    int *product_ids;                       ///< Tracked product IDs, ascending
+    int product_count;                      ///< Tracked products
+    int *working;                           ///< Stock after all rows seen
+    StockCheckpoint *checkpoints;           ///< Oldest first
+    int checkpoint_count;
+    int interval;                           ///< Minimum days between checkpoints
+    int rows;                               ///< Log rows seen
+    int last_day;                           ///< Day of the newest row seen
+} StockHistory;
+
+/**
+ * @brief Stock of one product on a day
+ */
+typedef struct {
+    int product_id;         ///< Product ID
+    int quantity;           ///< Units in stock at the end of the day
+} StockAsOf;
+
+/**
+ * @brief Rebuild the checkpoints from the current stock and the log
+ *
+ * Safe to call repeatedly (e.g. after a restore). The StockHistory must be
+ * zero-initialized before the first call.
+ *
+ * @param history History to rebuild
+ * @param products Current products
+ * @param transactions The log
+ * @return 1 on success, 0 on allocation failure
+ */
+int history_build(StockHistory *history, const ProductList *products,
+                  const TransactionList *transactions);
+
+/**
+ * @brief Release checkpoint memory
+ * @param history History to free
+ */
+void history_free(StockHistory *history);
+
+/**
+ * @brief Apply one appended log row (called by the listener)
+ * @param history Pointer to StockHistory
+ * @param transaction Row at index history->rows of the log
+ */
+void history_observe(StockHistory *history, const Transaction *transaction);
+
+/**
+ * @brief Keep the history current with every later transaction_add
+ * @param history Pointer to StockHistory
+ * @param transactions The list history_build was run on
+ * @return 1 on success, 0 if the list has no free listener slot
+ */
+int history_attach(StockHistory *history, TransactionList *transactions);
+
+/**
+ * @brief Get one product's stock at the end of a day
+ * @param history Pointer to StockHistory
+ * @param product_id Product ID
+ * @param day Day number
+ * @param quantity Output quantity
+ * @return 1 on success, 0 if the product is unknown
+ */
+int history_stock_as_of(const StockHistory *history, int product_id, int day, int *quantity);
+
+/**
+ * @brief Get every product's stock at the end of a day
+ *
+ * Lists tracked products (including ones deleted since) in ID order,
+ * followed by products added since the history was built.
+ *
+ * @param history Pointer to StockHistory
+ * @param day Day number
+ * @param results Output array (room for product_count + products->count entries)
+ * @return Number of entries
+ */
+int history_all_as_of(const StockHistory *history, int day, StockAsOf *results);
+
+#endif /* HISTORY_H */
@@ -15,6 +15,23 @@
 #include "storage.h"
 #include "ui.h"
 #include "report.h"
+#include "stock.h"
+#include "batch.h"
+#include "pool.h"
+#include "snapshot.h"
+#include "rollup.h"
+#include "forecast.h"
+#include "history.h"
+#include "filter.h"
+#include "cache.h"
+#include "sketch.h"
+#include "export.h"
+#include "view.h"
+#include "trie.h"
+#include "fuzzy.h"
+#include "shard.h"
+#include "metrics.h"
+#include "startup.h"
 #include "utils.h"
 
 // Global data structures
@@ -23,16 +40,67 @@ static SupplierList suppliers;
 static TransactionList transactions;
 static UserList users;
 static Session session;
+static SnapshotStore snapshots;
+static Rollup rollup;
+static ForecastStore forecasts;
+static StockHistory history;
+static FilterIndex filter_index;
+static ReportCache report_cache;
+static MovementSketches sketches;
+static int sketches_enabled = 0;
+static ViewCache product_views;
+static ViewCache supplier_views;
+static ViewCache transaction_views;
+static ProductTrie product_trie;
+static FuzzyIndex fuzzy_index;
+static StartupProfile startup;
 
 /**
  * @brief Load all data from files
+ *
+ * Each phase is timed into the startup profile.
  */
 void load_all_data(void) {
+    LoadStats load;
+    
+    startup_profile_begin(&startup);
     storage_init_directories();
-    storage_load_products(&products);
-    storage_load_suppliers(&suppliers);
-    storage_load_transactions(&transactions);
-    storage_load_users(&users);
+    startup_profile_mark(&startup, "init.directories", NULL);
+    storage_load_products(&products, &load);
+    startup_profile_mark(&startup, "load.products", &load);
+    storage_load_suppliers(&suppliers, &load);
+    startup_profile_mark(&startup, "load.suppliers", &load);
+    storage_load_transactions(&transactions, &load);
+    startup_profile_mark(&startup, "load.transactions", &load);
+    storage_load_users(&users, &load);
+    startup_profile_mark(&startup, "load.users", &load);
+    
+    // Derived data is rebuilt from the loaded rows, then kept current
+    rollup_build(&rollup, &products, &transactions);
+    rollup_attach(&rollup, &transactions);
+    startup_profile_mark(&startup, "index.rollup", NULL);
+    history_build(&history, &products, &transactions);
+    history_attach(&history, &transactions);
+    startup_profile_mark(&startup, "index.history", NULL);
+    if (sketches_enabled) {
+        sketch_build(&sketches, &transactions);
+        sketch_attach(&sketches, &transactions);
+        startup_profile_mark(&startup, "index.sketches", NULL);
+    }
+    
+    // The search indexes are built on first use, then follow the products
+    trie_free(&product_trie);
+    trie_attach(&product_trie, &products);
+    fuzzy_attach(&fuzzy_index, &products);
+    filter_attach(&filter_index, &products);
+    startup_profile_mark(&startup, "index.search", NULL);
+    
+    // Forecasts are saved, so only rows added since the last save are replayed
+    storage_load_forecasts(&forecasts, &load);
+    startup_profile_mark(&startup, "load.forecasts", &load);
+    forecast_catch_up(&forecasts, &transactions);
+    forecast_attach(&forecasts, &transactions);
+    startup_profile_mark(&startup, "index.forecasts", NULL);
 }
 
 /**
@@ -43,6 +111,283 @@ void save_all_data(void) {
     storage_save_suppliers(&suppliers);
     storage_save_transactions(&transactions);
     storage_save_users(&users);
+    storage_save_forecasts(&forecasts);
+}
+
+/**
+ * @brief Display an array of product results as a table
+ * @param results Products to display
+ * @param count Number of products
+ * @param empty_message Message shown when there are no results
+ */
+void display_product_results(const Product *results, int count,
+                             const char *empty_message) {
+    // Static to keep large capacities (-DMAX_PRODUCTS) off the stack
+    static ProductList temp_list;
+    
+    if (count <= 0) {
+        printf("\n%s\n", empty_message);
+        return;
+    }
+    
+    temp_list.count = 0;
+    for (int i = 0; i < count && i < MAX_PRODUCTS; i++) {
+        temp_list.products[temp_list.count++] = results[i];
+    }
+    ui_display_products_table(&temp_list);
+}
+
+static int print_product_match(void *ctx, const Product *product) {
+    (void)ctx;
+    ui_display_product_row(product);
+    return 1;
+}
+
+static int print_transaction_match(void *ctx, const Transaction *transaction) {
+    (void)ctx;
+    ui_display_transaction_row(transaction);
+    return 1;
+}
+
+/**
+ * @brief Search names, falling back to the closest spellings when nothing contains the text
+ * @param name Text to look for
+ */
+static void search_products_by_name(const char *name) {
+    static Product results[MAX_PRODUCTS];
+    FuzzyMatch matches[FUZZY_DEFAULT_RESULTS];
+    
+    int count = product_find_by_name(&products, name, results, MAX_PRODUCTS);
+    if (count > 0) {
+        display_product_results(results, count, "No products found.");
+        return;
+    }
+    
+    count = fuzzy_search(&fuzzy_index, &products, name, -1, matches, FUZZY_DEFAULT_RESULTS, NULL);
+    if (count <= 0) {
+        printf("\nNo products found.\n");
+        return;
+    }
+    printf("\nNo names contain \"%s\". Closest names (fewest edits first):\n\n", name);
+    printf("%-7s%-8s%-30s%s\n", "Edits", "ID", "Name", "Category");
+    for (int i = 0; i < count; i++) {
+        const Product *p = &products.products[matches[i].slot];
+        printf("%-7d%-8d%-30s%s\n", matches[i].distance, p->id, p->name, p->category);
+    }
+}
+
+/**
+ * @brief Read a filter expression and stream the matching rows
+ * @param target Products or transactions
+ */
+void filter_interactive(FilterTarget target) {
+    char expression[MAX_STRING_LEN];
+    FilterPlan plan;
+    
+    if (target == FILTER_PRODUCTS) {
+        printf("Fields: id name category description qty reorder price supplier value\n");
+    } else {
+        printf("Fields: id product type qty date notes\n");
+    }
+    printf("Enter filter (e.g. category=electronics AND qty<reorder): ");
+    if (!read_string(expression, sizeof(expression))) {
+        ui_display_error("Invalid filter.");
+        return;
+    }
+    if (!filter_compile(expression, target, &plan)) {
+        ui_display_error(plan.error);
+        return;
+    }
+    
+    // Rows are printed as they are found
+    int count;
+    if (target == FILTER_PRODUCTS) {
+        ui_display_products_header();
+        count = filter_run_products(&plan, &products, &filter_index, print_product_match, NULL);
+        ui_display_products_footer();
+    } else {
+        ui_display_transactions_header();
+        count = filter_run_transactions(&plan, &transactions, print_transaction_match, NULL);
+        ui_display_transactions_footer();
+    }
+    printf("%d matching (%s)\n", count, filter_access_name(&plan));
+}
+
+/**
+ * @brief Print one page of a table
+ * @param table Table to print
+ * @param order Sort permutation, or NULL for list order
+ * @param first First display position
+ * @param last One past the last display position
+ * @param descending Nonzero to read the order from the end
+ */
+static void print_table_page(ViewTable table, const int *order, int first, int last,
+                             int descending) {
+    if (table == VIEW_PRODUCTS) {
+        ui_display_products_header();
+        for (int i = first; i < last; i++) {
+            ui_display_product_row(&products.products[view_row(order, products.count, i, descending)]);
+        }
+        ui_display_products_footer();
+    } else if (table == VIEW_SUPPLIERS) {
+        ui_display_suppliers_header();
+        for (int i = first; i < last; i++) {
+            ui_display_supplier_row(&suppliers.suppliers[view_row(order, suppliers.count, i, descending)]);
+        }
+        ui_display_suppliers_footer();
+    } else {
+        ui_display_transactions_header();
+        for (int i = first; i < last; i++) {
+            ui_display_transaction_row(&transactions.transactions[view_row(order, transactions.count, i, descending)]);
+        }
+        ui_display_transactions_footer();
+    }
+}
+
+/**
+ * @brief Page through a table, sorted by any column
+ *
+ * Sorting uses the cached permutations of view.h, so only the rows of the
+ * page on screen are touched.
+ *
+ * @param table Table to browse
+ * @param descending Start in descending order (newest first for list order)
+ */
+void browse_table(ViewTable table, int descending) {
+    int column = VIEW_LIST_ORDER;
+    int page = 0;
+    char command[MAX_STRING_LEN];
+    
+    while (1) {
+        int rows;
+        const int *order = NULL;
+        
+        if (table == VIEW_PRODUCTS) {
+            rows = products.count;
+            if (column != VIEW_LIST_ORDER) order = view_sort_products(&product_views, &products, column);
+        } else if (table == VIEW_SUPPLIERS) {
+            rows = suppliers.count;
+            if (column != VIEW_LIST_ORDER) order = view_sort_suppliers(&supplier_views, &suppliers, column);
+        } else {
+            rows = transactions.count;
+            if (column != VIEW_LIST_ORDER) order = view_sort_transactions(&transaction_views, &transactions, column);
+        }
+        if (column != VIEW_LIST_ORDER && order == NULL) {
+            ui_display_error("Not enough memory to sort; showing list order.");
+            column = VIEW_LIST_ORDER;
+        }
+        
+        if (rows == 0) {
+            printf("\nNo %s found.\n", (table == VIEW_PRODUCTS) ? "products" :
+                   (table == VIEW_SUPPLIERS) ? "suppliers" : "transactions");
+            pause_screen();
+            return;
+        }
+        
+        int pages = (rows + VIEW_PAGE_ROWS - 1) / VIEW_PAGE_ROWS;
+        if (page >= pages) page = pages - 1;
+        if (page < 0) page = 0;
+        
+        int first = page * VIEW_PAGE_ROWS;
+        int last = (first + VIEW_PAGE_ROWS < rows) ? first + VIEW_PAGE_ROWS : rows;
+        print_table_page(table, order, first, last, descending);
+        
+        printf("Page %d of %d (rows %d-%d of %d, by %s %s)\n", page + 1, pages, first + 1, last,
+               rows, view_column_name(table, column), descending ? "descending" : "ascending");
+        printf("[n]ext [p]rev [f]irst [l]ast, page number, [s]ort <column>, [r]everse, [q]uit: ");
+        if (!read_string(command, sizeof(command))) return;
+        
+        char action = (char)tolower((unsigned char)command[0]);
+        if (action == '\0' || action == 'n') {
+            page++;
+        } else if (action == 'p') {
+            page--;
+        } else if (action == 'f') {
+            page = 0;
+        } else if (action == 'l') {
+            page = pages - 1;
+        } else if (isdigit((unsigned char)action)) {
+            page = atoi(command) - 1;
+        } else if (action == 'r') {
+            descending = !descending;
+            page = 0;
+        } else if (action == 's') {
+            int count = view_column_count(table);
+            int choice = atoi(command + 1);
+            
+            if (choice == 0) {
+                printf("Sort by: 0. List order");
+                for (int i = 0; i < count; i++) {
+                    printf("  %d. %s", i + 1, view_column_name(table, i));
+                }
+                printf("\nColumn: ");
+                if (!read_integer(&choice)) choice = -1;
+            }
+            if (choice < 0 || choice > count) {
+                ui_display_error("Invalid column.");
+                continue;
+            }
+            column = choice - 1;
+            descending = 0;
+            page = 0;
+        } else if (action == 'q') {
+            return;
+        } else {
+            ui_display_error("Invalid command.");
+        }
+    }
+}
+
+/**
+ * @brief Get the type-ahead trie, building it on first use
+ * @return The trie, or NULL if there was not enough memory
+ */
+static ProductTrie* lookup_trie(void) {
+    if (product_trie.root == NULL && !trie_build(&product_trie, &products)) {
+        trie_free(&product_trie);
+        return NULL;
+    }
+    return &product_trie;
+}
+
+/**
+ * @brief Look products up by name or ID prefix as the user types
+ *
+ * Each prefix shows the first TRIE_DEFAULT_COMPLETIONS matches in
+ * alphabetical order; a longer prefix narrows them. A blank line returns.
+ */
+void quick_find(void) {
+    char prefix[MAX_NAME_LEN];
+    int ids[TRIE_DEFAULT_COMPLETIONS + 1];
+    
+    ProductTrie *trie = lookup_trie();
+    if (trie == NULL) {
+        ui_display_error("Not enough memory for quick find.");
+        return;
+    }
+    
+    while (1) {
+        printf("\nName or ID prefix (blank to return): ");
+        if (!read_string(prefix, sizeof(prefix)) || strlen(prefix) == 0) return;
+        
+        // One extra completion tells whether the list was cut short
+        int count = trie_complete(trie, prefix, ids, TRIE_DEFAULT_COMPLETIONS + 1);
+        if (count == 0) {
+            printf("No products start with \"%s\".\n", prefix);
+            continue;
+        }
+        
+        int shown = (count > TRIE_DEFAULT_COMPLETIONS) ? TRIE_DEFAULT_COMPLETIONS : count;
+        ui_display_products_header();
+        for (int i = 0; i < shown; i++) {
+            Product *p = trie_product(trie, &products, ids[i]);
+            if (p != NULL) ui_display_product_row(p);
+        }
+        ui_display_products_footer();
+        if (count > shown) {
+            printf("First %d matches shown; type more to narrow them.\n", shown);
+        }
+    }
 }
 
 /**
@@ -84,7 +429,7 @@ int handle_login(void) {
 void handle_product_management(void) {
     int choice;
     Product product;
-    Product search_results[MAX_PRODUCTS];
+    static Product search_results[MAX_PRODUCTS];
     int search_count;
     int product_id;
     
@@ -112,8 +457,7 @@ void handle_product_management(void) {
                 break;
                 
             case 2:  // View All Products
-                ui_display_products_table(&products);
-                pause_screen();
+                browse_table(VIEW_PRODUCTS, 0);
                 break;
                 
             case 3:  // Search by ID
@@ -131,17 +475,7 @@ void handle_product_management(void) {
                 printf("Enter product name (partial match): ");
                 char name[100];
                 if (read_string(name, sizeof(name))) {
-                    search_count = product_find_by_name(&products, name, 
-                                                       search_results, MAX_PRODUCTS);
-                    if (search_count > 0) {
-                        ProductList temp_list = {0};
-                        for (int i = 0; i < search_count; i++) {
-                            product_add(&temp_list, &search_results[i]);
-                        }
-                        ui_display_products_table(&temp_list);
-                    } else {
-                        printf("\nNo products found.\n");
-                    }
+                    search_products_by_name(name);
                     pause_screen();
                 }
                 break;
@@ -152,15 +486,7 @@ void handle_product_management(void) {
                 if (read_string(category, sizeof(category))) {
                     search_count = product_find_by_category(&products, category,
                                                            search_results, MAX_PRODUCTS);
-                    if (search_count > 0) {
-                        ProductList temp_list = {0};
-                        for (int i = 0; i < search_count; i++) {
-                            product_add(&temp_list, &search_results[i]);
-                        }
-                        ui_display_products_table(&temp_list);
-                    } else {
-                        printf("\nNo products found.\n");
-                    }
+                    display_product_results(search_results, search_count, "No products found.");
                     pause_screen();
                 }
                 break;
@@ -212,19 +538,20 @@ void handle_product_management(void) {
                 
             case 8:  // Low Stock Products
                 search_count = product_get_low_stock(&products, search_results, MAX_PRODUCTS);
-                if (search_count > 0) {
-                    ProductList temp_list = {0};
-                    for (int i = 0; i < search_count; i++) {
-                        product_add(&temp_list, &search_results[i]);
-                    }
-                    ui_display_products_table(&temp_list);
-                } else {
-                    printf("\nNo low stock products.\n");
-                }
+                display_product_results(search_results, search_count, "No low stock products.");
+                pause_screen();
+                break;
+                
+            case 9:  // Filter Products
+                filter_interactive(FILTER_PRODUCTS);
                 pause_screen();
                 break;
                 
-            case 9:  // Back
+            case 10:  // Quick Find
+                quick_find();
+                break;
+                
+            case 11:  // Back
                 return;
                 
             default:
@@ -264,8 +591,7 @@ void handle_supplier_management(void) {
                 break;
                 
             case 2:  // View All Suppliers
-                ui_display_suppliers_table(&suppliers);
-                pause_screen();
+                browse_table(VIEW_SUPPLIERS, 0);
                 break;
                 
             case 3:  // Edit Supplier
@@ -340,7 +666,7 @@ void handle_stock_operations(void) {
     int product_id;
     int quantity;
     char notes[MAX_NOTES_LEN];
-    Transaction transaction;
+    StockStatus status;
     
     while (1) {
         ui_display_stock_menu();
@@ -374,19 +700,12 @@ void handle_stock_operations(void) {
                     notes[0] = '\0';
                 }
                 
-                // Update product quantity
-                p->quantity_in_stock += quantity;
-                
-                // Create transaction
-                transaction.transaction_id = transaction_get_next_id(&transactions);
-                transaction.product_id = product_id;
-                strcpy(transaction.type, TRANSACTION_TYPE_IN);
-                transaction.quantity = quantity;
-                get_current_datetime(transaction.date_time, sizeof(transaction.date_time));
-                strncpy(transaction.notes, notes, sizeof(transaction.notes) - 1);
-                transaction.notes[sizeof(transaction.notes) - 1] = '\0';
-                
-                transaction_add(&transactions, &transaction);
+                status = stock_move(&products, &transactions, product_id,
+                                    TRANSACTION_TYPE_IN, quantity, notes, NULL);
+                if (status != STOCK_OK) {
+                    ui_display_error(stock_status_message(status));
+                    break;
+                }
                 save_all_data();
                 
                 printf("\nStock updated successfully!\n");
@@ -423,19 +742,12 @@ void handle_stock_operations(void) {
                     notes[0] = '\0';
                 }
                 
-                // Update product quantity
-                p->quantity_in_stock -= quantity;
-                
-                // Create transaction
-                transaction.transaction_id = transaction_get_next_id(&transactions);
-                transaction.product_id = product_id;
-                strcpy(transaction.type, TRANSACTION_TYPE_OUT);
-                transaction.quantity = quantity;
-                get_current_datetime(transaction.date_time, sizeof(transaction.date_time));
-                strncpy(transaction.notes, notes, sizeof(transaction.notes) - 1);
-                transaction.notes[sizeof(transaction.notes) - 1] = '\0';
-                
-                transaction_add(&transactions, &transaction);
+                status = stock_move(&products, &transactions, product_id,
+                                    TRANSACTION_TYPE_OUT, quantity, notes, NULL);
+                if (status != STOCK_OK) {
+                    ui_display_error(stock_status_message(status));
+                    break;
+                }
                 save_all_data();
                 
                 printf("\nStock updated successfully!\n");
@@ -448,21 +760,49 @@ void handle_stock_operations(void) {
                 break;
                 
             case 3:  // View Recent Transactions
+                // Newest first, paging back through the log in place
+                browse_table(VIEW_TRANSACTIONS, 1);
+                break;
+                
+            case 4:  // Import Movements from File
                 {
-                    Transaction all_trans[MAX_TRANSACTIONS];
-                    int count = transaction_get_all(&transactions, all_trans);
-                    if (count > 0) {
-                        // Show last 20 transactions
-                        int start = (count > 20) ? count - 20 : 0;
-                        ui_display_transactions_table(&all_trans[start], count - start);
-                    } else {
-                        printf("\nNo transactions found.\n");
+                    char path[MAX_STRING_LEN];
+                    BatchContext ctx;
+                    ImportSummary summary;
+                    
+                    printf("Enter movement file path (product_id|type|quantity|notes): ");
+                    if (!read_string(path, sizeof(path)) || strlen(path) == 0) {
+                        ui_display_error("Invalid file path.");
+                        break;
+                    }
+                    
+                    batch_context_init(&ctx, &products, &suppliers, &transactions);
+                    ctx.forecasts = &forecasts;
+                    ctx.history = &history;
+                    ctx.filter_index = &filter_index;
+                    ctx.sketches = &sketches;
+                    ctx.trie = &product_trie;
+                    ctx.fuzzy = &fuzzy_index;
+                    if (!batch_import_movements(&ctx, path, 0, stdout, &summary)) {
+                        ui_display_error("Cannot read movement file.");
+                        break;
                     }
+                    if (summary.applied > 0) {
+                        save_all_data();
+                    }
+                    
+                    printf("\n%d rows: %d accepted, %d rejected, %d applied\n",
+                           summary.rows, summary.accepted, summary.rejected, summary.applied);
                     pause_screen();
                 }
                 break;
                 
-            case 4:  // Back
+            case 5:  // Filter Transactions
+                filter_interactive(FILTER_TRANSACTIONS);
+                pause_screen();
+                break;
+                
+            case 6:  // Back
                 return;
                 
             default:
@@ -472,15 +812,495 @@ void handle_stock_operations(void) {
     }
 }
 
+/**
+ * @brief Pin a consistent version of the data for a report
+ * @return Pinned snapshot (release with snapshot_release)
+ */
+static Snapshot* pin_report_snapshot(void) {
+    // This thread is also the writer, so it publishes pending changes first
+    snapshot_publish(&snapshots);
+    return snapshot_acquire(&snapshots);
+}
+
+// Reports kept in the result cache
+enum {
+    REPORT_KIND_TOTAL_VALUE = 1,
+    REPORT_KIND_TOP_QUANTITY,
+    REPORT_KIND_TOP_VALUE,
+    REPORT_KIND_LOW_STOCK,
+    REPORT_KIND_DATE_RANGE,
+    REPORT_KIND_VELOCITY,
+    REPORT_KIND_REORDER,
+    REPORT_KIND_AS_OF,
+    REPORT_KIND_GROUP,
+    REPORT_KIND_DASHBOARD,
+    REPORT_KIND_SKETCHES,
+    REPORT_KIND_ABC
+};
+
+/**
+ * @brief Build the cache key of a report on a pinned snapshot
+ * @param snap Snapshot the report reads
+ * @param kind Report kind
+ * @param p0 First parameter (0 if unused)
+ * @param p1 Second parameter (0 if unused)
+ * @return Cache key
+ */
+static ReportCacheKey report_key(const Snapshot *snap, int kind, long p0, long p1) {
+    ReportCacheKey key = {kind, {p0, p1, 0}, snap->product_generation,
+                          snap->transaction_generation};
+    return key;
+}
+
+/**
+ * @brief Copy a cached row array into rows
+ * @param key Report key
+ * @param rows Destination
+ * @param row_size Size of one row
+ * @return Number of rows, or -1 if the report is not cached
+ */
+static int cached_rows(const ReportCacheKey *key, void *rows, size_t row_size) {
+    size_t size;
+    const void *data = report_cache_get(&report_cache, key, &size);
+    if (data == NULL) return -1;
+    
+    memcpy(rows, data, size);
+    printf("\n(cached result; report cache: %ld hits, %ld misses)\n",
+           report_cache.hits, report_cache.misses);
+    return (int)(size / row_size);
+}
+
+/**
+ * @brief Keep a computed row array for repeated runs
+ * @param key Report key
+ * @param rows Rows computed
+ * @param count Number of rows
+ * @param row_size Size of one row
+ */
+static void remember_rows(const ReportCacheKey *key, const void *rows, int count, size_t row_size) {
+    report_cache_put(&report_cache, key, rows, (size_t)count * row_size);
+}
+
+/**
+ * @brief Show weekly IN/OUT units for one category from the rollups
+ */
+static void show_weekly_category_movement(void) {
+    char category[MAX_CATEGORY_LEN];
+    int weeks;
+    
+    printf("Enter category: ");
+    if (!read_string(category, sizeof(category)) || strlen(category) == 0) {
+        ui_display_error("Invalid category.");
+        return;
+    }
+    
+    printf("Enter number of weeks (1-260): ");
+    if (!read_integer(&weeks) || weeks < 1 || weeks > 260) {
+        ui_display_error("Invalid number of weeks.");
+        return;
+    }
+    
+    // Most recent week last, ending with the current week
+    RollupTotals totals[260];
+    int first_week = rollup_week_of_day(current_day()) - weeks + 1;
+    if (!rollup_category_weeks(&rollup, category, first_week, weeks, totals)) {
+        printf("\nNo movements recorded for category '%s'.\n", category);
+        return;
+    }
+    
+    printf("\n%-12s %10s %10s %10s %10s\n", "Week of", "In", "Out", "Net", "Moves");
+    print_separator(58, '-');
+    for (int i = 0; i < weeks; i++) {
+        char week_start[11];
+        days_to_date(rollup_week_start(first_week + i), week_start, sizeof(week_start));
+        printf("%-12s %10ld %10ld %10ld %10d\n", week_start,
+               totals[i].in_units, totals[i].out_units,
+               totals[i].in_units - totals[i].out_units, totals[i].movements);
+    }
+}
+
+/**
+ * @brief Show units out per day, days of cover and turnover per product
+ * @param snap Snapshot to report on
+ */
+static void show_stock_velocity(const Snapshot *snap) {
+    static VelocityRow rows[MAX_PRODUCTS];
+    int window;
+    
+    printf("Enter window in days (e.g. 30): ");
+    if (!read_integer(&window) || window < 1) {
+        ui_display_error("Invalid number of days.");
+        return;
+    }
+    
+    int today = current_day();
+    ReportCacheKey key = report_key(snap, REPORT_KIND_VELOCITY, window, today);
+    int count = cached_rows(&key, rows, sizeof(VelocityRow));
+    if (count < 0) {
+        count = report_stock_velocity_prefix(snap->products, snap->transactions,
+                                             snap->transaction_count, window, today, rows);
+        remember_rows(&key, rows, count, sizeof(VelocityRow));
+    }
+    if (count == 0) {
+        printf("\nNo products found.\n");
+        return;
+    }
+    
+    printf("\n%-6s %-30s %8s %8s %9s %11s %9s\n",
+           "ID", "Name", "Stock", "Out", "Per Day", "Cover Days", "Turnover");
+    print_separator(87, '-');
+    for (int i = 0; i < count; i++) {
+        const VelocityRow *r = &rows[i];
+        char cover[16];
+        if (r->days_of_cover < 0) {
+            strcpy(cover, "-");
+        } else {
+            snprintf(cover, sizeof(cover), "%.1f", r->days_of_cover);
+        }
+        printf("%-6d %-30.30s %8d %8ld %9.2f %11s %9.2f\n", r->product_id, r->name,
+               r->quantity_in_stock, r->units_out, r->velocity, cover, r->turnover);
+    }
+}
+
+/**
+ * @brief Show forecast-based reorder suggestions grouped by supplier
+ * @param snap Snapshot to check
+ */
+static void show_reorder_suggestions(const Snapshot *snap) {
+    static ReorderSuggestion rows[MAX_PRODUCTS];
+    
+    // Forecasts follow the transaction log, so the snapshot generations cover them
+    int today = current_day();
+    ReportCacheKey key = report_key(snap, REPORT_KIND_REORDER, today, 0);
+    int count = cached_rows(&key, rows, sizeof(ReorderSuggestion));
+    if (count < 0) {
+        count = forecast_reorder_suggestions(&forecasts, snap->products, today, rows);
+        remember_rows(&key, rows, count, sizeof(ReorderSuggestion));
+    }
+    if (count == 0) {
+        printf("\nNo products need reordering at the forecast demand.\n");
+        return;
+    }
+    
+    printf("\nLead time %d days, safety stock for ~95%% service level\n",
+           FORECAST_LEAD_TIME_DAYS);
+    for (int i = 0; i < count; i++) {
+        const ReorderSuggestion *r = &rows[i];
+        
+        if (i == 0 || r->supplier_id != rows[i - 1].supplier_id) {
+            Supplier *supplier = supplier_find_by_id(&suppliers, r->supplier_id);
+            printf("\nSupplier %d: %s\n", r->supplier_id,
+                   (supplier != NULL) ? supplier->name : "(unknown)");
+            printf("%-6s %-30s %8s %9s %8s %8s %8s\n",
+                   "ID", "Name", "Stock", "Per Day", "Safety", "Reorder", "Order");
+            print_separator(83, '-');
+        }
+        
+        printf("%-6d %-30.30s %8d %9.2f %8.1f %8d %8d\n", r->product_id,
+               r->name, r->quantity_in_stock,
+               r->forecast.daily_demand, r->forecast.safety_stock,
+               r->forecast.reorder_point, r->order_quantity);
+    }
+}
+
+/**
+ * @brief Show stock on a past date for one product or all of them
+ * @param snap Snapshot whose generations key the cached result
+ */
+static void show_stock_as_of(const Snapshot *snap) {
+    static StockAsOf rows[MAX_PRODUCTS * 2];
+    char date[11];
+    int day, product_id;
+    
+    printf("Enter date (YYYY-MM-DD): ");
+    if (!read_string(date, sizeof(date)) || !date_to_days(date, &day)) {
+        ui_display_error("Invalid date format.");
+        return;
+    }
+    
+    printf("Enter product ID (0 for all products): ");
+    if (!read_integer(&product_id) || product_id < 0) {
+        ui_display_error("Invalid product ID.");
+        return;
+    }
+    
+    ReportCacheKey key = report_key(snap, REPORT_KIND_AS_OF, day, product_id);
+    int count = cached_rows(&key, rows, sizeof(StockAsOf));
+    if (count < 0) {
+        if (product_id > 0) {
+            if (!history_stock_as_of(&history, product_id, day, &rows[0].quantity)) {
+                ui_display_error("Product not found.");
+                return;
+            }
+            rows[0].product_id = product_id;
+            count = 1;
+        } else {
+            count = history_all_as_of(&history, day, rows);
+        }
+        remember_rows(&key, rows, count, sizeof(StockAsOf));
+    }
+    
+    printf("\nStock at the end of %s\n", date);
+    printf("%-6s %-30s %10s %10s\n", "ID", "Name", "Then", "Now");
+    print_separator(59, '-');
+    for (int i = 0; i < count; i++) {
+        Product *p = product_find_by_id(&products, rows[i].product_id);
+        if (p != NULL) {
+            printf("%-6d %-30.30s %10d %10d\n", rows[i].product_id, p->name,
+                   rows[i].quantity, p->quantity_in_stock);
+        } else {
+            printf("%-6d %-30s %10d %10s\n", rows[i].product_id, "(deleted)",
+                   rows[i].quantity, "-");
+        }
+    }
+}
+
+/**
+ * @brief Show stock value, units and low-stock counts per category or supplier
+ * @param snap Snapshot to report on
+ */
+static void show_grouped_stock(const Snapshot *snap) {
+    static GroupRow rows[MAX_PRODUCTS];
+    int by, sort, limit;
+    
+    printf("Group by (1 = Category, 2 = Supplier): ");
+    if (!read_integer(&by) || by < 1 || by > 2) {
+        ui_display_error("Invalid choice.");
+        return;
+    }
+    
+    printf("Sort by (1 = Value, 2 = Units, 3 = Low Stock, 4 = Name): ");
+    if (!read_integer(&sort) || sort < 1 || sort > 4) {
+        ui_display_error("Invalid choice.");
+        return;
+    }
+    
+    printf("Number of rows (0 for all): ");
+    if (!read_integer(&limit) || limit < 0) {
+        ui_display_error("Invalid number.");
+        return;
+    }
+    
+    ReportGroupBy group_by = (by == 1) ? REPORT_GROUP_CATEGORY : REPORT_GROUP_SUPPLIER;
+    ReportGroupSort order = (ReportGroupSort)(sort - 1);
+    
+    // Supplier names are not versioned, so an order by supplier name is never cached
+    int cacheable = !(group_by == REPORT_GROUP_SUPPLIER && order == REPORT_SORT_NAME);
+    ReportCacheKey key = report_key(snap, REPORT_KIND_GROUP, by * 10 + sort, limit);
+    int count = cacheable ? cached_rows(&key, rows, sizeof(GroupRow)) : -1;
+    if (count < 0) {
+        count = report_group_stock(snap->products, &suppliers, group_by, order, limit, rows);
+        if (cacheable) remember_rows(&key, rows, count, sizeof(GroupRow));
+    }
+    if (count == 0) {
+        printf("\nNo products found.\n");
+        return;
+    }
+    
+    if (group_by == REPORT_GROUP_CATEGORY) {
+        printf("\n%-30s %9s %10s %15s %10s\n", "Category", "Products", "Units", "Value", "Low Stock");
+        print_separator(78, '-');
+        for (int i = 0; i < count; i++) {
+            printf("%-30.30s %9d %10ld %15.2f %10d\n", rows[i].name, rows[i].products,
+                   rows[i].units, rows[i].value, rows[i].low_stock);
+        }
+    } else {
+        printf("\n%-6s %-30s %9s %10s %15s %10s\n",
+               "ID", "Supplier", "Products", "Units", "Value", "Low Stock");
+        print_separator(85, '-');
+        for (int i = 0; i < count; i++) {
+            Supplier *supplier = supplier_find_by_id(&suppliers, rows[i].supplier_id);
+            printf("%-6d %-30.30s %9d %10ld %15.2f %10d\n", rows[i].supplier_id,
+                   (supplier != NULL) ? supplier->name : "(unknown)", rows[i].products,
+                   rows[i].units, rows[i].value, rows[i].low_stock);
+        }
+    }
+}
+
+/**
+ * @brief Print one short dashboard list
+ * @param title List heading
+ * @param rows Products to list
+ * @param count Number of rows
+ */
+static void print_dashboard_list(const char *title, const Product *rows, int count) {
+    printf("\n%s\n", title);
+    print_separator(70, '-');
+    if (count == 0) {
+        printf("(none)\n");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        const Product *p = &rows[i];
+        printf("%-6d %-30.30s %8d %8d %14.2f\n", p->id, p->name, p->quantity_in_stock,
+               p->reorder_level, p->quantity_in_stock * p->unit_price);
+    }
+}
+
+/**
+ * @brief Show the headline figures and short lists from one pass over the products
+ * @param snap Snapshot to report on
+ */
+static void show_dashboard(const Snapshot *snap) {
+    static DashboardSummary summary;
+    
+    ReportCacheKey key = report_key(snap, REPORT_KIND_DASHBOARD, 0, 0);
+    if (cached_rows(&key, &summary, sizeof(DashboardSummary)) < 0) {
+        report_dashboard(snap->products, &summary);
+        remember_rows(&key, &summary, 1, sizeof(DashboardSummary));
+    }
+    
+    printf("\nProducts: %d    Units: %ld    Stock value: $%.2f    Low stock: %d\n",
+           summary.total_products, summary.total_units, summary.total_value,
+           summary.low_stock_count);
+    printf("\n%-6s %-30s %8s %8s %14s\n", "ID", "Name", "Qty", "Reorder", "Value");
+    print_dashboard_list("Top by Quantity", summary.top_quantity, summary.top_quantity_count);
+    print_dashboard_list("Top by Value", summary.top_value, summary.top_value_count);
+    print_dashboard_list("Low Stock", summary.low_stock, summary.low_stock_shown);
+    if (summary.low_stock_count > summary.low_stock_shown) {
+        printf("... and %d more (see Low Stock Products)\n",
+               summary.low_stock_count - summary.low_stock_shown);
+    }
+}
+
+/**
+ * @brief Show approximate distinct products, quantity quantiles and top sellers
+ * @param snap Snapshot whose generations key the cached result
+ */
+static void show_movement_sketches(const Snapshot *snap) {
+    static HeavyHitter top[10];
+    int window;
+    
+    if (!sketches_enabled) {
+        printf("\nMovement sketches are not enabled (start with --sketches).\n");
+        return;
+    }
+    
+    printf("Enter window in days (1-%d): ", SKETCH_DAYS);
+    if (!read_integer(&window) || window < 1 || window > SKETCH_DAYS) {
+        ui_display_error("Invalid number of days.");
+        return;
+    }
+    
+    int today = current_day();
+    printf("\nDistinct products moved (+/- 1.6%%):\n");
+    printf("  Today:            %.0f\n", sketch_distinct_products(&sketches, today, today));
+    printf("  Last %2d day(s):   %.0f\n", window,
+           sketch_distinct_products(&sketches, today - window + 1, today));
+    
+    printf("\nMovement quantity (rank within ~1.7%%):\n");
+    int median, p90, p99;
+    if (sketch_quantity_quantile(&sketches, 0.5, &median) &&
+        sketch_quantity_quantile(&sketches, 0.9, &p90) &&
+        sketch_quantity_quantile(&sketches, 0.99, &p99)) {
+        printf("  Median %d, 90th percentile %d, 99th percentile %d\n", median, p90, p99);
+    } else {
+        printf("  No movements recorded.\n");
+    }
+    
+    ReportCacheKey key = report_key(snap, REPORT_KIND_SKETCHES, window, today);
+    int count = cached_rows(&key, top, sizeof(HeavyHitter));
+    if (count < 0) {
+        count = sketch_top_sellers(&sketches, today, window, top, 10);
+        remember_rows(&key, top, count, sizeof(HeavyHitter));
+    }
+    
+    printf("\nTop sellers, last %d day(s) (estimates never undercount):\n", window);
+    printf("%-6s %-30s %12s\n", "ID", "Name", "Units Out");
+    print_separator(50, '-');
+    if (count == 0) {
+        printf("(none)\n");
+    }
+    for (int i = 0; i < count; i++) {
+        Product *p = product_find_by_id(&products, top[i].product_id);
+        printf("%-6d %-30.30s %12ld\n", top[i].product_id,
+               (p != NULL) ? p->name : "(deleted)", top[i].units);
+    }
+}
+
+/**
+ * @brief Show the A/B/C tiers by share of stock value and the ranked A and B products
+ * @param snap Snapshot to classify
+ */
+static void show_abc_classification(const Snapshot *snap) {
+    static AbcRow rows[MAX_PRODUCTS];
+    static const char *const tiers[] = {"A", "B", "C"};
+    int a_percent, b_percent, limit;
+    AbcSummary summary;
+    
+    printf("Tier A share of value in %% (e.g. 80): ");
+    if (!read_integer(&a_percent) || a_percent < 1 || a_percent > 100) {
+        ui_display_error("Invalid percentage.");
+        return;
+    }
+    
+    printf("Tiers A + B share of value in %% (e.g. 95): ");
+    if (!read_integer(&b_percent) || b_percent < a_percent || b_percent > 100) {
+        ui_display_error("Invalid percentage.");
+        return;
+    }
+    
+    printf("Number of ranked products to list (0 for totals only): ");
+    if (!read_integer(&limit) || limit < 0) {
+        ui_display_error("Invalid number.");
+        return;
+    }
+    
+    // The cached result is the summary followed by all ranked rows
+    ReportCacheKey key = report_key(snap, REPORT_KIND_ABC, a_percent, b_percent);
+    size_t size;
+    const unsigned char *cached = report_cache_get(&report_cache, &key, &size);
+    int count;
+    if (cached != NULL) {
+        memcpy(&summary, cached, sizeof(AbcSummary));
+        count = (int)((size - sizeof(AbcSummary)) / sizeof(AbcRow));
+        memcpy(rows, cached + sizeof(AbcSummary), size - sizeof(AbcSummary));
+        printf("\n(cached result; report cache: %ld hits, %ld misses)\n",
+               report_cache.hits, report_cache.misses);
+    } else {
+        count = report_abc_classification(snap->products, a_percent / 100.0, b_percent / 100.0,
+                                          rows, MAX_PRODUCTS, &summary);
+        size = sizeof(AbcSummary) + sizeof(AbcRow) * (size_t)count;
+        unsigned char *blob = malloc(size);
+        if (blob != NULL) {
+            memcpy(blob, &summary, sizeof(AbcSummary));
+            memcpy(blob + sizeof(AbcSummary), rows, sizeof(AbcRow) * (size_t)count);
+            report_cache_put(&report_cache, &key, blob, size);
+            free(blob);
+        }
+    }
+    
+    printf("\n%-6s %10s %16s %10s\n", "Tier", "Products", "Value", "Share");
+    print_separator(45, '-');
+    for (int t = 0; t < 3; t++) {
+        double share = (summary.total_value > 0.0) ? summary.value[t] * 100.0 / summary.total_value : 0.0;
+        printf("%-6s %10d %16.2f %9.1f%%\n", tiers[t], summary.products[t], summary.value[t], share);
+    }
+    
+    if (limit > count) limit = count;
+    if (limit > 0) {
+        printf("\n%-6s %-6s %-30s %14s %12s\n", "Tier", "ID", "Name", "Value", "Cumulative");
+        print_separator(72, '-');
+        for (int i = 0; i < limit; i++) {
+            Product *p = product_find_by_id(&products, rows[i].product_id);
+            printf("%-6c %-6d %-30.30s %14.2f %11.1f%%\n", rows[i].tier, rows[i].product_id,
+                   (p != NULL) ? p->name : "(deleted)", rows[i].value,
+                   rows[i].cumulative_share * 100.0);
+        }
+    }
+}
+
 /**
  * @brief Handle reports menu
  */
 void handle_reports(void) {
     int choice;
-    Product top_products[MAX_PRODUCTS];
+    static Product top_products[MAX_PRODUCTS];
     int count;
     char start_date[11], end_date[11];
-    Transaction date_trans[MAX_TRANSACTIONS];
+    static Transaction date_trans[MAX_TRANSACTIONS];
+    ReportCacheKey key;
+    double value;
     
     while (1) {
         ui_display_reports_menu();
@@ -489,14 +1309,20 @@ void handle_reports(void) {
             continue;
         }
         
+        Snapshot *snap = pin_report_snapshot();
         switch (choice) {
             case 1:  // Total Products
-                printf("\nTotal number of products: %d\n", report_total_products(&products));
+                printf("\nTotal number of products: %d\n", report_total_products(snap->products));
                 pause_screen();
                 break;
                 
             case 2:  // Total Stock Value
-                printf("\nTotal stock value: $%.2f\n", report_total_stock_value(&products));
+                key = report_key(snap, REPORT_KIND_TOTAL_VALUE, 0, 0);
+                if (cached_rows(&key, &value, sizeof(double)) < 0) {
+                    value = report_total_stock_value(snap->products);
+                    remember_rows(&key, &value, 1, sizeof(double));
+                }
+                printf("\nTotal stock value: $%.2f\n", value);
                 pause_screen();
                 break;
                 
@@ -504,16 +1330,13 @@ void handle_reports(void) {
                 printf("Enter number of top products to show: ");
                 int n;
                 if (read_integer(&n) && n > 0) {
-                    count = report_top_products_by_quantity(&products, top_products, n);
-                    if (count > 0) {
-                        ProductList temp_list = {0};
-                        for (int i = 0; i < count; i++) {
-                            product_add(&temp_list, &top_products[i]);
-                        }
-                        ui_display_products_table(&temp_list);
-                    } else {
-                        printf("\nNo products found.\n");
+                    key = report_key(snap, REPORT_KIND_TOP_QUANTITY, n, 0);
+                    count = cached_rows(&key, top_products, sizeof(Product));
+                    if (count < 0) {
+                        count = report_top_products_by_quantity(snap->products, top_products, n);
+                        remember_rows(&key, top_products, count, sizeof(Product));
                     }
+                    display_product_results(top_products, count, "No products found.");
                 } else {
                     ui_display_error("Invalid number.");
                 }
@@ -523,16 +1346,13 @@ void handle_reports(void) {
             case 4:  // Top Products by Value
                 printf("Enter number of top products to show: ");
                 if (read_integer(&n) && n > 0) {
-                    count = report_top_products_by_value(&products, top_products, n);
-                    if (count > 0) {
-                        ProductList temp_list = {0};
-                        for (int i = 0; i < count; i++) {
-                            product_add(&temp_list, &top_products[i]);
-                        }
-                        ui_display_products_table(&temp_list);
-                    } else {
-                        printf("\nNo products found.\n");
+                    key = report_key(snap, REPORT_KIND_TOP_VALUE, n, 0);
+                    count = cached_rows(&key, top_products, sizeof(Product));
+                    if (count < 0) {
+                        count = report_top_products_by_value(snap->products, top_products, n);
+                        remember_rows(&key, top_products, count, sizeof(Product));
                     }
+                    display_product_results(top_products, count, "No products found.");
                 } else {
                     ui_display_error("Invalid number.");
                 }
@@ -540,16 +1360,13 @@ void handle_reports(void) {
                 break;
                 
             case 5:  // Low Stock Products
-                count = report_low_stock_products(&products, top_products, MAX_PRODUCTS);
-                if (count > 0) {
-                    ProductList temp_list = {0};
-                    for (int i = 0; i < count; i++) {
-                        product_add(&temp_list, &top_products[i]);
-                    }
-                    ui_display_products_table(&temp_list);
-                } else {
-                    printf("\nNo low stock products.\n");
+                key = report_key(snap, REPORT_KIND_LOW_STOCK, 0, 0);
+                count = cached_rows(&key, top_products, sizeof(Product));
+                if (count < 0) {
+                    count = report_low_stock_products(snap->products, top_products, MAX_PRODUCTS);
+                    remember_rows(&key, top_products, count, sizeof(Product));
                 }
+                display_product_results(top_products, count, "No low stock products.");
                 pause_screen();
                 break;
                 
@@ -566,8 +1383,24 @@ void handle_reports(void) {
                     break;
                 }
                 
-                count = transaction_get_by_date_range(&transactions, start_date, end_date,
-                                                      date_trans, MAX_TRANSACTIONS);
+                // Only well-formed dates have a stable key
+                int first_day, last_day;
+                if (date_to_days(start_date, &first_day) && date_to_days(end_date, &last_day)) {
+                    key = report_key(snap, REPORT_KIND_DATE_RANGE, first_day, last_day);
+                    count = cached_rows(&key, date_trans, sizeof(Transaction));
+                    if (count < 0) {
+                        count = transaction_get_by_date_range_prefix(snap->transactions,
+                                                                     snap->transaction_count,
+                                                                     start_date, end_date,
+                                                                     date_trans, MAX_TRANSACTIONS);
+                        remember_rows(&key, date_trans, count, sizeof(Transaction));
+                    }
+                } else {
+                    count = transaction_get_by_date_range_prefix(snap->transactions,
+                                                                 snap->transaction_count,
+                                                                 start_date, end_date,
+                                                                 date_trans, MAX_TRANSACTIONS);
+                }
                 if (count > 0) {
                     ui_display_transactions_table(date_trans, count);
                 } else {
@@ -576,13 +1409,55 @@ void handle_reports(void) {
                 pause_screen();
                 break;
                 
-            case 7:  // Back
+            case 7:  // Weekly Movement by Category
+                show_weekly_category_movement();
+                pause_screen();
+                break;
+                
+            case 8:  // Stock Velocity & Turnover
+                show_stock_velocity(snap);
+                pause_screen();
+                break;
+                
+            case 9:  // Reorder Suggestions by Supplier
+                show_reorder_suggestions(snap);
+                pause_screen();
+                break;
+                
+            case 10:  // Stock as of Date
+                show_stock_as_of(snap);
+                pause_screen();
+                break;
+                
+            case 11:  // Stock by Category or Supplier
+                show_grouped_stock(snap);
+                pause_screen();
+                break;
+                
+            case 12:  // Inventory Dashboard
+                show_dashboard(snap);
+                pause_screen();
+                break;
+                
+            case 13:  // Movement Sketches
+                show_movement_sketches(snap);
+                pause_screen();
+                break;
+                
+            case 14:  // ABC Classification
+                show_abc_classification(snap);
+                pause_screen();
+                break;
+                
+            case 15:  // Back
+                snapshot_release(snap);
                 return;
                 
             default:
                 ui_display_error("Invalid choice.");
                 break;
         }
+        snapshot_release(snap);
     }
 }
 
@@ -591,7 +1466,7 @@ void handle_reports(void) {
  */
 void handle_staff_menu(void) {
     int choice;
-    Product search_results[MAX_PRODUCTS];
+    static Product search_results[MAX_PRODUCTS];
     int search_count;
     char name[100];
     
@@ -604,24 +1479,13 @@ void handle_staff_menu(void) {
         
         switch (choice) {
             case 1:  // View Products
-                ui_display_products_table(&products);
-                pause_screen();
+                browse_table(VIEW_PRODUCTS, 0);
                 break;
                 
             case 2:  // Search Products
                 printf("Enter product name (partial match): ");
                 if (read_string(name, sizeof(name))) {
-                    search_count = product_find_by_name(&products, name,
-                                                       search_results, MAX_PRODUCTS);
-                    if (search_count > 0) {
-                        ProductList temp_list = {0};
-                        for (int i = 0; i < search_count; i++) {
-                            product_add(&temp_list, &search_results[i]);
-                        }
-                        ui_display_products_table(&temp_list);
-                    } else {
-                        printf("\nNo products found.\n");
-                    }
+                    search_products_by_name(name);
                     pause_screen();
                 }
                 break;
@@ -632,19 +1496,74 @@ void handle_staff_menu(void) {
                 
             case 4:  // Low Stock Products
                 search_count = product_get_low_stock(&products, search_results, MAX_PRODUCTS);
-                if (search_count > 0) {
-                    ProductList temp_list = {0};
-                    for (int i = 0; i < search_count; i++) {
-                        product_add(&temp_list, &search_results[i]);
-                    }
-                    ui_display_products_table(&temp_list);
-                } else {
-                    printf("\nNo low stock products.\n");
-                }
+                display_product_results(search_results, search_count, "No low stock products.");
                 pause_screen();
                 break;
                 
-            case 5:  // Logout
+            case 5:  // Quick Find
+                quick_find();
+                break;
+                
+            case 6:  // Logout
+                return;
+                
+            default:
+                ui_display_error("Invalid choice.");
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Show latency figures for the instrumented operations
+ */
+void show_performance_stats(void) {
+    int choice;
+    
+    while (1) {
+        ui_clear_screen();
+        ui_display_header("PERFORMANCE STATISTICS");
+        
+        int shown = 0;
+        printf("%-28s %9s %11s %11s %11s %11s\n", "Operation", "Calls", "Mean (us)",
+               "p50 (us)", "p99 (us)", "Max (us)");
+        print_separator(86, '-');
+        for (int id = 0; id < METRIC_COUNT; id++) {
+            MetricSummary s;
+            if (!metrics_summary((MetricId)id, &s)) continue;
+            printf("%-28s %9llu %11.1f %11.1f %11.1f %11.1f\n", s.name, s.count, s.mean_us,
+                   s.p50_us, s.p99_us, s.max_us);
+            shown++;
+        }
+        if (shown == 0) {
+            printf("No operations recorded yet.\n");
+        }
+        
+        printf("\nRecording is %s.\n", metrics_enabled() ? "on" : "off");
+        printf("\n1. Refresh\n");
+        printf("2. Reset Statistics\n");
+        printf("3. Turn Recording %s\n", metrics_enabled() ? "Off" : "On");
+        printf("4. Back\n");
+        printf("Enter choice: ");
+        if (!read_integer(&choice)) {
+            ui_display_error("Invalid input.");
+            continue;
+        }
+        
+        switch (choice) {
+            case 1:
+                break;
+                
+            case 2:
+                metrics_reset();
+                ui_display_success("Statistics reset.");
+                break;
+                
+            case 3:
+                metrics_set_enabled(!metrics_enabled());
+                break;
+                
+            case 4:
                 return;
                 
             default:
@@ -724,7 +1643,11 @@ void handle_admin_menu(void) {
                 }
                 break;
                 
-            case 6:  // Logout
+            case 6:  // Performance Statistics
+                show_performance_stats();
+                break;
+                
+            case 7:  // Logout
                 return;
                 
             default:
@@ -734,18 +1657,309 @@ void handle_admin_menu(void) {
     }
 }
 
+/**
+ * @brief Print command-line usage
+ * @param program Program name (argv[0])
+ */
+void print_usage(const char *program) {
+    printf("Usage: %s [options]\n", program);
+    printf("  (no options)          Start the interactive menu\n");
+    printf("  --batch <file|->      Run batch commands from a file or stdin\n");
+    printf("  --save-every <n>      In batch mode, save after every n changes\n");
+    printf("                        (default: save once at the end)\n");
+    printf("  --quiet               In batch mode, print only errors and queries\n");
+    printf("  --import <file>       Validate and apply a stock-movement file\n");
+    printf("                        (rows: product_id|type|quantity|notes)\n");
+    printf("  --strict              With --import, apply nothing if any row fails\n");
+    printf("  --report <file>       With --import, write the per-row report here\n");
+    printf("  --shards <n>          With --batch, use a store split into n shards\n");
+    printf("                        (1-%d; the data files are split on first use)\n",
+           MAX_SHARDS);
+    printf("  --shard-dir <dir>     Directory of the shard files (default %s)\n", SHARD_DIR);
+    printf("  --sketches            Keep approximate movement sketches (large logs)\n");
+    printf("  --export <file>       Write transactions to a columnar file for analytics\n");
+    printf("                        (streams the data file; any history size)\n");
+    printf("  --stats-file <file>   Write operation latency statistics to a file\n");
+    printf("                        periodically and at exit\n");
+    printf("  --stats-interval <s>  Seconds between statistics writes (default %d)\n",
+           METRICS_DEFAULT_INTERVAL);
+    printf("  --no-metrics          Do not time operations\n");
+    printf("  --startup-profile     Print the time, bytes and rows of each startup\n");
+    printf("                        phase to stderr (without --batch or --import,\n");
+    printf("                        exit instead of starting the menu)\n");
+    printf("  --startup-profile-file <file>\n");
+    printf("                        Append the startup profile to a file\n");
+    printf("  --help                Show this message\n");
+}
+
+/**
+ * @brief Run batch mode against the loaded data
+ * @param path Command file ("-" for stdin)
+ * @param save_interval Save every N mutating commands (0 = at end)
+ * @param quiet 1 to suppress per-command OK lines
+ * @return Process exit code
+ */
+int run_batch_mode(const char *path, int save_interval, int quiet) {
+    BatchContext ctx;
+    BatchSummary summary = {0};
+    
+    batch_context_init(&ctx, &products, &suppliers, &transactions);
+    ctx.forecasts = &forecasts;
+    ctx.history = &history;
+    ctx.filter_index = &filter_index;
+    ctx.sketches = &sketches;
+    ctx.trie = &product_trie;
+    ctx.fuzzy = &fuzzy_index;
+    ctx.save_interval = save_interval;
+    ctx.quiet = quiet;
+    
+    int ok = batch_run_file(&ctx, path, &summary);
+    if (summary.processed == 0 && !ok) {
+        fprintf(stderr, "Cannot read batch input: %s\n", path);
+        return 2;
+    }
+    
+    fprintf(stderr, "Batch complete: %d commands, %d succeeded, %d failed, %d saves\n",
+            summary.processed, summary.succeeded, summary.failed, summary.saves);
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Run batch mode against a sharded store
+ *
+ * Each shard is loaded from <shard_dir>/<k>/. When the shards hold no
+ * products yet, the data files are split into them and saved at once;
+ * the product and transaction lists then only hold the catalogue that
+ * the reports gather from the shards.
+ *
+ * @param path Command file ("-" for stdin)
+ * @param shard_count Number of shards
+ * @param shard_dir Directory of the shard files
+ * @param save_interval Save every N mutating commands (0 = at end)
+ * @param quiet 1 to suppress per-command OK lines
+ * @return Process exit code
+ */
+int run_sharded_batch_mode(const char *path, int shard_count, const char *shard_dir,
+                           int save_interval, int quiet) {
+    ShardedStore store;
+    BatchContext ctx;
+    BatchSummary summary = {0};
+    int shard_products;
+    
+    storage_init_directories();
+    storage_load_suppliers(&suppliers, NULL);
+    if (!shard_store_init(&store, shard_count)) {
+        fprintf(stderr, "Cannot create %d shards\n", shard_count);
+        return 2;
+    }
+    if (!shard_store_load(&store, shard_dir)) {
+        fprintf(stderr, "Cannot load %d shards from %s (saved with another shard count?)\n",
+                shard_count, shard_dir);
+        shard_store_free(&store);
+        return 2;
+    }
+    
+    shard_store_counts(&store, &shard_products, NULL);
+    if (shard_products == 0) {
+        storage_load_products(&products, NULL);
+        storage_load_transactions(&transactions, NULL);
+        if (!shard_store_import(&store, &products, &transactions) ||
+            !shard_store_save(&store, shard_dir)) {
+            fprintf(stderr, "Cannot split the data files into %s\n", shard_dir);
+            shard_store_free(&store);
+            return 2;
+        }
+    }
+    
+    pool_start(0);
+    batch_context_init(&ctx, &products, &suppliers, &transactions);
+    ctx.shards = &store;
+    ctx.shard_dir = shard_dir;
+    ctx.save_interval = save_interval;
+    ctx.quiet = quiet;
+    
+    int ok = batch_run_file(&ctx, path, &summary);
+    pool_stop();
+    shard_store_free(&store);
+    if (summary.processed == 0 && !ok) {
+        fprintf(stderr, "Cannot read batch input: %s\n", path);
+        return 2;
+    }
+    
+    fprintf(stderr, "Batch complete: %d commands, %d succeeded, %d failed, %d saves\n",
+            summary.processed, summary.succeeded, summary.failed, summary.saves);
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Run a bulk stock-movement import and save once
+ * @param path Movement file
+ * @param strict 1 to apply nothing if any row is rejected
+ * @param report_path Per-row report destination (NULL for stdout)
+ * @return Process exit code
+ */
+int run_import_mode(const char *path, int strict, const char *report_path) {
+    BatchContext ctx;
+    ImportSummary summary = {0};
+    FILE *report = stdout;
+    
+    if (report_path != NULL) {
+        report = fopen(report_path, "w");
+        if (report == NULL) {
+            fprintf(stderr, "Cannot write report: %s\n", report_path);
+            return 2;
+        }
+    }
+    
+    batch_context_init(&ctx, &products, &suppliers, &transactions);
+    ctx.forecasts = &forecasts;
+    ctx.history = &history;
+    ctx.filter_index = &filter_index;
+    ctx.sketches = &sketches;
+    ctx.trie = &product_trie;
+    ctx.fuzzy = &fuzzy_index;
+    int ok = batch_import_movements(&ctx, path, strict, report, &summary);
+    if (report != stdout) {
+        fclose(report);
+    }
+    if (!ok) {
+        fprintf(stderr, "Cannot import: %s\n", path);
+        return 2;
+    }
+    
+    if (summary.applied > 0) {
+        save_all_data();
+    }
+    
+    fprintf(stderr, "Import complete: %d rows, %d accepted, %d rejected, %d applied\n",
+            summary.rows, summary.accepted, summary.rejected, summary.applied);
+    return (summary.rejected == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Stream the transactions file into a columnar export
+ * @param path Output file
+ * @return Process exit code
+ */
+int run_export_mode(const char *path) {
+    ExportStats stats;
+    
+    storage_load_products(&products, NULL);
+    if (!export_transactions_file(path, &products, TRANSACTIONS_FILE, &stats)) {
+        fprintf(stderr, "Cannot export to: %s\n", path);
+        return 2;
+    }
+    
+    fprintf(stderr, "Export complete: %ld rows in %d row groups, %lld bytes\n",
+            stats.rows, stats.row_groups, stats.bytes);
+    return 0;
+}
+
+/**
+ * @brief Print and/or save the startup profile
+ * @param print Whether to print it to stderr
+ * @param path File to append it to, or NULL
+ */
+void report_startup_profile(int print, const char *path) {
+    if (print) {
+        startup_profile_print(&startup, stderr);
+    }
+    if (path != NULL && !startup_profile_write_file(&startup, path)) {
+        fprintf(stderr, "Cannot write startup profile to: %s\n", path);
+    }
+}
+
 /**
  * @brief Main function
  */
-int main(void) {
+int main(int argc, char *argv[]) {
+    const char *batch_path = NULL;
+    const char *import_path = NULL;
+    const char *report_path = NULL;
+    const char *export_path = NULL;
+    const char *stats_path = NULL;
+    const char *startup_path = NULL;
+    int startup_print = 0;
+    int stats_interval = METRICS_DEFAULT_INTERVAL;
+    const char *shard_dir = SHARD_DIR;
+    int shard_count = 0;
+    int save_interval = 0;
+    int quiet = 0;
+    int strict = 0;
+    
+    // Parse command-line options
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[++i];
+        } else if (strcmp(argv[i], "--save-every") == 0 && i + 1 < argc) {
+            save_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "--import") == 0 && i + 1 < argc) {
+            import_path = argv[++i];
+        } else if (strcmp(argv[i], "--strict") == 0) {
+            strict = 1;
+        } else if (strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+            report_path = argv[++i];
+        } else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            shard_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--shard-dir") == 0 && i + 1 < argc) {
+            shard_dir = argv[++i];
+        } else if (strcmp(argv[i], "--sketches") == 0) {
+            sketches_enabled = 1;
+        } else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+            export_path = argv[++i];
+        } else if (strcmp(argv[i], "--stats-file") == 0 && i + 1 < argc) {
+            stats_path = argv[++i];
+        } else if (strcmp(argv[i], "--stats-interval") == 0 && i + 1 < argc) {
+            stats_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--no-metrics") == 0) {
+            metrics_set_enabled(0);
+        } else if (strcmp(argv[i], "--startup-profile") == 0) {
+            startup_print = 1;
+        } else if (strcmp(argv[i], "--startup-profile-file") == 0 && i + 1 < argc) {
+            startup_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return (strcmp(argv[i], "--help") == 0) ? 0 : 2;
+        }
+    }
+    
+    if (stats_path != NULL && !metrics_start_dump(stats_path, stats_interval)) {
+        fprintf(stderr, "Cannot write statistics every %d s to: %s\n", stats_interval, stats_path);
+        return 2;
+    }
+    
+    if (shard_count != 0 && (batch_path == NULL || shard_count < 1 || shard_count > MAX_SHARDS)) {
+        fprintf(stderr, "--shards takes 1-%d and needs --batch\n", MAX_SHARDS);
+        return 2;
+    }
+    
+    // The export reads the transactions file directly, so the log is never loaded
+    if (export_path != NULL) {
+        return run_export_mode(export_path);
+    }
+    
+    // A sharded batch loads the shards instead of the data files
+    if (shard_count > 0) {
+        return run_sharded_batch_mode(batch_path, shard_count, shard_dir, save_interval, quiet);
+    }
+    
     // Initialize session
     session_init(&session);
     
     // Load all data
     load_all_data();
     
-    // Create default admin user if no users exist
-    if (users.count == 0) {
+    // Worker threads for reports over large lists
+    pool_start(0);
+    startup_profile_mark(&startup, "init.workers", NULL);
+    snapshot_store_init(&snapshots, &products, &transactions);
+    report_cache_init(&report_cache, 0);
+    startup_profile_mark(&startup, "init.caches", NULL);
+    
+    // Create default admin user if no users exist (not for batch or import runs)
+    if (batch_path == NULL && import_path == NULL && users.count == 0) {
         User admin = {0};
         strcpy(admin.username, "admin");
         hash_password("admin123", admin.password_hash);
@@ -760,6 +1974,20 @@ int main(void) {
         user_add(&users, &staff);
         
         storage_save_users(&users);
+        startup_profile_mark(&startup, "init.default_users", NULL);
+    }
+    report_startup_profile(startup_print, startup_path);
+    
+    if (batch_path != NULL) {
+        return run_batch_mode(batch_path, save_interval, quiet);
+    }
+    if (import_path != NULL) {
+        return run_import_mode(import_path, strict, report_path);
+    }
+    
+    // The menu would clear the printed profile, so a profiling run stops here
+    if (startup_print) {
+        return 0;
     }
     
     // Main application loop
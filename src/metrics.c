@@ -0,0 +1,280 @@
+/**
+ * @file metrics.c
+ * @brief Implementation of per-operation latency histograms
+ */
+
+#include "metrics.h"
+#include "sync.h"
+#include "utils.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define METRICS_DUMP_TICK_MS 200    // Stop-flag polling interval of the dump thread
+
+static const char *const metric_names[METRIC_COUNT] = {
+    "storage.load_products",
+    "storage.save_products",
+    "storage.load_suppliers",
+    "storage.save_suppliers",
+    "storage.load_transactions",
+    "storage.save_transactions",
+    "storage.load_users",
+    "storage.save_users",
+    "storage.load_forecasts",
+    "storage.save_forecasts",
+    "storage.load_movements",
+    "stock.move",
+    "stock.engine_move",
+    "stock.shard_move",
+    "stock.apply_movements",
+    "search.name",
+    "search.category",
+    "search.complete",
+    "search.fuzzy",
+    "search.filter_products",
+    "search.filter_transactions",
+    "report.total_products",
+    "report.stock_value",
+    "report.top_quantity",
+    "report.top_value",
+    "report.low_stock",
+    "report.count_by_date",
+    "report.velocity",
+    "report.dashboard",
+    "report.group_stock",
+    "report.abc",
+    "report.reorder_suggestions",
+    "report.stock_as_of",
+    "report.all_as_of",
+    "report.sketch_distinct",
+    "report.sketch_quantile",
+    "report.sketch_top_sellers",
+    "report.rollup_weeks"
+};
+
+static LatencyHistogram histograms[METRIC_COUNT];
+static atomic_int metrics_on = 1;
+
+static char dump_path[512];
+static int dump_interval;
+static atomic_int dump_stop;
+static int dump_running;
+static Thread dump_thread;
+
+// Bucket of a value: values below 2^SUB_BITS map to themselves, larger
+// values to their top SUB_BITS + 1 significant bits
+static int bucket_of(unsigned long long value) {
+    if (value >= (1ULL << METRICS_MAX_BITS)) value = (1ULL << METRICS_MAX_BITS) - 1;
+    if (value < (1ULL << METRICS_SUB_BITS)) return (int)value;
+    
+    int top = 0;
+    for (int step = 32; step > 0; step /= 2) {
+        if (value >> (top + step)) top += step;
+    }
+    int shift = top - METRICS_SUB_BITS;
+    return ((shift + 1) << METRICS_SUB_BITS) |
+           (int)((value >> shift) & ((1ULL << METRICS_SUB_BITS) - 1));
+}
+
+// Largest value that falls in a bucket
+static unsigned long long bucket_upper(int bucket) {
+    int shift = (bucket >> METRICS_SUB_BITS) - 1;
+    if (shift < 0) return (unsigned long long)bucket;
+    
+    unsigned long long mantissa = (1ULL << METRICS_SUB_BITS) |
+                                  (unsigned long long)(bucket & ((1 << METRICS_SUB_BITS) - 1));
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void metrics_set_enabled(int enabled) {
+    atomic_store_explicit(&metrics_on, enabled ? 1 : 0, memory_order_relaxed);
+}
+
+int metrics_enabled(void) {
+    return atomic_load_explicit(&metrics_on, memory_order_relaxed);
+}
+
+MetricTimer metrics_start(void) {
+    if (!atomic_load_explicit(&metrics_on, memory_order_relaxed)) return 0;
+    return sync_clock_ns() | 1;  // Never 0, which means "not timed"
+}
+
+void metrics_stop(MetricId id, MetricTimer start) {
+    if (start == 0) return;
+    unsigned long long now = sync_clock_ns();
+    metrics_record(id, (now > start) ? now - start : 0);
+}
+
+// Raise a maximum to value unless it is already higher
+static void raise_max(atomic_ullong *max_ns, unsigned long long value) {
+    unsigned long long max = atomic_load_explicit(max_ns, memory_order_relaxed);
+    while (value > max &&
+           !atomic_compare_exchange_weak_explicit(max_ns, &max, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void metrics_histogram_record(LatencyHistogram *histogram, unsigned long long nanoseconds) {
+    if (histogram == NULL) return;
+    
+    atomic_fetch_add_explicit(&histogram->buckets[bucket_of(nanoseconds)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->total_ns, nanoseconds, memory_order_relaxed);
+    raise_max(&histogram->max_ns, nanoseconds);
+}
+
+void metrics_record(MetricId id, unsigned long long nanoseconds) {
+    if ((int)id < 0 || id >= METRIC_COUNT) return;
+    metrics_histogram_record(&histograms[id], nanoseconds);
+}
+
+int metrics_histogram_summary(const LatencyHistogram *histogram, MetricSummary *summary) {
+    if (histogram == NULL || summary == NULL) return 0;
+    const LatencyHistogram *h = histogram;
+    
+    // Copy the counts once, so the percentiles agree with each other while
+    // other threads keep recording
+    static const double ranks[3] = {0.50, 0.90, 0.99};
+    unsigned long long counts[METRICS_BUCKETS];
+    unsigned long long count = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        counts[b] = atomic_load_explicit(&h->buckets[b], memory_order_relaxed);
+        count += counts[b];
+    }
+    unsigned long long max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    
+    memset(summary, 0, sizeof(*summary));
+    summary->count = count;
+    if (count == 0) return 0;
+    
+    double values[3];
+    int r = 0, b = 0;
+    unsigned long long seen = 0;
+    for (; r < 3; r++) {
+        // Nearest rank: the smallest value with at least rank * count calls at or below it
+        unsigned long long target = (unsigned long long)(ranks[r] * (double)count + 0.999999);
+        if (target < 1) target = 1;
+        while (b < METRICS_BUCKETS && seen + counts[b] < target) seen += counts[b++];
+        unsigned long long upper = (b < METRICS_BUCKETS) ? bucket_upper(b) : max;
+        values[r] = (double)(upper < max ? upper : max) / 1e3;
+    }
+    
+    summary->mean_us = (double)atomic_load_explicit(&h->total_ns, memory_order_relaxed) /
+                       (double)count / 1e3;
+    summary->p50_us = values[0];
+    summary->p90_us = values[1];
+    summary->p99_us = values[2];
+    summary->max_us = (double)max / 1e3;
+    return 1;
+}
+
+int metrics_summary(MetricId id, MetricSummary *summary) {
+    if ((int)id < 0 || id >= METRIC_COUNT || summary == NULL) return 0;
+    
+    int recorded = metrics_histogram_summary(&histograms[id], summary);
+    summary->name = metric_names[id];
+    return recorded;
+}
+
+void metrics_histogram_merge(LatencyHistogram *into, const LatencyHistogram *from) {
+    if (into == NULL || from == NULL) return;
+    
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        unsigned long long count = atomic_load_explicit(&from->buckets[b], memory_order_relaxed);
+        if (count != 0) atomic_fetch_add_explicit(&into->buckets[b], count, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&into->total_ns,
+                              atomic_load_explicit(&from->total_ns, memory_order_relaxed),
+                              memory_order_relaxed);
+    raise_max(&into->max_ns, atomic_load_explicit(&from->max_ns, memory_order_relaxed));
+}
+
+void metrics_histogram_reset(LatencyHistogram *histogram) {
+    if (histogram == NULL) return;
+    
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        atomic_store_explicit(&histogram->buckets[b], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->total_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max_ns, 0, memory_order_relaxed);
+}
+
+void metrics_reset(void) {
+    for (int id = 0; id < METRIC_COUNT; id++) {
+        metrics_histogram_reset(&histograms[id]);
+    }
+}
+
+int metrics_write(FILE *out) {
+    if (out == NULL) return 0;
+    
+    int written = 0;
+    fprintf(out, "operation|count|mean_us|p50_us|p90_us|p99_us|max_us\n");
+    for (int id = 0; id < METRIC_COUNT; id++) {
+        MetricSummary s;
+        if (!metrics_summary((MetricId)id, &s)) continue;
+        fprintf(out, "%s|%llu|%.1f|%.1f|%.1f|%.1f|%.1f\n", s.name, s.count, s.mean_us,
+                s.p50_us, s.p90_us, s.p99_us, s.max_us);
+        written++;
+    }
+    return written;
+}
+
+int metrics_write_file(const char *path) {
+    if (path == NULL) return 0;
+    
+    // Write beside the target and rename, so readers never see half a table
+    char temp[520];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    FILE *file = fopen(temp, "w");
+    if (file == NULL) return 0;
+    
+    char now[30];
+    get_current_datetime(now, sizeof(now));
+    fprintf(file, "# metrics %s%s\n", now, metrics_enabled() ? "" : " (recording off)");
+    metrics_write(file);
+    if (fclose(file) != 0) {
+        remove(temp);
+        return 0;
+    }
+#ifdef _WIN32
+    remove(path);  // rename does not replace on Windows
+#endif
+    return rename(temp, path) == 0;
+}
+
+static void dump_loop(void *arg) {
+    (void)arg;
+    unsigned long long interval_ns = (unsigned long long)dump_interval * 1000000000ULL;
+    unsigned long long next = sync_clock_ns() + interval_ns;
+    
+    while (!atomic_load(&dump_stop)) {
+        thread_sleep_ms(METRICS_DUMP_TICK_MS);
+        if (sync_clock_ns() >= next) {
+            metrics_write_file(dump_path);
+            next += interval_ns;
+        }
+    }
+}
+
+int metrics_start_dump(const char *path, int interval_seconds) {
+    if (path == NULL || interval_seconds <= 0 || dump_running) return 0;
+    
+    snprintf(dump_path, sizeof(dump_path), "%s", path);
+    dump_interval = interval_seconds;
+    atomic_store(&dump_stop, 0);
+    if (!thread_start(&dump_thread, dump_loop, NULL)) return 0;
+    
+    dump_running = 1;
+    atexit(metrics_stop_dump);
+    return 1;
+}
+
+void metrics_stop_dump(void) {
+    if (!dump_running) return;
+    
+    atomic_store(&dump_stop, 1);
+    thread_join(dump_thread);
+    dump_running = 0;
+    metrics_write_file(dump_path);
+}
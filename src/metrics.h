@@ -0,0 +1,218 @@
+/**
+ * @file metrics.h
+ * @brief Per-operation latency histograms for the hot paths
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Storage loads and saves, stock movements, searches and reports time
+ * themselves into one histogram per operation. Histograms are log-linear
+ * (as in HdrHistogram): each power of two of nanoseconds is split into
+ * 2^METRICS_SUB_BITS equal buckets, so any recorded value is known to
+ * within about 3% whatever its size, in a fixed table of counters.
+ *
+ * Recording is lock-free (relaxed atomic increments), so any thread may
+ * record at any time. When metrics are disabled, metrics_start returns 0
+ * without reading the clock and metrics_stop returns at once.
+ *
+ * Usage:
+ *   MetricTimer timer = metrics_start();
+ *   ... operation ...
+ *   metrics_stop(METRIC_REPORT_DASHBOARD, timer);
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define METRICS_SUB_BITS 5          // 32 buckets per power of two (values within 1/32)
+#define METRICS_MAX_BITS 40         // Largest value 2^40 ns (about 18 minutes)
+#define METRICS_BUCKETS ((METRICS_MAX_BITS - METRICS_SUB_BITS + 1) << METRICS_SUB_BITS)
+#define METRICS_DEFAULT_INTERVAL 60 // Seconds between periodic dumps
+
+/**
+ * @brief Instrumented operations
+ */
+typedef enum {
+    METRIC_LOAD_PRODUCTS,
+    METRIC_SAVE_PRODUCTS,
+    METRIC_LOAD_SUPPLIERS,
+    METRIC_SAVE_SUPPLIERS,
+    METRIC_LOAD_TRANSACTIONS,
+    METRIC_SAVE_TRANSACTIONS,
+    METRIC_LOAD_USERS,
+    METRIC_SAVE_USERS,
+    METRIC_LOAD_FORECASTS,
+    METRIC_SAVE_FORECASTS,
+    METRIC_LOAD_MOVEMENTS,
+    METRIC_STOCK_MOVE,
+    METRIC_STOCK_ENGINE_MOVE,
+    METRIC_STOCK_SHARD_MOVE,
+    METRIC_STOCK_APPLY_MOVEMENTS,
+    METRIC_SEARCH_NAME,
+    METRIC_SEARCH_CATEGORY,
+    METRIC_SEARCH_COMPLETE,
+    METRIC_SEARCH_FUZZY,
+    METRIC_SEARCH_FILTER_PRODUCTS,
+    METRIC_SEARCH_FILTER_TRANSACTIONS,
+    METRIC_REPORT_TOTAL_PRODUCTS,
+    METRIC_REPORT_STOCK_VALUE,
+    METRIC_REPORT_TOP_QUANTITY,
+    METRIC_REPORT_TOP_VALUE,
+    METRIC_REPORT_LOW_STOCK,
+    METRIC_REPORT_COUNT_BY_DATE,
+    METRIC_REPORT_VELOCITY,
+    METRIC_REPORT_DASHBOARD,
+    METRIC_REPORT_GROUP_STOCK,
+    METRIC_REPORT_ABC,
+    METRIC_REPORT_REORDER,
+    METRIC_REPORT_STOCK_AS_OF,
+    METRIC_REPORT_ALL_AS_OF,
+    METRIC_REPORT_SKETCH_DISTINCT,
+    METRIC_REPORT_SKETCH_QUANTILE,
+    METRIC_REPORT_SKETCH_TOP_SELLERS,
+    METRIC_REPORT_ROLLUP_WEEKS,
+    METRIC_COUNT
+} MetricId;
+
+/**
+ * @brief Start time from metrics_start (0 when metrics are disabled)
+ */
+typedef unsigned long long MetricTimer;
+
+/**
+ * @brief Latency counters of one operation
+ *
+ * The global histograms are indexed by MetricId; callers that need their
+ * own (e.g. per thread, merged afterwards) zero one with
+ * metrics_histogram_reset and use the metrics_histogram_* functions.
+ */
+typedef struct {
+    atomic_ullong buckets[METRICS_BUCKETS];
+    atomic_ullong total_ns;
+    atomic_ullong max_ns;
+} LatencyHistogram;
+
+/**
+ * @brief Latency figures of one operation
+ */
+typedef struct {
+    const char *name;               ///< Operation name, e.g. "storage.load_products"
+    unsigned long long count;       ///< Calls recorded
+    double mean_us;                 ///< Mean latency
+    double p50_us;                  ///< Median latency
+    double p90_us;                  ///< 90th percentile
+    double p99_us;                  ///< 99th percentile
+    double max_us;                  ///< Slowest call
+} MetricSummary;
+
+/**
+ * @brief Turn recording on or off (on by default)
+ * @param enabled 1 to record, 0 to stop recording
+ */
+void metrics_set_enabled(int enabled);
+
+/**
+ * @brief Check whether recording is on
+ * @return 1 if enabled, 0 otherwise
+ */
+int metrics_enabled(void);
+
+/**
+ * @brief Start timing an operation
+ * @return Start time, or 0 when metrics are disabled
+ */
+MetricTimer metrics_start(void);
+
+/**
+ * @brief Record the time since metrics_start
+ * @param id Operation
+ * @param start Value from metrics_start (0 records nothing)
+ */
+void metrics_stop(MetricId id, MetricTimer start);
+
+/**
+ * @brief Record a latency directly
+ * @param id Operation
+ * @param nanoseconds Latency
+ */
+void metrics_record(MetricId id, unsigned long long nanoseconds);
+
+/**
+ * @brief Summarize one operation
+ * @param id Operation
+ * @param summary Output figures (percentiles are bucket upper bounds)
+ * @return 1 if the operation has been recorded, 0 otherwise
+ */
+int metrics_summary(MetricId id, MetricSummary *summary);
+
+/**
+ * @brief Clear every histogram
+ */
+void metrics_reset(void);
+
+/**
+ * @brief Record a latency into a histogram (thread-safe)
+ * @param histogram Histogram
+ * @param nanoseconds Latency
+ */
+void metrics_histogram_record(LatencyHistogram *histogram, unsigned long long nanoseconds);
+
+/**
+ * @brief Summarize a histogram
+ * @param histogram Histogram
+ * @param summary Output figures (name is left NULL)
+ * @return 1 if anything has been recorded, 0 otherwise
+ */
+int metrics_histogram_summary(const LatencyHistogram *histogram, MetricSummary *summary);
+
+/**
+ * @brief Add the counts of one histogram to another
+ * @param into Histogram to add to
+ * @param from Histogram to add
+ */
+void metrics_histogram_merge(LatencyHistogram *into, const LatencyHistogram *from);
+
+/**
+ * @brief Clear a histogram
+ * @param histogram Histogram
+ */
+void metrics_histogram_reset(LatencyHistogram *histogram);
+
+/**
+ * @brief Write a table of all recorded operations
+ *
+ * Format: operation|count|mean_us|p50_us|p90_us|p99_us|max_us, after a
+ * header line of the same shape.
+ *
+ * @param out Output stream
+ * @return Number of operations written
+ */
+int metrics_write(FILE *out);
+
+/**
+ * @brief Write the table to a file, replacing it whole
+ * @param path File to write
+ * @return 1 on success, 0 on failure
+ */
+int metrics_write_file(const char *path);
+
+/**
+ * @brief Rewrite a dump file periodically from a background thread
+ *
+ * The file is also written once more by metrics_stop_dump, which is
+ * registered with atexit.
+ *
+ * @param path File to write
+ * @param interval_seconds Seconds between dumps (> 0)
+ * @return 1 on success, 0 if the thread could not start or a dump is running
+ */
+int metrics_start_dump(const char *path, int interval_seconds);
+
+/**
+ * @brief Stop the periodic dump and write the file a final time
+ */
+void metrics_stop_dump(void);
+
+#endif /* METRICS_H */
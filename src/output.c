@@ -0,0 +1,155 @@
+/**
+ * @file output.c
+ * @brief Implementation of buffered table output
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  // write()
+#endif
+
+#include "output.h"
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static char buffer[OUTPUT_BUFFER_SIZE];
+static size_t used = 0;
+
+/**
+ * @brief Write a block to the stdout descriptor, retrying short writes
+ */
+static void write_all(const char *data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(_fileno(stdout), data, (unsigned int)size);
+#else
+        ssize_t written = write(STDOUT_FILENO, data, size);
+#endif
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) {
+            // The descriptor is unusable; let stdio report or drop the rest
+            fwrite(data, 1, size, stdout);
+            fflush(stdout);
+            return;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+}
+
+/**
+ * @brief Make room for size bytes, flushing if the buffer is too full
+ * @return 1 if the bytes fit in the buffer, 0 if they must be written directly
+ */
+static int reserve(size_t size) {
+    if (used + size <= sizeof(buffer)) return 1;
+    output_flush();
+    return size <= sizeof(buffer);
+}
+
+/**
+ * @brief Append text padded with spaces to width
+ */
+static void append_field(const char *text, size_t length, int width) {
+    size_t padding = ((int)length < width) ? (size_t)width - length : 0;
+    
+    if (!reserve(length + padding)) {
+        // Longer than the whole buffer: write the text straight through
+        fflush(stdout);
+        write_all(text, length);
+        output_repeat(' ', (int)padding);
+        return;
+    }
+    memcpy(buffer + used, text, length);
+    memset(buffer + used + length, ' ', padding);
+    used += length + padding;
+}
+
+void output_char(char c) {
+    reserve(1);
+    buffer[used++] = c;
+}
+
+void output_repeat(char c, int count) {
+    while (count > 0) {
+        int chunk = (count < (int)sizeof(buffer)) ? count : (int)sizeof(buffer);
+        reserve((size_t)chunk);
+        memset(buffer + used, c, (size_t)chunk);
+        used += (size_t)chunk;
+        count -= chunk;
+    }
+}
+
+void output_text(const char *text) {
+    if (text != NULL) append_field(text, strlen(text), 0);
+}
+
+void output_padded(const char *text, int width) {
+    append_field((text != NULL) ? text : "", (text != NULL) ? strlen(text) : 0, width);
+}
+
+/**
+ * @brief Convert an integer to decimal digits
+ * @param digits Output (at least 21 bytes), not terminated
+ * @return Number of characters
+ */
+static int format_int(long long value, char *digits) {
+    char reversed[20];
+    int count = 0;
+    // Negate in unsigned arithmetic so LLONG_MIN converts too
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value
+                                               : (unsigned long long)value;
+    
+    do {
+        reversed[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    
+    int length = 0;
+    if (value < 0) digits[length++] = '-';
+    while (count > 0) digits[length++] = reversed[--count];
+    return length;
+}
+
+void output_int(long long value, int width) {
+    char digits[24];
+    append_field(digits, (size_t)format_int(value, digits), width);
+}
+
+void output_decimal(double value, int width) {
+    char text[DBL_MAX_10_EXP + 8];  // Longest "%.2f": sign, 309 digits, point, 2 decimals
+    double scaled = value * 100.0;
+    
+    // Hand off to printf for huge or non-finite values, and where value * 100
+    // is within rounding error of a half cent, so the result always matches %.2f
+    if (!(fabs(scaled) < 1e15) ||
+        fabs(fabs(scaled - floor(scaled)) - 0.5) <= fabs(scaled) * DBL_EPSILON) {
+        int length = snprintf(text, sizeof(text), "%.2f", value);
+        append_field(text, (length > 0) ? (size_t)length : 0, width);
+        return;
+    }
+    
+    long long cents = (long long)nearbyint(fabs(scaled));
+    int length = 0;
+    if (signbit(value)) text[length++] = '-';
+    length += format_int(cents / 100, text + length);
+    text[length++] = '.';
+    text[length++] = (char)('0' + (cents / 10) % 10);
+    text[length++] = (char)('0' + cents % 10);
+    append_field(text, (size_t)length, width);
+}
+
+void output_flush(void) {
+    // Earlier printf output must reach the descriptor first
+    fflush(stdout);
+    if (used > 0) write_all(buffer, used);
+    used = 0;
+}
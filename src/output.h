@@ -0,0 +1,69 @@
+/**
+ * @file output.h
+ * @brief Buffered table output written to stdout in large blocks
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Table rows are formatted into one reusable buffer with hand-rolled
+ * integer and decimal conversion, and the buffer is handed to the OS in
+ * writes of up to OUTPUT_BUFFER_SIZE bytes. On a terminal, where stdio is
+ * line buffered, this replaces one system call per row.
+ *
+ * Text appended here is not visible until output_flush(); stdout is
+ * flushed first so printf output and buffered output keep their order.
+ * Callers flush at the end of each table.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#ifndef OUTPUT_BUFFER_SIZE
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+#endif
+
+/**
+ * @brief Append one character
+ * @param c Character
+ */
+void output_char(char c);
+
+/**
+ * @brief Append a character several times
+ * @param c Character
+ * @param count Repeat count
+ */
+void output_repeat(char c, int count);
+
+/**
+ * @brief Append a string
+ * @param text String to append
+ */
+void output_text(const char *text);
+
+/**
+ * @brief Append a string left-justified in a field (as printf "%-*s")
+ * @param text String to append (never truncated)
+ * @param width Field width
+ */
+void output_padded(const char *text, int width);
+
+/**
+ * @brief Append an integer left-justified in a field (as printf "%-*d")
+ * @param value Integer
+ * @param width Field width
+ */
+void output_int(long long value, int width);
+
+/**
+ * @brief Append a number with two decimals left-justified in a field (as printf "%-*.2f")
+ * @param value Number
+ * @param width Field width
+ */
+void output_decimal(double value, int width);
+
+/**
+ * @brief Write everything buffered to stdout
+ */
+void output_flush(void);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,254 @@
+/**
+ * @file pool.c
+ * @brief Implementation of the work-stealing thread pool
+ */
+
+#include "pool.h"
+#include "sync.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Remaining index range owned by one worker
+ */
+typedef struct {
+    Mutex lock;
+    int begin;
+    int end;
+} WorkRange;
+
+/**
+ * @brief Process-wide pool state
+ */
+static struct {
+    Thread threads[POOL_MAX_THREADS];
+    WorkRange ranges[POOL_MAX_THREADS];
+    int workers;                    ///< Workers including the caller (0 = not started)
+    Mutex lock;                     ///< Guards job_seq, pending and stopping
+    CondVar wake;                   ///< Signalled when a job is posted or on stop
+    CondVar done;                   ///< Signalled when the last worker finishes
+    unsigned long job_seq;          ///< Incremented for every posted job
+    int pending;                    ///< Helper threads still running the job
+    int stopping;
+    
+    // Current job
+    PoolRangeFunc body;
+    void *ctx;
+    char *partials;
+    size_t partial_size;
+    int grain;
+} pool;
+
+static atomic_flag pool_busy = ATOMIC_FLAG_INIT;
+
+// Take the next chunk from the front of a worker's own range
+static int take_own(int w, int *begin, int *end) {
+    WorkRange *r = &pool.ranges[w];
+    int got = 0;
+    
+    mutex_lock(&r->lock);
+    if (r->begin < r->end) {
+        *begin = r->begin;
+        *end = (r->end - r->begin > pool.grain) ? r->begin + pool.grain : r->end;
+        r->begin = *end;
+        got = 1;
+    }
+    mutex_unlock(&r->lock);
+    
+    return got;
+}
+
+// Move the back half of the fullest other range into worker w's range
+static int steal(int w) {
+    for (;;) {
+        int victim = -1;
+        int best = 0;
+        
+        for (int v = 0; v < pool.workers; v++) {
+            if (v == w) continue;
+            mutex_lock(&pool.ranges[v].lock);
+            int left = pool.ranges[v].end - pool.ranges[v].begin;
+            mutex_unlock(&pool.ranges[v].lock);
+            if (left > best) {
+                best = left;
+                victim = v;
+            }
+        }
+        if (victim < 0) return 0;
+        
+        // The victim may have drained meanwhile; rescan if so
+        WorkRange *r = &pool.ranges[victim];
+        int begin = 0;
+        int end = 0;
+        
+        mutex_lock(&r->lock);
+        if (r->begin < r->end) {
+            end = r->end;
+            begin = (end - r->begin > pool.grain) ? r->begin + (end - r->begin) / 2 : r->begin;
+            r->end = begin;
+        }
+        mutex_unlock(&r->lock);
+        
+        if (begin < end) {
+            WorkRange *own = &pool.ranges[w];
+            mutex_lock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            mutex_unlock(&own->lock);
+            return 1;
+        }
+    }
+}
+
+// Run worker w's share of the current job, stealing when idle
+static void run_job(int w) {
+    void *partial = (pool.partial_size > 0) ? pool.partials + (size_t)w * pool.partial_size : NULL;
+    int begin;
+    int end;
+    
+    do {
+        while (take_own(w, &begin, &end)) {
+            pool.body(pool.ctx, partial, begin, end);
+        }
+    } while (steal(w));
+}
+
+static void worker_main(void *arg) {
+    int w = (int)(intptr_t)arg;
+    unsigned long seen = 0;
+    
+    for (;;) {
+        mutex_lock(&pool.lock);
+        while (!pool.stopping && pool.job_seq == seen) {
+            cond_wait(&pool.wake, &pool.lock);
+        }
+        if (pool.stopping) {
+            mutex_unlock(&pool.lock);
+            return;
+        }
+        seen = pool.job_seq;
+        mutex_unlock(&pool.lock);
+        
+        run_job(w);
+        
+        mutex_lock(&pool.lock);
+        if (--pool.pending == 0) {
+            cond_broadcast(&pool.done);
+        }
+        mutex_unlock(&pool.lock);
+    }
+}
+
+int pool_start(int threads) {
+    if (pool.workers > 0) return 1;
+    
+    if (threads <= 0) threads = sync_cpu_count();
+    if (threads > POOL_MAX_THREADS) threads = POOL_MAX_THREADS;
+    if (threads < 2) return 1;  // Nothing to run in parallel
+    
+    mutex_init(&pool.lock);
+    cond_init(&pool.wake);
+    cond_init(&pool.done);
+    for (int w = 0; w < POOL_MAX_THREADS; w++) {
+        mutex_init(&pool.ranges[w].lock);
+    }
+    pool.job_seq = 0;
+    pool.stopping = 0;
+    
+    // Worker 0 is whichever thread posts the job
+    pool.workers = 1;
+    for (int w = 1; w < threads; w++) {
+        if (!thread_start(&pool.threads[w], worker_main, (void *)(intptr_t)w)) {
+            break;
+        }
+        pool.workers++;
+    }
+    
+    if (pool.workers == 1) {
+        pool_stop();
+        return 0;
+    }
+    return 1;
+}
+
+void pool_stop(void) {
+    if (pool.workers == 0) return;
+    
+    mutex_lock(&pool.lock);
+    pool.stopping = 1;
+    cond_broadcast(&pool.wake);
+    mutex_unlock(&pool.lock);
+    
+    for (int w = 1; w < pool.workers; w++) {
+        thread_join(pool.threads[w]);
+    }
+    for (int w = 0; w < POOL_MAX_THREADS; w++) {
+        mutex_destroy(&pool.ranges[w].lock);
+    }
+    cond_destroy(&pool.done);
+    cond_destroy(&pool.wake);
+    mutex_destroy(&pool.lock);
+    pool.workers = 0;
+}
+
+int pool_size(void) {
+    return (pool.workers > 0) ? pool.workers : 1;
+}
+
+void pool_parallel_reduce(int n, int grain, PoolRangeFunc body,
+                          PoolMergeFunc merge, void *ctx, void *result,
+                          size_t partial_size) {
+    if (body == NULL || n <= 0) return;
+    if (grain < 1) grain = 1;
+    
+    int workers = pool_size();
+    if (workers < 2 || n < 2 * grain || atomic_flag_test_and_set(&pool_busy)) {
+        body(ctx, result, 0, n);
+        return;
+    }
+    
+    char *partials = NULL;
+    if (partial_size > 0) {
+        partials = calloc((size_t)workers, partial_size);
+        if (partials == NULL) {
+            atomic_flag_clear(&pool_busy);
+            body(ctx, result, 0, n);
+            return;
+        }
+    }
+    
+    // Even initial split; stealing rebalances uneven chunks
+    for (int w = 0; w < workers; w++) {
+        pool.ranges[w].begin = (int)((long long)n * w / workers);
+        pool.ranges[w].end = (int)((long long)n * (w + 1) / workers);
+    }
+    pool.body = body;
+    pool.ctx = ctx;
+    pool.partials = partials;
+    pool.partial_size = partial_size;
+    pool.grain = grain;
+    
+    mutex_lock(&pool.lock);
+    pool.pending = workers - 1;
+    pool.job_seq++;
+    cond_broadcast(&pool.wake);
+    mutex_unlock(&pool.lock);
+    
+    run_job(0);
+    
+    mutex_lock(&pool.lock);
+    while (pool.pending > 0) {
+        cond_wait(&pool.done, &pool.lock);
+    }
+    mutex_unlock(&pool.lock);
+    
+    if (merge != NULL && partials != NULL) {
+        for (int w = 0; w < workers; w++) {
+            merge(ctx, result, partials + (size_t)w * partial_size);
+        }
+    }
+    
+    free(partials);
+    atomic_flag_clear(&pool_busy);
+}
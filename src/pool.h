@@ -0,0 +1,81 @@
+/**
+ * @file pool.h
+ * @brief Work-stealing thread pool with a parallel reduce
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A process-wide pool of worker threads runs one parallel job at a time.
+ * The index range of a job is split evenly across the workers; each
+ * worker consumes its own range in grain-sized chunks and, when it runs
+ * dry, steals the back half of the largest remaining range. Every worker
+ * accumulates into a private partial result, and the partials are merged
+ * in worker order once the whole range is done.
+ *
+ * The calling thread takes part as worker 0. Jobs fall back to a single
+ * serial call when the pool isn't started, the range is small, or another
+ * job is already running (so nested or concurrent calls are safe).
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+#define POOL_MAX_THREADS 64
+
+/**
+ * @brief Process a half-open index range into a partial result
+ * @param ctx Caller context
+ * @param partial This worker's partial result (zero-initialized)
+ * @param begin First index
+ * @param end One past the last index
+ */
+typedef void (*PoolRangeFunc)(void *ctx, void *partial, int begin, int end);
+
+/**
+ * @brief Fold one worker's partial result into the final result
+ * @param ctx Caller context
+ * @param result Final result
+ * @param partial Partial result to merge
+ */
+typedef void (*PoolMergeFunc)(void *ctx, void *result, const void *partial);
+
+/**
+ * @brief Start the pool
+ * @param threads Total workers including the caller (<= 0 for CPU count)
+ * @return 1 on success, 0 on failure (jobs then run serially)
+ */
+int pool_start(int threads);
+
+/**
+ * @brief Stop the pool and join its threads
+ */
+void pool_stop(void);
+
+/**
+ * @brief Get the number of workers, including the caller
+ * @return Worker count (1 when the pool isn't running)
+ */
+int pool_size(void);
+
+/**
+ * @brief Run a parallel reduce over [0, n)
+ *
+ * With a single worker, body is called once as body(ctx, result, 0, n)
+ * and merge is not called. Otherwise each worker's partial starts zeroed
+ * and is merged into result in worker order. If the partials can't be
+ * allocated the job runs serially.
+ *
+ * @param n Number of indices
+ * @param grain Indices per chunk; ranges under 2 * grain run serially
+ * @param body Range function
+ * @param merge Merge function (NULL for a plain parallel-for)
+ * @param ctx Caller context
+ * @param result Final result (initialized by the caller)
+ * @param partial_size Size of one partial result in bytes
+ */
+void pool_parallel_reduce(int n, int grain, PoolRangeFunc body,
+                          PoolMergeFunc merge, void *ctx, void *result,
+                          size_t partial_size);
+
+#endif /* POOL_H */
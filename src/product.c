@@ -4,14 +4,39 @@
  */
 
 #include "product.h"
+#include "metrics.h"
+#include <stdlib.h>
 #include <string.h>
 
 void product_list_init(ProductList *list) {
     if (list == NULL) return;
-    list->count = 0;
+    product_list_reset(list);
     memset(list->products, 0, sizeof(list->products));
 }
 
+void product_list_reset(ProductList *list) {
+    if (list == NULL) return;
+    list->count = 0;
+    list->generation = generation_next();
+    list->listener_count = 0;
+}
+
+static void notify_listeners(ProductList *list, const Product *before, const Product *after) {
+    for (int l = 0; l < list->listener_count; l++) {
+        list->listeners[l](list->listener_ctx[l], before, after);
+    }
+}
+
+int product_add_listener(ProductList *list, ProductListener listener, void *ctx) {
+    if (list == NULL || listener == NULL) return 0;
+    if (list->listener_count >= MAX_PRODUCT_LISTENERS) return 0;
+    
+    list->listeners[list->listener_count] = listener;
+    list->listener_ctx[list->listener_count] = ctx;
+    list->listener_count++;
+    return 1;
+}
+
 int product_add(ProductList *list, const Product *product) {
     if (list == NULL || product == NULL) return 0;
     
@@ -29,6 +54,8 @@ int product_add(ProductList *list, const Product *product) {
     
     list->products[list->count] = *product;
     list->count++;
+    list->generation = generation_next();
+    notify_listeners(list, NULL, &list->products[list->count - 1]);
     return 1;
 }
 
@@ -44,8 +71,8 @@ Product* product_find_by_id(ProductList *list, int id) {
     return NULL;
 }
 
-int product_find_by_name(ProductList *list, const char *name,
-                         Product *results, int max_results) {
+static int find_by_name(ProductList *list, const char *name,
+                        Product *results, int max_results) {
     if (list == NULL || name == NULL || results == NULL) return 0;
     
     int found = 0;
@@ -69,8 +96,16 @@ int product_find_by_name(ProductList *list, const char *name,
     return found;
 }
 
-int product_find_by_category(ProductList *list, const char *category,
-                             Product *results, int max_results) {
+int product_find_by_name(ProductList *list, const char *name,
+                         Product *results, int max_results) {
+    MetricTimer timer = metrics_start();
+    int result = find_by_name(list, name, results, max_results);
+    metrics_stop(METRIC_SEARCH_NAME, timer);
+    return result;
+}
+
+static int find_by_category(ProductList *list, const char *category,
+                            Product *results, int max_results) {
     if (list == NULL || category == NULL || results == NULL) return 0;
     
     int found = 0;
@@ -95,11 +130,21 @@ int product_find_by_category(ProductList *list, const char *category,
     return found;
 }
 
+int product_find_by_category(ProductList *list, const char *category,
+                             Product *results, int max_results) {
+    MetricTimer timer = metrics_start();
+    int result = find_by_category(list, category, results, max_results);
+    metrics_stop(METRIC_SEARCH_CATEGORY, timer);
+    return result;
+}
+
 int product_update(ProductList *list, int id, const Product *updated_product) {
     if (list == NULL || updated_product == NULL) return 0;
     
     Product *product = product_find_by_id(list, id);
     if (product == NULL) return 0;
+    list->generation = generation_next();
+    Product before = *product;
     
     // Update all fields except ID
     strncpy(product->name, updated_product->name, MAX_NAME_LEN - 1);
@@ -115,6 +160,7 @@ int product_update(ProductList *list, int id, const Product *updated_product) {
     product->reorder_level = updated_product->reorder_level;
     product->unit_price = updated_product->unit_price;
     product->supplier_id = updated_product->supplier_id;
+    notify_listeners(list, &before, product);
     
     if (!product_validate(product)) {
         return 0;  // Updated data is invalid
@@ -135,6 +181,7 @@ int product_delete(ProductList *list, int id) {
     }
     
     if (index == -1) return 0;
+    Product removed = list->products[index];
     
     // Shift remaining products
     for (int i = index; i < list->count - 1; i++) {
@@ -142,6 +189,8 @@ int product_delete(ProductList *list, int id) {
     }
     
     list->count--;
+    list->generation = generation_next();
+    notify_listeners(list, &removed, NULL);
     return 1;
 }
 
@@ -185,3 +234,80 @@ int product_get_low_stock(ProductList *list, Product *results, int max_results)
     return found;
 }
 
+
+// Multiplicative hash spreading sequential IDs across the table
+static unsigned int hash_product_id(int id) {
+    return (unsigned int)id * 2654435761u;
+}
+
+int product_index_build(ProductIdIndex *index, const ProductList *list) {
+    if (index == NULL || list == NULL) return 0;
+    
+    // Keep load factor at or below 0.5
+    int capacity = 16;
+    while (capacity < list->count * 2) {
+        capacity *= 2;
+    }
+    
+    index->slots = malloc(sizeof(int) * capacity);
+    if (index->slots == NULL) {
+        index->capacity = 0;
+        return 0;
+    }
+    index->capacity = capacity;
+    for (int i = 0; i < capacity; i++) {
+        index->slots[i] = -1;
+    }
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < list->count; i++) {
+        unsigned int h = hash_product_id(list->products[i].id) & mask;
+        while (index->slots[h] != -1) {
+            h = (h + 1) & mask;
+        }
+        index->slots[h] = i;
+    }
+    
+    return 1;
+}
+
+int product_index_find(const ProductIdIndex *index, const ProductList *list, int id) {
+    if (index == NULL || list == NULL || index->capacity == 0) return -1;
+    
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int h = hash_product_id(id) & mask;
+    while (index->slots[h] != -1) {
+        int slot = index->slots[h];
+        if (list->products[slot].id == id) {
+            return slot;
+        }
+        h = (h + 1) & mask;
+    }
+    
+    return -1;
+}
+
+int product_index_insert(ProductIdIndex *index, const ProductList *list, int slot) {
+    if (index == NULL || list == NULL || slot < 0 || slot >= list->count) return 0;
+    
+    // Rebuild at double size once the load factor would pass 0.5
+    if ((slot + 1) * 2 > index->capacity) {
+        product_index_free(index);
+        return product_index_build(index, list);
+    }
+    
+    unsigned int mask = (unsigned int)index->capacity - 1;
+    unsigned int h = hash_product_id(list->products[slot].id) & mask;
+    while (index->slots[h] != -1) {
+        h = (h + 1) & mask;
+    }
+    index->slots[h] = slot;
+    return 1;
+}
+
+void product_index_free(ProductIdIndex *index) {
+    if (index == NULL) return;
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+}
@@ -10,7 +10,9 @@
 
 #include "utils.h"
 
+#ifndef MAX_PRODUCTS
 #define MAX_PRODUCTS 1000
+#endif
 #define MAX_CATEGORY_LEN 50
 #define MAX_DESC_LEN 200
 
@@ -28,20 +30,56 @@ typedef struct {
     int supplier_id;                 ///< Associated supplier ID
 } Product;
 
+/**
+ * @brief Callback run when a product is added, updated or deleted
+ * @param ctx Context given at registration
+ * @param before The product before the change (NULL when added)
+ * @param after The product after the change (NULL when deleted)
+ */
+typedef void (*ProductListener)(void *ctx, const Product *before, const Product *after);
+
+#define MAX_PRODUCT_LISTENERS 4
+
 /**
  * @brief Product list structure
  */
 typedef struct {
     Product products[MAX_PRODUCTS];
     int count;
+    unsigned long generation;        ///< New value on every change (see generation_next)
+    ProductListener listeners[MAX_PRODUCT_LISTENERS];
+    void *listener_ctx[MAX_PRODUCT_LISTENERS];
+    int listener_count;
 } ProductList;
 
+/**
+ * @brief Hash index from product ID to slot in a ProductList
+ *
+ * Built in one pass; valid until the list is modified structurally
+ * (add/delete). Quantity and field updates do not invalidate it.
+ */
+typedef struct {
+    int *slots;     ///< Open-addressing table of list slots (-1 = empty)
+    int capacity;   ///< Table size (power of two)
+} ProductIdIndex;
+
 /**
  * @brief Initialize product list
  * @param list Pointer to ProductList structure
  */
 void product_list_init(ProductList *list);
 
+/**
+ * @brief Empty a product list without clearing its slots
+ *
+ * Like product_list_init, but slots past the count are left as they are,
+ * so a list that is about to be filled (a load) does not first commit
+ * its whole fixed-size array.
+ *
+ * @param list Pointer to ProductList structure
+ */
+void product_list_reset(ProductList *list);
+
 /**
  * @brief Add a new product to the list
  * @param list Pointer to ProductList
@@ -50,6 +88,21 @@ void product_list_init(ProductList *list);
  */
 int product_add(ProductList *list, const Product *product);
 
+/**
+ * @brief Register a callback for every later product_add, product_update
+ *        and product_delete
+ *
+ * Stock movements change quantities in place and are not announced.
+ * Listeners are cleared by product_list_init, so loading a file does not
+ * fire them; register after loading and rebuild from the loaded rows.
+ *
+ * @param list Pointer to ProductList
+ * @param listener Callback
+ * @param ctx Context passed to the callback
+ * @return 1 on success, 0 if all listener slots are taken
+ */
+int product_add_listener(ProductList *list, ProductListener listener, void *ctx);
+
 /**
  * @brief Find product by ID
  * @param list Pointer to ProductList
@@ -129,5 +182,40 @@ int product_validate(const Product *product);
  */
 int product_get_low_stock(ProductList *list, Product *results, int max_results);
 
+/**
+ * @brief Build an ID index over a product list
+ * @param index Index to build (free with product_index_free)
+ * @param list Pointer to ProductList
+ * @return 1 on success, 0 on allocation failure
+ */
+int product_index_build(ProductIdIndex *index, const ProductList *list);
+
+/**
+ * @brief Look up a product slot by ID
+ * @param index Index built over list
+ * @param list The indexed ProductList
+ * @param id Product ID to find
+ * @return Slot in list->products, or -1 if not found
+ */
+int product_index_find(const ProductIdIndex *index, const ProductList *list, int id);
+
+/**
+ * @brief Add a newly appended product slot to an ID index
+ *
+ * Grows the table when needed, so bulk inserts stay O(1) amortized.
+ *
+ * @param index Index built over list
+ * @param list The indexed ProductList (slot already filled)
+ * @param slot Slot of the new product
+ * @return 1 on success, 0 on allocation failure
+ */
+int product_index_insert(ProductIdIndex *index, const ProductList *list, int slot);
+
+/**
+ * @brief Release an ID index
+ * @param index Index to free
+ */
+void product_index_free(ProductIdIndex *index);
+
 #endif /* PRODUCT_H */
 
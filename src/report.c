@@ -1,126 +1,945 @@
 /**
  * @file report.c
  * @brief Implementation of reporting functions
+ *
+ * Reports over large lists run on the thread pool: each worker scans
+ * chunks into a private partial (sum, count, top-N heap or slot list)
+ * and the partials are merged at the end. Lists under
+ * REPORT_PARALLEL_THRESHOLD rows are scanned serially.
  */
 
 #include "report.h"
+#include "metrics.h"
+#include "pool.h"
+#include <ctype.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-int report_total_products(const ProductList *list) {
+#define REPORT_PARALLEL_THRESHOLD 20000  // Rows below which reports run serially
+#define REPORT_GRAIN 4096                // Rows per work-stealing chunk
+
+// Scan [0, n) serially or on the pool depending on size
+static void report_reduce(int n, PoolRangeFunc body, PoolMergeFunc merge,
+                          void *ctx, void *result, size_t partial_size) {
+    if (n < REPORT_PARALLEL_THRESHOLD) {
+        body(ctx, result, 0, n);
+        return;
+    }
+    pool_parallel_reduce(n, REPORT_GRAIN, body, merge, ctx, result, partial_size);
+}
+
+static int total_products(const ProductList *list) {
     if (list == NULL) return 0;
     return list->count;
 }
 
-double report_total_stock_value(const ProductList *list) {
-    if (list == NULL) return 0.0;
-    
+int report_total_products(const ProductList *list) {
+    MetricTimer timer = metrics_start();
+    int result = total_products(list);
+    metrics_stop(METRIC_REPORT_TOTAL_PRODUCTS, timer);
+    return result;
+}
+
+static void stock_value_range(void *ctx, void *partial, int begin, int end) {
+    const ProductList *list = (const ProductList *)ctx;
     double total = 0.0;
-    for (int i = 0; i < list->count; i++) {
+    
+    for (int i = begin; i < end; i++) {
         total += list->products[i].quantity_in_stock * list->products[i].unit_price;
     }
+    *(double *)partial += total;
+}
+
+static void merge_double(void *ctx, void *result, const void *partial) {
+    (void)ctx;
+    *(double *)result += *(const double *)partial;
+}
+
+static double total_stock_value(const ProductList *list) {
+    if (list == NULL) return 0.0;
+    
+    double total = 0.0;
+    report_reduce(list->count, stock_value_range, merge_double,
+                  (void *)list, &total, sizeof(double));
     
     return total;
 }
 
-// Comparison function for sorting by quantity (descending)
-static int compare_by_quantity(const void *a, const void *b) {
-    const Product *pa = (const Product *)a;
-    const Product *pb = (const Product *)b;
-    
-    if (pa->quantity_in_stock > pb->quantity_in_stock) return -1;
-    if (pa->quantity_in_stock < pb->quantity_in_stock) return 1;
-    return 0;
+double report_total_stock_value(const ProductList *list) {
+    MetricTimer timer = metrics_start();
+    double result = total_stock_value(list);
+    metrics_stop(METRIC_REPORT_STOCK_VALUE, timer);
+    return result;
 }
 
-// Comparison function for sorting by value (descending)
-static int compare_by_value(const void *a, const void *b) {
-    const Product *pa = (const Product *)a;
-    const Product *pb = (const Product *)b;
-    
-    double value_a = pa->quantity_in_stock * pa->unit_price;
-    double value_b = pb->quantity_in_stock * pb->unit_price;
+/**
+ * @brief What a top-N heap ranks products by
+ */
+typedef enum {
+    TOP_BY_QUANTITY,
+    TOP_BY_VALUE,       ///< quantity * price
+    TOP_BY_POSITION     ///< Earliest slot first
+} TopKey;
+
+/**
+ * @brief Top-N selection context
+ */
+typedef struct {
+    const ProductList *list;
+    TopKey key;
+    int n;              ///< Heap capacity
+} TopContext;
+
+/**
+ * @brief Bounded min-heap of product slots (weakest entry at the root)
+ */
+typedef struct {
+    int count;
+    int slots[];
+} TopHeap;
+
+static double top_key(const TopContext *c, int slot) {
+    const Product *p = &c->list->products[slot];
+    switch (c->key) {
+        case TOP_BY_VALUE:
+            return p->quantity_in_stock * p->unit_price;
+        case TOP_BY_POSITION:
+            return -slot;
+        default:
+            return p->quantity_in_stock;
+    }
+}
+
+// 1 if slot a ranks below slot b (ties: later slot ranks lower)
+static int top_worse(const TopContext *c, int a, int b) {
+    double ka = top_key(c, a);
+    double kb = top_key(c, b);
     
-    if (value_a > value_b) return -1;
-    if (value_a < value_b) return 1;
-    return 0;
+    if (ka != kb) return ka < kb;
+    return a > b;
 }
 
-int report_top_products_by_quantity(const ProductList *list,
-                                   Product *results, int n) {
+static void top_sift_down(const TopContext *c, int *slots, int count, int i) {
+    for (;;) {
+        int weakest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        
+        if (left < count && top_worse(c, slots[left], slots[weakest])) weakest = left;
+        if (right < count && top_worse(c, slots[right], slots[weakest])) weakest = right;
+        if (weakest == i) return;
+        
+        int tmp = slots[i];
+        slots[i] = slots[weakest];
+        slots[weakest] = tmp;
+        i = weakest;
+    }
+}
+
+static void top_push(const TopContext *c, int *slots, int *count, int slot) {
+    if (*count < c->n) {
+        int i = (*count)++;
+        slots[i] = slot;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (!top_worse(c, slots[i], slots[parent])) break;
+            int tmp = slots[i];
+            slots[i] = slots[parent];
+            slots[parent] = tmp;
+            i = parent;
+        }
+    } else if (*count > 0 && top_worse(c, slots[0], slot)) {
+        slots[0] = slot;
+        top_sift_down(c, slots, *count, 0);
+    }
+}
+
+// Heap sort in place: pop the weakest to the back until empty, leaving best first
+static void top_sort(const TopContext *c, int *slots, int count) {
+    while (count > 1) {
+        int last = --count;
+        int tmp = slots[0];
+        slots[0] = slots[last];
+        slots[last] = tmp;
+        top_sift_down(c, slots, count, 0);
+    }
+}
+
+static void top_range(void *ctx, void *partial, int begin, int end) {
+    TopHeap *h = (TopHeap *)partial;
+    for (int i = begin; i < end; i++) {
+        top_push((const TopContext *)ctx, h->slots, &h->count, i);
+    }
+}
+
+static void merge_top(void *ctx, void *result, const void *partial) {
+    const TopHeap *part = (const TopHeap *)partial;
+    TopHeap *h = (TopHeap *)result;
+    for (int i = 0; i < part->count; i++) {
+        top_push((const TopContext *)ctx, h->slots, &h->count, part->slots[i]);
+    }
+}
+
+// Select the top n products by quantity or value, best first
+static int report_top_products(const ProductList *list, Product *results,
+                               int n, TopKey key) {
     if (list == NULL || results == NULL || n <= 0) return 0;
     
-    // Copy all products to results
-    int count = (n < list->count) ? n : list->count;
-    Product *temp = malloc(sizeof(Product) * list->count);
-    if (temp == NULL) return 0;
+    TopContext ctx = { list, key, (n < list->count) ? n : list->count };
+    if (ctx.n == 0) return 0;
     
-    for (int i = 0; i < list->count; i++) {
-        temp[i] = list->products[i];
-    }
+    size_t heap_size = sizeof(TopHeap) + sizeof(int) * (size_t)ctx.n;
+    TopHeap *heap = malloc(heap_size);
+    if (heap == NULL) return 0;
+    heap->count = 0;
     
-    // Sort by quantity
-    qsort(temp, list->count, sizeof(Product), compare_by_quantity);
+    report_reduce(list->count, top_range, merge_top, &ctx, heap, heap_size);
     
-    // Copy top N
+    int count = heap->count;
+    top_sort(&ctx, heap->slots, count);
     for (int i = 0; i < count; i++) {
-        results[i] = temp[i];
+        results[i] = list->products[heap->slots[i]];
     }
     
-    free(temp);
+    free(heap);
     return count;
 }
 
+static int top_products_by_quantity(const ProductList *list,
+                                   Product *results, int n) {
+    return report_top_products(list, results, n, TOP_BY_QUANTITY);
+}
+
+int report_top_products_by_quantity(const ProductList *list,
+                                   Product *results, int n) {
+    MetricTimer timer = metrics_start();
+    int result = top_products_by_quantity(list, results, n);
+    metrics_stop(METRIC_REPORT_TOP_QUANTITY, timer);
+    return result;
+}
+
+static int top_products_by_value(const ProductList *list,
+                                Product *results, int n) {
+    return report_top_products(list, results, n, TOP_BY_VALUE);
+}
+
 int report_top_products_by_value(const ProductList *list,
                                 Product *results, int n) {
-    if (list == NULL || results == NULL || n <= 0) return 0;
+    MetricTimer timer = metrics_start();
+    int result = top_products_by_value(list, results, n);
+    metrics_stop(METRIC_REPORT_TOP_VALUE, timer);
+    return result;
+}
+
+/**
+ * @brief Growable list of matching product slots
+ */
+typedef struct {
+    int *slots;
+    int count;
+    int capacity;
+    int failed;         ///< Set if an allocation failed
+} SlotList;
+
+static int slot_list_append(SlotList *s, int slot) {
+    if (s->failed) return 0;
+    if (s->count == s->capacity) {
+        int capacity = (s->capacity > 0) ? s->capacity * 2 : 64;
+        int *grown = realloc(s->slots, sizeof(int) * (size_t)capacity);
+        if (grown == NULL) {
+            s->failed = 1;
+            return 0;
+        }
+        s->slots = grown;
+        s->capacity = capacity;
+    }
+    s->slots[s->count++] = slot;
+    return 1;
+}
+
+static void low_stock_range(void *ctx, void *partial, int begin, int end) {
+    const ProductList *list = (const ProductList *)ctx;
+    SlotList *found = (SlotList *)partial;
     
-    // Copy all products to results
-    int count = (n < list->count) ? n : list->count;
-    Product *temp = malloc(sizeof(Product) * list->count);
-    if (temp == NULL) return 0;
+    for (int i = begin; i < end; i++) {
+        if (list->products[i].quantity_in_stock <= list->products[i].reorder_level) {
+            slot_list_append(found, i);
+        }
+    }
+}
+
+static void merge_slots(void *ctx, void *result, const void *partial) {
+    const SlotList *part = (const SlotList *)partial;
+    SlotList *into = (SlotList *)result;
+    (void)ctx;
     
-    for (int i = 0; i < list->count; i++) {
-        temp[i] = list->products[i];
+    for (int i = 0; i < part->count; i++) {
+        slot_list_append(into, part->slots[i]);
+    }
+    if (part->failed) into->failed = 1;
+    free(part->slots);
+}
+
+static int compare_slots(const void *a, const void *b) {
+    return *(const int *)a - *(const int *)b;
+}
+
+static int low_stock_products(const ProductList *list,
+                             Product *results, int max_results) {
+    if (list == NULL || results == NULL) return 0;
+    
+    SlotList found = { NULL, 0, 0, 0 };
+    report_reduce(list->count, low_stock_range, merge_slots,
+                  (void *)list, &found, sizeof(SlotList));
+    if (found.failed) {
+        free(found.slots);
+        return 0;
     }
     
-    // Sort by value
-    qsort(temp, list->count, sizeof(Product), compare_by_value);
+    // Chunks finish out of order; report in list order
+    if (found.count > 1) {
+        qsort(found.slots, found.count, sizeof(int), compare_slots);
+    }
     
-    // Copy top N
+    int count = (found.count < max_results) ? found.count : max_results;
     for (int i = 0; i < count; i++) {
-        results[i] = temp[i];
+        results[i] = list->products[found.slots[i]];
     }
     
-    free(temp);
+    free(found.slots);
     return count;
 }
 
 int report_low_stock_products(const ProductList *list,
                              Product *results, int max_results) {
-    if (list == NULL || results == NULL) return 0;
+    MetricTimer timer = metrics_start();
+    int result = low_stock_products(list, results, max_results);
+    metrics_stop(METRIC_REPORT_LOW_STOCK, timer);
+    return result;
+}
+
+/**
+ * @brief Per-worker dashboard totals and heaps
+ */
+typedef struct {
+    double value;
+    long units;
+    int low_stock;
+    int quantity_count;
+    int quantity_slots[REPORT_DASHBOARD_ROWS];
+    int value_count;
+    int value_slots[REPORT_DASHBOARD_ROWS];
+    int low_count;
+    int low_slots[REPORT_DASHBOARD_ROWS];   ///< Earliest low-stock slots
+} DashboardPartial;
+
+typedef struct {
+    TopContext quantity;
+    TopContext value;
+    TopContext low;
+} DashboardContext;
+
+static void dashboard_range(void *ctx, void *partial, int begin, int end) {
+    const DashboardContext *c = (const DashboardContext *)ctx;
+    DashboardPartial *d = (DashboardPartial *)partial;
+    const Product *products = c->quantity.list->products;
+    double value = 0.0;
+    long units = 0;
     
-    return product_get_low_stock((ProductList *)list, results, max_results);
+    // Every figure comes from the same read of each product
+    for (int i = begin; i < end; i++) {
+        const Product *p = &products[i];
+        value += p->quantity_in_stock * p->unit_price;
+        units += p->quantity_in_stock;
+        top_push(&c->quantity, d->quantity_slots, &d->quantity_count, i);
+        top_push(&c->value, d->value_slots, &d->value_count, i);
+        if (p->quantity_in_stock <= p->reorder_level) {
+            d->low_stock++;
+            top_push(&c->low, d->low_slots, &d->low_count, i);
+        }
+    }
+    d->value += value;
+    d->units += units;
 }
 
-int report_transaction_count_by_date(const TransactionList *list,
-                                     const char *start_date,
-                                     const char *end_date) {
-    if (list == NULL || start_date == NULL || end_date == NULL) return 0;
+static void merge_dashboard(void *ctx, void *result, const void *partial) {
+    const DashboardContext *c = (const DashboardContext *)ctx;
+    const DashboardPartial *part = (const DashboardPartial *)partial;
+    DashboardPartial *d = (DashboardPartial *)result;
+    
+    d->value += part->value;
+    d->units += part->units;
+    d->low_stock += part->low_stock;
+    for (int i = 0; i < part->quantity_count; i++) {
+        top_push(&c->quantity, d->quantity_slots, &d->quantity_count, part->quantity_slots[i]);
+    }
+    for (int i = 0; i < part->value_count; i++) {
+        top_push(&c->value, d->value_slots, &d->value_count, part->value_slots[i]);
+    }
+    for (int i = 0; i < part->low_count; i++) {
+        top_push(&c->low, d->low_slots, &d->low_count, part->low_slots[i]);
+    }
+}
+
+static int dashboard(const ProductList *list, DashboardSummary *summary) {
+    if (list == NULL || summary == NULL) return 0;
     
+    int n = (list->count < REPORT_DASHBOARD_ROWS) ? list->count : REPORT_DASHBOARD_ROWS;
+    DashboardContext ctx = {
+        { list, TOP_BY_QUANTITY, n },
+        { list, TOP_BY_VALUE, n },
+        { list, TOP_BY_POSITION, n }
+    };
+    DashboardPartial totals;
+    memset(&totals, 0, sizeof(totals));
+    
+    report_reduce(list->count, dashboard_range, merge_dashboard, &ctx, &totals,
+                  sizeof(DashboardPartial));
+    
+    memset(summary, 0, sizeof(DashboardSummary));
+    summary->total_products = list->count;
+    summary->total_value = totals.value;
+    summary->total_units = totals.units;
+    summary->low_stock_count = totals.low_stock;
+    
+    top_sort(&ctx.quantity, totals.quantity_slots, totals.quantity_count);
+    top_sort(&ctx.value, totals.value_slots, totals.value_count);
+    top_sort(&ctx.low, totals.low_slots, totals.low_count);
+    for (int i = 0; i < totals.quantity_count; i++) {
+        summary->top_quantity[i] = list->products[totals.quantity_slots[i]];
+    }
+    for (int i = 0; i < totals.value_count; i++) {
+        summary->top_value[i] = list->products[totals.value_slots[i]];
+    }
+    for (int i = 0; i < totals.low_count; i++) {
+        summary->low_stock[i] = list->products[totals.low_slots[i]];
+    }
+    summary->top_quantity_count = totals.quantity_count;
+    summary->top_value_count = totals.value_count;
+    summary->low_stock_shown = totals.low_count;
+    return 1;
+}
+
+int report_dashboard(const ProductList *list, DashboardSummary *summary) {
+    MetricTimer timer = metrics_start();
+    int result = dashboard(list, summary);
+    metrics_stop(METRIC_REPORT_DASHBOARD, timer);
+    return result;
+}
+
+/**
+ * @brief Date range count context
+ */
+typedef struct {
+    const TransactionList *list;
+    const char *start_date;
+    const char *end_date;
+} DateRangeContext;
+
+static void date_count_range(void *ctx, void *partial, int begin, int end) {
+    const DateRangeContext *c = (const DateRangeContext *)ctx;
     int count = 0;
-    for (int i = 0; i < list->count; i++) {
+    
+    for (int i = begin; i < end; i++) {
         // Extract date part
         char date_str[11];
-        strncpy(date_str, list->transactions[i].date_time, 10);
+        memcpy(date_str, c->list->transactions[i].date_time, 10);
         date_str[10] = '\0';
         
-        if (strcmp(date_str, start_date) >= 0 && 
-            strcmp(date_str, end_date) <= 0) {
+        if (strcmp(date_str, c->start_date) >= 0 &&
+            strcmp(date_str, c->end_date) <= 0) {
             count++;
         }
     }
+    *(int *)partial += count;
+}
+
+static void merge_int(void *ctx, void *result, const void *partial) {
+    (void)ctx;
+    *(int *)result += *(const int *)partial;
+}
+
+int report_transaction_count_by_date(const TransactionList *list,
+                                     const char *start_date,
+                                     const char *end_date) {
+    if (list == NULL) return 0;
+    return report_transaction_count_by_date_prefix(list, list->count, start_date, end_date);
+}
+
+static int count_by_date(const TransactionList *list, int count,
+                         const char *start_date,
+                         const char *end_date) {
+    if (list == NULL || start_date == NULL || end_date == NULL) return 0;
+    if (count > list->count) count = list->count;
+    
+    DateRangeContext ctx = { list, start_date, end_date };
+    int found = 0;
+    report_reduce(count, date_count_range, merge_int, &ctx, &found, sizeof(int));
+    
+    return found;
+}
+
+int report_transaction_count_by_date_prefix(const TransactionList *list, int count,
+                                            const char *start_date,
+                                            const char *end_date) {
+    MetricTimer timer = metrics_start();
+    int result = count_by_date(list, count, start_date, end_date);
+    metrics_stop(METRIC_REPORT_COUNT_BY_DATE, timer);
+    return result;
+}
+
+// Fastest mover first, then by product ID
+static int compare_by_velocity(const void *a, const void *b) {
+    const VelocityRow *ra = (const VelocityRow *)a;
+    const VelocityRow *rb = (const VelocityRow *)b;
+    
+    if (ra->velocity > rb->velocity) return -1;
+    if (ra->velocity < rb->velocity) return 1;
+    return (ra->product_id > rb->product_id) - (ra->product_id < rb->product_id);
+}
+
+static int stock_velocity(const ProductList *products,
+                          const TransactionList *transactions, int count,
+                          int window_days, int end_day, VelocityRow *results) {
+    if (products == NULL || transactions == NULL || results == NULL) return 0;
+    if (window_days <= 0 || products->count == 0) return 0;
+    if (count > transactions->count) count = transactions->count;
+    
+    ProductIdIndex index;
+    if (!product_index_build(&index, products)) return 0;
+    
+    for (int i = 0; i < products->count; i++) {
+        const Product *p = &products->products[i];
+        VelocityRow *row = &results[i];
+        
+        memset(row, 0, sizeof(*row));
+        row->product_id = p->id;
+        strcpy(row->name, p->name);
+        row->quantity_in_stock = p->quantity_in_stock;
+    }
+    
+    // One pass over the log, accumulating straight into the result rows
+    int first_day = end_day - window_days + 1;
+    for (int i = 0; i < count; i++) {
+        const Transaction *t = &transactions->transactions[i];
+        int day;
+        if (!date_to_days(t->date_time, &day) || day < first_day || day > end_day) {
+            continue;
+        }
+        
+        int slot = product_index_find(&index, products, t->product_id);
+        if (slot < 0) continue;
+        
+        if (strcmp(t->type, TRANSACTION_TYPE_IN) == 0) {
+            results[slot].units_in += t->quantity;
+        } else {
+            results[slot].units_out += t->quantity;
+        }
+    }
+    product_index_free(&index);
     
-    return count;
+    for (int i = 0; i < products->count; i++) {
+        VelocityRow *row = &results[i];
+        double start_stock = row->quantity_in_stock - row->units_in + row->units_out;
+        double average_stock = (start_stock + row->quantity_in_stock) / 2.0;
+        
+        row->velocity = (double)row->units_out / window_days;
+        row->days_of_cover = (row->velocity > 0.0) ? row->quantity_in_stock / row->velocity : -1.0;
+        row->turnover = (average_stock > 0.0) ? row->units_out / average_stock : 0.0;
+    }
+    
+    qsort(results, products->count, sizeof(VelocityRow), compare_by_velocity);
+    return products->count;
+}
+
+int report_stock_velocity(const ProductList *products,
+                          const TransactionList *transactions,
+                          int window_days, int end_day, VelocityRow *results) {
+    if (transactions == NULL) return 0;
+    return report_stock_velocity_prefix(products, transactions, transactions->count,
+                                        window_days, end_day, results);
+}
+
+int report_stock_velocity_prefix(const ProductList *products,
+                                 const TransactionList *transactions, int count,
+                                 int window_days, int end_day, VelocityRow *results) {
+    MetricTimer timer = metrics_start();
+    int result = stock_velocity(products, transactions, count, window_days, end_day, results);
+    metrics_stop(METRIC_REPORT_VELOCITY, timer);
+    return result;
+}
+
+/**
+ * @brief Hash table of group totals (products == 0 marks an empty cell)
+ */
+typedef struct {
+    GroupRow *rows;
+    int capacity;
+    int count;
+    int failed;         ///< Set if an allocation failed
+} GroupTable;
+
+typedef struct {
+    const ProductList *list;
+    ReportGroupBy by;
+} GroupContext;
+
+static unsigned int group_hash(ReportGroupBy by, const char *category, int supplier_id) {
+    if (by == REPORT_GROUP_SUPPLIER) {
+        return (unsigned int)supplier_id * 2654435761u;
+    }
+    
+    // FNV-1a over the lowercase name
+    unsigned int h = 2166136261u;
+    for (const char *c = category; *c != '\0'; c++) {
+        h = (h ^ (unsigned int)tolower((unsigned char)*c)) * 16777619u;
+    }
+    return h;
+}
+
+static int same_group(ReportGroupBy by, const GroupRow *row, const char *category, int supplier_id) {
+    if (by == REPORT_GROUP_SUPPLIER) return row->supplier_id == supplier_id;
+    
+    const char *a = row->name;
+    const char *b = category;
+    while (*a != '\0' && tolower((unsigned char)*a) == tolower((unsigned char)*b)) {
+        a++;
+        b++;
+    }
+    return tolower((unsigned char)*a) == tolower((unsigned char)*b);
 }
 
+static int group_grow(GroupTable *t, ReportGroupBy by) {
+    int capacity = (t->capacity > 0) ? t->capacity * 2 : 64;
+    GroupRow *rows = calloc((size_t)capacity, sizeof(GroupRow));
+    if (rows == NULL) return 0;
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < t->capacity; i++) {
+        const GroupRow *r = &t->rows[i];
+        if (r->products == 0) continue;
+        unsigned int h = group_hash(by, r->name, r->supplier_id) & mask;
+        while (rows[h].products != 0) {
+            h = (h + 1) & mask;
+        }
+        rows[h] = *r;
+    }
+    
+    free(t->rows);
+    t->rows = rows;
+    t->capacity = capacity;
+    return 1;
+}
+
+// Add totals to a group, creating it on first sight
+static void group_add(GroupTable *t, ReportGroupBy by, const char *category, int supplier_id,
+                      const GroupRow *totals) {
+    if (t->failed) return;
+    if ((t->count + 1) * 2 > t->capacity && !group_grow(t, by)) {
+        t->failed = 1;
+        return;
+    }
+    
+    unsigned int mask = (unsigned int)t->capacity - 1;
+    unsigned int h = group_hash(by, category, supplier_id) & mask;
+    while (t->rows[h].products != 0 && !same_group(by, &t->rows[h], category, supplier_id)) {
+        h = (h + 1) & mask;
+    }
+    
+    GroupRow *row = &t->rows[h];
+    if (row->products == 0) {
+        if (by == REPORT_GROUP_CATEGORY) {
+            strncpy(row->name, category, MAX_NAME_LEN - 1);  // First spelling seen
+        }
+        row->supplier_id = supplier_id;
+        t->count++;
+    }
+    row->products += totals->products;
+    row->units += totals->units;
+    row->value += totals->value;
+    row->low_stock += totals->low_stock;
+}
+
+// Find a group, or NULL if it was never added
+static GroupRow* group_find(const GroupTable *t, ReportGroupBy by, const char *category,
+                            int supplier_id) {
+    if (t->capacity == 0) return NULL;
+    
+    unsigned int mask = (unsigned int)t->capacity - 1;
+    unsigned int h = group_hash(by, category, supplier_id) & mask;
+    while (t->rows[h].products != 0) {
+        if (same_group(by, &t->rows[h], category, supplier_id)) return &t->rows[h];
+        h = (h + 1) & mask;
+    }
+    return NULL;
+}
+
+static void group_range(void *ctx, void *partial, int begin, int end) {
+    const GroupContext *c = (const GroupContext *)ctx;
+    GroupTable *t = (GroupTable *)partial;
+    
+    for (int i = begin; i < end; i++) {
+        const Product *p = &c->list->products[i];
+        GroupRow one = {0};
+        one.products = 1;
+        one.units = p->quantity_in_stock;
+        one.value = p->quantity_in_stock * p->unit_price;
+        one.low_stock = (p->quantity_in_stock <= p->reorder_level);
+        group_add(t, c->by, p->category, p->supplier_id, &one);
+    }
+}
+
+static void merge_groups(void *ctx, void *result, const void *partial) {
+    const GroupContext *c = (const GroupContext *)ctx;
+    GroupTable *into = (GroupTable *)result;
+    GroupTable *part = (GroupTable *)partial;
+    
+    for (int i = 0; i < part->capacity; i++) {
+        const GroupRow *r = &part->rows[i];
+        if (r->products > 0) {
+            group_add(into, c->by, r->name, r->supplier_id, r);
+        }
+    }
+    if (part->failed) into->failed = 1;
+    free(part->rows);  // The pool frees the partial itself
+}
+
+// Name, then supplier ID: the whole order for REPORT_SORT_NAME and the tie-break for the rest
+static int compare_group_names(const void *a, const void *b) {
+    const GroupRow *ga = (const GroupRow *)a;
+    const GroupRow *gb = (const GroupRow *)b;
+    int cmp = strcmp(ga->name, gb->name);
+    return (cmp != 0) ? cmp : (ga->supplier_id > gb->supplier_id) - (ga->supplier_id < gb->supplier_id);
+}
+
+static int compare_group_value(const void *a, const void *b) {
+    const GroupRow *ga = (const GroupRow *)a;
+    const GroupRow *gb = (const GroupRow *)b;
+    int cmp = (ga->value < gb->value) - (ga->value > gb->value);
+    return (cmp != 0) ? cmp : compare_group_names(a, b);
+}
+
+static int compare_group_units(const void *a, const void *b) {
+    const GroupRow *ga = (const GroupRow *)a;
+    const GroupRow *gb = (const GroupRow *)b;
+    int cmp = (ga->units < gb->units) - (ga->units > gb->units);
+    return (cmp != 0) ? cmp : compare_group_names(a, b);
+}
+
+static int compare_group_low_stock(const void *a, const void *b) {
+    const GroupRow *ga = (const GroupRow *)a;
+    const GroupRow *gb = (const GroupRow *)b;
+    int cmp = (ga->low_stock < gb->low_stock) - (ga->low_stock > gb->low_stock);
+    return (cmp != 0) ? cmp : compare_group_names(a, b);
+}
+
+static int group_stock(const ProductList *products, const SupplierList *suppliers,
+                       ReportGroupBy by, ReportGroupSort sort, int limit, GroupRow *results) {
+    if (products == NULL || results == NULL || limit < 0) return 0;
+    
+    GroupContext ctx = { products, by };
+    GroupTable table = { NULL, 0, 0, 0 };
+    report_reduce(products->count, group_range, merge_groups, &ctx, &table, sizeof(GroupTable));
+    if (table.failed) {
+        free(table.rows);
+        return 0;
+    }
+    
+    // Join supplier names with one probe per supplier; the first supplier with an ID wins
+    if (by == REPORT_GROUP_SUPPLIER && suppliers != NULL) {
+        for (int s = suppliers->count - 1; s >= 0; s--) {
+            const Supplier *supplier = &suppliers->suppliers[s];
+            GroupRow *row = group_find(&table, by, NULL, supplier->supplier_id);
+            if (row != NULL) {
+                strncpy(row->name, supplier->name, MAX_NAME_LEN - 1);
+            }
+        }
+    }
+    
+    int count = 0;
+    for (int i = 0; i < table.capacity; i++) {
+        if (table.rows[i].products > 0) {
+            results[count++] = table.rows[i];
+        }
+    }
+    free(table.rows);
+    
+    // Only the groups are sorted, never the products
+    int (*compare)(const void *, const void *);
+    switch (sort) {
+        case REPORT_SORT_VALUE:
+            compare = compare_group_value;
+            break;
+        case REPORT_SORT_UNITS:
+            compare = compare_group_units;
+            break;
+        case REPORT_SORT_LOW_STOCK:
+            compare = compare_group_low_stock;
+            break;
+        default:
+            compare = compare_group_names;
+            break;
+    }
+    qsort(results, (size_t)count, sizeof(GroupRow), compare);
+    
+    return (limit > 0 && limit < count) ? limit : count;
+}
+
+int report_group_stock(const ProductList *products, const SupplierList *suppliers,
+                       ReportGroupBy by, ReportGroupSort sort, int limit, GroupRow *results) {
+    MetricTimer timer = metrics_start();
+    int result = group_stock(products, suppliers, by, sort, limit, results);
+    metrics_stop(METRIC_REPORT_GROUP_STOCK, timer);
+    return result;
+}
+
+/**
+ * @brief Stock value of one product slot
+ */
+typedef struct {
+    double value;
+    int slot;
+} ValueSlot;
+
+typedef struct {
+    const ProductList *list;
+    ValueSlot *pairs;
+} AbcContext;
+
+static void abc_value_range(void *ctx, void *partial, int begin, int end) {
+    const AbcContext *c = (const AbcContext *)ctx;
+    double total = 0.0;
+    
+    for (int i = begin; i < end; i++) {
+        const Product *p = &c->list->products[i];
+        double value = p->quantity_in_stock * p->unit_price;
+        c->pairs[i].value = (value > 0.0) ? value : 0.0;
+        c->pairs[i].slot = i;
+        total += c->pairs[i].value;
+    }
+    *(double *)partial += total;
+}
+
+// Highest value first, then earliest slot
+static int compare_value_slots(const void *a, const void *b) {
+    const ValueSlot *x = (const ValueSlot *)a;
+    const ValueSlot *y = (const ValueSlot *)b;
+    if (x->value != y->value) return (x->value < y->value) - (x->value > y->value);
+    return (x->slot > y->slot) - (x->slot < y->slot);
+}
+
+static void swap_pairs(ValueSlot *a, ValueSlot *b) {
+    ValueSlot tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+/**
+ * @brief Move the smallest set of top-valued pairs covering target to the front
+ *
+ * Quickselect guided by partial sums: each round three-way partitions the
+ * undecided range around a pivot and keeps only the side that holds the
+ * boundary, so the expected cost is O(n). Pairs in front come out in no
+ * particular order.
+ *
+ * @return Number of pairs in front
+ */
+static int select_value_prefix(ValueSlot *pairs, int n, double target) {
+    int lo = 0, hi = n;
+    double taken = 0.0;     // Value of pairs[0, lo), all above the rest
+    
+    while (hi - lo > 32) {
+        // Median of three as pivot
+        double a = pairs[lo].value, b = pairs[lo + (hi - lo) / 2].value, c = pairs[hi - 1].value;
+        double pivot = (a < b) ? ((b < c) ? b : ((a < c) ? c : a)) : ((a < c) ? a : ((b < c) ? c : b));
+        
+        // [lo, gt) > pivot, [gt, i) == pivot, [lt, hi) < pivot
+        int gt = lo, i = lo, lt = hi;
+        double above = 0.0, equal = 0.0;
+        while (i < lt) {
+            if (pairs[i].value > pivot) {
+                above += pairs[i].value;
+                swap_pairs(&pairs[i++], &pairs[gt++]);
+            } else if (pairs[i].value < pivot) {
+                swap_pairs(&pairs[i], &pairs[--lt]);
+            } else {
+                equal += pairs[i++].value;
+            }
+        }
+        
+        if (taken + above >= target) {
+            hi = gt;
+        } else if (taken + above + equal >= target) {
+            // The boundary is inside a run of equal values: take the earliest slots
+            qsort(pairs + gt, (size_t)(lt - gt), sizeof(ValueSlot), compare_value_slots);
+            int needed = (int)ceil((target - taken - above) / pivot);
+            return gt + ((needed < lt - gt) ? needed : lt - gt);
+        } else {
+            taken += above + equal;
+            lo = lt;
+        }
+    }
+    
+    // Few pairs left: sort them and walk to the boundary
+    qsort(pairs + lo, (size_t)(hi - lo), sizeof(ValueSlot), compare_value_slots);
+    while (lo < hi && taken < target) {
+        taken += pairs[lo++].value;
+    }
+    return lo;
+}
+
+static int abc_classification(const ProductList *list, double a_share, double b_share,
+                              AbcRow *rows, int max_rows, AbcSummary *summary) {
+    if (list == NULL || summary == NULL) return 0;
+    if (a_share <= 0.0 || a_share > b_share || b_share > 1.0) return 0;
+    
+    memset(summary, 0, sizeof(AbcSummary));
+    ValueSlot *pairs = malloc(sizeof(ValueSlot) * (size_t)(list->count + 1));
+    if (pairs == NULL) return 0;
+    
+    AbcContext ctx = { list, pairs };
+    double total = 0.0;
+    report_reduce(list->count, abc_value_range, merge_double, &ctx, &total, sizeof(double));
+    summary->total_value = total;
+    
+    // Only the products that make up the A and B shares are ranked
+    int ranked = 0;
+    if (total > 0.0) {
+        // Guard against rounding leaving a sliver of value in front of tier C
+        double target = (b_share >= 1.0) ? total : total * b_share;
+        ranked = select_value_prefix(pairs, list->count, target);
+        qsort(pairs, (size_t)ranked, sizeof(ValueSlot), compare_value_slots);
+    }
+    
+    int written = 0;
+    double cumulative = 0.0;
+    for (int i = 0; i < ranked; i++) {
+        int tier = (cumulative < total * a_share) ? 0 : 1;
+        cumulative += pairs[i].value;
+        summary->products[tier]++;
+        summary->value[tier] += pairs[i].value;
+        
+        if (rows != NULL && written < max_rows) {
+            AbcRow *row = &rows[written++];
+            row->product_id = list->products[pairs[i].slot].id;
+            row->value = pairs[i].value;
+            row->cumulative_share = cumulative / total;
+            row->tier = (char)('A' + tier);
+        }
+    }
+    summary->products[2] = list->count - ranked;
+    summary->value[2] = total - summary->value[0] - summary->value[1];
+    if (summary->value[2] < 0.0) summary->value[2] = 0.0;
+    
+    free(pairs);
+    return written;
+}
+
+int report_abc_classification(const ProductList *list, double a_share, double b_share,
+                              AbcRow *rows, int max_rows, AbcSummary *summary) {
+    MetricTimer timer = metrics_start();
+    int result = abc_classification(list, a_share, b_share, rows, max_rows, summary);
+    metrics_stop(METRIC_REPORT_ABC, timer);
+    return result;
+}
@@ -12,6 +12,92 @@
 #include "supplier.h"
 #include "transaction.h"
 
+/**
+ * @brief Movement speed of one product over a window of days
+ */
+typedef struct {
+    int product_id;                 ///< Product ID
+    char name[MAX_NAME_LEN];        ///< Product name
+    int quantity_in_stock;          ///< Current stock
+    long units_in;                  ///< Units received in the window
+    long units_out;                 ///< Units issued in the window
+    double velocity;                ///< Units issued per day
+    double days_of_cover;           ///< Days current stock lasts (-1 if nothing was issued)
+    double turnover;                ///< Units issued / average stock in the window
+} VelocityRow;
+
+#ifndef REPORT_DASHBOARD_ROWS
+#define REPORT_DASHBOARD_ROWS 10
+#endif
+
+/**
+ * @brief Headline figures and short lists computed in one pass
+ */
+typedef struct {
+    int total_products;                             ///< Products in the list
+    long total_units;                               ///< Units in stock
+    double total_value;                             ///< Sum of quantity * price
+    int low_stock_count;                            ///< Products at or below reorder level
+    int top_quantity_count;                         ///< Rows in top_quantity
+    Product top_quantity[REPORT_DASHBOARD_ROWS];    ///< Largest stock first
+    int top_value_count;                            ///< Rows in top_value
+    Product top_value[REPORT_DASHBOARD_ROWS];       ///< Highest stock value first
+    int low_stock_shown;                            ///< Rows in low_stock
+    Product low_stock[REPORT_DASHBOARD_ROWS];       ///< First low-stock products in list order
+} DashboardSummary;
+
+/**
+ * @brief Grouping for report_group_stock
+ */
+typedef enum {
+    REPORT_GROUP_CATEGORY,          ///< One row per category (case-insensitive)
+    REPORT_GROUP_SUPPLIER           ///< One row per supplier ID
+} ReportGroupBy;
+
+/**
+ * @brief Row order for report_group_stock
+ */
+typedef enum {
+    REPORT_SORT_VALUE,              ///< Stock value, highest first
+    REPORT_SORT_UNITS,              ///< Units in stock, highest first
+    REPORT_SORT_LOW_STOCK,          ///< Low-stock products, most first
+    REPORT_SORT_NAME                ///< Category or supplier name, A to Z
+} ReportGroupSort;
+
+/**
+ * @brief Stock totals of one category or supplier
+ */
+typedef struct {
+    char name[MAX_NAME_LEN];        ///< Category, or supplier name ("" if unknown)
+    int supplier_id;                ///< Supplier ID (supplier grouping only)
+    int products;                   ///< Products in the group
+    long units;                     ///< Units in stock
+    double value;                   ///< Stock value (quantity * price)
+    int low_stock;                  ///< Products at or below their reorder level
+} GroupRow;
+
+#define REPORT_ABC_A_SHARE 0.80     // Default cumulative value share of tier A
+#define REPORT_ABC_B_SHARE 0.95     // Default cumulative value share of tiers A + B
+
+/**
+ * @brief One ranked product of an ABC classification
+ */
+typedef struct {
+    int product_id;                 ///< Product ID
+    double value;                   ///< Stock value (quantity * price)
+    double cumulative_share;        ///< Share of total value up to and including this row
+    char tier;                      ///< 'A' or 'B'
+} AbcRow;
+
+/**
+ * @brief Totals of an ABC classification
+ */
+typedef struct {
+    int products[3];                ///< Products in tiers A, B, C
+    double value[3];                ///< Stock value of tiers A, B, C
+    double total_value;             ///< Stock value of all products
+} AbcSummary;
+
 /**
  * @brief Calculate total number of products
  * @param list Pointer to ProductList
@@ -51,7 +137,7 @@ int report_top_products_by_value(const ProductList *list,
  * @param list Pointer to ProductList
  * @param results Output array
  * @param max_results Maximum number of results
- * @return Number of low stock products
+ * @return Number of low stock products (0 on allocation failure)
  */
 int report_low_stock_products(const ProductList *list,
                              Product *results, int max_results);
@@ -67,5 +153,107 @@ int report_transaction_count_by_date(const TransactionList *list,
                                      const char *start_date,
                                      const char *end_date);
 
+/**
+ * @brief Get transaction count within date range among the first rows
+ *
+ * For snapshot readers, which see only a prefix of the shared log.
+ *
+ * @param list Pointer to TransactionList
+ * @param count Number of leading rows to consider
+ * @param start_date Start date (YYYY-MM-DD)
+ * @param end_date End date (YYYY-MM-DD)
+ * @return Number of transactions
+ */
+int report_transaction_count_by_date_prefix(const TransactionList *list, int count,
+                                            const char *start_date,
+                                            const char *end_date);
+
+/**
+ * @brief Compute stock velocity, days of cover and turnover for every product
+ *
+ * Walks the transaction list once (O(products + transactions)). Average
+ * stock is the mean of the current quantity and the quantity implied at
+ * the start of the window. Rows are sorted fastest mover first.
+ *
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList
+ * @param window_days Window length in days (> 0)
+ * @param end_day Last day of the window (e.g. current_day())
+ * @param results Output array (room for products->count rows)
+ * @return Number of rows, or 0 on invalid arguments/allocation failure
+ */
+int report_stock_velocity(const ProductList *products,
+                          const TransactionList *transactions,
+                          int window_days, int end_day, VelocityRow *results);
+
+/**
+ * @brief Compute stock velocity over the first rows of the log
+ *
+ * For snapshot readers, which see only a prefix of the shared log.
+ *
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList
+ * @param count Number of leading log rows to consider
+ * @param window_days Window length in days (> 0)
+ * @param end_day Last day of the window (e.g. current_day())
+ * @param results Output array (room for products->count rows)
+ * @return Number of rows, or 0 on invalid arguments/allocation failure
+ */
+int report_stock_velocity_prefix(const ProductList *products,
+                                 const TransactionList *transactions, int count,
+                                 int window_days, int end_day, VelocityRow *results);
+
+/**
+ * @brief Compute the dashboard figures in a single pass over the products
+ *
+ * Gives the same results as report_total_products, report_total_stock_value,
+ * report_low_stock_products and both top-N reports (limited to
+ * REPORT_DASHBOARD_ROWS rows each) while reading each product once, using
+ * bounded heaps for the short lists.
+ *
+ * @param list Pointer to ProductList
+ * @param summary Output figures
+ * @return 1 on success, 0 on invalid arguments
+ */
+int report_dashboard(const ProductList *list, DashboardSummary *summary);
+
+/**
+ * @brief Aggregate stock by category or by supplier
+ *
+ * One pass over the products into a hash table of groups (on the thread
+ * pool for large lists, merging per-worker tables); only the groups are
+ * sorted. Supplier names are joined from the supplier list.
+ *
+ * @param products Pointer to ProductList
+ * @param suppliers Supplier names (may be NULL; needed for supplier grouping names)
+ * @param by Grouping
+ * @param sort Row order
+ * @param limit Maximum rows to return (0 = all)
+ * @param results Output array (room for products->count rows)
+ * @return Number of rows, or 0 on invalid arguments/allocation failure
+ */
+int report_group_stock(const ProductList *products, const SupplierList *suppliers,
+                       ReportGroupBy by, ReportGroupSort sort, int limit, GroupRow *results);
+
+/**
+ * @brief Classify products into A/B/C tiers by their share of stock value
+ *
+ * Ranking by value, a product is in tier A while the value before it is
+ * under a_share of the total, in tier B while it is under b_share, and in
+ * tier C otherwise. Only (value, slot) pairs are moved: a sum-guided
+ * quickselect finds the smallest set of top products covering b_share,
+ * and only that set is sorted. Tier C is counted but never ordered.
+ *
+ * @param list Pointer to ProductList
+ * @param a_share Tier A cutoff (0 < a_share <= b_share <= 1)
+ * @param b_share Tier B cutoff
+ * @param rows Output A and B rows, highest value first (may be NULL)
+ * @param max_rows Capacity of rows
+ * @param summary Output tier totals
+ * @return Number of rows written, or 0 on invalid arguments/allocation failure
+ */
+int report_abc_classification(const ProductList *list, double a_share, double b_share,
+                              AbcRow *rows, int max_rows, AbcSummary *summary);
+
 #endif /* REPORT_H */
 
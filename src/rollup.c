@@ -0,0 +1,339 @@
+/**
+ * @file rollup.c
+ * @brief Implementation of movement rollups
+ */
+
+#include "rollup.h"
+#include "metrics.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int cell_hash(int period, int key) {
+    return ((unsigned int)period * 2654435761u) ^ ((unsigned int)key * 2246822519u);
+}
+
+static void table_free(RollupTable *table) {
+    free(table->cells);
+    table->cells = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+static int table_grow(RollupTable *table) {
+    int capacity = (table->capacity > 0) ? table->capacity * 2 : 1024;
+    RollupCell *cells = calloc((size_t)capacity, sizeof(RollupCell));
+    if (cells == NULL) return 0;
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < table->capacity; i++) {
+        const RollupCell *c = &table->cells[i];
+        if (c->key == 0) continue;
+        unsigned int h = cell_hash(c->period, c->key) & mask;
+        while (cells[h].key != 0) {
+            h = (h + 1) & mask;
+        }
+        cells[h] = *c;
+    }
+    
+    free(table->cells);
+    table->cells = cells;
+    table->capacity = capacity;
+    return 1;
+}
+
+// Find a cell, creating it if needed (NULL on allocation failure)
+static RollupCell* table_upsert(RollupTable *table, int period, int key) {
+    // Keep load factor at or below 0.5
+    if ((table->count + 1) * 2 > table->capacity && !table_grow(table)) {
+        return NULL;
+    }
+    
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int h = cell_hash(period, key) & mask;
+    while (table->cells[h].key != 0) {
+        if (table->cells[h].period == period && table->cells[h].key == key) {
+            return &table->cells[h];
+        }
+        h = (h + 1) & mask;
+    }
+    
+    table->cells[h].period = period;
+    table->cells[h].key = key;
+    table->count++;
+    return &table->cells[h];
+}
+
+static const RollupCell* table_find(const RollupTable *table, int period, int key) {
+    if (table->capacity == 0) return NULL;
+    
+    unsigned int mask = (unsigned int)table->capacity - 1;
+    unsigned int h = cell_hash(period, key) & mask;
+    while (table->cells[h].key != 0) {
+        if (table->cells[h].period == period && table->cells[h].key == key) {
+            return &table->cells[h];
+        }
+        h = (h + 1) & mask;
+    }
+    return NULL;
+}
+
+static void totals_add(RollupTotals *into, const RollupTotals *from) {
+    into->in_units += from->in_units;
+    into->out_units += from->out_units;
+    into->movements += from->movements;
+}
+
+// Floor division, so days before 1970 land in the right week
+int rollup_week_of_day(int day) {
+    int d = day - 4;  // Day 4 (1970-01-05) is a Monday
+    return (d >= 0) ? d / 7 : -((-d + 6) / 7);
+}
+
+int rollup_week_start(int week) {
+    return week * 7 + 4;
+}
+
+// Case-insensitive category comparison, matching product_find_by_category
+static int same_category(const char *a, const char *b) {
+    while (*a != '\0' && *b != '\0') {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return 0;
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+// FNV-1a over the lowercase name, so spellings that compare equal collide
+static unsigned int category_hash(const char *category) {
+    unsigned int h = 2166136261u;
+    for (const char *c = category; *c != '\0'; c++) {
+        h = (h ^ (unsigned int)tolower((unsigned char)*c)) * 16777619u;
+    }
+    return h;
+}
+
+// Lookup cell holding a category, or the empty cell where it would go
+static int* lookup_cell(const Rollup *rollup, const char *category) {
+    unsigned int mask = (unsigned int)rollup->lookup_capacity - 1;
+    unsigned int h = category_hash(category) & mask;
+    while (rollup->category_lookup[h] != 0 &&
+           !same_category(rollup->categories[rollup->category_lookup[h] - 1], category)) {
+        h = (h + 1) & mask;
+    }
+    return &rollup->category_lookup[h];
+}
+
+static int find_category(const Rollup *rollup, const char *category) {
+    if (rollup->lookup_capacity == 0) return -1;
+    return *lookup_cell(rollup, category) - 1;
+}
+
+// Double the name array and the lookup table, keeping load at or below 0.5
+static int grow_categories(Rollup *rollup) {
+    int capacity = (rollup->category_capacity > 0) ? rollup->category_capacity * 2 : 64;
+    char (*names)[MAX_CATEGORY_LEN] = realloc(rollup->categories,
+                                              sizeof(*names) * (size_t)capacity);
+    if (names == NULL) return 0;
+    rollup->categories = names;
+    
+    int *lookup = calloc((size_t)capacity * 2, sizeof(int));
+    if (lookup == NULL) return 0;
+    free(rollup->category_lookup);
+    rollup->category_lookup = lookup;
+    rollup->lookup_capacity = capacity * 2;
+    rollup->category_capacity = capacity;
+    
+    for (int i = 0; i < rollup->category_count; i++) {
+        *lookup_cell(rollup, rollup->categories[i]) = i + 1;
+    }
+    return 1;
+}
+
+// Slot for a category name, interning it on first sight (-1 on allocation failure)
+static int intern_category(Rollup *rollup, const char *category) {
+    int slot = find_category(rollup, category);
+    if (slot >= 0) return slot;
+    
+    if (rollup->category_count == rollup->category_capacity && !grow_categories(rollup)) {
+        return -1;
+    }
+    slot = rollup->category_count++;
+    strncpy(rollup->categories[slot], category, MAX_CATEGORY_LEN - 1);
+    rollup->categories[slot][MAX_CATEGORY_LEN - 1] = '\0';
+    *lookup_cell(rollup, rollup->categories[slot]) = slot + 1;
+    return slot;
+}
+
+// Re-index product slots after products were added, removed or moved
+static int refresh_index(Rollup *rollup) {
+    const ProductList *products = rollup->products;
+    
+    product_index_free(&rollup->index);
+    free(rollup->slot_category);
+    rollup->slot_category = malloc(sizeof(int) * (size_t)(products->count + 1));
+    if (rollup->slot_category == NULL) return 0;
+    if (!product_index_build(&rollup->index, products)) return 0;
+    rollup->index_generation = products->generation;
+    
+    for (int i = 0; i < products->count; i++) {
+        rollup->slot_category[i] = intern_category(rollup, products->products[i].category);
+    }
+    return 1;
+}
+
+// Category slot of a product (-1 if the product no longer exists)
+static int category_of(Rollup *rollup, int product_id) {
+    const ProductList *products = rollup->products;
+    int slot = product_index_find(&rollup->index, products, product_id);
+    
+    if (slot < 0 || slot >= products->count) {
+        // Unchanged list: the product is gone, not just unindexed
+        if (rollup->index_generation == products->generation) return -1;
+        if (!refresh_index(rollup)) return -1;
+        slot = product_index_find(&rollup->index, products, product_id);
+        if (slot < 0) return -1;
+    }
+    
+    // The product may have been edited into another category
+    int category = rollup->slot_category[slot];
+    if (category < 0 ||
+        !same_category(rollup->categories[category], products->products[slot].category)) {
+        category = intern_category(rollup, products->products[slot].category);
+        rollup->slot_category[slot] = category;
+    }
+    return category;
+}
+
+void rollup_add(Rollup *rollup, const Transaction *transaction) {
+    if (rollup == NULL || transaction == NULL || rollup->products == NULL) return;
+    
+    int day;
+    if (!date_to_days(transaction->date_time, &day)) {
+        rollup->skipped++;
+        return;
+    }
+    
+    RollupTotals delta = {0, 0, 1};
+    if (strcmp(transaction->type, TRANSACTION_TYPE_IN) == 0) {
+        delta.in_units = transaction->quantity;
+    } else {
+        delta.out_units = transaction->quantity;
+    }
+    
+    RollupCell *cell = table_upsert(&rollup->product_days, day, transaction->product_id);
+    if (cell != NULL) totals_add(&cell->totals, &delta);
+    
+    int category = category_of(rollup, transaction->product_id);
+    if (category < 0) return;
+    
+    cell = table_upsert(&rollup->category_days, day, category + 1);
+    if (cell != NULL) totals_add(&cell->totals, &delta);
+    
+    cell = table_upsert(&rollup->category_weeks, rollup_week_of_day(day), category + 1);
+    if (cell != NULL) totals_add(&cell->totals, &delta);
+}
+
+void rollup_free(Rollup *rollup) {
+    if (rollup == NULL) return;
+    
+    table_free(&rollup->product_days);
+    table_free(&rollup->category_days);
+    table_free(&rollup->category_weeks);
+    product_index_free(&rollup->index);
+    free(rollup->slot_category);
+    rollup->slot_category = NULL;
+    free(rollup->categories);
+    rollup->categories = NULL;
+    free(rollup->category_lookup);
+    rollup->category_lookup = NULL;
+    rollup->category_count = 0;
+    rollup->category_capacity = 0;
+    rollup->lookup_capacity = 0;
+    rollup->skipped = 0;
+}
+
+int rollup_build(Rollup *rollup, const ProductList *products,
+                 const TransactionList *transactions) {
+    if (rollup == NULL || products == NULL || transactions == NULL) return 0;
+    
+    rollup_free(rollup);
+    rollup->products = products;
+    if (!refresh_index(rollup)) return 0;
+    
+    for (int i = 0; i < transactions->count; i++) {
+        rollup_add(rollup, &transactions->transactions[i]);
+    }
+    return 1;
+}
+
+static void rollup_listener(void *ctx, const Transaction *transaction) {
+    rollup_add((Rollup *)ctx, transaction);
+}
+
+int rollup_attach(Rollup *rollup, TransactionList *transactions) {
+    if (rollup == NULL) return 0;
+    return transaction_add_listener(transactions, rollup_listener, rollup);
+}
+
+RollupTotals rollup_product_range(const Rollup *rollup, int product_id,
+                                  int first_day, int last_day) {
+    RollupTotals totals = {0, 0, 0};
+    if (rollup == NULL) return totals;
+    
+    for (int day = first_day; day <= last_day; day++) {
+        const RollupCell *cell = table_find(&rollup->product_days, day, product_id);
+        if (cell != NULL) totals_add(&totals, &cell->totals);
+    }
+    return totals;
+}
+
+RollupTotals rollup_category_range(const Rollup *rollup, const char *category,
+                                   int first_day, int last_day) {
+    RollupTotals totals = {0, 0, 0};
+    if (rollup == NULL || category == NULL) return totals;
+    
+    int key = find_category(rollup, category) + 1;
+    if (key == 0) return totals;
+    
+    int day = first_day;
+    while (day <= last_day) {
+        int week = rollup_week_of_day(day);
+        int week_end = rollup_week_start(week) + 6;
+        
+        // Whole weeks come from the weekly table, partial ones day by day
+        if (day == rollup_week_start(week) && week_end <= last_day) {
+            const RollupCell *cell = table_find(&rollup->category_weeks, week, key);
+            if (cell != NULL) totals_add(&totals, &cell->totals);
+            day = week_end + 1;
+        } else {
+            const RollupCell *cell = table_find(&rollup->category_days, day, key);
+            if (cell != NULL) totals_add(&totals, &cell->totals);
+            day++;
+        }
+    }
+    return totals;
+}
+
+static int weekly_totals(const Rollup *rollup, const char *category,
+                         int first_week, int weeks, RollupTotals *results) {
+    if (rollup == NULL || category == NULL || results == NULL || weeks <= 0) return 0;
+    
+    memset(results, 0, sizeof(RollupTotals) * (size_t)weeks);
+    int key = find_category(rollup, category) + 1;
+    if (key == 0) return 0;
+    
+    for (int i = 0; i < weeks; i++) {
+        const RollupCell *cell = table_find(&rollup->category_weeks, first_week + i, key);
+        if (cell != NULL) results[i] = cell->totals;
+    }
+    return 1;
+}
+
+int rollup_category_weeks(const Rollup *rollup, const char *category,
+                          int first_week, int weeks, RollupTotals *results) {
+    MetricTimer timer = metrics_start();
+    int result = weekly_totals(rollup, category, first_week, weeks, results);
+    metrics_stop(METRIC_REPORT_ROLLUP_WEEKS, timer);
+    return result;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file rollup.h
+ * @brief Daily and weekly stock movement rollups
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Keeps IN/OUT unit totals per (day, product), per (day, category) and
+ * per (week, category). The rollups are rebuilt from the transaction log
+ * at load and then updated by a transaction listener, so time-based
+ * queries read a few hundred cells instead of rescanning the history.
+ *
+ * Days are numbered from 1970-01-01 (see date_to_days); weeks start on
+ * Monday. A transaction is counted under its product's category at the
+ * time it was added. The category table grows as new names appear.
+ */
+
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include "product.h"
+#include "transaction.h"
+
+/**
+ * @brief Movement totals for one cell or range
+ */
+typedef struct {
+    long in_units;      ///< Units received
+    long out_units;     ///< Units issued
+    int movements;      ///< Number of transactions
+} RollupTotals;
+
+/**
+ * @brief Hash table cell keyed by (period, key)
+ */
+typedef struct {
+    int period;         ///< Day or week number
+    int key;            ///< Product ID or category slot + 1 (0 = empty cell)
+    RollupTotals totals;
+} RollupCell;
+
+/**
+ * @brief Open-addressing table of rollup cells
+ */
+typedef struct {
+    RollupCell *cells;
+    int capacity;       ///< Power of two (0 = not allocated)
+    int count;          ///< Cells in use
+} RollupTable;
+
+/**
+ * @brief Rollup store
+ */
+typedef struct {
+    const ProductList *products;        ///< Products for category lookups
+    RollupTable product_days;           ///< (day, product ID)
+    RollupTable category_days;          ///< (day, category)
+    RollupTable category_weeks;         ///< (week, category)
+    char (*categories)[MAX_CATEGORY_LEN];   ///< Category names by slot
+    int category_count;
+    int category_capacity;              ///< Slots allocated in categories
+    int *category_lookup;               ///< Hash of names to slot + 1 (0 = empty)
+    int lookup_capacity;                ///< Power of two (0 = not allocated)
+    ProductIdIndex index;               ///< Product ID to slot
+    unsigned long index_generation;     ///< Product list generation the index was built at
+    int *slot_category;                 ///< Category of each product slot
+    int skipped;                        ///< Transactions with unreadable dates
+} Rollup;
+
+/**
+ * @brief Rebuild all rollups from a transaction log
+ *
+ * Safe to call repeatedly (e.g. after a restore); previous contents are
+ * discarded. The Rollup must be zero-initialized before the first call.
+ *
+ * @param rollup Rollup to rebuild
+ * @param products Product list used for categories
+ * @param transactions Log to aggregate
+ * @return 1 on success, 0 on allocation failure
+ */
+int rollup_build(Rollup *rollup, const ProductList *products,
+                 const TransactionList *transactions);
+
+/**
+ * @brief Release rollup memory
+ * @param rollup Rollup to free
+ */
+void rollup_free(Rollup *rollup);
+
+/**
+ * @brief Count one transaction
+ * @param rollup Pointer to Rollup
+ * @param transaction Transaction to add
+ */
+void rollup_add(Rollup *rollup, const Transaction *transaction);
+
+/**
+ * @brief Keep the rollup current with every later transaction_add
+ * @param rollup Pointer to Rollup
+ * @param transactions The list rollup_build was run on
+ * @return 1 on success, 0 if the list has no free listener slot
+ */
+int rollup_attach(Rollup *rollup, TransactionList *transactions);
+
+/**
+ * @brief Get a product's totals over a day range
+ * @param rollup Pointer to Rollup
+ * @param product_id Product ID
+ * @param first_day First day (inclusive)
+ * @param last_day Last day (inclusive)
+ * @return Totals over the range
+ */
+RollupTotals rollup_product_range(const Rollup *rollup, int product_id,
+                                  int first_day, int last_day);
+
+/**
+ * @brief Get a category's totals over a day range
+ * @param rollup Pointer to Rollup
+ * @param category Category name (case-insensitive)
+ * @param first_day First day (inclusive)
+ * @param last_day Last day (inclusive)
+ * @return Totals over the range (zero for an unknown category)
+ */
+RollupTotals rollup_category_range(const Rollup *rollup, const char *category,
+                                   int first_day, int last_day);
+
+/**
+ * @brief Get a category's totals for consecutive weeks
+ * @param rollup Pointer to Rollup
+ * @param category Category name (case-insensitive)
+ * @param first_week First week (see rollup_week_of_day)
+ * @param weeks Number of weeks
+ * @param results Output array with one entry per week
+ * @return 1 if the category is known, 0 otherwise (results zeroed)
+ */
+int rollup_category_weeks(const Rollup *rollup, const char *category,
+                          int first_week, int weeks, RollupTotals *results);
+
+/**
+ * @brief Get the week containing a day
+ * @param day Day number
+ * @return Week number
+ */
+int rollup_week_of_day(int day);
+
+/**
+ * @brief Get the first day (Monday) of a week
+ * @param week Week number
+ * @return Day number
+ */
+int rollup_week_start(int week);
+
+#endif /* ROLLUP_H */
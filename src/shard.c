@@ -0,0 +1,432 @@
+/**
+ * @file shard.c
+ * @brief Implementation of the sharded store
+ */
+
+#include "shard.h"
+#include "metrics.h"
+#include "storage.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Per-thread work item for shard fan-out
+ */
+typedef struct {
+    Shard *shard;
+    ShardSummary partial;
+} ShardTask;
+
+// Align a shard's next transaction ID to its residue class
+static void align_next_id(ShardedStore *store, int k) {
+    TransactionList *t = store->shards[k].transactions;
+    int id = transaction_get_next_id(t);
+    int n = store->count;
+    
+    id += ((k + 1 - id) % n + n) % n;
+    t->next_id = id;
+}
+
+// Keep new IDs above every imported/loaded ID in any shard
+static void sync_next_ids(ShardedStore *store) {
+    int max_next = 1;
+    for (int k = 0; k < store->count; k++) {
+        int next = transaction_get_next_id(store->shards[k].transactions);
+        if (next > max_next) max_next = next;
+    }
+    for (int k = 0; k < store->count; k++) {
+        store->shards[k].transactions->next_id = max_next;
+        align_next_id(store, k);
+    }
+}
+
+// Insert into a top-N list kept in descending value order
+static void top_insert(ShardSummary *s, int id, double value) {
+    if (s->top_count == SHARD_TOP_N && value <= s->top_values[SHARD_TOP_N - 1]) {
+        return;
+    }
+    
+    int pos = (s->top_count < SHARD_TOP_N) ? s->top_count++ : SHARD_TOP_N - 1;
+    while (pos > 0 && s->top_values[pos - 1] < value) {
+        s->top_ids[pos] = s->top_ids[pos - 1];
+        s->top_values[pos] = s->top_values[pos - 1];
+        pos--;
+    }
+    s->top_ids[pos] = id;
+    s->top_values[pos] = value;
+}
+
+int shard_store_init(ShardedStore *store, int shard_count) {
+    if (store == NULL || shard_count < 1 || shard_count > MAX_SHARDS) return 0;
+    
+    memset(store, 0, sizeof(*store));
+    for (int k = 0; k < shard_count; k++) {
+        Shard *shard = &store->shards[k];
+        shard->products = calloc(1, sizeof(ProductList));
+        shard->transactions = calloc(1, sizeof(TransactionList));
+        if (shard->products == NULL || shard->transactions == NULL) {
+            free(shard->products);
+            free(shard->transactions);
+            shard_store_free(store);
+            return 0;
+        }
+        
+        // The lists are already zero; *_list_init would clear (and so
+        // commit) every fixed-size array, so only the headers are reset
+        product_list_reset(shard->products);
+        transaction_list_reset(shard->transactions);
+        if (!product_index_build(&shard->index, shard->products)) {
+            free(shard->products);
+            free(shard->transactions);
+            shard_store_free(store);
+            return 0;
+        }
+        mutex_init(&shard->lock);
+        store->count++;
+    }
+    
+    sync_next_ids(store);
+    return 1;
+}
+
+void shard_store_free(ShardedStore *store) {
+    if (store == NULL) return;
+    
+    for (int k = 0; k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        mutex_destroy(&shard->lock);
+        product_index_free(&shard->index);
+        free(shard->products);
+        free(shard->transactions);
+    }
+    store->count = 0;
+}
+
+int shard_of(const ShardedStore *store, int product_id) {
+    if (store == NULL || store->count <= 1) return 0;
+    
+    // Same multiplicative hash family as the ID index, high bits
+    unsigned int h = (unsigned int)product_id * 2654435761u;
+    return (int)((h >> 16) % (unsigned int)store->count);
+}
+
+int shard_store_add_product(ShardedStore *store, const Product *product) {
+    if (store == NULL || product == NULL) return 0;
+    
+    Shard *shard = &store->shards[shard_of(store, product->id)];
+    int ok = 0;
+    
+    mutex_lock(&shard->lock);
+    if (product_index_find(&shard->index, shard->products, product->id) < 0 &&
+        shard->products->count < MAX_PRODUCTS &&
+        product_validate(product)) {
+        int slot = shard->products->count;
+        shard->products->products[slot] = *product;
+        shard->products->count++;
+        ok = product_index_insert(&shard->index, shard->products, slot);
+        if (ok) {
+            shard->products->generation = generation_next();
+        } else {
+            shard->products->count--;
+        }
+    }
+    mutex_unlock(&shard->lock);
+    
+    return ok;
+}
+
+int shard_store_get_product(ShardedStore *store, int product_id, Product *out) {
+    if (store == NULL || out == NULL) return 0;
+    
+    Shard *shard = &store->shards[shard_of(store, product_id)];
+    int found = 0;
+    
+    mutex_lock(&shard->lock);
+    int slot = product_index_find(&shard->index, shard->products, product_id);
+    if (slot >= 0) {
+        *out = shard->products->products[slot];
+        found = 1;
+    }
+    mutex_unlock(&shard->lock);
+    
+    return found;
+}
+
+StockStatus shard_store_move(ShardedStore *store, int product_id,
+                             const char *type, int quantity,
+                             const char *notes, Transaction *logged) {
+    if (store == NULL || store->count == 0) return STOCK_ERR_INVALID;
+    
+    MetricTimer timer = metrics_start();
+    int k = shard_of(store, product_id);
+    Shard *shard = &store->shards[k];
+    StockStatus status;
+    
+    mutex_lock(&shard->lock);
+    int slot = product_index_find(&shard->index, shard->products, product_id);
+    if (slot < 0) {
+        status = STOCK_ERR_NOT_FOUND;
+    } else {
+        status = stock_move_product(&shard->products->products[slot],
+                                    shard->transactions, type, quantity,
+                                    notes, logged);
+        if (status == STOCK_OK) {
+            shard->products->generation = generation_next();
+            align_next_id(store, k);
+        }
+    }
+    mutex_unlock(&shard->lock);
+    
+    metrics_stop(METRIC_STOCK_SHARD_MOVE, timer);
+    return status;
+}
+
+int shard_store_import(ShardedStore *store, const ProductList *products,
+                       const TransactionList *transactions) {
+    if (store == NULL || products == NULL || transactions == NULL) return 0;
+    
+    for (int i = 0; i < products->count; i++) {
+        if (!shard_store_add_product(store, &products->products[i])) {
+            return 0;
+        }
+    }
+    
+    for (int i = 0; i < transactions->count; i++) {
+        const Transaction *t = &transactions->transactions[i];
+        Shard *shard = &store->shards[shard_of(store, t->product_id)];
+        if (!transaction_add(shard->transactions, t)) {
+            return 0;
+        }
+    }
+    
+    sync_next_ids(store);
+    return 1;
+}
+
+// Check that every product of shard k hashes to it (a different shard count moves them)
+static int shard_owns_products(const ShardedStore *store, int k) {
+    const ProductList *list = store->shards[k].products;
+    for (int i = 0; i < list->count; i++) {
+        if (shard_of(store, list->products[i].id) != k) return 0;
+    }
+    return 1;
+}
+
+int shard_store_load(ShardedStore *store, const char *base_dir) {
+    if (store == NULL || base_dir == NULL) return 0;
+    
+    char path[256];
+    for (int k = 0; k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        
+        // The loads only reset the list headers, so a shard commits what it reads
+        mutex_lock(&shard->lock);
+        snprintf(path, sizeof(path), "%s/%d/products.txt", base_dir, k);
+        int ok = storage_load_products_file(shard->products, path);
+        snprintf(path, sizeof(path), "%s/%d/transactions.txt", base_dir, k);
+        ok = ok && storage_load_transactions_file(shard->transactions, path);
+        ok = ok && shard_owns_products(store, k);
+        
+        product_index_free(&shard->index);
+        ok = ok && product_index_build(&shard->index, shard->products);
+        mutex_unlock(&shard->lock);
+        
+        if (!ok) return 0;
+    }
+    
+    sync_next_ids(store);
+    return 1;
+}
+
+int shard_store_save(ShardedStore *store, const char *base_dir) {
+    if (store == NULL || base_dir == NULL) return 0;
+    
+    if (!storage_ensure_directory(base_dir)) return 0;
+    
+    char path[256];
+    int ok = 1;
+    for (int k = 0; k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        
+        snprintf(path, sizeof(path), "%s/%d", base_dir, k);
+        if (!storage_ensure_directory(path)) return 0;
+        
+        mutex_lock(&shard->lock);
+        snprintf(path, sizeof(path), "%s/%d/products.txt", base_dir, k);
+        ok = storage_save_products_file(shard->products, path) && ok;
+        snprintf(path, sizeof(path), "%s/%d/transactions.txt", base_dir, k);
+        ok = storage_save_transactions_file(shard->transactions, path) && ok;
+        mutex_unlock(&shard->lock);
+    }
+    
+    return ok;
+}
+
+// Summarize one shard under its own lock
+static void summarize_shard(void *arg) {
+    ShardTask *task = (ShardTask *)arg;
+    Shard *shard = task->shard;
+    ShardSummary *s = &task->partial;
+    
+    memset(s, 0, sizeof(*s));
+    mutex_lock(&shard->lock);
+    
+    const ProductList *list = shard->products;
+    s->product_count = list->count;
+    s->transaction_count = shard->transactions->count;
+    for (int i = 0; i < list->count; i++) {
+        const Product *p = &list->products[i];
+        double value = p->quantity_in_stock * p->unit_price;
+        
+        s->stock_value += value;
+        if (p->quantity_in_stock <= p->reorder_level) {
+            s->low_stock_count++;
+        }
+        top_insert(s, p->id, value);
+    }
+    
+    mutex_unlock(&shard->lock);
+}
+
+int shard_store_summary(ShardedStore *store, ShardSummary *summary) {
+    if (store == NULL || summary == NULL) return 0;
+    
+    ShardTask tasks[MAX_SHARDS];
+    Thread threads[MAX_SHARDS];
+    int started[MAX_SHARDS] = {0};
+    
+    // Fan out: one thread per shard (shard 0 runs on the caller)
+    for (int k = 0; k < store->count; k++) {
+        tasks[k].shard = &store->shards[k];
+        if (k > 0) {
+            started[k] = thread_start(&threads[k], summarize_shard, &tasks[k]);
+        }
+        if (!started[k]) {
+            summarize_shard(&tasks[k]);
+        }
+    }
+    for (int k = 1; k < store->count; k++) {
+        if (started[k]) {
+            thread_join(threads[k]);
+        }
+    }
+    
+    // Merge partial results
+    memset(summary, 0, sizeof(*summary));
+    for (int k = 0; k < store->count; k++) {
+        const ShardSummary *part = &tasks[k].partial;
+        summary->product_count += part->product_count;
+        summary->transaction_count += part->transaction_count;
+        summary->low_stock_count += part->low_stock_count;
+        summary->stock_value += part->stock_value;
+        for (int i = 0; i < part->top_count; i++) {
+            top_insert(summary, part->top_ids[i], part->top_values[i]);
+        }
+    }
+    
+    return 1;
+}
+
+void shard_store_counts(ShardedStore *store, int *products, int *transactions) {
+    int product_count = 0, transaction_count = 0;
+    
+    for (int k = 0; store != NULL && k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        mutex_lock(&shard->lock);
+        product_count += shard->products->count;
+        transaction_count += shard->transactions->count;
+        mutex_unlock(&shard->lock);
+    }
+    
+    if (products != NULL) *products = product_count;
+    if (transactions != NULL) *transactions = transaction_count;
+}
+
+static int product_key(const void *row) {
+    return ((const Product *)row)->id;
+}
+
+static int transaction_key(const void *row) {
+    return ((const Transaction *)row)->transaction_id;
+}
+
+// Merge the per-shard runs of gathered rows into key order (each run is in key order)
+static int merge_runs(void *rows, size_t row_size, int count, const int *run_start, int runs,
+                      int (*key)(const void *row)) {
+    if (runs <= 1 || count == 0) return 1;
+    
+    char *base = (char *)rows;
+    char *merged = malloc(row_size * (size_t)count);
+    if (merged == NULL) return 0;
+    
+    int next[MAX_SHARDS];
+    memcpy(next, run_start, sizeof(int) * (size_t)runs);
+    for (int i = 0; i < count; i++) {
+        int best = -1;
+        for (int r = 0; r < runs; r++) {
+            if (next[r] == run_start[r + 1]) continue;
+            if (best < 0 || key(base + row_size * (size_t)next[r]) <
+                            key(base + row_size * (size_t)next[best])) {
+                best = r;
+            }
+        }
+        memcpy(merged + row_size * (size_t)i, base + row_size * (size_t)next[best]++, row_size);
+    }
+    
+    memcpy(base, merged, row_size * (size_t)count);
+    free(merged);
+    return 1;
+}
+
+int shard_store_gather(ShardedStore *store, ProductList *products,
+                       TransactionList *transactions) {
+    if (store == NULL || products == NULL) return 0;
+    
+    // Each shard is copied under its own lock, so movements elsewhere go on
+    int run_start[MAX_SHARDS + 1];
+    product_list_reset(products);
+    for (int k = 0; k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        mutex_lock(&shard->lock);
+        int n = shard->products->count;
+        int fits = (products->count + n <= MAX_PRODUCTS);
+        if (fits) {
+            run_start[k] = products->count;
+            memcpy(&products->products[products->count], shard->products->products,
+                   sizeof(Product) * (size_t)n);
+            products->count += n;
+        }
+        mutex_unlock(&shard->lock);
+        if (!fits) return 0;
+    }
+    run_start[store->count] = products->count;
+    if (!merge_runs(products->products, sizeof(Product), products->count,
+                    run_start, store->count, product_key)) {
+        return 0;
+    }
+    if (transactions == NULL) return 1;
+    
+    transaction_list_reset(transactions);
+    for (int k = 0; k < store->count; k++) {
+        Shard *shard = &store->shards[k];
+        mutex_lock(&shard->lock);
+        int n = shard->transactions->count;
+        int fits = (transactions->count + n <= MAX_TRANSACTIONS);
+        if (fits) {
+            run_start[k] = transactions->count;
+            memcpy(&transactions->transactions[transactions->count],
+                   shard->transactions->transactions, sizeof(Transaction) * (size_t)n);
+            transactions->count += n;
+            if (shard->transactions->next_id > transactions->next_id) {
+                transactions->next_id = shard->transactions->next_id;
+            }
+        }
+        mutex_unlock(&shard->lock);
+        if (!fits) return 0;
+    }
+    run_start[store->count] = transactions->count;
+    
+    return merge_runs(transactions->transactions, sizeof(Transaction), transactions->count,
+                      run_start, store->count, transaction_key);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file shard.h
+ * @brief Optional sharded product/transaction store
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Products and their transactions are partitioned across shards by a
+ * hash of the product ID. Each shard has its own lists, ID index, lock
+ * and data files, so operations on one product touch one shard and
+ * writers on different shards never contend. Catalogue-wide summaries
+ * fan out one thread per shard and merge the partial results.
+ *
+ * Transaction IDs stay globally unique: shard k only issues IDs that
+ * are congruent to k + 1 modulo the shard count.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "product.h"
+#include "transaction.h"
+#include "stock.h"
+#include "sync.h"
+
+#define MAX_SHARDS 16
+#define SHARD_TOP_N 10
+#define SHARD_DIR "data/shards"
+
+/**
+ * @brief One partition of the store
+ */
+typedef struct {
+    ProductList *products;          ///< Products owned by this shard
+    TransactionList *transactions;  ///< Transactions of those products
+    ProductIdIndex index;           ///< ID to slot lookup
+    Mutex lock;                     ///< Guards lists and index
+} Shard;
+
+/**
+ * @brief Sharded store
+ */
+typedef struct {
+    Shard shards[MAX_SHARDS];
+    int count;                      ///< Number of shards in use
+} ShardedStore;
+
+/**
+ * @brief Merged catalogue-wide summary
+ */
+typedef struct {
+    int product_count;              ///< Products across all shards
+    int transaction_count;          ///< Transactions across all shards
+    int low_stock_count;            ///< Products at or below reorder level
+    double stock_value;             ///< Sum of quantity * price
+    int top_count;                  ///< Entries used in top_ids/top_values
+    int top_ids[SHARD_TOP_N];       ///< Top products by stock value
+    double top_values[SHARD_TOP_N]; ///< Stock value of each top product
+} ShardSummary;
+
+/**
+ * @brief Create an empty store
+ * @param store Store to initialize
+ * @param shard_count Number of shards (1..MAX_SHARDS)
+ * @return 1 on success, 0 on invalid count or allocation failure
+ */
+int shard_store_init(ShardedStore *store, int shard_count);
+
+/**
+ * @brief Release all shard memory
+ * @param store Store to free
+ */
+void shard_store_free(ShardedStore *store);
+
+/**
+ * @brief Get the shard that owns a product
+ * @param store Pointer to ShardedStore
+ * @param product_id Product ID
+ * @return Shard number
+ */
+int shard_of(const ShardedStore *store, int product_id);
+
+/**
+ * @brief Add a product to its shard (thread-safe)
+ * @param store Pointer to ShardedStore
+ * @param product Product to add
+ * @return 1 on success, 0 if full, duplicate or invalid
+ */
+int shard_store_add_product(ShardedStore *store, const Product *product);
+
+/**
+ * @brief Copy a product out of its shard (thread-safe)
+ * @param store Pointer to ShardedStore
+ * @param product_id Product ID
+ * @param out Output product
+ * @return 1 if found, 0 otherwise
+ */
+int shard_store_get_product(ShardedStore *store, int product_id, Product *out);
+
+/**
+ * @brief Apply a stock movement in the product's shard (thread-safe)
+ * @param store Pointer to ShardedStore
+ * @param product_id Product to move
+ * @param type TRANSACTION_TYPE_IN or TRANSACTION_TYPE_OUT
+ * @param quantity Units to move
+ * @param notes Optional notes (may be NULL)
+ * @param logged Optional output for the logged transaction (may be NULL)
+ * @return STOCK_OK on success, error status otherwise
+ */
+StockStatus shard_store_move(ShardedStore *store, int product_id,
+                             const char *type, int quantity,
+                             const char *notes, Transaction *logged);
+
+/**
+ * @brief Partition existing lists into the store
+ * @param store Empty store from shard_store_init
+ * @param products Products to distribute
+ * @param transactions Transactions to distribute (by product)
+ * @return 1 on success, 0 if a shard overflowed
+ */
+int shard_store_import(ShardedStore *store, const ProductList *products,
+                       const TransactionList *transactions);
+
+/**
+ * @brief Load every shard from <base_dir>/<k>/
+ * @param store Store from shard_store_init
+ * @param base_dir Base directory (e.g. SHARD_DIR)
+ * @return 1 on success, 0 on failure
+ */
+int shard_store_load(ShardedStore *store, const char *base_dir);
+
+/**
+ * @brief Save every shard to <base_dir>/<k>/
+ * @param store Pointer to ShardedStore
+ * @param base_dir Base directory (e.g. SHARD_DIR)
+ * @return 1 on success, 0 on failure
+ */
+int shard_store_save(ShardedStore *store, const char *base_dir);
+
+/**
+ * @brief Count the products and transactions across all shards
+ * @param store Pointer to ShardedStore
+ * @param products Output product count (may be NULL)
+ * @param transactions Output transaction count (may be NULL)
+ */
+void shard_store_counts(ShardedStore *store, int *products, int *transactions);
+
+/**
+ * @brief Copy every shard into one product list and log, for the report.c reports
+ *
+ * Each shard is copied under its own lock, then the per-shard runs are
+ * merged, products by ID and the log by transaction ID (so the result is
+ * fully ordered when every shard is). The target lists are overwritten
+ * without firing listeners, so they must not have any.
+ *
+ * @param store Pointer to ShardedStore
+ * @param products Output catalogue
+ * @param transactions Output log (NULL to copy only the products)
+ * @return 1 on success, 0 if the rows do not fit or on allocation failure
+ */
+int shard_store_gather(ShardedStore *store, ProductList *products,
+                       TransactionList *transactions);
+
+/**
+ * @brief Compute a catalogue-wide summary, one thread per shard
+ * @param store Pointer to ShardedStore
+ * @param summary Output merged summary
+ * @return 1 on success, 0 on failure
+ */
+int shard_store_summary(ShardedStore *store, ShardSummary *summary);
+
+#endif /* SHARD_H */
@@ -0,0 +1,454 @@
+/**
+ * @file sketch.c
+ * @brief Implementation of the movement sketches
+ */
+
+#include "sketch.h"
+#include "metrics.h"
+#include "utils.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SKETCH_NO_DAY INT_MIN
+
+// splitmix64 finalizer: a well-mixed 64-bit hash of a product ID
+static unsigned long long mix64(unsigned long long x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+static unsigned long long product_hash(int product_id, int seed) {
+    return mix64(((unsigned long long)(unsigned int)product_id << 8) | (unsigned int)seed);
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int ring_slot(int day) {
+    return ((day % SKETCH_DAYS) + SKETCH_DAYS) % SKETCH_DAYS;
+}
+
+// Sketch of a day if it is still in the ring (NULL otherwise)
+static const DaySketch* day_sketch(const MovementSketches *sketches, int day) {
+    const DaySketch *d = &sketches->days[ring_slot(day)];
+    return (d->day == day) ? d : NULL;
+}
+
+static void hll_add(unsigned char *registers, int product_id) {
+    unsigned long long h = product_hash(product_id, 0);
+    int index = (int)(h >> (64 - SKETCH_HLL_PRECISION));
+    unsigned long long rest = h << SKETCH_HLL_PRECISION;
+    
+    // Rank = position of the first 1 bit in the remaining bits
+    int rank = 1;
+    while (rank <= 64 - SKETCH_HLL_PRECISION && (rest & (1ULL << 63)) == 0) {
+        rest <<= 1;
+        rank++;
+    }
+    if (rank > registers[index]) {
+        registers[index] = (unsigned char)rank;
+    }
+}
+
+static double hll_estimate(const unsigned char *registers) {
+    const double m = SKETCH_HLL_REGISTERS;
+    double sum = 0.0;
+    int zeros = 0;
+    
+    for (int i = 0; i < SKETCH_HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -registers[i]);
+        if (registers[i] == 0) zeros++;
+    }
+    
+    double estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);  // Linear counting for small cardinalities
+    }
+    return estimate;
+}
+
+// Room a level may fill before it is compacted; shrinks by 2/3 per level below the top
+static int kll_capacity(const QuantileSketch *s, int level) {
+    double capacity = SKETCH_KLL_K;
+    for (int h = s->levels - 1; h > level; h--) {
+        capacity *= 2.0 / 3.0;
+    }
+    return (capacity < 2.0) ? 2 : (int)ceil(capacity);
+}
+
+static int kll_append(QuantileSketch *s, int level, int value) {
+    if (s->sizes[level] == s->allocated[level]) {
+        int room = (s->allocated[level] > 0) ? s->allocated[level] * 2 : 16;
+        int *grown = realloc(s->items[level], sizeof(int) * (size_t)room);
+        if (grown == NULL) return 0;
+        s->items[level] = grown;
+        s->allocated[level] = room;
+    }
+    s->items[level][s->sizes[level]++] = value;
+    return 1;
+}
+
+static unsigned int kll_coin(QuantileSketch *s) {
+    // xorshift32
+    s->random ^= s->random << 13;
+    s->random ^= s->random >> 17;
+    s->random ^= s->random << 5;
+    return s->random & 1u;
+}
+
+// Halve each full level: sort it and promote every other item, starting at a random one
+static void kll_compact(QuantileSketch *s) {
+    for (int h = 0; h < s->levels; h++) {
+        if (s->sizes[h] < kll_capacity(s, h)) continue;
+        if (h + 1 == s->levels) {
+            if (s->levels == SKETCH_KLL_MAX_LEVELS) return;
+            s->levels++;
+        }
+        
+        int *items = s->items[h];
+        int size = s->sizes[h];
+        qsort(items, (size_t)size, sizeof(int), compare_ints);
+        
+        int pairs = size & ~1;
+        for (int i = (int)kll_coin(s); i < pairs; i += 2) {
+            if (!kll_append(s, h + 1, items[i])) return;
+        }
+        
+        // An odd item out stays at this level
+        if (size & 1) {
+            items[0] = items[size - 1];
+        }
+        s->sizes[h] = size & 1;
+    }
+}
+
+static void kll_add(QuantileSketch *s, int value) {
+    if (s->levels == 0) {
+        s->levels = 1;
+        if (s->random == 0) s->random = 2463534242u;
+    }
+    if (!kll_append(s, 0, value)) return;
+    s->count++;
+    if (s->sizes[0] >= kll_capacity(s, 0)) {
+        kll_compact(s);
+    }
+}
+
+static void kll_free(QuantileSketch *s) {
+    for (int h = 0; h < SKETCH_KLL_MAX_LEVELS; h++) {
+        free(s->items[h]);
+    }
+    memset(s, 0, sizeof(QuantileSketch));
+}
+
+/**
+ * @brief Sketch item and the number of rows it stands for
+ */
+typedef struct {
+    int value;
+    long weight;
+} WeightedItem;
+
+static int compare_weighted(const void *a, const void *b) {
+    int x = ((const WeightedItem *)a)->value;
+    int y = ((const WeightedItem *)b)->value;
+    return (x > y) - (x < y);
+}
+
+// Rank (1-based) a quantile falls on among n rows
+static long quantile_rank(double q, long n) {
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    long rank = (long)ceil(q * (double)n);
+    return (rank < 1) ? 1 : rank;
+}
+
+static long cm_estimate(const DaySketch *d, int product_id) {
+    long estimate = LONG_MAX;
+    for (int r = 0; r < SKETCH_CM_DEPTH; r++) {
+        int col = (int)(product_hash(product_id, r + 1) & (SKETCH_CM_WIDTH - 1));
+        if (d->counts[r][col] < estimate) estimate = d->counts[r][col];
+    }
+    return estimate;
+}
+
+static void cm_add(DaySketch *d, int product_id, long units) {
+    for (int r = 0; r < SKETCH_CM_DEPTH; r++) {
+        int col = (int)(product_hash(product_id, r + 1) & (SKETCH_CM_WIDTH - 1));
+        d->counts[r][col] += units;
+    }
+}
+
+// Keep the day's candidates: known ones are refreshed, a new one replaces the smallest
+static void heavy_update(DaySketch *d, int product_id, long estimate) {
+    int smallest = -1;
+    for (int i = 0; i < d->heavy_count; i++) {
+        if (d->heavy[i].product_id == product_id) {
+            d->heavy[i].units = estimate;
+            return;
+        }
+        if (smallest < 0 || d->heavy[i].units < d->heavy[smallest].units) smallest = i;
+    }
+    
+    if (d->heavy_count < SKETCH_HEAVY_CANDIDATES) {
+        smallest = d->heavy_count++;
+    } else if (estimate <= d->heavy[smallest].units) {
+        return;
+    }
+    d->heavy[smallest].product_id = product_id;
+    d->heavy[smallest].units = estimate;
+}
+
+void sketch_observe(MovementSketches *sketches, const Transaction *transaction) {
+    if (sketches == NULL || transaction == NULL || sketches->days == NULL) return;
+    
+    kll_add(&sketches->quantities, transaction->quantity);
+    
+    int day;
+    if (!date_to_days(transaction->date_time, &day)) return;
+    
+    DaySketch *d = &sketches->days[ring_slot(day)];
+    if (d->day != day) {
+        if (d->day != SKETCH_NO_DAY && d->day > day) return;  // Older than the ring
+        memset(d, 0, sizeof(DaySketch));
+        d->day = day;
+    }
+    if (day > sketches->newest_day) {
+        sketches->newest_day = day;
+    }
+    
+    hll_add(d->registers, transaction->product_id);
+    if (strcmp(transaction->type, TRANSACTION_TYPE_OUT) == 0) {
+        cm_add(d, transaction->product_id, transaction->quantity);
+        heavy_update(d, transaction->product_id, cm_estimate(d, transaction->product_id));
+    }
+}
+
+void sketch_free(MovementSketches *sketches) {
+    if (sketches == NULL) return;
+    
+    free(sketches->days);
+    sketches->days = NULL;
+    kll_free(&sketches->quantities);
+}
+
+int sketch_build(MovementSketches *sketches, const TransactionList *transactions) {
+    if (sketches == NULL || transactions == NULL) return 0;
+    
+    sketch_free(sketches);
+    sketches->days = malloc(sizeof(DaySketch) * SKETCH_DAYS);
+    if (sketches->days == NULL) return 0;
+    for (int i = 0; i < SKETCH_DAYS; i++) {
+        sketches->days[i].day = SKETCH_NO_DAY;
+    }
+    sketches->newest_day = SKETCH_NO_DAY;
+    
+    for (int i = 0; i < transactions->count; i++) {
+        sketch_observe(sketches, &transactions->transactions[i]);
+    }
+    return 1;
+}
+
+static void sketch_listener(void *ctx, const Transaction *transaction) {
+    sketch_observe((MovementSketches *)ctx, transaction);
+}
+
+int sketch_attach(MovementSketches *sketches, TransactionList *transactions) {
+    if (sketches == NULL) return 0;
+    return transaction_add_listener(transactions, sketch_listener, sketches);
+}
+
+static double distinct_products(const MovementSketches *sketches, int first_day, int last_day) {
+    if (sketches == NULL || sketches->days == NULL || first_day > last_day) return -1;
+    if (last_day - first_day >= SKETCH_DAYS) return -1;
+    if (sketches->newest_day != SKETCH_NO_DAY && first_day <= sketches->newest_day - SKETCH_DAYS) {
+        return -1;
+    }
+    
+    // The union of several days is the register-wise maximum
+    unsigned char merged[SKETCH_HLL_REGISTERS] = {0};
+    for (int day = first_day; day <= last_day; day++) {
+        const DaySketch *d = day_sketch(sketches, day);
+        if (d == NULL) continue;
+        for (int i = 0; i < SKETCH_HLL_REGISTERS; i++) {
+            if (d->registers[i] > merged[i]) merged[i] = d->registers[i];
+        }
+    }
+    return hll_estimate(merged);
+}
+
+double sketch_distinct_products(const MovementSketches *sketches, int first_day, int last_day) {
+    MetricTimer timer = metrics_start();
+    double result = distinct_products(sketches, first_day, last_day);
+    metrics_stop(METRIC_REPORT_SKETCH_DISTINCT, timer);
+    return result;
+}
+
+static int quantity_quantile(const MovementSketches *sketches, double q, int *quantity) {
+    if (sketches == NULL || quantity == NULL) return 0;
+    
+    const QuantileSketch *s = &sketches->quantities;
+    int items = 0;
+    for (int h = 0; h < s->levels; h++) {
+        items += s->sizes[h];
+    }
+    if (items == 0) return 0;
+    
+    WeightedItem *all = malloc(sizeof(WeightedItem) * (size_t)items);
+    if (all == NULL) return 0;
+    
+    int n = 0;
+    long total = 0;
+    for (int h = 0; h < s->levels; h++) {
+        for (int i = 0; i < s->sizes[h]; i++) {
+            all[n].value = s->items[h][i];
+            all[n].weight = 1L << h;
+            total += all[n].weight;
+            n++;
+        }
+    }
+    qsort(all, (size_t)n, sizeof(WeightedItem), compare_weighted);
+    
+    long rank = quantile_rank(q, total);
+    long seen = 0;
+    *quantity = all[n - 1].value;
+    for (int i = 0; i < n; i++) {
+        seen += all[i].weight;
+        if (seen >= rank) {
+            *quantity = all[i].value;
+            break;
+        }
+    }
+    
+    free(all);
+    return 1;
+}
+
+int sketch_quantity_quantile(const MovementSketches *sketches, double q, int *quantity) {
+    MetricTimer timer = metrics_start();
+    int result = quantity_quantile(sketches, q, quantity);
+    metrics_stop(METRIC_REPORT_SKETCH_QUANTILE, timer);
+    return result;
+}
+
+static int compare_heavy(const void *a, const void *b) {
+    const HeavyHitter *x = (const HeavyHitter *)a;
+    const HeavyHitter *y = (const HeavyHitter *)b;
+    if (x->units != y->units) return (x->units < y->units) - (x->units > y->units);
+    return (x->product_id > y->product_id) - (x->product_id < y->product_id);
+}
+
+static int top_sellers(const MovementSketches *sketches, int last_day, int window_days,
+                       HeavyHitter *results, int max_results) {
+    if (sketches == NULL || sketches->days == NULL || results == NULL || max_results <= 0) return 0;
+    if (window_days < 1 || window_days > SKETCH_DAYS) return 0;
+    
+    // Candidates: every product that was a heavy hitter on some day in the window
+    HeavyHitter *candidates = malloc(sizeof(HeavyHitter) * SKETCH_DAYS * SKETCH_HEAVY_CANDIDATES);
+    if (candidates == NULL) return 0;
+    
+    int count = 0;
+    for (int day = last_day - window_days + 1; day <= last_day; day++) {
+        const DaySketch *d = day_sketch(sketches, day);
+        if (d == NULL) continue;
+        for (int i = 0; i < d->heavy_count; i++) {
+            int known = 0;
+            for (int c = 0; c < count && !known; c++) {
+                known = (candidates[c].product_id == d->heavy[i].product_id);
+            }
+            if (!known) {
+                candidates[count].product_id = d->heavy[i].product_id;
+                candidates[count].units = 0;
+                count++;
+            }
+        }
+    }
+    
+    // Window estimate: per-day Count-Min estimates summed over the window
+    for (int day = last_day - window_days + 1; day <= last_day; day++) {
+        const DaySketch *d = day_sketch(sketches, day);
+        if (d == NULL) continue;
+        for (int c = 0; c < count; c++) {
+            candidates[c].units += cm_estimate(d, candidates[c].product_id);
+        }
+    }
+    
+    qsort(candidates, (size_t)count, sizeof(HeavyHitter), compare_heavy);
+    if (count > max_results) count = max_results;
+    memcpy(results, candidates, sizeof(HeavyHitter) * (size_t)count);
+    
+    free(candidates);
+    return count;
+}
+
+int sketch_top_sellers(const MovementSketches *sketches, int last_day, int window_days,
+                       HeavyHitter *results, int max_results) {
+    MetricTimer timer = metrics_start();
+    int result = top_sellers(sketches, last_day, window_days, results, max_results);
+    metrics_stop(METRIC_REPORT_SKETCH_TOP_SELLERS, timer);
+    return result;
+}
+
+int sketch_exact_distinct(const TransactionList *transactions, int first_day, int last_day) {
+    if (transactions == NULL) return -1;
+    
+    int *ids = malloc(sizeof(int) * (size_t)(transactions->count + 1));
+    if (ids == NULL) return -1;
+    
+    int n = 0;
+    for (int i = 0; i < transactions->count; i++) {
+        int day;
+        if (date_to_days(transactions->transactions[i].date_time, &day) &&
+            day >= first_day && day <= last_day) {
+            ids[n++] = transactions->transactions[i].product_id;
+        }
+    }
+    qsort(ids, (size_t)n, sizeof(int), compare_ints);
+    
+    int distinct = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || ids[i] != ids[i - 1]) distinct++;
+    }
+    
+    free(ids);
+    return distinct;
+}
+
+int sketch_exact_quantile(const TransactionList *transactions, double q, int *quantity) {
+    if (transactions == NULL || quantity == NULL || transactions->count == 0) return 0;
+    
+    int *values = malloc(sizeof(int) * (size_t)transactions->count);
+    if (values == NULL) return 0;
+    
+    for (int i = 0; i < transactions->count; i++) {
+        values[i] = transactions->transactions[i].quantity;
+    }
+    qsort(values, (size_t)transactions->count, sizeof(int), compare_ints);
+    *quantity = values[quantile_rank(q, transactions->count) - 1];
+    
+    free(values);
+    return 1;
+}
+
+long sketch_exact_out_units(const TransactionList *transactions, int product_id,
+                            int last_day, int window_days) {
+    if (transactions == NULL) return 0;
+    
+    long units = 0;
+    for (int i = 0; i < transactions->count; i++) {
+        const Transaction *t = &transactions->transactions[i];
+        int day;
+        if (t->product_id == product_id && strcmp(t->type, TRANSACTION_TYPE_OUT) == 0 &&
+            date_to_days(t->date_time, &day) && day > last_day - window_days && day <= last_day) {
+            units += t->quantity;
+        }
+    }
+    return units;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file sketch.h
+ * @brief Approximate movement analytics in small fixed memory
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Three sketches are kept current from the transaction log, each updated
+ * in O(1) (amortized) per added row:
+ *
+ * - Distinct products moved per day: one HyperLogLog per day for the last
+ *   SKETCH_DAYS days, 2^SKETCH_HLL_PRECISION one-byte registers each.
+ *   Standard error 1.04 / sqrt(2^p) = 1.6% for p = 12; days can be merged
+ *   to count distinct products over a range of days.
+ *
+ * - Movement-quantity quantiles: a KLL sketch with SKETCH_KLL_K = 200 over
+ *   every movement. A quantile's rank is within about 1.7% of the true rank
+ *   (99% confidence), using O(k) items regardless of the log size.
+ *
+ * - Top-selling products: one Count-Min sketch of OUT units per day
+ *   (SKETCH_CM_DEPTH rows of SKETCH_CM_WIDTH counters), plus a short list
+ *   of heavy-hitter candidates per day. Summed over a sliding window of
+ *   days, an estimate never undercounts and overcounts by at most
+ *   e / width of the window's OUT units (0.27%) with probability
+ *   1 - e^-depth (98%).
+ *
+ * Rows whose date is older than the day ring only feed the quantile
+ * sketch. Exact reference computations are provided for benchmarking.
+ */
+
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include "transaction.h"
+
+#define SKETCH_DAYS 32                  // Days of distinct and top-N history
+#define SKETCH_HLL_PRECISION 12         // Registers = 2^precision
+#define SKETCH_HLL_REGISTERS (1 << SKETCH_HLL_PRECISION)
+#define SKETCH_KLL_K 200                // Size of the top compactor
+#define SKETCH_KLL_MAX_LEVELS 40
+#define SKETCH_CM_WIDTH 1024            // Counters per row (power of two)
+#define SKETCH_CM_DEPTH 4               // Independent rows
+#define SKETCH_HEAVY_CANDIDATES 32      // Heavy-hitter candidates per day
+
+/**
+ * @brief KLL quantile sketch over integer quantities
+ */
+typedef struct {
+    int *items[SKETCH_KLL_MAX_LEVELS];      ///< Level h items each stand for 2^h rows
+    int sizes[SKETCH_KLL_MAX_LEVELS];       ///< Items held per level
+    int allocated[SKETCH_KLL_MAX_LEVELS];   ///< Room per level
+    int levels;                             ///< Levels in use
+    long count;                             ///< Rows added
+    unsigned int random;                    ///< Compaction coin state
+} QuantileSketch;
+
+/**
+ * @brief Estimated OUT units of a heavy-hitter candidate on one day
+ */
+typedef struct {
+    int product_id;
+    long units;
+} HeavyHitter;
+
+/**
+ * @brief Sketches of one day
+ */
+typedef struct {
+    int day;                                            ///< Day number of the slot's data
+    unsigned char registers[SKETCH_HLL_REGISTERS];      ///< HyperLogLog
+    long counts[SKETCH_CM_DEPTH][SKETCH_CM_WIDTH];      ///< Count-Min of OUT units
+    HeavyHitter heavy[SKETCH_HEAVY_CANDIDATES];
+    int heavy_count;
+} DaySketch;
+
+/**
+ * @brief All movement sketches
+ *
+ * Zero-initialize, then sketch_build. About 1.2 MB is allocated; free
+ * with sketch_free.
+ */
+typedef struct {
+    DaySketch *days;            ///< Ring of SKETCH_DAYS days (NULL = not built)
+    QuantileSketch quantities;
+    int newest_day;             ///< Newest day seen
+} MovementSketches;
+
+/**
+ * @brief Rebuild the sketches from the log
+ * @param sketches Sketches to rebuild
+ * @param transactions The log
+ * @return 1 on success, 0 on allocation failure
+ */
+int sketch_build(MovementSketches *sketches, const TransactionList *transactions);
+
+/**
+ * @brief Keep the sketches current as transactions are added
+ * @param sketches Sketches
+ * @param transactions List to listen to
+ * @return 1 on success, 0 if no listener slot is free
+ */
+int sketch_attach(MovementSketches *sketches, TransactionList *transactions);
+
+/**
+ * @brief Fold one transaction into the sketches
+ * @param sketches Sketches
+ * @param transaction Added transaction
+ */
+void sketch_observe(MovementSketches *sketches, const Transaction *transaction);
+
+/**
+ * @brief Release sketch memory
+ * @param sketches Sketches to free
+ */
+void sketch_free(MovementSketches *sketches);
+
+/**
+ * @brief Estimate distinct products moved over a range of days
+ * @param sketches Sketches
+ * @param first_day First day (inclusive)
+ * @param last_day Last day (inclusive)
+ * @return Estimated count, or -1 if the range is outside the day ring
+ */
+double sketch_distinct_products(const MovementSketches *sketches, int first_day, int last_day);
+
+/**
+ * @brief Estimate a movement-quantity quantile
+ * @param sketches Sketches
+ * @param q Quantile in [0, 1] (0.5 = median)
+ * @param quantity Output quantity
+ * @return 1 on success, 0 if no movements were seen
+ */
+int sketch_quantity_quantile(const MovementSketches *sketches, double q, int *quantity);
+
+/**
+ * @brief Estimate the top-selling products over the last days
+ * @param sketches Sketches
+ * @param last_day Last day of the window
+ * @param window_days Days in the window (1 to SKETCH_DAYS)
+ * @param results Output, most units first
+ * @param max_results Capacity of results
+ * @return Number of results
+ */
+int sketch_top_sellers(const MovementSketches *sketches, int last_day, int window_days,
+                       HeavyHitter *results, int max_results);
+
+/**
+ * @brief Exact distinct products moved over a range of days (reference)
+ * @param transactions The log
+ * @param first_day First day (inclusive)
+ * @param last_day Last day (inclusive)
+ * @return Count, or -1 on allocation failure
+ */
+int sketch_exact_distinct(const TransactionList *transactions, int first_day, int last_day);
+
+/**
+ * @brief Exact movement-quantity quantile (reference, same rank rule as the sketch)
+ * @param transactions The log
+ * @param q Quantile in [0, 1]
+ * @param quantity Output quantity
+ * @return 1 on success, 0 if the log is empty or on allocation failure
+ */
+int sketch_exact_quantile(const TransactionList *transactions, double q, int *quantity);
+
+/**
+ * @brief Exact OUT units of one product over a window (reference)
+ * @param transactions The log
+ * @param product_id Product ID
+ * @param last_day Last day of the window
+ * @param window_days Days in the window
+ * @return Units issued
+ */
+long sketch_exact_out_units(const TransactionList *transactions, int product_id,
+                            int last_day, int window_days);
+
+#endif /* SKETCH_H */
@@ -0,0 +1,111 @@
+/**
+ * @file snapshot.c
+ * @brief Implementation of reference-counted read snapshots
+ */
+
+#include "snapshot.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Copy the live lists into a new version holding one reference
+static Snapshot* snapshot_create(const SnapshotStore *store, unsigned long version,
+                                 SnapshotCopyFunc copy_products, void *ctx) {
+    Snapshot *snap = malloc(sizeof(Snapshot));
+    ProductList *copy = malloc(sizeof(ProductList));
+    if (snap == NULL || copy == NULL) {
+        free(snap);
+        free(copy);
+        return NULL;
+    }
+    
+    // Only the used prefix of the array is copied
+    const ProductList *live = store->products;
+    copy->count = live->count;
+    copy->generation = live->generation;
+    if (copy_products != NULL) {
+        copy_products(ctx, copy);
+    } else {
+        memcpy(copy->products, live->products, sizeof(Product) * (size_t)live->count);
+    }
+    
+    snap->products = copy;
+    snap->transactions = store->transactions;
+    snap->transaction_count = store->transactions->count;
+    snap->version = version;
+    snap->product_generation = live->generation;
+    snap->transaction_generation = store->transactions->generation;
+    atomic_init(&snap->refs, 1);
+    return snap;
+}
+
+int snapshot_store_init(SnapshotStore *store, const ProductList *products,
+                        const TransactionList *transactions) {
+    if (store == NULL || products == NULL || transactions == NULL) return 0;
+    
+    store->products = products;
+    store->transactions = transactions;
+    store->version = 1;
+    store->current = snapshot_create(store, store->version, NULL, NULL);
+    if (store->current == NULL) return 0;
+    
+    mutex_init(&store->lock);
+    return 1;
+}
+
+void snapshot_store_free(SnapshotStore *store) {
+    if (store == NULL || store->current == NULL) return;
+    
+    snapshot_release(store->current);
+    store->current = NULL;
+    mutex_destroy(&store->lock);
+}
+
+int snapshot_publish(SnapshotStore *store) {
+    return snapshot_publish_with(store, NULL, NULL);
+}
+
+int snapshot_publish_with(SnapshotStore *store, SnapshotCopyFunc copy, void *ctx) {
+    if (store == NULL || store->current == NULL) return 0;
+    
+    // Only the writer replaces current, so reading it unlocked is safe here
+    const Snapshot *current = store->current;
+    if (current->product_generation == store->products->generation &&
+        current->transaction_generation == store->transactions->generation) {
+        return 1;
+    }
+    
+    Snapshot *snap = snapshot_create(store, store->version + 1, copy, ctx);
+    if (snap == NULL) return 0;
+    
+    mutex_lock(&store->lock);
+    Snapshot *old = store->current;
+    store->current = snap;
+    store->version++;
+    mutex_unlock(&store->lock);
+    
+    // Freed now unless a reader still has it pinned
+    snapshot_release(old);
+    return 1;
+}
+
+Snapshot* snapshot_acquire(SnapshotStore *store) {
+    if (store == NULL) return NULL;
+    
+    mutex_lock(&store->lock);
+    Snapshot *snap = store->current;
+    if (snap != NULL) {
+        atomic_fetch_add(&snap->refs, 1);
+    }
+    mutex_unlock(&store->lock);
+    
+    return snap;
+}
+
+void snapshot_release(Snapshot *snapshot) {
+    if (snapshot == NULL) return;
+    
+    if (atomic_fetch_sub(&snapshot->refs, 1) == 1) {
+        free((ProductList *)snapshot->products);
+        free(snapshot);
+    }
+}
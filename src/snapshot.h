@@ -0,0 +1,121 @@
+/**
+ * @file snapshot.h
+ * @brief Reference-counted read snapshots of the product and transaction lists
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A writer publishes versions; readers pin the current version, run
+ * against it for as long as they like and release it. Pinning and
+ * publishing only hold the store lock for a pointer swap, so a long
+ * report never blocks stock movements and always sees one consistent
+ * state. A version is freed when its last holder releases it.
+ *
+ * Each version owns a copy of the product list. The transaction list is
+ * append-only, so versions share it and only record how many rows were
+ * visible when they were published; readers must stop at that count.
+ *
+ * Publishing copies the whole used part of the product array, so it costs
+ * O(products) however few products changed. That is why it is skipped
+ * when neither list changed and only runs when a reader needs a new
+ * version. Versions are not chunked copy-on-write because every report
+ * takes a contiguous ProductList.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdatomic.h>
+#include "product.h"
+#include "transaction.h"
+#include "sync.h"
+
+/**
+ * @brief One published, immutable version
+ */
+typedef struct {
+    const ProductList *products;         ///< Private copy of the products
+    const TransactionList *transactions; ///< Shared log; read only the first transaction_count rows
+    int transaction_count;               ///< Log rows visible in this version
+    unsigned long version;               ///< Publish sequence number
+    unsigned long product_generation;    ///< Product list generation copied
+    unsigned long transaction_generation;///< Transaction list generation seen
+    atomic_int refs;                     ///< Store reference + pinned readers
+} Snapshot;
+
+/**
+ * @brief Publisher of versions over one pair of live lists
+ */
+typedef struct {
+    const ProductList *products;         ///< Live products (single writer)
+    const TransactionList *transactions; ///< Live log (append-only while the store is open)
+    Snapshot *current;                   ///< Latest version
+    unsigned long version;               ///< Last version number issued
+    Mutex lock;                          ///< Guards current
+} SnapshotStore;
+
+/**
+ * @brief Open a store and publish the first version
+ * @param store Store to initialize
+ * @param products Live product list
+ * @param transactions Live transaction list
+ * @return 1 on success, 0 on allocation failure
+ */
+int snapshot_store_init(SnapshotStore *store, const ProductList *products,
+                        const TransactionList *transactions);
+
+/**
+ * @brief Close a store
+ *
+ * Versions still pinned stay valid until released.
+ *
+ * @param store Store to close
+ */
+void snapshot_store_free(SnapshotStore *store);
+
+/**
+ * @brief Publish the live lists as a new version (writer side)
+ *
+ * Must be called by the thread that writes the live lists, between
+ * changes. Does nothing when neither list changed since the last version.
+ *
+ * @param store Pointer to SnapshotStore
+ * @return 1 on success, 0 on allocation failure (previous version stays current)
+ */
+int snapshot_publish(SnapshotStore *store);
+
+/**
+ * @brief Fill a new version's products from the live list
+ * @param ctx Context given to snapshot_publish_with
+ * @param copy Version's list; write slots 0 to copy->count - 1
+ */
+typedef void (*SnapshotCopyFunc)(void *ctx, ProductList *copy);
+
+/**
+ * @brief Publish with a caller-supplied product copy
+ *
+ * For live lists whose products other threads update in place (see
+ * stock_engine_publish): copy reads each product under whatever lock
+ * guards it, instead of one memcpy of the whole array. The caller must
+ * still be the only thread publishing and changing the list generations.
+ *
+ * @param store Pointer to SnapshotStore
+ * @param copy Copy function
+ * @param ctx Context passed to copy
+ * @return 1 on success, 0 on allocation failure (previous version stays current)
+ */
+int snapshot_publish_with(SnapshotStore *store, SnapshotCopyFunc copy, void *ctx);
+
+/**
+ * @brief Pin the current version (reader side, thread-safe)
+ * @param store Pointer to SnapshotStore
+ * @return Pinned version; pass to snapshot_release when done
+ */
+Snapshot* snapshot_acquire(SnapshotStore *store);
+
+/**
+ * @brief Release a pinned version, freeing it if it is no longer current
+ * @param snapshot Version from snapshot_acquire (NULL is ignored)
+ */
+void snapshot_release(Snapshot *snapshot);
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,102 @@
+/**
+ * @file startup.c
+ * @brief Implementation of startup phase timing
+ */
+
+#include "startup.h"
+#include "sync.h"
+#include "utils.h"
+#include <string.h>
+
+void startup_profile_begin(StartupProfile *profile) {
+    if (profile == NULL) return;
+    memset(profile, 0, sizeof(*profile));
+    profile->begin_ns = sync_clock_ns();
+    profile->mark_ns = profile->begin_ns;
+}
+
+int startup_profile_mark(StartupProfile *profile, const char *name, const LoadStats *load) {
+    if (profile == NULL || name == NULL) return 0;
+    
+    unsigned long long now = sync_clock_ns();
+    if (profile->count >= STARTUP_MAX_PHASES) {
+        profile->mark_ns = now;
+        return 0;
+    }
+    
+    StartupPhase *phase = &profile->phases[profile->count++];
+    phase->name = name;
+    phase->ns = now - profile->mark_ns;
+    phase->has_load = (load != NULL);
+    if (load != NULL) phase->load = *load;
+    profile->mark_ns = now;
+    return 1;
+}
+
+unsigned long long startup_profile_total(const StartupProfile *profile) {
+    if (profile == NULL) return 0;
+    return profile->mark_ns - profile->begin_ns;
+}
+
+// Sum of the file counters of every phase
+static LoadStats load_totals(const StartupProfile *profile) {
+    LoadStats total = {0, 0, 0};
+    for (int i = 0; i < profile->count; i++) {
+        if (!profile->phases[i].has_load) continue;
+        total.bytes += profile->phases[i].load.bytes;
+        total.rows += profile->phases[i].load.rows;
+        total.rejected += profile->phases[i].load.rejected;
+    }
+    return total;
+}
+
+void startup_profile_print(const StartupProfile *profile, FILE *out) {
+    if (profile == NULL || out == NULL) return;
+    
+    unsigned long long total_ns = startup_profile_total(profile);
+    fprintf(out, "%-20s %10s %6s %12s %10s %9s\n", "Startup phase", "Time (ms)", "Share",
+            "Bytes", "Rows", "Rejected");
+    for (int i = 0; i < profile->count; i++) {
+        const StartupPhase *phase = &profile->phases[i];
+        double share = (total_ns > 0) ? 100.0 * (double)phase->ns / (double)total_ns : 0.0;
+        
+        fprintf(out, "%-20s %10.3f %5.1f%%", phase->name, (double)phase->ns / 1e6, share);
+        if (phase->has_load) {
+            fprintf(out, " %12lld %10d %9d\n", phase->load.bytes, phase->load.rows,
+                    phase->load.rejected);
+        } else {
+            fprintf(out, "\n");
+        }
+    }
+    
+    LoadStats total = load_totals(profile);
+    fprintf(out, "%-20s %10.3f %5.1f%% %12lld %10d %9d\n", "total", (double)total_ns / 1e6,
+            100.0, total.bytes, total.rows, total.rejected);
+}
+
+int startup_profile_write_file(const StartupProfile *profile, const char *path) {
+    if (profile == NULL || path == NULL) return 0;
+    
+    FILE *file = fopen(path, "a");
+    if (file == NULL) return 0;
+    
+    char now[30];
+    get_current_datetime(now, sizeof(now));
+    fprintf(file, "# startup %s\n", now);
+    fprintf(file, "phase|ms|bytes|rows|rejected\n");
+    for (int i = 0; i < profile->count; i++) {
+        const StartupPhase *phase = &profile->phases[i];
+        fprintf(file, "%s|%.3f|", phase->name, (double)phase->ns / 1e6);
+        if (phase->has_load) {
+            fprintf(file, "%lld|%d|%d\n", phase->load.bytes, phase->load.rows,
+                    phase->load.rejected);
+        } else {
+            fprintf(file, "||\n");
+        }
+    }
+    
+    LoadStats total = load_totals(profile);
+    fprintf(file, "total|%.3f|%lld|%d|%d\n", (double)startup_profile_total(profile) / 1e6,
+            total.bytes, total.rows, total.rejected);
+    return fclose(file) == 0;
+}
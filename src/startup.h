@@ -0,0 +1,92 @@
+/**
+ * @file startup.h
+ * @brief Phase-by-phase timing of program startup
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * Startup is a sequence of phases (create directories, load each data
+ * file, build each derived index, ...). The caller marks the end of each
+ * phase; the time since the previous mark is charged to it, so the phases
+ * add up to the whole startup. Phases that read a data file also carry
+ * the bytes read and the rows parsed and rejected.
+ *
+ * Usage:
+ *   startup_profile_begin(&profile);
+ *   storage_load_products(&products, &load);
+ *   startup_profile_mark(&profile, "load.products", &load);
+ *   ...
+ *   startup_profile_print(&profile, stderr);
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <stdio.h>
+#include "storage.h"
+
+#define STARTUP_MAX_PHASES 24
+
+/**
+ * @brief One timed phase
+ */
+typedef struct {
+    const char *name;               ///< Phase name (string literal)
+    unsigned long long ns;          ///< Time taken
+    int has_load;                   ///< Whether load holds file counters
+    LoadStats load;                 ///< What the phase read
+} StartupPhase;
+
+/**
+ * @brief Phases of one startup
+ */
+typedef struct {
+    StartupPhase phases[STARTUP_MAX_PHASES];
+    int count;
+    unsigned long long begin_ns;    ///< Clock when profiling began
+    unsigned long long mark_ns;     ///< Clock at the last mark
+} StartupProfile;
+
+/**
+ * @brief Start a profile, discarding any earlier phases
+ * @param profile Profile to reset
+ */
+void startup_profile_begin(StartupProfile *profile);
+
+/**
+ * @brief End the current phase
+ * @param profile Profile
+ * @param name Phase name (string literal, kept by pointer)
+ * @param load File counters of the phase, or NULL if it read no file
+ * @return 1 on success, 0 if the profile is full
+ */
+int startup_profile_mark(StartupProfile *profile, const char *name, const LoadStats *load);
+
+/**
+ * @brief Total time from startup_profile_begin to the last mark
+ * @param profile Profile
+ * @return Nanoseconds
+ */
+unsigned long long startup_profile_total(const StartupProfile *profile);
+
+/**
+ * @brief Print the phases as an aligned table
+ * @param profile Profile
+ * @param out Output stream
+ */
+void startup_profile_print(const StartupProfile *profile, FILE *out);
+
+/**
+ * @brief Append the phases to a file
+ *
+ * Each startup adds a "# startup <date time>" line, then
+ * phase|ms|bytes|rows|rejected rows ending with a "total" row; the
+ * counters are empty for phases that read no file. Appending keeps a
+ * history to compare startups as the data grows.
+ *
+ * @param profile Profile
+ * @param path File to append to
+ * @return 1 on success, 0 on failure
+ */
+int startup_profile_write_file(const StartupProfile *profile, const char *path);
+
+#endif /* STARTUP_H */
@@ -0,0 +1,396 @@
+/**
+ * @file stock.c
+ * @brief Implementation of stock movement operations
+ */
+
+#include "stock.h"
+#include "metrics.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Build the transaction record for a movement
+static void fill_transaction(Transaction *t, int transaction_id, int product_id,
+                             int is_in, int quantity, const char *notes) {
+    memset(t, 0, sizeof(*t));
+    t->transaction_id = transaction_id;
+    t->product_id = product_id;
+    strcpy(t->type, is_in ? TRANSACTION_TYPE_IN : TRANSACTION_TYPE_OUT);
+    t->quantity = quantity;
+    get_current_datetime(t->date_time, sizeof(t->date_time));
+    if (notes != NULL) {
+        strncpy(t->notes, notes, sizeof(t->notes) - 1);
+    }
+}
+
+// Parse a movement type; returns 1 for IN, 0 for OUT, -1 if invalid
+static int parse_type(const char *type) {
+    if (type == NULL) return -1;
+    if (strcmp(type, TRANSACTION_TYPE_IN) == 0) return 1;
+    if (strcmp(type, TRANSACTION_TYPE_OUT) == 0) return 0;
+    return -1;
+}
+
+static StockStatus move_by_id(ProductList *products, TransactionList *transactions,
+                              int product_id, const char *type, int quantity,
+                              const char *notes, Transaction *logged) {
+    if (products == NULL || transactions == NULL) {
+        return STOCK_ERR_INVALID;
+    }
+    
+    Product *p = product_find_by_id(products, product_id);
+    if (p == NULL) {
+        // Report a bad type/quantity before a missing product
+        return (parse_type(type) < 0 || quantity <= 0) ? STOCK_ERR_INVALID
+                                                        : STOCK_ERR_NOT_FOUND;
+    }
+    
+    StockStatus status = stock_move_product(p, transactions, type, quantity, notes, logged);
+    if (status == STOCK_OK) {
+        products->generation = generation_next();
+    }
+    return status;
+}
+
+StockStatus stock_move(ProductList *products, TransactionList *transactions,
+                       int product_id, const char *type, int quantity,
+                       const char *notes, Transaction *logged) {
+    MetricTimer timer = metrics_start();
+    StockStatus status = move_by_id(products, transactions, product_id, type, quantity, notes, logged);
+    metrics_stop(METRIC_STOCK_MOVE, timer);
+    return status;
+}
+
+StockStatus stock_move_product(Product *product, TransactionList *transactions,
+                               const char *type, int quantity,
+                               const char *notes, Transaction *logged) {
+    if (product == NULL || transactions == NULL) {
+        return STOCK_ERR_INVALID;
+    }
+    
+    int is_in = parse_type(type);
+    if (is_in < 0 || quantity <= 0) return STOCK_ERR_INVALID;
+    
+    if (!is_in && quantity > product->quantity_in_stock) {
+        return STOCK_ERR_INSUFFICIENT;
+    }
+    
+    if (transactions->count >= MAX_TRANSACTIONS) {
+        return STOCK_ERR_FULL;
+    }
+    
+    Transaction t;
+    fill_transaction(&t, transaction_get_next_id(transactions), product->id,
+                     is_in, quantity, notes);
+    
+    if (!transaction_add(transactions, &t)) {
+        return STOCK_ERR_INVALID;
+    }
+    
+    // Update product quantity
+    if (is_in) {
+        product->quantity_in_stock += quantity;
+    } else {
+        product->quantity_in_stock -= quantity;
+    }
+    
+    if (logged != NULL) {
+        *logged = t;
+    }
+    return STOCK_OK;
+}
+
+const char* stock_status_message(StockStatus status) {
+    switch (status) {
+        case STOCK_OK:               return "OK";
+        case STOCK_ERR_INVALID:      return "Invalid movement (type or quantity)";
+        case STOCK_ERR_NOT_FOUND:    return "Product not found";
+        case STOCK_ERR_INSUFFICIENT: return "Insufficient stock";
+        case STOCK_ERR_FULL:         return "Transaction list is full";
+    }
+    return "Unknown error";
+}
+
+/**
+ * @brief Project movements against current stock in one pass
+ *
+ * Uses an ID index and a copy of the quantities, so validation is
+ * O(products + rows) instead of a linear product lookup per row.
+ */
+static int project_movements(const ProductList *products,
+                             const TransactionList *transactions,
+                             const StockMovement *rows, int count,
+                             StockMovementResult *results) {
+    ProductIdIndex index;
+    if (!product_index_build(&index, products)) return -1;
+    
+    int *projected = malloc(sizeof(int) * (products->count > 0 ? products->count : 1));
+    if (projected == NULL) {
+        product_index_free(&index);
+        return -1;
+    }
+    for (int i = 0; i < products->count; i++) {
+        projected[i] = products->products[i].quantity_in_stock;
+    }
+    
+    int room = MAX_TRANSACTIONS - transactions->count;
+    int accepted = 0;
+    
+    for (int i = 0; i < count; i++) {
+        const StockMovement *m = &rows[i];
+        StockMovementResult *r = &results[i];
+        int is_in = (strcmp(m->type, TRANSACTION_TYPE_IN) == 0);
+        int slot;
+        
+        r->balance = 0;
+        if ((!is_in && strcmp(m->type, TRANSACTION_TYPE_OUT) != 0) ||
+            m->quantity <= 0) {
+            r->status = STOCK_ERR_INVALID;
+        } else if ((slot = product_index_find(&index, products, m->product_id)) < 0) {
+            r->status = STOCK_ERR_NOT_FOUND;
+        } else if (!is_in && m->quantity > projected[slot]) {
+            r->status = STOCK_ERR_INSUFFICIENT;
+            r->balance = projected[slot];
+        } else if (accepted >= room) {
+            r->status = STOCK_ERR_FULL;
+        } else {
+            projected[slot] += is_in ? m->quantity : -m->quantity;
+            r->status = STOCK_OK;
+            r->balance = projected[slot];
+            accepted++;
+        }
+    }
+    
+    free(projected);
+    product_index_free(&index);
+    return accepted;
+}
+
+int stock_validate_movements(const ProductList *products,
+                             const TransactionList *transactions,
+                             const StockMovement *rows, int count,
+                             StockMovementResult *results) {
+    if (products == NULL || transactions == NULL || results == NULL ||
+        (rows == NULL && count > 0)) {
+        return -1;
+    }
+    
+    return project_movements(products, transactions, rows, count, results);
+}
+
+static int apply_movements(ProductList *products, TransactionList *transactions,
+                           const StockMovement *rows,
+                           const StockMovementResult *results, int count) {
+    if (products == NULL || transactions == NULL || results == NULL ||
+        (rows == NULL && count > 0)) {
+        return -1;
+    }
+    if (count == 0) return 0;
+    
+    // Re-check so that either every accepted row applies or none does
+    StockMovementResult *check = malloc(sizeof(StockMovementResult) * count);
+    if (check == NULL) return -1;
+    
+    if (project_movements(products, transactions, rows, count, check) < 0) {
+        free(check);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (results[i].status == STOCK_OK && check[i].status != STOCK_OK) {
+            free(check);
+            return -1;  // Lists changed since validation
+        }
+    }
+    free(check);
+    
+    ProductIdIndex index;
+    if (!product_index_build(&index, products)) return -1;
+    
+    char date_time[30];
+    get_current_datetime(date_time, sizeof(date_time));
+    
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i].status != STOCK_OK) continue;
+        
+        const StockMovement *m = &rows[i];
+        int slot = product_index_find(&index, products, m->product_id);
+        int is_in = (strcmp(m->type, TRANSACTION_TYPE_IN) == 0);
+        
+        Transaction t;
+        fill_transaction(&t, transaction_get_next_id(transactions), m->product_id,
+                         is_in, m->quantity, m->notes);
+        strcpy(t.date_time, date_time);  // One timestamp for the whole import
+        
+        transaction_add(transactions, &t);
+        products->products[slot].quantity_in_stock += is_in ? m->quantity : -m->quantity;
+        applied++;
+    }
+    if (applied > 0) {
+        products->generation = generation_next();
+    }
+    
+    product_index_free(&index);
+    return applied;
+}
+
+int stock_apply_movements(ProductList *products, TransactionList *transactions,
+                          const StockMovement *rows,
+                          const StockMovementResult *results, int count) {
+    MetricTimer timer = metrics_start();
+    int applied = apply_movements(products, transactions, rows, results, count);
+    metrics_stop(METRIC_STOCK_APPLY_MOVEMENTS, timer);
+    return applied;
+}
+
+void stock_write_movement_report(FILE *out, const StockMovement *rows,
+                                 const StockMovementResult *results, int count) {
+    if (out == NULL || rows == NULL || results == NULL) return;
+    
+    fprintf(out, "line|result|product_id|detail\n");
+    for (int i = 0; i < count; i++) {
+        if (results[i].status == STOCK_OK) {
+            fprintf(out, "%d|ACCEPT|%d|%d\n",
+                    rows[i].line_no, rows[i].product_id, results[i].balance);
+        } else {
+            fprintf(out, "%d|REJECT|%d|%s\n", rows[i].line_no, rows[i].product_id,
+                    stock_status_message(results[i].status));
+        }
+    }
+}
+
+int stock_engine_begin(StockEngine *engine, ProductList *products,
+                       TransactionList *transactions) {
+    if (engine == NULL || products == NULL || transactions == NULL) return 0;
+    
+    if (!product_index_build(&engine->index, products)) return 0;
+    
+    engine->products = products;
+    engine->transactions = transactions;
+    engine->base_slot = transactions->count;
+    engine->base_id = transaction_get_next_id(transactions);
+    atomic_init(&engine->reserved, transactions->count);
+    engine->published_reserved = transactions->count;
+    
+    for (int i = 0; i < STOCK_LOCK_STRIPES; i++) {
+        mutex_init(&engine->stripes[i]);
+    }
+    return 1;
+}
+
+static StockStatus engine_move(StockEngine *engine, int product_id,
+                               const char *type, int quantity,
+                               const char *notes, Transaction *logged) {
+    if (engine == NULL) return STOCK_ERR_INVALID;
+    
+    int is_in = parse_type(type);
+    if (is_in < 0 || quantity <= 0) return STOCK_ERR_INVALID;
+    
+    int slot = product_index_find(&engine->index, engine->products, product_id);
+    if (slot < 0) return STOCK_ERR_NOT_FOUND;
+    
+    Product *p = &engine->products->products[slot];
+    Mutex *stripe = &engine->stripes[slot % STOCK_LOCK_STRIPES];
+    
+    // Check, reserve and update under the product's stripe so the
+    // insufficient-stock check cannot race with another movement
+    mutex_lock(stripe);
+    if (!is_in && quantity > p->quantity_in_stock) {
+        mutex_unlock(stripe);
+        return STOCK_ERR_INSUFFICIENT;
+    }
+    
+    int row = atomic_fetch_add(&engine->reserved, 1);
+    if (row >= MAX_TRANSACTIONS) {
+        mutex_unlock(stripe);
+        return STOCK_ERR_FULL;
+    }
+    
+    p->quantity_in_stock += is_in ? quantity : -quantity;
+    mutex_unlock(stripe);
+    
+    // The reserved row is private to this thread until stock_engine_end
+    Transaction *t = &engine->transactions->transactions[row];
+    fill_transaction(t, engine->base_id + (row - engine->base_slot),
+                     product_id, is_in, quantity, notes);
+    
+    if (logged != NULL) {
+        *logged = *t;
+    }
+    return STOCK_OK;
+}
+
+StockStatus stock_engine_move(StockEngine *engine, int product_id,
+                              const char *type, int quantity,
+                              const char *notes, Transaction *logged) {
+    MetricTimer timer = metrics_start();
+    StockStatus status = engine_move(engine, product_id, type, quantity, notes, logged);
+    metrics_stop(METRIC_STOCK_ENGINE_MOVE, timer);
+    return status;
+}
+
+int stock_engine_quantity(StockEngine *engine, int product_id) {
+    if (engine == NULL) return -1;
+    
+    int slot = product_index_find(&engine->index, engine->products, product_id);
+    if (slot < 0) return -1;
+    
+    Mutex *stripe = &engine->stripes[slot % STOCK_LOCK_STRIPES];
+    mutex_lock(stripe);
+    int quantity = engine->products->products[slot].quantity_in_stock;
+    mutex_unlock(stripe);
+    return quantity;
+}
+
+// Copy each stripe's products under its lock, so a movement waits for
+// one stripe's share of the copy at most
+static void copy_by_stripe(void *ctx, ProductList *copy) {
+    StockEngine *engine = ctx;
+    const Product *live = engine->products->products;
+    
+    for (int stripe = 0; stripe < STOCK_LOCK_STRIPES; stripe++) {
+        mutex_lock(&engine->stripes[stripe]);
+        for (int slot = stripe; slot < copy->count; slot += STOCK_LOCK_STRIPES) {
+            copy->products[slot] = live[slot];
+        }
+        mutex_unlock(&engine->stripes[stripe]);
+    }
+}
+
+int stock_engine_publish(StockEngine *engine, SnapshotStore *store) {
+    if (engine == NULL || store == NULL) return 0;
+    
+    // Movements never change the generation themselves. A movement that
+    // reserves after this load is picked up by the next publish
+    int reserved = atomic_load(&engine->reserved);
+    if (reserved != engine->published_reserved) {
+        engine->products->generation = generation_next();
+        engine->published_reserved = reserved;
+    }
+    return snapshot_publish_with(store, copy_by_stripe, engine);
+}
+
+int stock_engine_end(StockEngine *engine) {
+    if (engine == NULL) return 0;
+    
+    // Failed reservations past capacity were never written
+    int count = atomic_load(&engine->reserved);
+    if (count > MAX_TRANSACTIONS) {
+        count = MAX_TRANSACTIONS;
+    }
+    
+    TransactionList *transactions = engine->transactions;
+    transactions->count = count;
+    transactions->next_id = engine->base_id + (count - engine->base_slot);
+    transactions->generation = generation_next();
+    engine->products->generation = generation_next();
+    
+    // Rows were written in place, so listeners hear about them now
+    transaction_notify_listeners(transactions, engine->base_slot, count - engine->base_slot);
+    
+    for (int i = 0; i < STOCK_LOCK_STRIPES; i++) {
+        mutex_destroy(&engine->stripes[i]);
+    }
+    product_index_free(&engine->index);
+    
+    return count - engine->base_slot;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file stock.h
+ * @brief Stock movement operations (stock in / stock out)
+ * @author Inventory Management System
+ * @date 2025
+ */
+
+#ifndef STOCK_H
+#define STOCK_H
+
+#include <stdatomic.h>
+#include "product.h"
+#include "transaction.h"
+#include "snapshot.h"
+#include "sync.h"
+
+#define STOCK_LOCK_STRIPES 64
+
+/**
+ * @brief Result of a stock movement
+ */
+typedef enum {
+    STOCK_OK = 0,               ///< Movement applied and logged
+    STOCK_ERR_INVALID,          ///< Bad type or non-positive quantity
+    STOCK_ERR_NOT_FOUND,        ///< Product does not exist
+    STOCK_ERR_INSUFFICIENT,     ///< OUT quantity exceeds stock on hand
+    STOCK_ERR_FULL              ///< Transaction list is full
+} StockStatus;
+
+/**
+ * @brief One row of a bulk movement import
+ */
+typedef struct {
+    int line_no;                ///< Source line (for reporting)
+    int product_id;             ///< Product to move
+    char type[10];              ///< "IN" or "OUT" ("" if the row was malformed)
+    int quantity;               ///< Units to move
+    char notes[MAX_NOTES_LEN];  ///< Optional notes
+} StockMovement;
+
+/**
+ * @brief Validation outcome for one bulk movement row
+ */
+typedef struct {
+    StockStatus status;         ///< STOCK_OK if the row is accepted
+    int balance;                ///< Projected stock after the row (if accepted)
+} StockMovementResult;
+
+/**
+ * @brief Apply a stock movement and log it as a transaction
+ *
+ * Updates the product quantity and appends the matching transaction.
+ * Nothing is changed unless every check passes.
+ *
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList
+ * @param product_id Product to move
+ * @param type TRANSACTION_TYPE_IN or TRANSACTION_TYPE_OUT
+ * @param quantity Units to move (must be > 0)
+ * @param notes Optional notes (may be NULL)
+ * @param logged Optional output for the logged transaction (may be NULL)
+ * @return STOCK_OK on success, error status otherwise
+ */
+StockStatus stock_move(ProductList *products, TransactionList *transactions,
+                       int product_id, const char *type, int quantity,
+                       const char *notes, Transaction *logged);
+
+/**
+ * @brief Apply a stock movement to an already located product
+ *
+ * Same as stock_move() for callers that found the product through
+ * their own index.
+ *
+ * @param product Product to move (must belong to the caller's list)
+ * @param transactions Pointer to TransactionList
+ * @param type TRANSACTION_TYPE_IN or TRANSACTION_TYPE_OUT
+ * @param quantity Units to move (must be > 0)
+ * @param notes Optional notes (may be NULL)
+ * @param logged Optional output for the logged transaction (may be NULL)
+ * @return STOCK_OK on success, error status otherwise
+ */
+StockStatus stock_move_product(Product *product, TransactionList *transactions,
+                               const char *type, int quantity,
+                               const char *notes, Transaction *logged);
+
+/**
+ * @brief Get a human-readable message for a stock status
+ * @param status Status code
+ * @return Static message string
+ */
+const char* stock_status_message(StockStatus status);
+
+/**
+ * @brief Validate bulk movements in arrival order (single pass)
+ *
+ * Each row is checked against the stock projected from the current
+ * quantities plus all previously accepted rows, so an OUT is only
+ * accepted if earlier rows in the same file leave enough stock.
+ * Rows that would not fit in the transaction list are rejected
+ * with STOCK_ERR_FULL. Nothing is modified.
+ *
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList (for capacity)
+ * @param rows Movements to validate
+ * @param count Number of rows
+ * @param results Output array of count results
+ * @return Number of accepted rows, or -1 on allocation failure
+ */
+int stock_validate_movements(const ProductList *products,
+                             const TransactionList *transactions,
+                             const StockMovement *rows, int count,
+                             StockMovementResult *results);
+
+/**
+ * @brief Apply all accepted rows from a validation pass
+ *
+ * Must be called on the same, unmodified lists that were validated.
+ * All accepted rows are applied, or none if the lists changed since
+ * validation. The caller persists once afterwards.
+ *
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList
+ * @param rows Movements that were validated
+ * @param results Results from stock_validate_movements
+ * @param count Number of rows
+ * @return Number of rows applied, or -1 if nothing could be applied
+ */
+int stock_apply_movements(ProductList *products, TransactionList *transactions,
+                          const StockMovement *rows,
+                          const StockMovementResult *results, int count);
+
+/**
+ * @brief Write a per-row accept/reject report
+ *
+ * Format: line|ACCEPT|product_id|balance or line|REJECT|product_id|reason
+ *
+ * @param out Output stream
+ * @param rows Movements
+ * @param results Validation results
+ * @param count Number of rows
+ */
+void stock_write_movement_report(FILE *out, const StockMovement *rows,
+                                 const StockMovementResult *results, int count);
+
+/**
+ * @brief Concurrent stock movement engine
+ *
+ * Lets several threads apply movements to the same lists at once.
+ * Each product maps to one of STOCK_LOCK_STRIPES locks, so the stock
+ * check and update are atomic per product while movements on products
+ * in different stripes run in parallel. Transaction slots and IDs are
+ * reserved with a single atomic increment; the list count is published
+ * by stock_engine_end().
+ *
+ * Between begin and end the catalogue must not be changed structurally
+ * (no product add/delete) and the transaction list must only be
+ * appended to through the engine.
+ */
+typedef struct {
+    ProductList *products;          ///< Products being updated
+    TransactionList *transactions;  ///< Log being appended to
+    ProductIdIndex index;           ///< ID to slot lookup (read-only)
+    Mutex stripes[STOCK_LOCK_STRIPES]; ///< Per-product lock stripes
+    atomic_int reserved;            ///< Next free transaction slot
+    int published_reserved;         ///< reserved at the last publish
+    int base_slot;                  ///< List count at begin
+    int base_id;                    ///< Next transaction ID at begin
+} StockEngine;
+
+/**
+ * @brief Start a concurrent movement session
+ * @param engine Engine to initialize
+ * @param products Pointer to ProductList
+ * @param transactions Pointer to TransactionList
+ * @return 1 on success, 0 on allocation failure
+ */
+int stock_engine_begin(StockEngine *engine, ProductList *products,
+                       TransactionList *transactions);
+
+/**
+ * @brief Apply one movement (thread-safe)
+ * @param engine Engine from stock_engine_begin
+ * @param product_id Product to move
+ * @param type TRANSACTION_TYPE_IN or TRANSACTION_TYPE_OUT
+ * @param quantity Units to move (must be > 0)
+ * @param notes Optional notes (may be NULL)
+ * @param logged Optional output for the logged transaction (may be NULL)
+ * @return STOCK_OK on success, error status otherwise
+ */
+StockStatus stock_engine_move(StockEngine *engine, int product_id,
+                              const char *type, int quantity,
+                              const char *notes, Transaction *logged);
+
+/**
+ * @brief Read a product's quantity consistently (thread-safe)
+ * @param engine Engine from stock_engine_begin
+ * @param product_id Product to read
+ * @return Quantity in stock, or -1 if not found
+ */
+int stock_engine_quantity(StockEngine *engine, int product_id);
+
+/**
+ * @brief Publish the products as they are now to a snapshot store
+ *
+ * Does nothing if no movement happened since the last publish (every
+ * movement reserves a log row). Otherwise the products are copied one
+ * stripe at a time under that stripe's lock, so each product is copied
+ * whole and movements wait for at most one stripe's share of the copy.
+ * The version is consistent per product, not a single instant across
+ * stripes. Readers then work on it without blocking movements.
+ * Transactions appended during the session become visible only after
+ * stock_engine_end. Call from one publishing thread at a time.
+ *
+ * @param engine Engine from stock_engine_begin
+ * @param store Store opened on the engine's lists
+ * @return 1 on success, 0 on allocation failure (previous version stays current)
+ */
+int stock_engine_publish(StockEngine *engine, SnapshotStore *store);
+
+/**
+ * @brief Finish a session and publish the appended transactions
+ *
+ * Call after all worker threads have been joined.
+ *
+ * @param engine Engine from stock_engine_begin
+ * @return Number of transactions appended during the session
+ */
+int stock_engine_end(StockEngine *engine);
+
+#endif /* STOCK_H */
@@ -4,6 +4,9 @@
  */
 
 #include "storage.h"
+#include "metrics.h"
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -19,28 +22,19 @@
 #include <unistd.h>
 #endif
 
-int storage_init_directories(void) {
-    // Create data directory if it doesn't exist
+int storage_ensure_directory(const char *path) {
+    if (path == NULL) return 0;
+
 #ifdef _WIN32
-    if (_access(DATA_DIR, 0) != 0) {
-        if (_mkdir(DATA_DIR) != 0) {
-            return 0;
-        }
-    }
-    if (_access(BACKUP_DIR, 0) != 0) {
-        if (_mkdir(BACKUP_DIR) != 0) {
+    if (_access(path, 0) != 0) {
+        if (_mkdir(path) != 0) {
             return 0;
         }
     }
 #else
     struct stat st = {0};
-    if (stat(DATA_DIR, &st) == -1) {
-        if (mkdir(DATA_DIR, 0700) != 0) {
-            return 0;
-        }
-    }
-    if (stat(BACKUP_DIR, &st) == -1) {
-        if (mkdir(BACKUP_DIR, 0700) != 0) {
+    if (stat(path, &st) == -1) {
+        if (mkdir(path, 0700) != 0) {
             return 0;
         }
     }
@@ -48,17 +42,33 @@ int storage_init_directories(void) {
     return 1;
 }
 
-int storage_load_products(ProductList *list) {
-    if (list == NULL) return 0;
+int storage_init_directories(void) {
+    // Create data and backup directories if they don't exist
+    return storage_ensure_directory(DATA_DIR) &&
+           storage_ensure_directory(BACKUP_DIR);
+}
+
+// Record what a load read, before its file is closed (NULL when missing)
+static void set_load_stats(LoadStats *stats, FILE *file, int rows, int kept) {
+    if (stats == NULL) return;
+    stats->bytes = (file != NULL) ? (long long)ftell(file) : 0;
+    stats->rows = rows;
+    stats->rejected = rows - kept;
+}
+
+static int read_products(ProductList *list, const char *path, LoadStats *stats) {
+    if (list == NULL || path == NULL) return 0;
     
-    FILE *file = fopen(PRODUCTS_FILE, "r");
+    FILE *file = fopen(path, "r");
     if (file == NULL) {
         // File doesn't exist yet, initialize empty list
-        product_list_init(list);
+        product_list_reset(list);
+        set_load_stats(stats, NULL, 0, 0);
         return 1;
     }
     
-    product_list_init(list);
+    // Every slot below the count is written, so the rest is left uncleared
+    product_list_reset(list);
     
     char line[1000];
     // Skip header line if present
@@ -70,8 +80,11 @@ int storage_load_products(ProductList *list) {
         }
     }
     
-    while (fgets(line, sizeof(line), file) != NULL && list->count < MAX_PRODUCTS) {
+    int rows = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
         Product p = {0};
+        rows++;
+        if (list->count >= MAX_PRODUCTS) continue;  // Full: counted as rejected
         
         // Parse line: id|name|category|description|quantity|reorder_level|price|supplier_id
         char *token = strtok(line, "|\n");
@@ -114,15 +127,36 @@ int storage_load_products(ProductList *list) {
             list->count++;
         }
     }
+    list->generation = generation_next();
+    set_load_stats(stats, file, rows, list->count);
     
     fclose(file);
     return 1;
 }
 
+static int load_products(ProductList *list, const char *path, LoadStats *stats) {
+    MetricTimer timer = metrics_start();
+    int ok = read_products(list, path, stats);
+    metrics_stop(METRIC_LOAD_PRODUCTS, timer);
+    return ok;
+}
+
+int storage_load_products(ProductList *list, LoadStats *stats) {
+    return load_products(list, PRODUCTS_FILE, stats);
+}
+
+int storage_load_products_file(ProductList *list, const char *path) {
+    return load_products(list, path, NULL);
+}
+
 int storage_save_products(const ProductList *list) {
-    if (list == NULL) return 0;
+    return storage_save_products_file(list, PRODUCTS_FILE);
+}
+
+static int write_products(const ProductList *list, const char *path) {
+    if (list == NULL || path == NULL) return 0;
     
-    FILE *file = fopen(PRODUCTS_FILE, "w");
+    FILE *file = fopen(path, "w");
     if (file == NULL) return 0;
     
     // Write header
@@ -139,12 +173,20 @@ int storage_save_products(const ProductList *list) {
     return 1;
 }
 
-int storage_load_suppliers(SupplierList *list) {
-    if (list == NULL) return 0;
+int storage_save_products_file(const ProductList *list, const char *path) {
+    MetricTimer timer = metrics_start();
+    int ok = write_products(list, path);
+    metrics_stop(METRIC_SAVE_PRODUCTS, timer);
+    return ok;
+}
+
+static int read_suppliers(SupplierList *list, const char *path, LoadStats *stats) {
+    if (list == NULL || path == NULL) return 0;
     
-    FILE *file = fopen(SUPPLIERS_FILE, "r");
+    FILE *file = fopen(path, "r");
     if (file == NULL) {
         supplier_list_init(list);
+        set_load_stats(stats, NULL, 0, 0);
         return 1;
     }
     
@@ -158,8 +200,11 @@ int storage_load_suppliers(SupplierList *list) {
         }
     }
     
-    while (fgets(line, sizeof(line), file) != NULL && list->count < MAX_SUPPLIERS) {
+    int rows = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
         Supplier s = {0};
+        rows++;
+        if (list->count >= MAX_SUPPLIERS) continue;  // Full: counted as rejected
         
         // Parse: supplier_id|name|contact_number|email|address
         char *token = strtok(line, "|\n");
@@ -191,15 +236,36 @@ int storage_load_suppliers(SupplierList *list) {
             list->count++;
         }
     }
+    list->generation = generation_next();
+    set_load_stats(stats, file, rows, list->count);
     
     fclose(file);
     return 1;
 }
 
+static int load_suppliers(SupplierList *list, const char *path, LoadStats *stats) {
+    MetricTimer timer = metrics_start();
+    int ok = read_suppliers(list, path, stats);
+    metrics_stop(METRIC_LOAD_SUPPLIERS, timer);
+    return ok;
+}
+
+int storage_load_suppliers(SupplierList *list, LoadStats *stats) {
+    return load_suppliers(list, SUPPLIERS_FILE, stats);
+}
+
+int storage_load_suppliers_file(SupplierList *list, const char *path) {
+    return load_suppliers(list, path, NULL);
+}
+
 int storage_save_suppliers(const SupplierList *list) {
-    if (list == NULL) return 0;
+    return storage_save_suppliers_file(list, SUPPLIERS_FILE);
+}
+
+static int write_suppliers(const SupplierList *list, const char *path) {
+    if (list == NULL || path == NULL) return 0;
     
-    FILE *file = fopen(SUPPLIERS_FILE, "w");
+    FILE *file = fopen(path, "w");
     if (file == NULL) return 0;
     
     fprintf(file, "supplier_id|name|contact_number|email|address\n");
@@ -214,16 +280,59 @@ int storage_save_suppliers(const SupplierList *list) {
     return 1;
 }
 
-int storage_load_transactions(TransactionList *list) {
-    if (list == NULL) return 0;
+int storage_save_suppliers_file(const SupplierList *list, const char *path) {
+    MetricTimer timer = metrics_start();
+    int ok = write_suppliers(list, path);
+    metrics_stop(METRIC_SAVE_SUPPLIERS, timer);
+    return ok;
+}
+
+int storage_parse_transaction(char *line, Transaction *t) {
+    if (line == NULL || t == NULL) return 0;
+    memset(t, 0, sizeof(Transaction));
+    
+    // Parse: transaction_id|product_id|type|quantity|date_time|notes
+    char *token = strtok(line, "|\n");
+    if (token == NULL) return 0;
+    t->transaction_id = atoi(token);
+    
+    token = strtok(NULL, "|\n");
+    if (token == NULL) return 0;
+    t->product_id = atoi(token);
+    
+    token = strtok(NULL, "|\n");
+    if (token == NULL) return 0;
+    strncpy(t->type, token, 9);
+    t->type[9] = '\0';
+    
+    token = strtok(NULL, "|\n");
+    if (token == NULL) return 0;
+    t->quantity = atoi(token);
+    
+    token = strtok(NULL, "|\n");
+    if (token == NULL) return 0;
+    strncpy(t->date_time, token, 29);
+    t->date_time[29] = '\0';
+    
+    token = strtok(NULL, "|\n");
+    if (token != NULL) {
+        strncpy(t->notes, token, MAX_NOTES_LEN - 1);
+        t->notes[MAX_NOTES_LEN - 1] = '\0';
+    }
+    return 1;
+}
+
+static int read_transactions(TransactionList *list, const char *path, LoadStats *stats) {
+    if (list == NULL || path == NULL) return 0;
     
-    FILE *file = fopen(TRANSACTIONS_FILE, "r");
+    FILE *file = fopen(path, "r");
     if (file == NULL) {
-        transaction_list_init(list);
+        transaction_list_reset(list);
+        set_load_stats(stats, NULL, 0, 0);
         return 1;
     }
     
-    transaction_list_init(list);
+    transaction_list_reset(list);
     
     char line[1000];
     // Skip header line if present
@@ -233,73 +342,241 @@ int storage_load_transactions(TransactionList *list) {
         }
     }
     
-    while (fgets(line, sizeof(line), file) != NULL && list->count < MAX_TRANSACTIONS) {
-        Transaction t = {0};
+    int rows = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        Transaction t;
+        rows++;
+        if (list->count >= MAX_TRANSACTIONS) continue;  // Full: counted as rejected
+        if (!storage_parse_transaction(line, &t)) continue;
         
-        // Parse: transaction_id|product_id|type|quantity|date_time|notes
-        char *token = strtok(line, "|\n");
-        if (token == NULL) continue;
-        t.transaction_id = atoi(token);
+        transaction_add(list, &t);  // Validates and tracks next ID
+    }
+    set_load_stats(stats, file, rows, list->count);
+    
+    fclose(file);
+    return 1;
+}
+
+static int load_transactions(TransactionList *list, const char *path, LoadStats *stats) {
+    MetricTimer timer = metrics_start();
+    int ok = read_transactions(list, path, stats);
+    metrics_stop(METRIC_LOAD_TRANSACTIONS, timer);
+    return ok;
+}
+
+int storage_load_transactions(TransactionList *list, LoadStats *stats) {
+    return load_transactions(list, TRANSACTIONS_FILE, stats);
+}
+
+int storage_load_transactions_file(TransactionList *list, const char *path) {
+    return load_transactions(list, path, NULL);
+}
+
+int storage_save_transactions(const TransactionList *list) {
+    return storage_save_transactions_file(list, TRANSACTIONS_FILE);
+}
+
+static int write_transactions(const TransactionList *list, const char *path) {
+    if (list == NULL || path == NULL) return 0;
+    
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return 0;
+    
+    fprintf(file, "transaction_id|product_id|type|quantity|date_time|notes\n");
+    
+    for (int i = 0; i < list->count; i++) {
+        const Transaction *t = &list->transactions[i];
+        fprintf(file, "%d|%d|%s|%d|%s|%s\n",
+                t->transaction_id, t->product_id, t->type, t->quantity, 
+                t->date_time, t->notes);
+    }
+    
+    fclose(file);
+    return 1;
+}
+
+int storage_save_transactions_file(const TransactionList *list, const char *path) {
+    MetricTimer timer = metrics_start();
+    int ok = write_transactions(list, path);
+    metrics_stop(METRIC_SAVE_TRANSACTIONS, timer);
+    return ok;
+}
+
+// Parse a whole-field integer, rejecting values that do not fit an int
+static int parse_movement_int(const char *field, int *value) {
+    if (*field == '\0') return 0;
+    
+    char *endptr;
+    errno = 0;
+    long result = strtol(field, &endptr, 10);
+    if (*endptr != '\0' || errno == ERANGE) return 0;
+    if (result < INT_MIN || result > INT_MAX) return 0;
+    
+    *value = (int)result;
+    return 1;
+}
+
+static int read_movements(const char *path, StockMovement **rows, int *count) {
+    if (path == NULL || rows == NULL || count == NULL) return 0;
+    
+    *rows = NULL;
+    *count = 0;
+    
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return 0;
+    
+    int capacity = 1024;
+    StockMovement *buffer = malloc(sizeof(StockMovement) * capacity);
+    if (buffer == NULL) {
+        fclose(file);
+        return 0;
+    }
+    
+    char line[1000];
+    int line_no = 0;
+    int n = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_no++;
+        trim_string(line);
+        if (line[0] == '\0' || line[0] == '#') continue;
+        if (line_no == 1 && strstr(line, "product_id|") != NULL) continue;
         
-        token = strtok(NULL, "|\n");
-        if (token == NULL) continue;
-        t.product_id = atoi(token);
+        if (n == capacity) {
+            StockMovement *grown = realloc(buffer, sizeof(StockMovement) * capacity * 2);
+            if (grown == NULL) {
+                free(buffer);
+                fclose(file);
+                return 0;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
         
-        token = strtok(NULL, "|\n");
-        if (token == NULL) continue;
-        strncpy(t.type, token, 9);
-        t.type[9] = '\0';
+        StockMovement *m = &buffer[n++];
+        memset(m, 0, sizeof(*m));
+        m->line_no = line_no;
         
-        token = strtok(NULL, "|\n");
-        if (token == NULL) continue;
-        t.quantity = atoi(token);
+        // Parse: product_id|type|quantity|notes (notes may be empty or absent)
+        char *fields[4] = {NULL, NULL, NULL, NULL};
+        char *start = line;
+        int field_count = 0;
+        while (field_count < 4) {
+            fields[field_count++] = start;
+            char *sep = (field_count < 4) ? strchr(start, '|') : NULL;
+            if (sep == NULL) break;
+            *sep = '\0';
+            start = sep + 1;
+        }
+        if (field_count < 3) continue;  // Malformed: empty type rejects it
         
-        token = strtok(NULL, "|\n");
-        if (token == NULL) continue;
-        strncpy(t.date_time, token, 29);
-        t.date_time[29] = '\0';
+        if (!parse_movement_int(fields[0], &m->product_id)) continue;
+        if (!parse_movement_int(fields[2], &m->quantity)) continue;
         
-        token = strtok(NULL, "|\n");
-        if (token != NULL) {
-            strncpy(t.notes, token, MAX_NOTES_LEN - 1);
-            t.notes[MAX_NOTES_LEN - 1] = '\0';
+        strncpy(m->type, fields[1], sizeof(m->type) - 1);
+        for (char *c = m->type; *c != '\0'; c++) {
+            *c = (char)toupper((unsigned char)*c);
         }
+        if (fields[3] != NULL) {
+            strncpy(m->notes, fields[3], MAX_NOTES_LEN - 1);
+        }
+    }
+    
+    fclose(file);
+    *rows = buffer;
+    *count = n;
+    return 1;
+}
+
+int storage_load_movements(const char *path, StockMovement **rows, int *count) {
+    MetricTimer timer = metrics_start();
+    int ok = read_movements(path, rows, count);
+    metrics_stop(METRIC_LOAD_MOVEMENTS, timer);
+    return ok;
+}
+
+static int read_forecasts(ForecastStore *store, LoadStats *stats) {
+    if (store == NULL) return 0;
+    
+    forecast_free(store);
+    set_load_stats(stats, NULL, 0, 0);
+    FILE *file = fopen(FORECASTS_FILE, "r");
+    if (file == NULL) return 1;
+    
+    char line[256];
+    // First line: log rows the states cover
+    if (fgets(line, sizeof(line), file) == NULL ||
+        sscanf(line, "covered|%d|%d", &store->covered_rows, &store->covered_last_id) != 2) {
+        store->covered_rows = 0;
+        store->covered_last_id = 0;
+        set_load_stats(stats, file, 0, 0);
+        fclose(file);
+        return 1;
+    }
+    
+    int rows = 0, kept = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        DemandState s = {0};
+        if (strncmp(line, "product_id|", 11) == 0) continue;  // Header
+        rows++;
         
-        if (transaction_validate(&t)) {
-            list->transactions[list->count] = t;
-            list->count++;
+        // Parse: product_id|last_day|day_units|mean|variance|days
+        if (sscanf(line, "%d|%d|%ld|%lf|%lf|%d", &s.product_id, &s.last_day,
+                   &s.day_units, &s.mean, &s.variance, &s.days) != 6) {
+            continue;  // Damaged row
         }
+        if (!forecast_put(store, &s)) {
+            fclose(file);
+            return 0;
+        }
+        kept++;
     }
+    set_load_stats(stats, file, rows, kept);
     
     fclose(file);
     return 1;
 }
 
-int storage_save_transactions(const TransactionList *list) {
-    if (list == NULL) return 0;
+int storage_load_forecasts(ForecastStore *store, LoadStats *stats) {
+    MetricTimer timer = metrics_start();
+    int ok = read_forecasts(store, stats);
+    metrics_stop(METRIC_LOAD_FORECASTS, timer);
+    return ok;
+}
+
+static int write_forecasts(const ForecastStore *store) {
+    if (store == NULL) return 0;
     
-    FILE *file = fopen(TRANSACTIONS_FILE, "w");
+    FILE *file = fopen(FORECASTS_FILE, "w");
     if (file == NULL) return 0;
     
-    fprintf(file, "transaction_id|product_id|type|quantity|date_time|notes\n");
+    fprintf(file, "covered|%d|%d\n", store->covered_rows, store->covered_last_id);
+    fprintf(file, "product_id|last_day|day_units|mean|variance|days\n");
     
-    for (int i = 0; i < list->count; i++) {
-        const Transaction *t = &list->transactions[i];
-        fprintf(file, "%d|%d|%s|%d|%s|%s\n",
-                t->transaction_id, t->product_id, t->type, t->quantity, 
-                t->date_time, t->notes);
+    for (int i = 0; i < store->capacity; i++) {
+        const DemandState *s = &store->slots[i];
+        if (s->product_id == 0) continue;
+        fprintf(file, "%d|%d|%ld|%.17g|%.17g|%d\n",
+                s->product_id, s->last_day, s->day_units, s->mean, s->variance, s->days);
     }
     
     fclose(file);
     return 1;
 }
 
-int storage_load_users(UserList *list) {
+int storage_save_forecasts(const ForecastStore *store) {
+    MetricTimer timer = metrics_start();
+    int ok = write_forecasts(store);
+    metrics_stop(METRIC_SAVE_FORECASTS, timer);
+    return ok;
+}
+
+static int read_users(UserList *list, LoadStats *stats) {
     if (list == NULL) return 0;
     
     FILE *file = fopen(USERS_FILE, "r");
     if (file == NULL) {
         user_list_init(list);
+        set_load_stats(stats, NULL, 0, 0);
         return 1;
     }
     
@@ -313,8 +590,11 @@ int storage_load_users(UserList *list) {
         }
     }
     
-    while (fgets(line, sizeof(line), file) != NULL && list->count < MAX_USERS) {
+    int rows = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
         User u = {0};
+        rows++;
+        if (list->count >= MAX_USERS) continue;  // Full: counted as rejected
         
         // Parse: username|password_hash|role
         char *token = strtok(line, "|\n");
@@ -338,12 +618,20 @@ int storage_load_users(UserList *list) {
         list->users[list->count] = u;
         list->count++;
     }
+    set_load_stats(stats, file, rows, list->count);
     
     fclose(file);
     return 1;
 }
 
-int storage_save_users(const UserList *list) {
+int storage_load_users(UserList *list, LoadStats *stats) {
+    MetricTimer timer = metrics_start();
+    int ok = read_users(list, stats);
+    metrics_stop(METRIC_LOAD_USERS, timer);
+    return ok;
+}
+
+static int write_users(const UserList *list) {
     if (list == NULL) return 0;
     
     FILE *file = fopen(USERS_FILE, "w");
@@ -360,6 +648,13 @@ int storage_save_users(const UserList *list) {
     return 1;
 }
 
+int storage_save_users(const UserList *list) {
+    MetricTimer timer = metrics_start();
+    int ok = write_users(list);
+    metrics_stop(METRIC_SAVE_USERS, timer);
+    return ok;
+}
+
 int storage_backup_data(void) {
     char backup_path[200];
     FILE *src, *dst;
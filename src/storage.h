@@ -12,6 +12,8 @@
 #include "supplier.h"
 #include "transaction.h"
 #include "auth.h"
+#include "stock.h"
+#include "forecast.h"
 
 #define DATA_DIR "data"
 #define BACKUP_DIR "backup"
@@ -21,13 +23,24 @@
 #define SUPPLIERS_FILE "data/suppliers.txt"
 #define TRANSACTIONS_FILE "data/transactions.txt"
 #define USERS_FILE "data/users.txt"
+#define FORECASTS_FILE "data/forecasts.txt"
+
+/**
+ * @brief What a load read from its file
+ */
+typedef struct {
+    long long bytes;            ///< Bytes read (0 when the file is missing)
+    int rows;                   ///< Data rows read, header excluded
+    int rejected;               ///< Rows skipped as malformed, invalid or over capacity
+} LoadStats;
 
 /**
  * @brief Load all products from file
  * @param list Pointer to ProductList to populate
+ * @param stats Output counters (may be NULL)
  * @return 1 on success, 0 on failure
  */
-int storage_load_products(ProductList *list);
+int storage_load_products(ProductList *list, LoadStats *stats);
 
 /**
  * @brief Save all products to file
@@ -36,12 +49,29 @@ int storage_load_products(ProductList *list);
  */
 int storage_save_products(const ProductList *list);
 
+/**
+ * @brief Load products from a specific file
+ * @param list Pointer to ProductList to populate
+ * @param path File to read (missing file gives an empty list)
+ * @return 1 on success, 0 on failure
+ */
+int storage_load_products_file(ProductList *list, const char *path);
+
+/**
+ * @brief Save products to a specific file
+ * @param list Pointer to ProductList to save
+ * @param path File to write
+ * @return 1 on success, 0 on failure
+ */
+int storage_save_products_file(const ProductList *list, const char *path);
+
 /**
  * @brief Load all suppliers from file
  * @param list Pointer to SupplierList to populate
+ * @param stats Output counters (may be NULL)
  * @return 1 on success, 0 on failure
  */
-int storage_load_suppliers(SupplierList *list);
+int storage_load_suppliers(SupplierList *list, LoadStats *stats);
 
 /**
  * @brief Save all suppliers to file
@@ -50,12 +80,29 @@ int storage_load_suppliers(SupplierList *list);
  */
 int storage_save_suppliers(const SupplierList *list);
 
+/**
+ * @brief Load suppliers from a specific file
+ * @param list Pointer to SupplierList to populate
+ * @param path File to read (missing file gives an empty list)
+ * @return 1 on success, 0 on failure
+ */
+int storage_load_suppliers_file(SupplierList *list, const char *path);
+
+/**
+ * @brief Save suppliers to a specific file
+ * @param list Pointer to SupplierList to save
+ * @param path File to write
+ * @return 1 on success, 0 on failure
+ */
+int storage_save_suppliers_file(const SupplierList *list, const char *path);
+
 /**
  * @brief Load all transactions from file
  * @param list Pointer to TransactionList to populate
+ * @param stats Output counters (may be NULL)
  * @return 1 on success, 0 on failure
  */
-int storage_load_transactions(TransactionList *list);
+int storage_load_transactions(TransactionList *list, LoadStats *stats);
 
 /**
  * @brief Save all transactions to file
@@ -64,12 +111,37 @@ int storage_load_transactions(TransactionList *list);
  */
 int storage_save_transactions(const TransactionList *list);
 
+/**
+ * @brief Parse one line of the transactions file
+ * @param line Line text (modified by the parser)
+ * @param t Output transaction
+ * @return 1 on success, 0 if the line has too few fields
+ */
+int storage_parse_transaction(char *line, Transaction *t);
+
+/**
+ * @brief Load transactions from a specific file
+ * @param list Pointer to TransactionList to populate
+ * @param path File to read (missing file gives an empty list)
+ * @return 1 on success, 0 on failure
+ */
+int storage_load_transactions_file(TransactionList *list, const char *path);
+
+/**
+ * @brief Save transactions to a specific file
+ * @param list Pointer to TransactionList to save
+ * @param path File to write
+ * @return 1 on success, 0 on failure
+ */
+int storage_save_transactions_file(const TransactionList *list, const char *path);
+
 /**
  * @brief Load all users from file
  * @param list Pointer to UserList to populate
+ * @param stats Output counters (may be NULL)
  * @return 1 on success, 0 on failure
  */
-int storage_load_users(UserList *list);
+int storage_load_users(UserList *list, LoadStats *stats);
 
 /**
  * @brief Save all users to file
@@ -78,6 +150,42 @@ int storage_load_users(UserList *list);
  */
 int storage_save_users(const UserList *list);
 
+/**
+ * @brief Load a bulk stock-movement file
+ *
+ * Format: product_id|type|quantity|notes, one movement per line, with an
+ * optional "product_id|" header. Malformed rows are kept with an empty
+ * type so they are rejected (and reported) by validation.
+ *
+ * @param path File to read
+ * @param rows Output: malloc'd array of movements (caller frees)
+ * @param count Output: number of rows
+ * @return 1 on success, 0 on failure
+ */
+int storage_load_movements(const char *path, StockMovement **rows, int *count);
+
+/**
+ * @brief Load saved demand forecast states
+ * @param store Store to replace (a missing file gives an empty store)
+ * @param stats Output counters (may be NULL)
+ * @return 1 on success, 0 on failure
+ */
+int storage_load_forecasts(ForecastStore *store, LoadStats *stats);
+
+/**
+ * @brief Save demand forecast states
+ * @param store Store to save
+ * @return 1 on success, 0 on failure
+ */
+int storage_save_forecasts(const ForecastStore *store);
+
+/**
+ * @brief Create a directory if it doesn't exist
+ * @param path Directory path
+ * @return 1 on success, 0 on failure
+ */
+int storage_ensure_directory(const char *path);
+
 /**
  * @brief Initialize data directory (create if doesn't exist)
  * @return 1 on success, 0 on failure
@@ -10,6 +10,7 @@ void supplier_list_init(SupplierList *list) {
     if (list == NULL) return;
     list->count = 0;
     memset(list->suppliers, 0, sizeof(list->suppliers));
+    list->generation = generation_next();
 }
 
 int supplier_add(SupplierList *list, const Supplier *supplier) {
@@ -29,6 +30,7 @@ int supplier_add(SupplierList *list, const Supplier *supplier) {
     
     list->suppliers[list->count] = *supplier;
     list->count++;
+    list->generation = generation_next();
     return 1;
 }
 
@@ -64,6 +66,7 @@ int supplier_update(SupplierList *list, int id, const Supplier *updated_supplier
     strncpy(supplier->address, updated_supplier->address, MAX_ADDRESS_LEN - 1);
     supplier->address[MAX_ADDRESS_LEN - 1] = '\0';
     
+    list->generation = generation_next();
     if (!supplier_validate(supplier)) {
         return 0;  // Updated data is invalid
     }
@@ -90,6 +93,7 @@ int supplier_delete(SupplierList *list, int id) {
     }
     
     list->count--;
+    list->generation = generation_next();
     return 1;
 }
 
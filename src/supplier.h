@@ -10,7 +10,9 @@
 
 #include "utils.h"
 
+#ifndef MAX_SUPPLIERS
 #define MAX_SUPPLIERS 500
+#endif
 
 /**
  * @brief Supplier structure
@@ -29,6 +31,7 @@ typedef struct {
 typedef struct {
     Supplier suppliers[MAX_SUPPLIERS];
     int count;
+    unsigned long generation;           ///< New value on every change (see generation_next)
 } SupplierList;
 
 /**
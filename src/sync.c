@@ -0,0 +1,185 @@
+/**
+ * @file sync.c
+ * @brief Implementation of portable mutex, thread and clock wrappers
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sync.h"
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Heap-allocated start record passed to the native thread entry
+ */
+typedef struct {
+    ThreadFunc func;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+
+void mutex_init(Mutex *mutex) {
+    InitializeCriticalSection(mutex);
+}
+
+void mutex_destroy(Mutex *mutex) {
+    DeleteCriticalSection(mutex);
+}
+
+void mutex_lock(Mutex *mutex) {
+    EnterCriticalSection(mutex);
+}
+
+void mutex_unlock(Mutex *mutex) {
+    LeaveCriticalSection(mutex);
+}
+
+void cond_init(CondVar *cond) {
+    InitializeConditionVariable(cond);
+}
+
+void cond_destroy(CondVar *cond) {
+    (void)cond;  // Win32 condition variables need no cleanup
+}
+
+void cond_wait(CondVar *cond, Mutex *mutex) {
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+void cond_broadcast(CondVar *cond) {
+    WakeAllConditionVariable(cond);
+}
+
+static DWORD WINAPI thread_entry(LPVOID param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.func(start.arg);
+    return 0;
+}
+
+int thread_start(Thread *thread, ThreadFunc func, void *arg) {
+    if (thread == NULL || func == NULL) return 0;
+    
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (start == NULL) return 0;
+    start->func = func;
+    start->arg = arg;
+    
+    *thread = CreateThread(NULL, 0, thread_entry, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return 0;
+    }
+    return 1;
+}
+
+void thread_join(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void thread_sleep_ms(int milliseconds) {
+    Sleep((DWORD)milliseconds);
+}
+
+unsigned long long sync_clock_ns(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    // Split to avoid overflowing counter * 1e9
+    unsigned long long ticks = (unsigned long long)counter.QuadPart;
+    unsigned long long hz = (unsigned long long)frequency.QuadPart;
+    return ticks / hz * 1000000000ULL + ticks % hz * 1000000000ULL / hz;
+}
+
+int sync_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (int)info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+void mutex_init(Mutex *mutex) {
+    pthread_mutex_init(mutex, NULL);
+}
+
+void mutex_destroy(Mutex *mutex) {
+    pthread_mutex_destroy(mutex);
+}
+
+void mutex_lock(Mutex *mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+void mutex_unlock(Mutex *mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+void cond_init(CondVar *cond) {
+    pthread_cond_init(cond, NULL);
+}
+
+void cond_destroy(CondVar *cond) {
+    pthread_cond_destroy(cond);
+}
+
+void cond_wait(CondVar *cond, Mutex *mutex) {
+    pthread_cond_wait(cond, mutex);
+}
+
+void cond_broadcast(CondVar *cond) {
+    pthread_cond_broadcast(cond);
+}
+
+static void *thread_entry(void *param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.func(start.arg);
+    return NULL;
+}
+
+int thread_start(Thread *thread, ThreadFunc func, void *arg) {
+    if (thread == NULL || func == NULL) return 0;
+    
+    ThreadStart *start = malloc(sizeof(ThreadStart));
+    if (start == NULL) return 0;
+    start->func = func;
+    start->arg = arg;
+    
+    if (pthread_create(thread, NULL, thread_entry, start) != 0) {
+        free(start);
+        return 0;
+    }
+    return 1;
+}
+
+void thread_join(Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+void thread_sleep_ms(int milliseconds) {
+    struct timespec ts = {milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+unsigned long long sync_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+int sync_cpu_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file sync.h
+ * @brief Portable mutex, thread and clock wrappers (Win32 / POSIX threads)
+ * @author Inventory Management System
+ * @date 2025
+ */
+
+#ifndef SYNC_H
+#define SYNC_H
+
+#ifdef _WIN32
+#include <windows.h>
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE CondVar;
+typedef HANDLE Thread;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t CondVar;
+typedef pthread_t Thread;
+#endif
+
+/**
+ * @brief Thread entry point
+ */
+typedef void (*ThreadFunc)(void *arg);
+
+/**
+ * @brief Initialize a mutex
+ * @param mutex Mutex to initialize
+ */
+void mutex_init(Mutex *mutex);
+
+/**
+ * @brief Destroy a mutex
+ * @param mutex Mutex to destroy
+ */
+void mutex_destroy(Mutex *mutex);
+
+/**
+ * @brief Lock a mutex
+ * @param mutex Mutex to lock
+ */
+void mutex_lock(Mutex *mutex);
+
+/**
+ * @brief Unlock a mutex
+ * @param mutex Mutex to unlock
+ */
+void mutex_unlock(Mutex *mutex);
+
+/**
+ * @brief Initialize a condition variable
+ * @param cond Condition variable to initialize
+ */
+void cond_init(CondVar *cond);
+
+/**
+ * @brief Destroy a condition variable
+ * @param cond Condition variable to destroy
+ */
+void cond_destroy(CondVar *cond);
+
+/**
+ * @brief Atomically unlock a mutex and wait for a broadcast
+ * @param cond Condition variable
+ * @param mutex Locked mutex (locked again on return)
+ */
+void cond_wait(CondVar *cond, Mutex *mutex);
+
+/**
+ * @brief Wake every thread waiting on a condition variable
+ * @param cond Condition variable
+ */
+void cond_broadcast(CondVar *cond);
+
+/**
+ * @brief Start a thread
+ * @param thread Output thread handle
+ * @param func Function to run
+ * @param arg Argument passed to func
+ * @return 1 on success, 0 on failure
+ */
+int thread_start(Thread *thread, ThreadFunc func, void *arg);
+
+/**
+ * @brief Wait for a thread to finish
+ * @param thread Thread handle from thread_start
+ */
+void thread_join(Thread thread);
+
+/**
+ * @brief Suspend the calling thread
+ * @param milliseconds Time to sleep
+ */
+void thread_sleep_ms(int milliseconds);
+
+/**
+ * @brief Read the monotonic clock
+ * @return Nanoseconds since an arbitrary fixed point (never goes backwards)
+ */
+unsigned long long sync_clock_ns(void);
+
+/**
+ * @brief Get the number of online CPUs
+ * @return CPU count (at least 1)
+ */
+int sync_cpu_count(void);
+
+#endif /* SYNC_H */
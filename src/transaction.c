@@ -8,10 +8,18 @@
 
 void transaction_list_init(TransactionList *list) {
     if (list == NULL) return;
-    list->count = 0;
+    transaction_list_reset(list);
     memset(list->transactions, 0, sizeof(list->transactions));
 }
 
+void transaction_list_reset(TransactionList *list) {
+    if (list == NULL) return;
+    list->count = 0;
+    list->next_id = 1;
+    list->generation = generation_next();
+    list->listener_count = 0;
+}
+
 int transaction_add(TransactionList *list, const Transaction *transaction) {
     if (list == NULL || transaction == NULL) return 0;
     
@@ -25,9 +33,36 @@ int transaction_add(TransactionList *list, const Transaction *transaction) {
     
     list->transactions[list->count] = *transaction;
     list->count++;
+    list->generation = generation_next();
+    
+    if (transaction->transaction_id >= list->next_id) {
+        list->next_id = transaction->transaction_id + 1;
+    }
+    
+    transaction_notify_listeners(list, list->count - 1, 1);
+    return 1;
+}
+
+int transaction_add_listener(TransactionList *list, TransactionListener listener, void *ctx) {
+    if (list == NULL || listener == NULL) return 0;
+    if (list->listener_count >= MAX_TRANSACTION_LISTENERS) return 0;
+    
+    list->listeners[list->listener_count] = listener;
+    list->listener_ctx[list->listener_count] = ctx;
+    list->listener_count++;
     return 1;
 }
 
+void transaction_notify_listeners(TransactionList *list, int first, int count) {
+    if (list == NULL) return;
+    
+    for (int i = first; i < first + count && i < list->count; i++) {
+        for (int l = 0; l < list->listener_count; l++) {
+            list->listeners[l](list->listener_ctx[l], &list->transactions[i]);
+        }
+    }
+}
+
 Transaction* transaction_find_by_id(TransactionList *list, int id) {
     if (list == NULL) return NULL;
     
@@ -60,13 +95,24 @@ int transaction_get_by_date_range(TransactionList *list,
                                   const char *end_date,
                                   Transaction *results,
                                   int max_results) {
+    if (list == NULL) return 0;
+    return transaction_get_by_date_range_prefix(list, list->count, start_date, end_date,
+                                                results, max_results);
+}
+
+int transaction_get_by_date_range_prefix(const TransactionList *list, int count,
+                                         const char *start_date,
+                                         const char *end_date,
+                                         Transaction *results,
+                                         int max_results) {
     if (list == NULL || start_date == NULL || end_date == NULL || 
         results == NULL) {
         return 0;
     }
+    if (count > list->count) count = list->count;
     
     int found = 0;
-    for (int i = 0; i < list->count && found < max_results; i++) {
+    for (int i = 0; i < count && found < max_results; i++) {
         // Extract date part (first 10 characters: YYYY-MM-DD)
         char date_str[11];
         strncpy(date_str, list->transactions[i].date_time, 10);
@@ -96,14 +142,7 @@ int transaction_get_all(TransactionList *list, Transaction *results) {
 int transaction_get_next_id(TransactionList *list) {
     if (list == NULL) return 1;
     
-    int max_id = 0;
-    for (int i = 0; i < list->count; i++) {
-        if (list->transactions[i].transaction_id > max_id) {
-            max_id = list->transactions[i].transaction_id;
-        }
-    }
-    
-    return max_id + 1;
+    return (list->next_id > 0) ? list->next_id : 1;
 }
 
 int transaction_validate(const Transaction *transaction) {
@@ -10,7 +10,9 @@
 
 #include "utils.h"
 
+#ifndef MAX_TRANSACTIONS
 #define MAX_TRANSACTIONS 5000
+#endif
 #define TRANSACTION_TYPE_IN "IN"
 #define TRANSACTION_TYPE_OUT "OUT"
 
@@ -26,12 +28,26 @@ typedef struct {
     char notes[MAX_NOTES_LEN];       ///< Optional notes
 } Transaction;
 
+/**
+ * @brief Callback run for every transaction appended to a list
+ * @param ctx Context given at registration
+ * @param transaction The transaction just added
+ */
+typedef void (*TransactionListener)(void *ctx, const Transaction *transaction);
+
+#define MAX_TRANSACTION_LISTENERS 8
+
 /**
  * @brief Transaction list structure
  */
 typedef struct {
     Transaction transactions[MAX_TRANSACTIONS];
     int count;
+    int next_id;                     ///< Cached next transaction ID (max ID + 1)
+    unsigned long generation;        ///< New value on every change (see generation_next)
+    TransactionListener listeners[MAX_TRANSACTION_LISTENERS];
+    void *listener_ctx[MAX_TRANSACTION_LISTENERS];
+    int listener_count;
 } TransactionList;
 
 /**
@@ -40,6 +56,16 @@ typedef struct {
  */
 void transaction_list_init(TransactionList *list);
 
+/**
+ * @brief Empty a transaction list without clearing its slots
+ *
+ * Like transaction_list_init, but slots past the count are left as they
+ * are, so a load does not first commit the whole fixed-size array.
+ *
+ * @param list Pointer to TransactionList structure
+ */
+void transaction_list_reset(TransactionList *list);
+
 /**
  * @brief Add a new transaction
  * @param list Pointer to TransactionList
@@ -48,6 +74,28 @@ void transaction_list_init(TransactionList *list);
  */
 int transaction_add(TransactionList *list, const Transaction *transaction);
 
+/**
+ * @brief Register a callback for every later transaction_add
+ *
+ * Listeners keep derived data (rollups, forecasts) up to date. They are
+ * cleared by transaction_list_init, so loading a file does not fire them;
+ * register after loading and rebuild from the loaded rows instead.
+ *
+ * @param list Pointer to TransactionList
+ * @param listener Callback
+ * @param ctx Context passed to the callback
+ * @return 1 on success, 0 if all listener slots are taken
+ */
+int transaction_add_listener(TransactionList *list, TransactionListener listener, void *ctx);
+
+/**
+ * @brief Run every listener for rows appended without transaction_add
+ * @param list Pointer to TransactionList
+ * @param first First row to announce
+ * @param count Number of rows
+ */
+void transaction_notify_listeners(TransactionList *list, int first, int count);
+
 /**
  * @brief Find transaction by ID
  * @param list Pointer to TransactionList
@@ -82,6 +130,25 @@ int transaction_get_by_date_range(TransactionList *list,
                                   Transaction *results, 
                                   int max_results);
 
+/**
+ * @brief Get transactions within a date range among the first rows
+ *
+ * For snapshot readers, which see only a prefix of the shared log.
+ *
+ * @param list Pointer to TransactionList
+ * @param count Number of leading rows to consider
+ * @param start_date Start date string (YYYY-MM-DD format)
+ * @param end_date End date string (YYYY-MM-DD format)
+ * @param results Output array
+ * @param max_results Maximum number of results
+ * @return Number of transactions found
+ */
+int transaction_get_by_date_range_prefix(const TransactionList *list, int count,
+                                         const char *start_date,
+                                         const char *end_date,
+                                         Transaction *results,
+                                         int max_results);
+
 /**
  * @brief Get all transactions
  * @param list Pointer to TransactionList
@@ -93,7 +160,7 @@ int transaction_get_all(TransactionList *list, Transaction *results);
 /**
  * @brief Get next available transaction ID
  * @param list Pointer to TransactionList
- * @return Next available ID
+ * @return Next available ID (O(1), maintained by transaction_add)
  */
 int transaction_get_next_id(TransactionList *list);
 
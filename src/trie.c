@@ -0,0 +1,390 @@
+/**
+ * @file trie.c
+ * @brief Implementation of the product prefix trie
+ */
+
+#include "trie.h"
+#include "metrics.h"
+#include "view.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRIE_MAX_KEY (MAX_NAME_LEN + 16)
+#define NAME_COLUMN 1               // Product "Name" column of view.h
+
+// Case-folded copy of a key, truncated to fit
+static void fold_key(const char *text, char *key) {
+    int i = 0;
+    for (; text[i] != '\0' && i < TRIE_MAX_KEY - 1; i++) {
+        key[i] = (char)tolower((unsigned char)text[i]);
+    }
+    key[i] = '\0';
+}
+
+static TrieNode* node_new(ProductTrie *trie, const char *label, int length) {
+    TrieNode *node = calloc(1, sizeof(TrieNode) + (size_t)length);
+    if (node == NULL) return NULL;
+    
+    memcpy(node->label, label, (size_t)length);
+    node->label_length = length;
+    trie->nodes++;
+    return node;
+}
+
+static void node_free(ProductTrie *trie, TrieNode *node) {
+    free(node->children);
+    free(node->ids);
+    free(node);
+    trie->nodes--;
+}
+
+static void subtree_free(ProductTrie *trie, TrieNode *node) {
+    for (int i = 0; i < node->child_count; i++) {
+        subtree_free(trie, node->children[i].node);
+    }
+    node_free(trie, node);
+}
+
+/**
+ * @brief Find the child whose label starts with a byte
+ * @param node Parent
+ * @param c First byte
+ * @param slot Output: index of the child, or where it would be inserted
+ * @return The child, or NULL
+ */
+static TrieNode* find_child(const TrieNode *node, unsigned char c, int *slot) {
+    int low = 0, high = node->child_count;
+    
+    while (low < high) {
+        int mid = (low + high) / 2;
+        unsigned char first = node->children[mid].first;
+        if (first == c) {
+            if (slot != NULL) *slot = mid;
+            return node->children[mid].node;
+        }
+        if (first < c) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (slot != NULL) *slot = low;
+    return NULL;
+}
+
+static int insert_child(TrieNode *node, int slot, TrieNode *child) {
+    if (node->child_count >= node->child_capacity) {
+        int capacity = (node->child_capacity > 0) ? node->child_capacity * 2 : 2;
+        TrieEdge *grown = realloc(node->children, (size_t)capacity * sizeof(TrieEdge));
+        if (grown == NULL) return 0;
+        node->children = grown;
+        node->child_capacity = capacity;
+    }
+    memmove(&node->children[slot + 1], &node->children[slot],
+            (size_t)(node->child_count - slot) * sizeof(TrieEdge));
+    node->children[slot].first = (unsigned char)child->label[0];
+    node->children[slot].node = child;
+    node->child_count++;
+    return 1;
+}
+
+static void remove_child(TrieNode *node, int slot) {
+    memmove(&node->children[slot], &node->children[slot + 1],
+            (size_t)(node->child_count - slot - 1) * sizeof(TrieEdge));
+    node->child_count--;
+}
+
+static int add_id(TrieNode *node, int id) {
+    int slot = node->id_count;
+    while (slot > 0 && node->ids[slot - 1] >= id) {
+        if (node->ids[slot - 1] == id) return 1;  // Already stored
+        slot--;
+    }
+    
+    if (node->id_count >= node->id_capacity) {
+        int capacity = (node->id_capacity > 0) ? node->id_capacity * 2 : 1;
+        int *grown = realloc(node->ids, (size_t)capacity * sizeof(int));
+        if (grown == NULL) return 0;
+        node->ids = grown;
+        node->id_capacity = capacity;
+    }
+    memmove(&node->ids[slot + 1], &node->ids[slot], (size_t)(node->id_count - slot) * sizeof(int));
+    node->ids[slot] = id;
+    node->id_count++;
+    return 1;
+}
+
+static int remove_id(TrieNode *node, int id) {
+    for (int i = 0; i < node->id_count; i++) {
+        if (node->ids[i] == id) {
+            memmove(&node->ids[i], &node->ids[i + 1], (size_t)(node->id_count - i - 1) * sizeof(int));
+            node->id_count--;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int common_prefix(const char *a, int a_length, const char *b) {
+    int i = 0;
+    while (i < a_length && b[i] != '\0' && a[i] == b[i]) i++;
+    return i;
+}
+
+/**
+ * @brief Split a child's edge after length bytes
+ * @return The new node standing for the first length bytes, or NULL
+ */
+static TrieNode* split_edge(ProductTrie *trie, TrieNode *parent, int slot, int length) {
+    TrieNode *child = parent->children[slot].node;
+    TrieNode *middle = node_new(trie, child->label, length);
+    if (middle == NULL) return NULL;
+    
+    memmove(child->label, child->label + length, (size_t)(child->label_length - length));
+    child->label_length -= length;
+    if (!insert_child(middle, 0, child)) {
+        memmove(child->label + length, child->label, (size_t)child->label_length);
+        memcpy(child->label, middle->label, (size_t)length);
+        child->label_length += length;
+        node_free(trie, middle);
+        return NULL;
+    }
+    parent->children[slot].node = middle;
+    return middle;
+}
+
+static int insert_key(ProductTrie *trie, const char *key, int id) {
+    TrieNode *node = trie->root;
+    
+    while (*key != '\0') {
+        int slot;
+        TrieNode *child = find_child(node, (unsigned char)*key, &slot);
+        
+        if (child == NULL) {
+            TrieNode *leaf = node_new(trie, key, (int)strlen(key));
+            if (leaf == NULL) return 0;
+            if (!add_id(leaf, id) || !insert_child(node, slot, leaf)) {
+                node_free(trie, leaf);
+                return 0;
+            }
+            trie->keys++;
+            return 1;
+        }
+        
+        int shared = common_prefix(child->label, child->label_length, key);
+        if (shared < child->label_length) {
+            child = split_edge(trie, node, slot, shared);
+            if (child == NULL) return 0;
+        }
+        node = child;
+        key += shared;
+    }
+    
+    int before = node->id_count;
+    if (!add_id(node, id)) return 0;
+    trie->keys += node->id_count - before;
+    return 1;
+}
+
+// Join a node that neither ends a key nor branches with its only child
+static void merge_with_child(ProductTrie *trie, TrieNode *parent, int slot) {
+    TrieNode *node = parent->children[slot].node;
+    int length = node->label_length + node->children[0].node->label_length;
+    TrieNode *child = realloc(node->children[0].node, sizeof(TrieNode) + (size_t)length);
+    if (child == NULL) return;  // Leave the tree uncompressed but correct
+    
+    memmove(child->label + node->label_length, child->label, (size_t)child->label_length);
+    memcpy(child->label, node->label, (size_t)node->label_length);
+    child->label_length = length;
+    parent->children[slot].node = child;
+    node->child_count = 0;
+    node_free(trie, node);
+}
+
+static void remove_key(ProductTrie *trie, const char *key, int id) {
+    TrieNode *path[TRIE_MAX_KEY + 1];
+    int slots[TRIE_MAX_KEY + 1];
+    int depth = 0;
+    TrieNode *node = trie->root;
+    
+    while (*key != '\0') {
+        int slot;
+        TrieNode *child = find_child(node, (unsigned char)*key, &slot);
+        if (child == NULL) return;
+        int shared = common_prefix(child->label, child->label_length, key);
+        if (shared < child->label_length) return;
+        
+        path[depth] = node;
+        slots[depth] = slot;
+        depth++;
+        node = child;
+        key += shared;
+    }
+    if (!remove_id(node, id)) return;
+    trie->keys--;
+    if (depth == 0 || node->id_count > 0) return;
+    
+    // Prune the emptied leaf, then re-compress what is left
+    TrieNode *parent = path[depth - 1];
+    int slot = slots[depth - 1];
+    if (node->child_count == 0) {
+        remove_child(parent, slot);
+        node_free(trie, node);
+        if (depth >= 2 && parent->id_count == 0 && parent->child_count == 1) {
+            merge_with_child(trie, path[depth - 2], slots[depth - 2]);
+        }
+    } else if (node->child_count == 1) {
+        merge_with_child(trie, parent, slot);
+    }
+}
+
+static int insert_name(ProductTrie *trie, const Product *product) {
+    char name[TRIE_MAX_KEY];
+    fold_key(product->name, name);
+    if (insert_key(trie, name, product->id)) return 1;
+    trie->failed = 1;
+    return 0;
+}
+
+static int insert_id(ProductTrie *trie, const Product *product) {
+    char id[16];
+    snprintf(id, sizeof(id), "%d", product->id);
+    if (insert_key(trie, id, product->id)) return 1;
+    trie->failed = 1;
+    return 0;
+}
+
+int trie_insert(ProductTrie *trie, const Product *product) {
+    if (trie == NULL || trie->root == NULL || product == NULL) return 0;
+    return insert_name(trie, product) && insert_id(trie, product);
+}
+
+void trie_remove(ProductTrie *trie, const Product *product) {
+    if (trie == NULL || trie->root == NULL || product == NULL) return;
+    
+    char name[TRIE_MAX_KEY], id[16];
+    fold_key(product->name, name);
+    snprintf(id, sizeof(id), "%d", product->id);
+    remove_key(trie, name, product->id);
+    remove_key(trie, id, product->id);
+}
+
+void trie_free(ProductTrie *trie) {
+    if (trie == NULL) return;
+    if (trie->root != NULL) subtree_free(trie, trie->root);
+    trie->root = NULL;
+    trie->keys = 0;
+    trie->nodes = 0;
+    trie->failed = 0;
+    product_index_free(&trie->index);
+}
+
+int trie_build(ProductTrie *trie, const ProductList *products) {
+    if (trie == NULL || products == NULL) return 0;
+    
+    trie_free(trie);
+    trie->root = node_new(trie, "", 0);
+    if (trie->root == NULL) return 0;
+    
+    // Inserting in key order keeps the path being extended in cache: names
+    // go in name order (the case-insensitive sort of view.h is the trie's
+    // order), IDs in list order, which is usually ascending
+    ViewCache names;
+    view_cache_init(&names);
+    const int *order = view_sort_products(&names, products, NAME_COLUMN);
+    int ok = 1;
+    for (int i = 0; i < products->count && ok; i++) {
+        ok = insert_name(trie, &products->products[(order != NULL) ? order[i] : i]);
+    }
+    view_cache_free(&names);
+    for (int i = 0; i < products->count && ok; i++) {
+        ok = insert_id(trie, &products->products[i]);
+    }
+    return ok;
+}
+
+static void on_product_change(void *ctx, const Product *before, const Product *after) {
+    ProductTrie *trie = ctx;
+    
+    // Quantity and price edits leave the keys alone
+    if (before != NULL && after != NULL && before->id == after->id &&
+        strcmp(before->name, after->name) == 0) {
+        return;
+    }
+    if (before != NULL) trie_remove(trie, before);
+    if (after != NULL) trie_insert(trie, after);
+}
+
+int trie_attach(ProductTrie *trie, ProductList *products) {
+    if (trie == NULL) return 0;
+    return product_add_listener(products, on_product_change, trie);
+}
+
+/**
+ * @brief Collect IDs below a node in key order
+ * @return Nonzero once max_results IDs have been collected
+ */
+static int collect(const TrieNode *node, int *ids, int *count, int max_results) {
+    for (int i = 0; i < node->id_count; i++) {
+        int seen = 0;
+        for (int j = 0; j < *count && !seen; j++) seen = (ids[j] == node->ids[i]);
+        if (!seen) {
+            ids[(*count)++] = node->ids[i];
+            if (*count >= max_results) return 1;
+        }
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        if (collect(node->children[i].node, ids, count, max_results)) return 1;
+    }
+    return 0;
+}
+
+static int complete(const ProductTrie *trie, const char *prefix, int *ids, int max_results) {
+    if (trie == NULL || trie->root == NULL || prefix == NULL || ids == NULL || max_results <= 0) {
+        return 0;
+    }
+    
+    char key[TRIE_MAX_KEY];
+    fold_key(prefix, key);
+    
+    // Walk down; the prefix may end part way along an edge
+    const TrieNode *node = trie->root;
+    const char *rest = key;
+    while (*rest != '\0') {
+        const TrieNode *child = find_child(node, (unsigned char)*rest, NULL);
+        if (child == NULL) return 0;
+        int shared = common_prefix(child->label, child->label_length, rest);
+        if (rest[shared] != '\0' && shared < child->label_length) return 0;
+        node = child;
+        rest += shared;
+    }
+    
+    int count = 0;
+    collect(node, ids, &count, max_results);
+    return count;
+}
+
+int trie_complete(const ProductTrie *trie, const char *prefix, int *ids, int max_results) {
+    MetricTimer timer = metrics_start();
+    int result = complete(trie, prefix, ids, max_results);
+    metrics_stop(METRIC_SEARCH_COMPLETE, timer);
+    return result;
+}
+
+Product* trie_product(ProductTrie *trie, ProductList *products, int id) {
+    if (trie == NULL || products == NULL) return NULL;
+    
+    int slot = product_index_find(&trie->index, products, id);
+    if (slot < 0 || slot >= products->count) {
+        // Unchanged list: the product is gone, not just unindexed
+        if (trie->index.capacity > 0 && trie->index_generation == products->generation) return NULL;
+        product_index_free(&trie->index);
+        if (!product_index_build(&trie->index, products)) return product_find_by_id(products, id);
+        trie->index_generation = products->generation;
+        slot = product_index_find(&trie->index, products, id);
+        if (slot < 0) return NULL;
+    }
+    return &products->products[slot];
+}
@@ -0,0 +1,127 @@
+/**
+ * @file trie.h
+ * @brief Prefix trie of product names and IDs for type-ahead lookup
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A compressed trie (radix tree): every edge carries a run of bytes and
+ * every inner node branches, so a tree of n keys has fewer than 2n nodes.
+ * Each product is stored under its case-folded name and under its decimal
+ * ID. Children are kept sorted, so a depth-first walk yields completions
+ * in alphabetical order; finding the first k costs O(prefix length + k)
+ * node visits, independent of the catalogue size.
+ *
+ * The trie follows the product list through a product listener, so it
+ * stays current across add, update and delete without rebuilding.
+ */
+
+#ifndef TRIE_H
+#define TRIE_H
+
+#include "product.h"
+
+#define TRIE_DEFAULT_COMPLETIONS 10     // Completions shown by type-ahead
+
+typedef struct TrieNode TrieNode;
+
+/**
+ * @brief Link to a child, with the first byte of its label for searching
+ */
+typedef struct {
+    unsigned char first;
+    TrieNode *node;
+} TrieEdge;
+
+/**
+ * @brief One trie node
+ */
+struct TrieNode {
+    TrieEdge *children;         ///< Ordered by first label byte
+    int child_count;
+    int child_capacity;
+    int *ids;                   ///< Products whose key ends here, ascending
+    int id_count;
+    int id_capacity;
+    int label_length;
+    char label[];               ///< Bytes on the edge from the parent (not terminated)
+};
+
+/**
+ * @brief Product name and ID trie
+ *
+ * Zero-initialize, then trie_build. Free with trie_free.
+ */
+typedef struct {
+    TrieNode *root;
+    long keys;                  ///< Keys stored (two per product)
+    long nodes;                 ///< Nodes allocated, root included
+    int failed;                 ///< Set if an allocation failed (the trie is incomplete)
+    ProductIdIndex index;       ///< Completed IDs to list slots
+    unsigned long index_generation; ///< Product generation the index was built at
+} ProductTrie;
+
+/**
+ * @brief Rebuild the trie from a product list
+ * @param trie Trie to rebuild
+ * @param products Products
+ * @return 1 on success, 0 on allocation failure
+ */
+int trie_build(ProductTrie *trie, const ProductList *products);
+
+/**
+ * @brief Keep the trie current as products are added, updated and deleted
+ * @param trie Trie
+ * @param products List to listen to
+ * @return 1 on success, 0 if no listener slot is free
+ */
+int trie_attach(ProductTrie *trie, ProductList *products);
+
+/**
+ * @brief Release all trie memory
+ * @param trie Trie to free
+ */
+void trie_free(ProductTrie *trie);
+
+/**
+ * @brief Add a product's keys
+ * @param trie Trie
+ * @param product Product
+ * @return 1 on success, 0 on allocation failure
+ */
+int trie_insert(ProductTrie *trie, const Product *product);
+
+/**
+ * @brief Remove a product's keys
+ * @param trie Trie
+ * @param product Product as it was inserted
+ */
+void trie_remove(ProductTrie *trie, const Product *product);
+
+/**
+ * @brief Find products whose name or ID starts with a prefix
+ *
+ * Name matches ignore case. Results are in key order (a product matched
+ * by both its name and its ID is listed once).
+ *
+ * @param trie Trie
+ * @param prefix Prefix (the empty prefix matches every product)
+ * @param ids Output product IDs
+ * @param max_results Most results to return (k)
+ * @return Number of results
+ */
+int trie_complete(const ProductTrie *trie, const char *prefix, int *ids, int max_results);
+
+/**
+ * @brief Look up a completed product
+ *
+ * Uses an ID index kept with the trie, rebuilt only when an ID is missing
+ * and the list has changed since the last build.
+ *
+ * @param trie Trie
+ * @param products The product list
+ * @param id Product ID from trie_complete
+ * @return The product, or NULL if it no longer exists
+ */
+Product* trie_product(ProductTrie *trie, ProductList *products, int id);
+
+#endif /* TRIE_H */
@@ -4,6 +4,7 @@
  */
 
 #include "ui.h"
+#include "output.h"
 #include "utils.h"
 #include <stdio.h>
 #include <string.h>
@@ -46,7 +47,8 @@ void ui_display_admin_menu(void) {
     printf("3. Stock Operations\n");
     printf("4. Reports\n");
     printf("5. Backup & Restore\n");
-    printf("6. Logout\n");
+    printf("6. Performance Statistics\n");
+    printf("7. Logout\n");
     printf("\nEnter your choice: ");
 }
 
@@ -57,7 +59,8 @@ void ui_display_staff_menu(void) {
     printf("2. Search Products\n");
     printf("3. Stock Operations\n");
     printf("4. View Low Stock Products\n");
-    printf("5. Logout\n");
+    printf("5. Quick Find\n");
+    printf("6. Logout\n");
     printf("\nEnter your choice: ");
 }
 
@@ -72,7 +75,9 @@ void ui_display_product_menu(void) {
     printf("6. Edit Product\n");
     printf("7. Delete Product\n");
     printf("8. View Low Stock Products\n");
-    printf("9. Back to Main Menu\n");
+    printf("9. Filter Products\n");
+    printf("10. Quick Find\n");
+    printf("11. Back to Main Menu\n");
     printf("\nEnter your choice: ");
 }
 
@@ -93,7 +98,9 @@ void ui_display_stock_menu(void) {
     printf("1. Stock In\n");
     printf("2. Stock Out\n");
     printf("3. View Recent Transactions\n");
-    printf("4. Back to Main Menu\n");
+    printf("4. Import Movements from File\n");
+    printf("5. Filter Transactions\n");
+    printf("6. Back to Main Menu\n");
     printf("\nEnter your choice: ");
 }
 
@@ -106,7 +113,15 @@ void ui_display_reports_menu(void) {
     printf("4. Top Products by Value\n");
     printf("5. Low Stock Products\n");
     printf("6. Transactions by Date Range\n");
-    printf("7. Back to Main Menu\n");
+    printf("7. Weekly Movement by Category\n");
+    printf("8. Stock Velocity & Turnover\n");
+    printf("9. Reorder Suggestions by Supplier\n");
+    printf("10. Stock as of Date\n");
+    printf("11. Stock by Category or Supplier\n");
+    printf("12. Inventory Dashboard\n");
+    printf("13. Movement Sketches (Approximate)\n");
+    printf("14. ABC Classification by Value\n");
+    printf("15. Back to Main Menu\n");
     printf("\nEnter your choice: ");
 }
 
@@ -116,34 +131,60 @@ void ui_display_products_table(const ProductList *list) {
         return;
     }
     
-    printf("\n");
-    print_separator(120, '-');
-    printf("%-6s %-20s %-15s %-25s %-8s %-8s %-10s %-8s\n",
-           "ID", "Name", "Category", "Description", "Qty", "Reorder", "Price", "Supp ID");
-    print_separator(120, '-');
-    
+    ui_display_products_header();
     for (int i = 0; i < list->count; i++) {
-        const Product *p = &list->products[i];
-        int is_low_stock = (p->quantity_in_stock <= p->reorder_level);
-        
-        if (is_low_stock) {
-            printf("*");  // Mark low stock
-        } else {
-            printf(" ");
-        }
-        
-        printf("%-5d %-20s %-15s %-25s %-8d %-8d $%-9.2f %-8d",
-               p->id, p->name, p->category, p->description,
-               p->quantity_in_stock, p->reorder_level, p->unit_price, p->supplier_id);
-        
-        if (is_low_stock) {
-            printf(" [LOW STOCK]");
-        }
-        printf("\n");
+        ui_display_product_row(&list->products[i]);
     }
+    ui_display_products_footer();
+}
+
+/**
+ * @brief Append a separator line to the table buffer
+ */
+static void output_separator(int length, char character) {
+    output_repeat(character, length);
+    output_char('\n');
+}
+
+void ui_display_products_header(void) {
+    output_char('\n');
+    output_separator(120, '-');
+    output_text("ID     Name                 Category        Description               "
+                "Qty      Reorder  Price      Supp ID \n");
+    output_separator(120, '-');
+}
+
+void ui_display_product_row(const Product *p) {
+    int is_low_stock = (p->quantity_in_stock <= p->reorder_level);
     
-    print_separator(120, '-');
-    printf("\n* = Low Stock Item\n");
+    // Same columns as "%-5d %-20s %-15s %-25s %-8d %-8d $%-9.2f %-8d"
+    output_char(is_low_stock ? '*' : ' ');  // Mark low stock
+    output_int(p->id, 5);
+    output_char(' ');
+    output_padded(p->name, 20);
+    output_char(' ');
+    output_padded(p->category, 15);
+    output_char(' ');
+    output_padded(p->description, 25);
+    output_char(' ');
+    output_int(p->quantity_in_stock, 8);
+    output_char(' ');
+    output_int(p->reorder_level, 8);
+    output_text(" $");
+    output_decimal(p->unit_price, 9);
+    output_char(' ');
+    output_int(p->supplier_id, 8);
+    
+    if (is_low_stock) {
+        output_text(" [LOW STOCK]");
+    }
+    output_char('\n');
+}
+
+void ui_display_products_footer(void) {
+    output_separator(120, '-');
+    output_text("\n* = Low Stock Item\n");
+    output_flush();
 }
 
 void ui_display_product(const Product *product) {
@@ -177,19 +218,38 @@ void ui_display_suppliers_table(const SupplierList *list) {
         return;
     }
     
-    printf("\n");
-    print_separator(100, '-');
-    printf("%-8s %-25s %-20s %-30s %-30s\n",
-           "ID", "Name", "Contact", "Email", "Address");
-    print_separator(100, '-');
-    
+    ui_display_suppliers_header();
     for (int i = 0; i < list->count; i++) {
-        const Supplier *s = &list->suppliers[i];
-        printf("%-8d %-25s %-20s %-30s %-30s\n",
-               s->supplier_id, s->name, s->contact_number, s->email, s->address);
+        ui_display_supplier_row(&list->suppliers[i]);
     }
-    
-    print_separator(100, '-');
+    ui_display_suppliers_footer();
+}
+
+void ui_display_suppliers_header(void) {
+    output_char('\n');
+    output_separator(100, '-');
+    output_text("ID       Name                      Contact              "
+                "Email                          Address                       \n");
+    output_separator(100, '-');
+}
+
+void ui_display_supplier_row(const Supplier *s) {
+    // Same columns as "%-8d %-25s %-20s %-30s %-30s"
+    output_int(s->supplier_id, 8);
+    output_char(' ');
+    output_padded(s->name, 25);
+    output_char(' ');
+    output_padded(s->contact_number, 20);
+    output_char(' ');
+    output_padded(s->email, 30);
+    output_char(' ');
+    output_padded(s->address, 30);
+    output_char('\n');
+}
+
+void ui_display_suppliers_footer(void) {
+    output_separator(100, '-');
+    output_flush();
 }
 
 void ui_display_supplier(const Supplier *supplier) {
@@ -216,20 +276,40 @@ void ui_display_transactions_table(const Transaction *transactions, int count) {
         return;
     }
     
-    printf("\n");
-    print_separator(100, '-');
-    printf("%-8s %-8s %-6s %-8s %-20s %-30s\n",
-           "Trans ID", "Prod ID", "Type", "Qty", "Date/Time", "Notes");
-    print_separator(100, '-');
-    
+    ui_display_transactions_header();
     for (int i = 0; i < count; i++) {
-        const Transaction *t = &transactions[i];
-        printf("%-8d %-8d %-6s %-8d %-20s %-30s\n",
-               t->transaction_id, t->product_id, t->type, t->quantity,
-               t->date_time, t->notes);
+        ui_display_transaction_row(&transactions[i]);
     }
-    
-    print_separator(100, '-');
+    ui_display_transactions_footer();
+}
+
+void ui_display_transactions_header(void) {
+    output_char('\n');
+    output_separator(100, '-');
+    output_text("Trans ID Prod ID  Type   Qty      Date/Time            "
+                "Notes                         \n");
+    output_separator(100, '-');
+}
+
+void ui_display_transaction_row(const Transaction *t) {
+    // Same columns as "%-8d %-8d %-6s %-8d %-20s %-30s"
+    output_int(t->transaction_id, 8);
+    output_char(' ');
+    output_int(t->product_id, 8);
+    output_char(' ');
+    output_padded(t->type, 6);
+    output_char(' ');
+    output_int(t->quantity, 8);
+    output_char(' ');
+    output_padded(t->date_time, 20);
+    output_char(' ');
+    output_padded(t->notes, 30);
+    output_char('\n');
+}
+
+void ui_display_transactions_footer(void) {
+    output_separator(100, '-');
+    output_flush();
 }
 
 void ui_display_transaction(const Transaction *transaction) {
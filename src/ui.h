@@ -60,6 +60,25 @@ void ui_display_header(const char *title);
  */
 void ui_display_products_table(const ProductList *list);
 
+/**
+ * @brief Print the column headings of the products table
+ *
+ * The header and rows are buffered (see output.h) until
+ * ui_display_products_footer writes the table out.
+ */
+void ui_display_products_header(void);
+
+/**
+ * @brief Print one row of the products table
+ * @param product Product to print
+ */
+void ui_display_product_row(const Product *product);
+
+/**
+ * @brief Print the closing line and legend of the products table
+ */
+void ui_display_products_footer(void);
+
 /**
  * @brief Display a single product
  * @param product Pointer to Product
@@ -72,6 +91,25 @@ void ui_display_product(const Product *product);
  */
 void ui_display_suppliers_table(const SupplierList *list);
 
+/**
+ * @brief Print the column headings of the suppliers table
+ *
+ * Buffered like the products table; ui_display_suppliers_footer
+ * writes the table out.
+ */
+void ui_display_suppliers_header(void);
+
+/**
+ * @brief Print one row of the suppliers table
+ * @param supplier Supplier to print
+ */
+void ui_display_supplier_row(const Supplier *supplier);
+
+/**
+ * @brief Print the closing line of the suppliers table
+ */
+void ui_display_suppliers_footer(void);
+
 /**
  * @brief Display a single supplier
  * @param supplier Pointer to Supplier
@@ -85,6 +123,25 @@ void ui_display_supplier(const Supplier *supplier);
  */
 void ui_display_transactions_table(const Transaction *transactions, int count);
 
+/**
+ * @brief Print the column headings of the transactions table
+ *
+ * Buffered like the products table; ui_display_transactions_footer
+ * writes the table out.
+ */
+void ui_display_transactions_header(void);
+
+/**
+ * @brief Print one row of the transactions table
+ * @param transaction Transaction to print
+ */
+void ui_display_transaction_row(const Transaction *transaction);
+
+/**
+ * @brief Print the closing line of the transactions table
+ */
+void ui_display_transactions_footer(void);
+
 /**
  * @brief Display a single transaction
  * @param transaction Pointer to Transaction
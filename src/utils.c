@@ -3,16 +3,91 @@
  * @brief Implementation of utility functions
  */
 
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L  // localtime_r
+#endif
+
 #include "utils.h"
+#include <stdatomic.h>
+
+static atomic_ulong generation_counter;
 
 void get_current_datetime(char *buffer, size_t size) {
     time_t rawtime;
-    struct tm *timeinfo;
+    struct tm timeinfo;
     
     time(&rawtime);
-    timeinfo = localtime(&rawtime);
+    // Stock movements may be logged from several threads
+#ifdef _WIN32
+    timeinfo = *localtime(&rawtime);  // MSVCRT keeps this buffer per thread
+#else
+    localtime_r(&rawtime, &timeinfo);
+#endif
+    
+    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &timeinfo);
+}
+
+// Civil calendar conversions (proleptic Gregorian, valid for any year)
+int date_to_days(const char *date, int *days) {
+    if (date == NULL || days == NULL) return 0;
+    
+    for (int i = 0; i < 10; i++) {
+        if (i == 4 || i == 7) {
+            if (date[i] != '-') return 0;
+        } else if (!isdigit((unsigned char)date[i])) {
+            return 0;
+        }
+    }
+    
+    int y = (date[0] - '0') * 1000 + (date[1] - '0') * 100 + (date[2] - '0') * 10 + (date[3] - '0');
+    int m = (date[5] - '0') * 10 + (date[6] - '0');
+    int d = (date[8] - '0') * 10 + (date[9] - '0');
+    if (m < 1 || m > 12 || d < 1 || d > 31) return 0;
     
-    strftime(buffer, size, "%Y-%m-%d %H:%M:%S", timeinfo);
+    y -= (m <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    *days = era * 146097 + doe - 719468;
+    return 1;
+}
+
+int datetime_to_seconds(const char *date_time, long long *seconds) {
+    int day, h = 0, m = 0, s = 0;
+    if (!date_to_days(date_time, &day)) return 0;
+    if (strlen(date_time) >= 19) {
+        sscanf(date_time + 11, "%d:%d:%d", &h, &m, &s);
+    }
+    *seconds = (long long)day * 86400 + h * 3600 + m * 60 + s;
+    return 1;
+}
+
+void days_to_date(int days, char *buffer, size_t size) {
+    int z = days + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int d = doy - (153 * mp + 2) / 5 + 1;
+    int m = mp + (mp < 10 ? 3 : -9);
+    int y = yoe + era * 400 + (m <= 2);
+    
+    snprintf(buffer, size, "%04d-%02d-%02d", y, m, d);
+}
+
+int current_day(void) {
+    char now[30];
+    int days = 0;
+    
+    get_current_datetime(now, sizeof(now));
+    date_to_days(now, &days);
+    return days;
+}
+
+unsigned long generation_next(void) {
+    return atomic_fetch_add(&generation_counter, 1) + 1;
 }
 
 void clear_input_buffer(void) {
@@ -157,8 +232,13 @@ int is_all_digits(const char *str) {
 }
 
 void print_separator(int length, char character) {
-    for (int i = 0; i < length; i++) {
-        putchar(character);
+    char line[128];
+    
+    memset(line, character, sizeof(line));
+    while (length > 0) {
+        int chunk = (length < (int)sizeof(line)) ? length : (int)sizeof(line);
+        fwrite(line, 1, (size_t)chunk, stdout);
+        length -= chunk;
     }
     putchar('\n');
 }
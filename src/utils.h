@@ -28,6 +28,46 @@
  */
 void get_current_datetime(char *buffer, size_t size);
 
+/**
+ * @brief Convert a "YYYY-MM-DD..." date to a day number
+ * @param date Date string (only the first 10 characters are read)
+ * @param days Output days since 1970-01-01
+ * @return 1 on success, 0 if the date is malformed
+ */
+int date_to_days(const char *date, int *days);
+
+/**
+ * @brief Convert "YYYY-MM-DD HH:MM:SS" (or just the date) to seconds since 1970-01-01
+ * @param date_time Date and optional time
+ * @param seconds Output seconds
+ * @return 1 on success, 0 if the date is malformed
+ */
+int datetime_to_seconds(const char *date_time, long long *seconds);
+
+/**
+ * @brief Format a day number as "YYYY-MM-DD"
+ * @param days Days since 1970-01-01
+ * @param buffer Output buffer (at least 11 bytes)
+ * @param size Size of the buffer
+ */
+void days_to_date(int days, char *buffer, size_t size);
+
+/**
+ * @brief Get today's day number (local time)
+ * @return Days since 1970-01-01
+ */
+int current_day(void);
+
+/**
+ * @brief Get a new, process-wide unique generation number
+ *
+ * Lists stamp themselves with a fresh generation on every change, so two
+ * equal generations always mean identical contents (thread-safe).
+ *
+ * @return Generation number (never 0)
+ */
+unsigned long generation_next(void);
+
 /**
  * @brief Clear the input buffer
  */
@@ -0,0 +1,290 @@
+/**
+ * @file view.c
+ * @brief Implementation of sorted table views
+ */
+
+#include "view.h"
+#include "utils.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Sort key of one row
+ */
+typedef struct {
+    unsigned long long key;
+    int row;
+} SortKey;
+
+/**
+ * @brief Read one column of a row
+ * @param list The list
+ * @param row Slot in the list
+ * @param column Column
+ * @param key Set for number columns
+ * @return The text of a text column, or NULL for a number column
+ */
+typedef const char* (*FieldFunc)(const void *list, int row, int column, unsigned long long *key);
+
+static const char *const product_columns[] = {
+    "ID", "Name", "Category", "Description", "Qty", "Reorder", "Price", "Supp ID"
+};
+static const char *const supplier_columns[] = {
+    "ID", "Name", "Contact", "Email", "Address"
+};
+static const char *const transaction_columns[] = {
+    "Trans ID", "Prod ID", "Type", "Qty", "Date/Time", "Notes"
+};
+
+static unsigned long long int_key(long long value) {
+    return (unsigned long long)value ^ (1ULL << 63);
+}
+
+static unsigned long long double_key(double value) {
+    unsigned long long bits;
+    if (value == 0.0) value = 0.0;  // -0.0 sorts with 0.0
+    memcpy(&bits, &value, sizeof(bits));
+    // Negative numbers order by inverted magnitude, positive ones above them
+    return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+// The next 8 bytes of text, lowercased, as a big-endian number ("" pads with 0)
+static unsigned long long text_key(const char *text) {
+    unsigned long long key = 0;
+    int i = 0;
+    
+    for (; i < 8 && text[i] != '\0'; i++) {
+        key = (key << 8) | (unsigned char)tolower((unsigned char)text[i]);
+    }
+    return (i > 0) ? key << (8 * (8 - i)) : 0;
+}
+
+static const char* product_field(const void *list, int row, int column, unsigned long long *key) {
+    const Product *p = &((const ProductList *)list)->products[row];
+    switch (column) {
+        case 0: *key = int_key(p->id); return NULL;
+        case 1: return p->name;
+        case 2: return p->category;
+        case 3: return p->description;
+        case 4: *key = int_key(p->quantity_in_stock); return NULL;
+        case 5: *key = int_key(p->reorder_level); return NULL;
+        case 6: *key = double_key(p->unit_price); return NULL;
+        default: *key = int_key(p->supplier_id); return NULL;
+    }
+}
+
+static const char* supplier_field(const void *list, int row, int column, unsigned long long *key) {
+    const Supplier *s = &((const SupplierList *)list)->suppliers[row];
+    switch (column) {
+        case 0: *key = int_key(s->supplier_id); return NULL;
+        case 1: return s->name;
+        case 2: return s->contact_number;
+        case 3: return s->email;
+        default: return s->address;
+    }
+}
+
+static const char* transaction_field(const void *list, int row, int column, unsigned long long *key) {
+    const Transaction *t = &((const TransactionList *)list)->transactions[row];
+    long long seconds;
+    switch (column) {
+        case 0: *key = int_key(t->transaction_id); return NULL;
+        case 1: *key = int_key(t->product_id); return NULL;
+        case 2: return t->type;
+        case 3: *key = int_key(t->quantity); return NULL;
+        case 4:
+            // Malformed dates sort first
+            *key = datetime_to_seconds(t->date_time, &seconds) ? int_key(seconds) : 0;
+            return NULL;
+        default: return t->notes;
+    }
+}
+
+/**
+ * @brief Stable LSD radix sort of keys, 8 bits per pass
+ * @param keys Keys to sort
+ * @param temp Scratch of the same size
+ * @param n Number of keys
+ */
+static void radix_sort(SortKey *keys, SortKey *temp, int n) {
+    int counts[8][256];
+    
+    // Short runs (most text ties) are cheaper to insert than to count
+    if (n <= 32) {
+        for (int i = 1; i < n; i++) {
+            SortKey k = keys[i];
+            int j = i;
+            while (j > 0 && keys[j - 1].key > k.key) {
+                keys[j] = keys[j - 1];
+                j--;
+            }
+            keys[j] = k;
+        }
+        return;
+    }
+    
+    memset(counts, 0, sizeof(counts));
+    for (int i = 0; i < n; i++) {
+        for (int d = 0; d < 8; d++) {
+            counts[d][(keys[i].key >> (8 * d)) & 0xFF]++;
+        }
+    }
+    
+    SortKey *from = keys;
+    SortKey *to = temp;
+    for (int d = 0; d < 8; d++) {
+        // A byte every key shares does not change the order
+        if (counts[d][(keys[0].key >> (8 * d)) & 0xFF] == n) continue;
+        
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int c = counts[d][b];
+            counts[d][b] = offset;
+            offset += c;
+        }
+        for (int i = 0; i < n; i++) {
+            to[counts[d][(from[i].key >> (8 * d)) & 0xFF]++] = from[i];
+        }
+        SortKey *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != keys) memcpy(keys, from, (size_t)n * sizeof(SortKey));
+}
+
+/**
+ * @brief Order runs of text rows whose keys tie on the bytes seen so far
+ *
+ * A key with a nonzero last byte means both texts go on, so the run is
+ * re-keyed on the next 8 bytes and sorted again.
+ *
+ * @param keys Sorted keys
+ * @param temp Scratch
+ * @param n Number of keys
+ * @param offset Bytes of text the keys already cover
+ * @param field Column reader
+ * @param list The list
+ * @param column Text column
+ */
+static void sort_text_runs(SortKey *keys, SortKey *temp, int n, int offset,
+                           FieldFunc field, const void *list, int column) {
+    int start = 0;
+    
+    while (start < n) {
+        int end = start + 1;
+        while (end < n && keys[end].key == keys[start].key) end++;
+        
+        if (end - start > 1 && (keys[start].key & 0xFF) != 0) {
+            for (int i = start; i < end; i++) {
+                unsigned long long unused;
+                const char *text = field(list, keys[i].row, column, &unused);
+                keys[i].key = text_key(text + offset + 8);
+            }
+            radix_sort(keys + start, temp, end - start);
+            sort_text_runs(keys + start, temp, end - start, offset + 8, field, list, column);
+        }
+        start = end;
+    }
+}
+
+/**
+ * @brief Get a cached permutation, sorting on a miss
+ */
+static const int* cached_order(ViewCache *cache, unsigned long generation, int count,
+                               int column, int columns, FieldFunc field, const void *list) {
+    if (cache == NULL || list == NULL || column < 0 || column >= columns) return NULL;
+    
+    // Permutations of older data can never be used again
+    if (cache->generation != generation || cache->count != count) {
+        view_cache_free(cache);
+        cache->generation = generation;
+        cache->count = count;
+    }
+    if (cache->orders[column] != NULL) return cache->orders[column];
+    
+    SortKey *keys = malloc((size_t)(count > 0 ? count : 1) * 2 * sizeof(SortKey));
+    int *order = malloc((size_t)(count > 0 ? count : 1) * sizeof(int));
+    if (keys == NULL || order == NULL) {
+        free(keys);
+        free(order);
+        return NULL;
+    }
+    SortKey *temp = keys + count;
+    
+    int is_text = 0;
+    for (int i = 0; i < count; i++) {
+        const char *text = field(list, i, column, &keys[i].key);
+        if (text != NULL) {
+            keys[i].key = text_key(text);
+            is_text = 1;
+        }
+        keys[i].row = i;
+    }
+    
+    if (count > 1) {
+        radix_sort(keys, temp, count);
+        if (is_text) sort_text_runs(keys, temp, count, 0, field, list, column);
+    }
+    
+    for (int i = 0; i < count; i++) order[i] = keys[i].row;
+    free(keys);
+    
+    cache->orders[column] = order;
+    return order;
+}
+
+void view_cache_init(ViewCache *cache) {
+    if (cache == NULL) return;
+    memset(cache, 0, sizeof(ViewCache));
+}
+
+void view_cache_free(ViewCache *cache) {
+    if (cache == NULL) return;
+    
+    for (int i = 0; i < VIEW_MAX_COLUMNS; i++) {
+        free(cache->orders[i]);
+        cache->orders[i] = NULL;
+    }
+}
+
+int view_column_count(ViewTable table) {
+    switch (table) {
+        case VIEW_PRODUCTS: return (int)(sizeof(product_columns) / sizeof(product_columns[0]));
+        case VIEW_SUPPLIERS: return (int)(sizeof(supplier_columns) / sizeof(supplier_columns[0]));
+        default: return (int)(sizeof(transaction_columns) / sizeof(transaction_columns[0]));
+    }
+}
+
+const char* view_column_name(ViewTable table, int column) {
+    if (column < 0 || column >= view_column_count(table)) return "list order";
+    
+    switch (table) {
+        case VIEW_PRODUCTS: return product_columns[column];
+        case VIEW_SUPPLIERS: return supplier_columns[column];
+        default: return transaction_columns[column];
+    }
+}
+
+const int* view_sort_products(ViewCache *cache, const ProductList *list, int column) {
+    if (list == NULL) return NULL;
+    return cached_order(cache, list->generation, list->count, column,
+                        view_column_count(VIEW_PRODUCTS), product_field, list);
+}
+
+const int* view_sort_suppliers(ViewCache *cache, const SupplierList *list, int column) {
+    if (list == NULL) return NULL;
+    return cached_order(cache, list->generation, list->count, column,
+                        view_column_count(VIEW_SUPPLIERS), supplier_field, list);
+}
+
+const int* view_sort_transactions(ViewCache *cache, const TransactionList *list, int column) {
+    if (list == NULL) return NULL;
+    return cached_order(cache, list->generation, list->count, column,
+                        view_column_count(VIEW_TRANSACTIONS), transaction_field, list);
+}
+
+int view_row(const int *order, int count, int position, int descending) {
+    int index = descending ? count - 1 - position : position;
+    return (order != NULL) ? order[index] : index;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file view.h
+ * @brief Sorted, paged views of the product, supplier and transaction tables
+ * @author Inventory Management System
+ * @date 2025
+ *
+ * A sorted view is an index permutation of the list: order[i] is the slot
+ * of the i-th row. Permutations are built once per column and cached until
+ * the list's generation changes, so paging and reversing the direction
+ * never re-sort or copy rows. Descending order reads the ascending
+ * permutation from the end.
+ *
+ * Each row gets a 64-bit order-preserving key (integers and prices are
+ * mapped to unsigned order, dates to seconds, text to its first 8
+ * lowercased bytes), the keys are radix sorted, and only runs of text rows
+ * that share a prefix are compared in full. Text sorts ignore case. Equal
+ * rows keep list order.
+ */
+
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "product.h"
+#include "supplier.h"
+#include "transaction.h"
+
+#define VIEW_PAGE_ROWS 20           // Rows per page
+#define VIEW_MAX_COLUMNS 8          // Most sortable columns of any table
+#define VIEW_LIST_ORDER (-1)        // Column value for the unsorted list order
+
+/**
+ * @brief Tables that can be viewed
+ */
+typedef enum {
+    VIEW_PRODUCTS,
+    VIEW_SUPPLIERS,
+    VIEW_TRANSACTIONS
+} ViewTable;
+
+/**
+ * @brief Cached sort permutations of one table
+ *
+ * Zero-initialize (or view_cache_init), and free with view_cache_free.
+ */
+typedef struct {
+    int *orders[VIEW_MAX_COLUMNS];  ///< Permutation per column (NULL = not built)
+    int count;                      ///< Rows the permutations cover
+    unsigned long generation;       ///< List generation they were built at
+} ViewCache;
+
+/**
+ * @brief Initialize an empty cache
+ * @param cache Cache to initialize
+ */
+void view_cache_init(ViewCache *cache);
+
+/**
+ * @brief Release all cached permutations
+ * @param cache Cache to free
+ */
+void view_cache_free(ViewCache *cache);
+
+/**
+ * @brief Number of sortable columns of a table
+ * @param table Table
+ * @return Column count
+ */
+int view_column_count(ViewTable table);
+
+/**
+ * @brief Heading of a column
+ * @param table Table
+ * @param column Column (0-based, or VIEW_LIST_ORDER)
+ * @return Column name ("list order" for VIEW_LIST_ORDER)
+ */
+const char* view_column_name(ViewTable table, int column);
+
+/**
+ * @brief Get the products sorted ascending by a column
+ *
+ * Columns: ID, Name, Category, Description, Qty, Reorder, Price, Supp ID.
+ *
+ * @param cache Cache of the product table
+ * @param list Products
+ * @param column Column (0-based)
+ * @return Permutation of list->count slots (owned by the cache), or NULL on
+ *         allocation failure or a bad column
+ */
+const int* view_sort_products(ViewCache *cache, const ProductList *list, int column);
+
+/**
+ * @brief Get the suppliers sorted ascending by a column
+ *
+ * Columns: ID, Name, Contact, Email, Address.
+ *
+ * @param cache Cache of the supplier table
+ * @param list Suppliers
+ * @param column Column (0-based)
+ * @return Permutation (owned by the cache), or NULL on failure
+ */
+const int* view_sort_suppliers(ViewCache *cache, const SupplierList *list, int column);
+
+/**
+ * @brief Get the transactions sorted ascending by a column
+ *
+ * Columns: Trans ID, Prod ID, Type, Qty, Date/Time, Notes.
+ *
+ * @param cache Cache of the transaction table
+ * @param list Transactions
+ * @param column Column (0-based)
+ * @return Permutation (owned by the cache), or NULL on failure
+ */
+const int* view_sort_transactions(ViewCache *cache, const TransactionList *list, int column);
+
+/**
+ * @brief Map a display position to a list slot
+ * @param order Permutation, or NULL for list order
+ * @param count Rows in the table
+ * @param position Display position (0-based)
+ * @param descending Nonzero to read the order from the end
+ * @return List slot
+ */
+int view_row(const int *order, int count, int position, int descending);
+
+#endif /* VIEW_H */